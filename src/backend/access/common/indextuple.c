@@ -18,6 +18,7 @@
 
 #include "access/heapam.h"
 #include "access/itup.h"
+#include "access/toast_compression.h"
 #include "access/tuptoaster.h"
 
 
@@ -92,7 +93,8 @@ index_form_tuple(TupleDesc tupleDescriptor,
 		VARSIZE(DatumGetPointer(untoasted_values[i])) > TOAST_INDEX_TARGET &&
 			(att->attstorage == 'x' || att->attstorage == 'm'))
 		{
-			Datum		cvalue = toast_compress_datum(untoasted_values[i]);
+			Datum		cvalue = toast_compress_datum(untoasted_values[i],
+											  default_toast_compression);
 
 			if (DatumGetPointer(cvalue) != NULL)
 			{
@@ -441,3 +443,34 @@ CopyIndexTuple(IndexTuple source)
 	memcpy(result, source, size);
 	return result;
 }
+
+/*
+ * Truncate tailing attributes from given index tuple leaving it with
+ * new_indnatts number of attributes.
+ *
+ * The result is a palloc'd copy; the source tuple is not modified.  The
+ * truncated tuple keeps the source's t_tid.  Since an index tuple's null
+ * bitmap has a fixed size, the remaining attributes can still be fetched
+ * using the full tuple descriptor of the index.
+ */
+IndexTuple
+index_truncate_tuple(TupleDesc tupleDescriptor, IndexTuple olditup,
+					 int new_indnatts)
+{
+	TupleDesc	itupdesc = CreateTupleDescCopy(tupleDescriptor);
+	Datum		values[INDEX_MAX_KEYS];
+	bool		isnull[INDEX_MAX_KEYS];
+	IndexTuple	newitup;
+
+	Assert(new_indnatts > 0 && new_indnatts <= tupleDescriptor->natts);
+
+	itupdesc->natts = new_indnatts;
+
+	index_deform_tuple(olditup, tupleDescriptor, values, isnull);
+	newitup = index_form_tuple(itupdesc, values, isnull);
+	newitup->t_tid = olditup->t_tid;
+
+	FreeTupleDesc(itupdesc);
+	Assert(IndexTupleSize(newitup) <= IndexTupleSize(olditup));
+	return newitup;
+}
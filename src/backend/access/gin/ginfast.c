@@ -3,9 +3,12 @@
  * ginfast.c
  *	  Fast insert routines for the Postgres inverted index access method.
  *	  Pending entries are stored in linear list of pages.  Later on
- *	  (typically during VACUUM), ginInsertCleanup() will be invoked to
- *	  transfer pending entries into the regular index structure.  This
- *	  wins because bulk insertion is much more efficient than retail.
+ *	  (typically during VACUUM or autovacuum's ANALYZE), ginInsertCleanup()
+ *	  will be invoked to transfer pending entries into the regular index
+ *	  structure.  This wins because bulk insertion is much more efficient
+ *	  than retail.  An insertion that finds the pending list over its limit
+ *	  only moves a bounded portion of it, so that a single unlucky insert
+ *	  doesn't pay for the whole list.
  *
  * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -19,9 +22,13 @@
 #include "postgres.h"
 
 #include "access/gin_private.h"
+#include "access/xlog.h"
 #include "access/xloginsert.h"
+#include "catalog/pg_am.h"
 #include "commands/vacuum.h"
 #include "miscadmin.h"
+#include "storage/lmgr.h"
+#include "utils/acl.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
@@ -415,12 +422,11 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 		UnlockReleaseBuffer(buffer);
 
 	/*
-	 * Force pending list cleanup when it becomes too long. And,
-	 * ginInsertCleanup could take significant amount of time, so we prefer to
-	 * call it when it can do all the work in a single collection cycle. In
-	 * non-vacuum mode, it shouldn't require maintenance_work_mem, so fire it
-	 * while pending list is still small enough to fit into
-	 * gin_pending_list_limit.
+	 * Force pending list cleanup when it becomes too long.  In non-vacuum
+	 * mode ginInsertCleanup only does a single collection cycle bounded by
+	 * work_mem, and gives up at once if another backend is already cleaning
+	 * the list, so the cost charged to this insertion stays bounded; the
+	 * rest is left to later insertions and to (auto)vacuum.
 	 *
 	 * ginInsertCleanup() should not be called inside our CRIT_SECTION.
 	 */
@@ -712,26 +718,32 @@ processPendingPage(BuildAccumulator *accum, KeyArray *ka,
 /*
  * Move tuples from pending pages into regular GIN structure.
  *
- * This can be called concurrently by multiple backends, so it must cope.
- * On first glance it looks completely not concurrent-safe and not crash-safe
- * either.  The reason it's okay is that multiple insertion of the same entry
- * is detected and treated as a no-op by gininsert.c.  If we crash after
- * posting entries to the main index and before removing them from the
- * pending list, it's okay because when we redo the posting later on, nothing
- * bad will happen.  Likewise, if two backends simultaneously try to post
- * a pending entry into the main index, one will succeed and one will do
- * nothing.  We try to notice when someone else is a little bit ahead of
- * us in the process, but that's just to avoid wasting cycles.  Only the
- * action of removing a page from the pending list really needs exclusive
- * lock.
+ * On first glance this looks completely not crash-safe.  The reason it's
+ * okay is that multiple insertion of the same entry is detected and treated
+ * as a no-op by gininsert.c.  If we crash after posting entries to the main
+ * index and before removing them from the pending list, it's okay because
+ * when we redo the posting later on, nothing bad will happen.
+ *
+ * Only one backend cleans up the pending list at a time; that is enforced
+ * with a heavyweight page lock on the metapage, which unlike the buffer
+ * locks can be held across the whole operation.  Letting several backends
+ * merge the same pending pages only wastes work, and under a heavy insert
+ * load it made every inserter that crossed the limit pile into the cleanup.
+ * The code still copes with a concurrent cleanup (the GinPageIsDeleted
+ * checks), since it does no harm to be careful.
+ *
+ * full_clean indicates that ginInsertCleanup is called from vacuum or from
+ * gin_clean_pending_list(): we wait for the cleanup lock, process the whole
+ * list using maintenance_work_mem, and call vacuum_delay_point()
+ * periodically.  Otherwise we're called from an insertion: if someone else
+ * is already cleaning up we just return, and we stop after the first
+ * collection cycle, whose memory is bounded by work_mem.
  *
- * vac_delay indicates that ginInsertCleanup is called from vacuum process,
- * so call vacuum_delay_point() periodically.
  * If stats isn't null, we count deleted pending pages into the counts.
  */
 void
 ginInsertCleanup(GinState *ginstate,
-				 bool vac_delay, IndexBulkDeleteResult *stats)
+				 bool full_clean, IndexBulkDeleteResult *stats)
 {
 	Relation	index = ginstate->index;
 	Buffer		metabuffer,
@@ -744,6 +756,20 @@ ginInsertCleanup(GinState *ginstate,
 	BuildAccumulator accum;
 	KeyArray	datums;
 	BlockNumber blkno;
+	long		workMemory;
+
+	if (full_clean)
+	{
+		LockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock);
+		workMemory = maintenance_work_mem;
+	}
+	else
+	{
+		/* someone else is cleaning up, no need for us to wait */
+		if (!ConditionalLockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock))
+			return;
+		workMemory = work_mem;
+	}
 
 	metabuffer = ReadBuffer(index, GIN_METAPAGE_BLKNO);
 	LockBuffer(metabuffer, GIN_SHARE);
@@ -754,6 +780,7 @@ ginInsertCleanup(GinState *ginstate,
 	{
 		/* Nothing to do */
 		UnlockReleaseBuffer(metabuffer);
+		UnlockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock);
 		return;
 	}
 
@@ -801,7 +828,7 @@ ginInsertCleanup(GinState *ginstate,
 		 */
 		processPendingPage(&accum, &datums, page, FirstOffsetNumber);
 
-		if (vac_delay)
+		if (full_clean)
 			vacuum_delay_point();
 
 		/*
@@ -814,7 +841,7 @@ ginInsertCleanup(GinState *ginstate,
 		 */
 		if (GinPageGetOpaque(page)->rightlink == InvalidBlockNumber ||
 			(GinPageHasFullRow(page) &&
-			 (accum.allocatedMemory >= maintenance_work_mem * 1024L)))
+			 (accum.allocatedMemory >= workMemory * 1024L)))
 		{
 			ItemPointerData *list;
 			uint32		nlist;
@@ -842,7 +869,7 @@ ginInsertCleanup(GinState *ginstate,
 			{
 				ginEntryInsert(ginstate, attnum, key, category,
 							   list, nlist, NULL);
-				if (vac_delay)
+				if (full_clean)
 					vacuum_delay_point();
 			}
 
@@ -902,9 +929,10 @@ ginInsertCleanup(GinState *ginstate,
 			LockBuffer(metabuffer, GIN_UNLOCK);
 
 			/*
-			 * if we removed the whole pending list just exit
+			 * if we removed the whole pending list just exit; an insertion
+			 * does only one collection cycle, leaving the rest to others
 			 */
-			if (blkno == InvalidBlockNumber)
+			if (blkno == InvalidBlockNumber || !full_clean)
 				break;
 
 			/*
@@ -930,8 +958,62 @@ ginInsertCleanup(GinState *ginstate,
 	}
 
 	ReleaseBuffer(metabuffer);
+	UnlockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock);
 
 	/* Clean up temporary space */
 	MemoryContextSwitchTo(oldCtx);
 	MemoryContextDelete(opCtx);
 }
+
+/*
+ * SQL-callable function to move all entries of a GIN index's pending list
+ * into the main index structure.  This allows the pending list to be
+ * drained on a schedule of the user's choosing, outside of both the
+ * inserting transactions and (auto)vacuum.  Returns the number of pending
+ * list pages removed.
+ */
+Datum
+gin_clean_pending_list(PG_FUNCTION_ARGS)
+{
+	Oid			indexoid = PG_GETARG_OID(0);
+	Relation	indexRel = index_open(indexoid, AccessShareLock);
+	IndexBulkDeleteResult stats;
+	GinState	ginstate;
+
+	if (RecoveryInProgress())
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("recovery is in progress"),
+		 errhint("GIN pending list cannot be cleaned up during recovery.")));
+
+	/* Must be a GIN index */
+	if (indexRel->rd_rel->relkind != RELKIND_INDEX ||
+		indexRel->rd_rel->relam != GIN_AM_OID)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("\"%s\" is not a GIN index",
+						RelationGetRelationName(indexRel))));
+
+	/*
+	 * Reject attempts to read non-local temporary relations; we would be
+	 * likely to get wrong data since we have no visibility into the owning
+	 * session's local buffers.
+	 */
+	if (RELATION_IS_OTHER_TEMP(indexRel))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			   errmsg("cannot access temporary indexes of other sessions")));
+
+	/* User must own the index (comparable to privileges needed for VACUUM) */
+	if (!pg_class_ownercheck(indexoid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER, ACL_KIND_CLASS,
+					   RelationGetRelationName(indexRel));
+
+	memset(&stats, 0, sizeof(stats));
+	initGinState(&ginstate, indexRel);
+	ginInsertCleanup(&ginstate, true, &stats);
+
+	index_close(indexRel, AccessShareLock);
+
+	PG_RETURN_INT64((int64) stats.pages_deleted);
+}
@@ -571,6 +571,47 @@ startScan(IndexScanDesc scan)
 		startScanKey(ginstate, so, so->keys + i);
 }
 
+/*
+ * Find the first item in items[start .. nitems - 1] that is > advancePast,
+ * and return its index, or nitems if there is none.
+ *
+ * The items must be in ascending order.  We gallop forward from 'start' in
+ * exponentially growing steps and then binary search within the last step,
+ * so that skipping a long run of items costs O(log n) comparisons, while
+ * advancing by just a few items, the common case, stays cheap.
+ */
+static int
+ginSkipItemsTo(ItemPointer items, int start, int nitems,
+			   ItemPointerData advancePast)
+{
+	int			lo = start;
+	int			hi;
+	int			step = 1;
+
+	/* Gallop until items[hi] > advancePast, or we run off the end */
+	hi = start;
+	while (hi < nitems && ginCompareItemPointers(&items[hi], &advancePast) <= 0)
+	{
+		lo = hi + 1;
+		hi += step;
+		step *= 2;
+	}
+	if (hi > nitems)
+		hi = nitems;
+
+	/* Now items[lo - 1] <= advancePast, and items[hi] > advancePast */
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (ginCompareItemPointers(&items[mid], &advancePast) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
 /*
  * Load the next batch of item pointers from a posting tree.
  *
@@ -694,22 +735,20 @@ entryLoadMoreItems(GinState *ginstate, GinScanEntry entry, ItemPointerData advan
 
 		entry->list = GinDataLeafPageGetItems(page, &entry->nlist, advancePast);
 
-		for (i = 0; i < entry->nlist; i++)
+		i = ginSkipItemsTo(entry->list, 0, entry->nlist, advancePast);
+		if (i < entry->nlist)
 		{
-			if (ginCompareItemPointers(&advancePast, &entry->list[i]) < 0)
-			{
-				entry->offset = i;
+			entry->offset = i;
 
-				if (GinPageRightMost(page))
-				{
-					/* after processing the copied items, we're done. */
-					UnlockReleaseBuffer(entry->buffer);
-					entry->buffer = InvalidBuffer;
-				}
-				else
-					LockBuffer(entry->buffer, GIN_UNLOCK);
-				return;
+			if (GinPageRightMost(page))
+			{
+				/* after processing the copied items, we're done. */
+				UnlockReleaseBuffer(entry->buffer);
+				entry->buffer = InvalidBuffer;
 			}
+			else
+				LockBuffer(entry->buffer, GIN_UNLOCK);
+			return;
 		}
 	}
 }
@@ -832,8 +871,13 @@ entryGetItem(GinState *ginstate, GinScanEntry entry,
 	{
 		/*
 		 * A posting list from an entry tuple, or the last page of a posting
-		 * tree.
+		 * tree.  Skip directly past the items <= advancePast; when another
+		 * key lets us jump far ahead, that is much cheaper than stepping
+		 * through them one at a time.
 		 */
+		if (ItemPointerIsValid(&advancePast) && entry->offset < entry->nlist)
+			entry->offset = ginSkipItemsTo(entry->list, entry->offset,
+										   entry->nlist, advancePast);
 		do
 		{
 			if (entry->offset >= entry->nlist)
@@ -850,6 +894,9 @@ entryGetItem(GinState *ginstate, GinScanEntry entry,
 	else
 	{
 		/* A posting tree */
+		if (ItemPointerIsValid(&advancePast) && entry->offset < entry->nlist)
+			entry->offset = ginSkipItemsTo(entry->list, entry->offset,
+										   entry->nlist, advancePast);
 		do
 		{
 			/* If we've processed the current batch, load more items */
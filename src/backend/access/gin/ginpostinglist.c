@@ -292,23 +292,22 @@ ginPostingListDecodeAllSegments(GinPostingList *segment, int len, int *ndecoded_
 	int			ndecoded;
 	unsigned char *ptr;
 	unsigned char *endptr;
+	GinPostingList *seg;
 
 	/*
-	 * Guess an initial size of the array.
+	 * Every item but the first in a segment takes at least one byte, so we
+	 * can compute an upper bound for the number of items from the segment
+	 * headers alone.  Sizing the output array up front lets the decoding
+	 * loop below run without checking for overflow on every item.
 	 */
-	nallocated = segment->nbytes * 2 + 1;
-	result = palloc(nallocated * sizeof(ItemPointerData));
+	nallocated = 0;
+	for (seg = segment; (char *) seg < endseg; seg = GinNextPostingListSegment(seg))
+		nallocated += 1 + seg->nbytes;
+	result = palloc(Max(nallocated, 1) * sizeof(ItemPointerData));
 
 	ndecoded = 0;
 	while ((char *) segment < endseg)
 	{
-		/* enlarge output array if needed */
-		if (ndecoded >= nallocated)
-		{
-			nallocated *= 2;
-			result = repalloc(result, nallocated * sizeof(ItemPointerData));
-		}
-
 		/* copy the first item */
 		Assert(OffsetNumberIsValid(ItemPointerGetOffsetNumber(&segment->first)));
 		Assert(ndecoded == 0 || ginCompareItemPointers(&segment->first, &result[ndecoded - 1]) > 0);
@@ -320,11 +319,30 @@ ginPostingListDecodeAllSegments(GinPostingList *segment, int len, int *ndecoded_
 		endptr = segment->bytes + segment->nbytes;
 		while (ptr < endptr)
 		{
-			/* enlarge output array if needed */
-			if (ndecoded >= nallocated)
+			/*
+			 * Fast path for dense lists: if none of the next eight bytes has
+			 * the continuation bit set, they are eight single-byte deltas,
+			 * and we can decode them without examining each byte for
+			 * continuation separately.
+			 */
+			if (endptr - ptr >= sizeof(uint64))
 			{
-				nallocated *= 2;
-				result = repalloc(result, nallocated * sizeof(ItemPointerData));
+				uint64		chunk;
+
+				memcpy(&chunk, ptr, sizeof(uint64));
+				if ((chunk & UINT64CONST(0x8080808080808080)) == 0)
+				{
+					int			i;
+
+					for (i = 0; i < sizeof(uint64); i++)
+					{
+						val += ptr[i];
+						uint64_to_itemptr(val, &result[ndecoded]);
+						ndecoded++;
+					}
+					ptr += sizeof(uint64);
+					continue;
+				}
 			}
 
 			val += decode_varbyte(&ptr);
@@ -334,6 +352,7 @@ ginPostingListDecodeAllSegments(GinPostingList *segment, int len, int *ndecoded_
 		}
 		segment = GinNextPostingListSegment(segment);
 	}
+	Assert(ndecoded <= nallocated);
 
 	if (ndecoded_out)
 		*ndecoded_out = ndecoded;
@@ -26,6 +26,14 @@
 #include "storage/smgr.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
+#include "utils/tuplesort.h"
+
+/*
+ * LSN given to the pages of a sorted build that are not WAL-logged because
+ * wal_level is minimal.  Any valid LSN would do, as nothing can have been
+ * split yet.
+ */
+#define GistBuildLSN	((XLogRecPtr) 1)
 
 /* Step of index tuples for check whether to switch to buffering build mode */
 #define BUFFERING_MODE_SWITCH_CHECK_STEP 256
@@ -48,7 +56,8 @@ typedef enum
 	GIST_BUFFERING_STATS,		/* gathering statistics of index tuple size
 								 * before switching to the buffering build
 								 * mode */
-	GIST_BUFFERING_ACTIVE		/* in buffering build mode */
+	GIST_BUFFERING_ACTIVE,		/* in buffering build mode */
+	GIST_SORTED_BUILD			/* bottom-up build of pre-sorted tuples */
 } GistBufferingMode;
 
 /* Working state for gistbuild and its callback */
@@ -71,8 +80,30 @@ typedef struct
 	HTAB	   *parentMap;
 
 	GistBufferingMode bufferingMode;
+
+	/*
+	 * Extra data structures used during a sorted build.  'sortstate' holds
+	 * the tuples to be loaded, and the rest keeps track of the pages written
+	 * directly to disk, like in nbtsort.c.
+	 */
+	Tuplesortstate *sortstate;
+	bool		use_wal;		/* dump pages to WAL? */
+	BlockNumber pages_allocated;	/* # of pages allocated */
+	BlockNumber pages_written;	/* # of pages written out */
+	Page		zeropage;		/* workspace for filling zeroes */
 } GISTBuildState;
 
+/*
+ * In sorted build, we use a stack of these structs, one for each level, to
+ * hold an in-memory buffer of the rightmost page at the level.  When the page
+ * fills up, it is written out and a new page is allocated.
+ */
+typedef struct GistSortedBuildPageState
+{
+	Page		page;
+	struct GistSortedBuildPageState *parent;	/* Upper level, if any */
+} GistSortedBuildPageState;
+
 /* prototypes for private functions */
 static void gistInitBuffering(GISTBuildState *buildstate);
 static int	calculatePagesPerBuffer(GISTBuildState *buildstate, int levelStep);
@@ -98,6 +129,24 @@ static void gistProcessEmptyingQueue(GISTBuildState *buildstate);
 static void gistEmptyAllBuffers(GISTBuildState *buildstate);
 static int	gistGetMaxLevel(Relation index);
 
+static double gistInsertBuild(Relation heap, Relation index,
+				IndexInfo *indexInfo, GISTBuildState *buildstate);
+static bool gistCanSortedBuild(Relation index);
+static void gistSortedBuildCallback(Relation index,
+						HeapTuple htup,
+						Datum *values,
+						bool *isnull,
+						bool tupleIsAlive,
+						void *state);
+static void gist_indexsortbuild(GISTBuildState *state);
+static void gist_indexsortbuild_pagestate_add(GISTBuildState *state,
+								  GistSortedBuildPageState *pagestate,
+								  IndexTuple itup);
+static void gist_indexsortbuild_pagestate_flush(GISTBuildState *state,
+									GistSortedBuildPageState *pagestate);
+static void gist_indexsortbuild_writepage(GISTBuildState *state, Page page,
+							  BlockNumber blkno);
+
 static void gistInitParentMap(GISTBuildState *buildstate);
 static void gistMemorizeParent(GISTBuildState *buildstate, BlockNumber child,
 				   BlockNumber parent);
@@ -105,9 +154,14 @@ static void gistMemorizeAllDownlinks(GISTBuildState *buildstate, Buffer parent);
 static BlockNumber gistGetParent(GISTBuildState *buildstate, BlockNumber child);
 
 /*
- * Main entry point to GiST index build. Initially calls insert over and over,
- * but switches to more efficient buffering build algorithm after a certain
- * number of tuples (unless buffering mode is disabled).
+ * Main entry point to GiST index build.
+ *
+ * If all the opclasses of the index provide a sort support function, and
+ * buffering isn't explicitly requested or disabled, the heap tuples are
+ * sorted and the index is built bottom-up from them, which is much faster.
+ * Otherwise we call insert over and over, but switch to the more efficient
+ * buffering build algorithm after a certain number of tuples (unless
+ * buffering mode is disabled).
  */
 Datum
 gistbuild(PG_FUNCTION_ARGS)
@@ -118,8 +172,6 @@ gistbuild(PG_FUNCTION_ARGS)
 	IndexBuildResult *result;
 	double		reltuples;
 	GISTBuildState buildstate;
-	Buffer		buffer;
-	Page		page;
 	MemoryContext oldcxt = CurrentMemoryContext;
 	int			fillfactor;
 
@@ -169,6 +221,67 @@ gistbuild(PG_FUNCTION_ARGS)
 	 */
 	buildstate.giststate->tempCxt = createTempGistContext();
 
+	/* build the index */
+	buildstate.indtuples = 0;
+	buildstate.indtuplesSize = 0;
+
+	if (buildstate.bufferingMode == GIST_BUFFERING_AUTO &&
+		gistCanSortedBuild(index))
+	{
+		buildstate.bufferingMode = GIST_SORTED_BUILD;
+
+		/*
+		 * Sort all the tuples, then build the index bottom-up from the
+		 * sorted stream.
+		 */
+		buildstate.sortstate = tuplesort_begin_index_gist(heap,
+														  index,
+														  maintenance_work_mem,
+														  false);
+
+		reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
+									   gistSortedBuildCallback,
+									   (void *) &buildstate);
+
+		tuplesort_performsort(buildstate.sortstate);
+
+		gist_indexsortbuild(&buildstate);
+
+		tuplesort_end(buildstate.sortstate);
+	}
+	else
+		reltuples = gistInsertBuild(heap, index, indexInfo, &buildstate);
+
+	/* okay, all heap tuples are indexed */
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(buildstate.giststate->tempCxt);
+
+	freeGISTstate(buildstate.giststate);
+
+	/*
+	 * Return statistics
+	 */
+	result = (IndexBuildResult *) palloc(sizeof(IndexBuildResult));
+
+	result->heap_tuples = reltuples;
+	result->index_tuples = (double) buildstate.indtuples;
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Build the index by inserting the tuples one by one, possibly switching to
+ * the buffering build algorithm on the way.  Returns the number of heap
+ * tuples scanned.
+ */
+static double
+gistInsertBuild(Relation heap, Relation index, IndexInfo *indexInfo,
+				GISTBuildState *buildstate)
+{
+	double		reltuples;
+	Buffer		buffer;
+	Page		page;
+
 	/* initialize the root page */
 	buffer = gistNewBuffer(index);
 	Assert(BufferGetBlockNumber(buffer) == GIST_ROOT_BLKNO);
@@ -197,42 +310,313 @@ gistbuild(PG_FUNCTION_ARGS)
 
 	END_CRIT_SECTION();
 
-	/* build the index */
-	buildstate.indtuples = 0;
-	buildstate.indtuplesSize = 0;
-
 	/*
 	 * Do the heap scan.
 	 */
 	reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
-								   gistBuildCallback, (void *) &buildstate);
+								   gistBuildCallback, (void *) buildstate);
 
 	/*
 	 * If buffering was used, flush out all the tuples that are still in the
 	 * buffers.
 	 */
-	if (buildstate.bufferingMode == GIST_BUFFERING_ACTIVE)
+	if (buildstate->bufferingMode == GIST_BUFFERING_ACTIVE)
 	{
 		elog(DEBUG1, "all tuples processed, emptying buffers");
-		gistEmptyAllBuffers(&buildstate);
-		gistFreeBuildBuffers(buildstate.gfbb);
+		gistEmptyAllBuffers(buildstate);
+		gistFreeBuildBuffers(buildstate->gfbb);
 	}
 
-	/* okay, all heap tuples are indexed */
-	MemoryContextSwitchTo(oldcxt);
-	MemoryContextDelete(buildstate.giststate->tempCxt);
+	return reltuples;
+}
 
-	freeGISTstate(buildstate.giststate);
+/*-------------------------------------------------------------------------
+ * Routines for the sorted build
+ *-------------------------------------------------------------------------
+ */
+
+/*
+ * Can the index be built by sorting?  That requires a sort support function
+ * for every column.
+ */
+static bool
+gistCanSortedBuild(Relation index)
+{
+	int			i;
+
+	for (i = 0; i < IndexRelationGetNumberOfKeyAttributes(index); i++)
+	{
+		if (!OidIsValid(index_getprocid(index, i + 1, GIST_SORTSUPPORT_PROC)))
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Per-tuple callback from IndexBuildHeapScan, for the sorted build.
+ */
+static void
+gistSortedBuildCallback(Relation index,
+						HeapTuple htup,
+						Datum *values,
+						bool *isnull,
+						bool tupleIsAlive,
+						void *state)
+{
+	GISTBuildState *buildstate = (GISTBuildState *) state;
+	MemoryContext oldCtx;
+	Datum		compressed_values[INDEX_MAX_KEYS];
+
+	oldCtx = MemoryContextSwitchTo(buildstate->giststate->tempCxt);
+
+	/* Form an index tuple and point it at the heap tuple */
+	gistCompressValues(buildstate->giststate, index,
+					   values, isnull,
+					   true, compressed_values);
+
+	tuplesort_putindextuplevalues(buildstate->sortstate,
+								  buildstate->indexrel,
+								  &htup->t_self,
+								  compressed_values, isnull);
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextReset(buildstate->giststate->tempCxt);
+
+	/* Update tuple count. */
+	buildstate->indtuples += 1;
+}
+
+/*
+ * Build GiST index from bottom up from pre-sorted tuples.
+ *
+ * Like nbtsort.c, the pages are assembled in local memory and written out
+ * with smgrextend as soon as they're full, bypassing shared buffers.  The
+ * downlink for a page is the union of all the tuples on it, and is added to
+ * the page one level up, so the tree grows upwards as the leaf level is
+ * filled.  Block 0 is reserved for the root and written last.
+ */
+static void
+gist_indexsortbuild(GISTBuildState *state)
+{
+	IndexTuple	itup;
+	bool		should_free;
+	GistSortedBuildPageState *leafstate;
+	GistSortedBuildPageState *pagestate;
+	Page		page;
+
+	state->use_wal = XLogIsNeeded() && RelationNeedsWAL(state->indexrel);
+	state->pages_allocated = 0;
+	state->pages_written = 0;
+	state->zeropage = NULL;
+
+	/* Reserve block 0 for the root page */
+	state->pages_allocated = 1;
+
+	/* Allocate a temporary buffer for the first leaf page. */
+	leafstate = palloc(sizeof(GistSortedBuildPageState));
+	leafstate->page = (Page) palloc(BLCKSZ);
+	leafstate->parent = NULL;
+	gistinitpage(leafstate->page, F_LEAF);
 
 	/*
-	 * Return statistics
+	 * Fill index pages with tuples in the sorted order.
 	 */
-	result = (IndexBuildResult *) palloc(sizeof(IndexBuildResult));
+	while ((itup = tuplesort_getindextuple(state->sortstate, true,
+										   &should_free)) != NULL)
+	{
+		gist_indexsortbuild_pagestate_add(state, leafstate, itup);
+		MemoryContextReset(state->giststate->tempCxt);
+		if (should_free)
+			pfree(itup);
+	}
 
-	result->heap_tuples = reltuples;
-	result->index_tuples = (double) buildstate.indtuples;
+	/*
+	 * Write out the partially full non-root pages.
+	 *
+	 * Keep in mind that flush can build a new root.
+	 */
+	pagestate = leafstate;
+	while (pagestate->parent != NULL)
+	{
+		GistSortedBuildPageState *parent;
 
-	PG_RETURN_POINTER(result);
+		gist_indexsortbuild_pagestate_flush(state, pagestate);
+		parent = pagestate->parent;
+		pfree(pagestate->page);
+		pfree(pagestate);
+		pagestate = parent;
+	}
+
+	/*
+	 * The topmost page is the root.  It's a leaf if the whole index fits on a
+	 * single page.
+	 */
+	page = pagestate->page;
+	gist_indexsortbuild_writepage(state, page, GIST_ROOT_BLKNO);
+	pfree(page);
+	pfree(pagestate);
+
+	/*
+	 * If the index is WAL-logged, we must fsync it down to disk before it's
+	 * safe to commit the transaction.  See the comments in nbtsort.c's
+	 * _bt_load for why that is necessary even when the pages were WAL-logged.
+	 */
+	if (RelationNeedsWAL(state->indexrel))
+	{
+		RelationOpenSmgr(state->indexrel);
+		smgrimmedsync(state->indexrel->rd_smgr, MAIN_FORKNUM);
+	}
+
+	if (state->zeropage)
+		pfree(state->zeropage);
+}
+
+/*
+ * Add tuple to a page. If the page is full, write it out and re-initialize
+ * a new page first.
+ */
+static void
+gist_indexsortbuild_pagestate_add(GISTBuildState *state,
+								  GistSortedBuildPageState *pagestate,
+								  IndexTuple itup)
+{
+	Size		sizeNeeded;
+
+	/* Check if tuple can be added to the current page */
+	sizeNeeded = IndexTupleSize(itup) + sizeof(ItemIdData) + state->freespace;
+	if (PageGetFreeSpace(pagestate->page) < sizeNeeded &&
+		!PageIsEmpty(pagestate->page))
+		gist_indexsortbuild_pagestate_flush(state, pagestate);
+
+	if (PageGetFreeSpace(pagestate->page) < IndexTupleSize(itup))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+			errmsg("index row size %zu exceeds maximum %zu for index \"%s\"",
+				   IndexTupleSize(itup), GiSTPageSize,
+				   RelationGetRelationName(state->indexrel))));
+
+	gistfillbuffer(pagestate->page, &itup, 1, InvalidOffsetNumber);
+}
+
+/*
+ * Write out a full page, and insert its downlink to the parent level,
+ * creating the parent level if this was the topmost page so far.  The page
+ * buffer is re-initialized as an empty page of the same level.
+ */
+static void
+gist_indexsortbuild_pagestate_flush(GISTBuildState *state,
+									GistSortedBuildPageState *pagestate)
+{
+	GistSortedBuildPageState *parent;
+	IndexTuple *itvec;
+	IndexTuple	union_tuple;
+	int			vect_len;
+	bool		isleaf;
+	BlockNumber blkno;
+	MemoryContext oldCtx;
+
+	/* check once per page */
+	CHECK_FOR_INTERRUPTS();
+
+	blkno = state->pages_allocated++;
+
+	/*
+	 * Form the downlink from the tuples on the page.  The union is computed
+	 * in the temporary context, which is reset once per leaf tuple.
+	 */
+	oldCtx = MemoryContextSwitchTo(state->giststate->tempCxt);
+	itvec = gistextractpage(pagestate->page, &vect_len);
+	union_tuple = gistunion(state->indexrel, itvec, vect_len,
+							state->giststate);
+	ItemPointerSetBlockNumber(&(union_tuple->t_tid), blkno);
+	MemoryContextSwitchTo(oldCtx);
+
+	isleaf = GistPageIsLeaf(pagestate->page);
+	gist_indexsortbuild_writepage(state, pagestate->page, blkno);
+
+	/* Re-initialize the page buffer for the next page on this level. */
+	gistinitpage(pagestate->page, isleaf ? F_LEAF : 0);
+
+	/*
+	 * Insert the downlink to the parent page. If this was the root, create a
+	 * new page as the parent, which becomes the new root.
+	 */
+	parent = pagestate->parent;
+	if (parent == NULL)
+	{
+		parent = palloc(sizeof(GistSortedBuildPageState));
+		parent->page = (Page) palloc(BLCKSZ);
+		parent->parent = NULL;
+		gistinitpage(parent->page, 0);
+
+		pagestate->parent = parent;
+	}
+	gist_indexsortbuild_pagestate_add(state, parent, union_tuple);
+}
+
+/*
+ * Write a finished page to disk, WAL-logging it if needed.  This is the
+ * same thing _bt_blwritepage does for B-trees.
+ */
+static void
+gist_indexsortbuild_writepage(GISTBuildState *state, Page page,
+							  BlockNumber blkno)
+{
+	Relation	index = state->indexrel;
+
+	/* Ensure rd_smgr is open (could have been closed by relcache flush!) */
+	RelationOpenSmgr(index);
+
+	/*
+	 * The pages carry no NSN and no rightlink, but gistdoinsert() expects
+	 * every page to have a valid LSN, and scans compare it with the NSN of
+	 * pages split later on.
+	 */
+	if (state->use_wal)
+	{
+		/* We use the heap NEWPAGE record type for this */
+		log_newpage(&index->rd_node, MAIN_FORKNUM, blkno, page, true);
+	}
+	else if (RelationNeedsWAL(index))
+		PageSetLSN(page, GistBuildLSN);
+	else
+		PageSetLSN(page, gistGetFakeLSN(index));
+
+	/*
+	 * If we have to write pages nonsequentially, fill in the space with
+	 * zeroes until we come back and overwrite.  The dummy pages aren't
+	 * WAL-logged though.
+	 */
+	while (blkno > state->pages_written)
+	{
+		if (!state->zeropage)
+			state->zeropage = (Page) palloc0(BLCKSZ);
+		/* don't set checksum for all-zero page */
+		smgrextend(index->rd_smgr, MAIN_FORKNUM,
+				   state->pages_written++,
+				   (char *) state->zeropage,
+				   true);
+	}
+
+	PageSetChecksumInplace(page, blkno);
+
+	/*
+	 * Now write the page.  There's no need for smgr to schedule an fsync for
+	 * this write; we'll do it ourselves before ending the build.
+	 */
+	if (blkno == state->pages_written)
+	{
+		/* extending the file... */
+		smgrextend(index->rd_smgr, MAIN_FORKNUM, blkno,
+				   (char *) page, true);
+		state->pages_written++;
+	}
+	else
+	{
+		/* overwriting a block we zero-filled before */
+		smgrwrite(index->rd_smgr, MAIN_FORKNUM, blkno,
+				  (char *) page, true);
+	}
 }
 
 /*
@@ -17,9 +17,12 @@
  */
 #include "postgres.h"
 
+#include <math.h>
+
 #include "access/gist.h"
 #include "access/stratnum.h"
 #include "utils/geo_decls.h"
+#include "utils/sortsupport.h"
 
 
 static bool gist_box_leaf_consistent(BOX *key, BOX *query,
@@ -1516,3 +1519,163 @@ gist_bbox_distance(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8(distance);
 }
 
+
+
+/*
+ * Z-order routines for the sorted index build
+ *
+ * Z-order (also known as Morton code) maps a two-dimensional point to a
+ * single integer in a way that preserves locality: points that are close
+ * to each other in the plane mostly get integers that are close to each
+ * other.  Sorting the points by it and packing them into pages in that
+ * order gives an index that is about as good as one built by repeated
+ * insertion, in a fraction of the time.
+ *
+ * The Z-value is computed by interleaving the bits of the X and Y
+ * coordinates.  It is normally defined for integers only, so we first map
+ * each coordinate to an unsigned 32-bit integer that sorts the same way as
+ * the coordinate itself.  Going through float4 loses precision, which only
+ * matters for the quality of the clustering, not for correctness.
+ */
+
+/* Map an IEEE float to uint32, preserving the ordering */
+static uint32
+ieee_float32_to_uint32(float f)
+{
+	union
+	{
+		float		f;
+		uint32		i;
+	}			u;
+
+	/* sort NaNs after everything else, like float8 comparisons do */
+	if (isnan(f))
+		return 0xFFFFFFFF;
+
+	u.f = f;
+
+	/*
+	 * With IEEE floats, positive values sort correctly as unsigned integers
+	 * once the sign bit is set; for negative values all the bits need to be
+	 * flipped, as a larger magnitude means a smaller value.
+	 */
+	if ((u.i & 0x80000000) != 0)
+		return ~u.i;
+	else
+		return u.i | 0x80000000;
+}
+
+/* Spread the 32 bits of x over the even bits of the result */
+static uint64
+part_bits32_by2(uint32 x)
+{
+	uint64		n = x;
+
+	n = (n | (n << 16)) & UINT64CONST(0x0000FFFF0000FFFF);
+	n = (n | (n << 8)) & UINT64CONST(0x00FF00FF00FF00FF);
+	n = (n | (n << 4)) & UINT64CONST(0x0F0F0F0F0F0F0F0F);
+	n = (n | (n << 2)) & UINT64CONST(0x3333333333333333);
+	n = (n | (n << 1)) & UINT64CONST(0x5555555555555555);
+
+	return n;
+}
+
+static uint64
+point_zorder_internal(float4 x, float4 y)
+{
+	uint32		ix = ieee_float32_to_uint32(x);
+	uint32		iy = ieee_float32_to_uint32(y);
+
+	/* Interleave the bits */
+	return part_bits32_by2(ix) | (part_bits32_by2(iy) << 1);
+}
+
+/*
+ * Compare the Z-values of two compressed points.  The compress method of
+ * point_ops turns each point into a zero-size box, so we look at its lower
+ * corner.
+ */
+static int
+gist_bbox_zorder_cmp(Datum a, Datum b, SortSupport ssup)
+{
+	Point	   *p1 = &(DatumGetBoxP(a)->low);
+	Point	   *p2 = &(DatumGetBoxP(b)->low);
+	uint64		z1;
+	uint64		z2;
+
+	/*
+	 * Check for equality first; that's cheap, and it's the common case when
+	 * we are called as the tie-breaker for equal abbreviated keys.
+	 */
+	if (p1->x == p2->x && p1->y == p2->y)
+		return 0;
+
+	z1 = point_zorder_internal(p1->x, p1->y);
+	z2 = point_zorder_internal(p2->x, p2->y);
+	if (z1 > z2)
+		return 1;
+	else if (z1 < z2)
+		return -1;
+	else
+		return 0;
+}
+
+#if SIZEOF_DATUM >= 8
+
+/*
+ * Abbreviated version of the Z-order comparison: the abbreviated key is the
+ * Z-value itself, so most comparisons need not look at the boxes at all.
+ */
+static Datum
+gist_bbox_zorder_abbrev_convert(Datum original, SortSupport ssup)
+{
+	Point	   *p = &(DatumGetBoxP(original)->low);
+
+	return (Datum) point_zorder_internal(p->x, p->y);
+}
+
+static int
+gist_bbox_zorder_cmp_abbrev(Datum z1, Datum z2, SortSupport ssup)
+{
+	if (z1 > z2)
+		return 1;
+	else if (z1 < z2)
+		return -1;
+	else
+		return 0;
+}
+
+/*
+ * We never consider aborting the abbreviation: the abbreviated key carries
+ * all the information the full comparator uses, short of the precision lost
+ * in the float4 conversion.
+ */
+static bool
+gist_bbox_zorder_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+	return false;
+}
+#endif   /* SIZEOF_DATUM >= 8 */
+
+/*
+ * Sort support routine for the sorted build of point_ops indexes
+ */
+Datum
+gist_point_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+#if SIZEOF_DATUM >= 8
+	if (ssup->abbreviate)
+	{
+		ssup->comparator = gist_bbox_zorder_cmp_abbrev;
+		ssup->abbrev_converter = gist_bbox_zorder_abbrev_convert;
+		ssup->abbrev_abort = gist_bbox_zorder_abbrev_abort;
+		ssup->abbrev_full_comparator = gist_bbox_zorder_cmp;
+	}
+	else
+#endif
+		ssup->comparator = gist_bbox_zorder_cmp;
+
+	PG_RETURN_VOID();
+}
@@ -168,6 +168,96 @@ GetVisibilityMapPins(Relation relation, Buffer buffer1, Buffer buffer2,
 	}
 }
 
+/*
+ * Extend a relation by multiple blocks to avoid future contention on the
+ * relation extension lock.  Our goal is to pre-extend the relation by an
+ * amount which ramps up as the degree of contention ramps up, but limiting
+ * the result to some sane overall value.
+ *
+ * The new blocks are allocated with a single smgrzeroextend() call, which
+ * avoids writing them out where the platform supports posix_fallocate(),
+ * and are then initialized in shared buffers and entered into the free
+ * space map, where the backends waiting for the extension lock will find
+ * them.
+ *
+ * Caller must hold the relation extension lock.
+ */
+static void
+RelationAddExtraBlocks(Relation relation, BulkInsertState bistate)
+{
+	BlockNumber firstBlock;
+	BlockNumber blockNum;
+	int			extraBlocks;
+	int			lockWaiters;
+	Size		freespace = 0;
+
+	/* Use the length of the lock wait queue to judge how much to extend. */
+	lockWaiters = RelationExtensionLockWaiterCount(relation);
+	if (lockWaiters <= 0)
+		return;
+
+	/*
+	 * It might seem like multiplying the number of lock waiters by as much as
+	 * 20 is too aggressive, but a single waiter usually wants more than one
+	 * page by the time it gets the lock, and under heavy concurrent COPY
+	 * smaller factors leave most backends still queueing on the lock.  512
+	 * is just an arbitrary cap to prevent pathological results.
+	 */
+	extraBlocks = Min(512, lockWaiters * 20);
+
+	firstBlock = RelationGetNumberOfBlocks(relation);
+
+	/* Leave room for the block the caller is about to add */
+	if ((uint64) firstBlock + extraBlocks >= (uint64) MaxBlockNumber)
+		return;
+
+	RelationOpenSmgr(relation);
+	smgrzeroextend(relation->rd_smgr, MAIN_FORKNUM, firstBlock, extraBlocks,
+				   false);
+
+	for (blockNum = firstBlock; blockNum < firstBlock + extraBlocks; blockNum++)
+	{
+		Buffer		buffer;
+		Page		page;
+
+		/*
+		 * The page is all zeroes on disk, so there's no need to read it.
+		 * Someone else could only have it in a buffer already if they read
+		 * it after we extended the file, in which case it's all zeroes in
+		 * the buffer too.
+		 */
+		buffer = ReadBufferExtended(relation, MAIN_FORKNUM, blockNum,
+									RBM_ZERO_AND_LOCK,
+									bistate ? bistate->strategy : NULL);
+		page = BufferGetPage(buffer);
+
+		if (!PageIsNew(page))
+			elog(ERROR, "page %u of relation \"%s\" should be empty but is not",
+				 blockNum,
+				 RelationGetRelationName(relation));
+
+		/*
+		 * Like the page added by our caller, the initialization isn't
+		 * WAL-logged.  If we crash before the page is written out, it'll be
+		 * all zeroes again, which VACUUM knows how to cope with.
+		 */
+		PageInit(page, BufferGetPageSize(buffer), 0);
+		MarkBufferDirty(buffer);
+
+		freespace = PageGetHeapFreeSpace(page);
+		UnlockReleaseBuffer(buffer);
+	}
+
+	/*
+	 * Enter all the new pages into the FSM at once, including its upper
+	 * levels, so that the backends queued up on the extension lock find
+	 * them right away.  All the pages are equally empty, so the free space
+	 * of the last one is right for all of them.
+	 */
+	UpdateFreeSpaceMap(relation, firstBlock, firstBlock + extraBlocks - 1,
+					   freespace);
+}
+
 /*
  * RelationGetBufferForTuple
  *
@@ -202,6 +292,12 @@ GetVisibilityMapPins(Relation relation, Buffer buffer1, Buffer buffer2,
  *	This can save some cycles when we know the relation is new and doesn't
  *	contain useful amounts of free space.
  *
+ *	When the relation has to be extended and other backends are queued up on
+ *	the relation extension lock, we add a batch of extra pages, scaled to the
+ *	number of waiters, and enter them into the FSM for the waiters to use
+ *	(see RelationAddExtraBlocks).  This is skipped when HEAP_INSERT_SKIP_FSM
+ *	is specified.
+ *
  *	HEAP_INSERT_SKIP_FSM is also useful for non-WAL-logged additions to a
  *	relation, if the caller holds exclusive lock and is careful to invalidate
  *	relation's smgr_targblock before the first insertion --- that ensures that
@@ -308,6 +404,7 @@ RelationGetBufferForTuple(Relation relation, Size len,
 		}
 	}
 
+loop:
 	while (targetBlock != InvalidBlockNumber)
 	{
 		/*
@@ -440,8 +537,41 @@ RelationGetBufferForTuple(Relation relation, Size len,
 	 */
 	needLock = !RELATION_IS_LOCAL(relation);
 
+	/*
+	 * If we need the lock but are not able to acquire it immediately, we'll
+	 * consider extending the relation by multiple blocks at a time to manage
+	 * contention on the relation extension lock.  However, this only makes
+	 * sense if we're using the FSM; otherwise, there's no point.
+	 */
 	if (needLock)
-		LockRelationForExtension(relation, ExclusiveLock);
+	{
+		if (!use_fsm)
+			LockRelationForExtension(relation, ExclusiveLock);
+		else if (!ConditionalLockRelationForExtension(relation, ExclusiveLock))
+		{
+			/* Couldn't get the lock immediately; wait for it. */
+			LockRelationForExtension(relation, ExclusiveLock);
+
+			/*
+			 * Check if some other backend has extended a block for us while
+			 * we were waiting on the lock.
+			 */
+			targetBlock = GetPageWithFreeSpace(relation, len + saveFreeSpace);
+
+			/*
+			 * If some other waiter has already extended the relation, we
+			 * don't need to do so; just use the existing freespace.
+			 */
+			if (targetBlock != InvalidBlockNumber)
+			{
+				UnlockRelationForExtension(relation, ExclusiveLock);
+				goto loop;
+			}
+
+			/* Time to bulk-extend. */
+			RelationAddExtraBlocks(relation, bistate);
+		}
+	}
 
 	/*
 	 * XXX This does an lseek - rather expensive - but at the moment it is the
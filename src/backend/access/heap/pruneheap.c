@@ -18,10 +18,13 @@
 #include "access/heapam_xlog.h"
 #include "access/transam.h"
 #include "access/htup_details.h"
+#include "access/multixact.h"
 #include "access/xlog.h"
 #include "catalog/catalog.h"
+#include "commands/vacuum.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "postmaster/autovacuum.h"
 #include "storage/bufmgr.h"
 #include "utils/snapmgr.h"
 #include "utils/rel.h"
@@ -42,6 +45,9 @@ typedef struct
 	OffsetNumber nowunused[MaxHeapTuplesPerPage];
 	/* marked[i] is TRUE if item i is entered in one of the above arrays */
 	bool		marked[MaxHeapTuplesPerPage + 1];
+	/* tuples to be frozen opportunistically, see heap_prune_prepare_freeze */
+	int			nfrozen;
+	xl_heap_freeze_tuple frozen[MaxHeapTuplesPerPage];
 } PruneState;
 
 /* Local functions */
@@ -54,6 +60,10 @@ static void heap_prune_record_redirect(PruneState *prstate,
 						   OffsetNumber offnum, OffsetNumber rdoffnum);
 static void heap_prune_record_dead(PruneState *prstate, OffsetNumber offnum);
 static void heap_prune_record_unused(PruneState *prstate, OffsetNumber offnum);
+static void heap_prune_prepare_freeze(Relation relation, Buffer buffer,
+						  TransactionId OldestXmin,
+						  TransactionId FreezeLimit,
+						  PruneState *prstate);
 
 
 /*
@@ -70,6 +80,10 @@ static void heap_prune_record_unused(PruneState *prstate, OffsetNumber offnum);
  *
  * OldestXmin is the cutoff XID used to distinguish whether tuples are DEAD
  * or RECENTLY_DEAD (see HeapTupleSatisfiesVacuum).
+ *
+ * While we're at it, we freeze the page's remaining tuples if they are all
+ * older than vacuum_freeze_min_age, the age at which VACUUM would freeze
+ * them; see heap_page_prune.
  */
 void
 heap_page_prune_opt(Relation relation, Buffer buffer)
@@ -77,6 +91,8 @@ heap_page_prune_opt(Relation relation, Buffer buffer)
 	Page		page = BufferGetPage(buffer);
 	Size		minfree;
 	TransactionId OldestXmin;
+	TransactionId FreezeLimit;
+	int			freezemin;
 
 	/*
 	 * We can't write WAL in recovery mode, so there's no point trying to
@@ -143,8 +159,19 @@ heap_page_prune_opt(Relation relation, Buffer buffer)
 			TransactionId ignore = InvalidTransactionId;		/* return value not
 																 * needed */
 
+			/*
+			 * Compute the freeze cutoff the same way vacuum_set_xid_limits
+			 * does for a plain VACUUM.
+			 */
+			freezemin = Min(vacuum_freeze_min_age,
+							autovacuum_freeze_max_age / 2);
+			FreezeLimit = OldestXmin - freezemin;
+			if (!TransactionIdIsNormal(FreezeLimit))
+				FreezeLimit = FirstNormalTransactionId;
+
 			/* OK to prune */
-			(void) heap_page_prune(relation, buffer, OldestXmin, true, &ignore);
+			(void) heap_page_prune(relation, buffer, OldestXmin, FreezeLimit,
+								   true, &ignore);
 		}
 
 		/* And release buffer lock */
@@ -161,6 +188,14 @@ heap_page_prune_opt(Relation relation, Buffer buffer)
  * OldestXmin is the cutoff XID used to distinguish whether tuples are DEAD
  * or RECENTLY_DEAD (see HeapTupleSatisfiesVacuum).
  *
+ * If FreezeLimit is valid and we are going to prune the page anyway, we also
+ * freeze the tuples that remain on it, provided that they are all visible to
+ * everyone and were inserted before FreezeLimit.  The freezing is included
+ * in the same WAL record as the pruning, so it costs little beyond the
+ * record's size, whereas leaving it to VACUUM would mean dirtying and
+ * WAL-logging the page once more.  FreezeLimit must not be later than
+ * OldestXmin.
+ *
  * If report_stats is true then we send the number of reclaimed heap-only
  * tuples to pgstats.  (This must be FALSE during vacuum, since vacuum will
  * send its own new total to pgstats, and we don't want this delta applied
@@ -171,7 +206,8 @@ heap_page_prune_opt(Relation relation, Buffer buffer)
  */
 int
 heap_page_prune(Relation relation, Buffer buffer, TransactionId OldestXmin,
-				bool report_stats, TransactionId *latestRemovedXid)
+				TransactionId FreezeLimit, bool report_stats,
+				TransactionId *latestRemovedXid)
 {
 	int			ndeleted = 0;
 	Page		page = BufferGetPage(buffer);
@@ -193,6 +229,7 @@ heap_page_prune(Relation relation, Buffer buffer, TransactionId OldestXmin,
 	prstate.new_prune_xid = InvalidTransactionId;
 	prstate.latestRemovedXid = *latestRemovedXid;
 	prstate.nredirected = prstate.ndead = prstate.nunused = 0;
+	prstate.nfrozen = 0;
 	memset(prstate.marked, 0, sizeof(prstate.marked));
 
 	/* Scan the page */
@@ -218,6 +255,15 @@ heap_page_prune(Relation relation, Buffer buffer, TransactionId OldestXmin,
 									 &prstate);
 	}
 
+	/*
+	 * If we're going to dirty the page anyway, see if we can freeze what's
+	 * left on it.
+	 */
+	if (TransactionIdIsValid(FreezeLimit) &&
+		(prstate.nredirected > 0 || prstate.ndead > 0 || prstate.nunused > 0))
+		heap_prune_prepare_freeze(relation, buffer, OldestXmin, FreezeLimit,
+								  &prstate);
+
 	/* Any error while applying the changes is critical */
 	START_CRIT_SECTION();
 
@@ -231,7 +277,8 @@ heap_page_prune(Relation relation, Buffer buffer, TransactionId OldestXmin,
 		heap_page_prune_execute(buffer,
 								prstate.redirected, prstate.nredirected,
 								prstate.nowdead, prstate.ndead,
-								prstate.nowunused, prstate.nunused);
+								prstate.nowunused, prstate.nunused,
+								prstate.frozen, prstate.nfrozen);
 
 		/*
 		 * Update the page's pd_prune_xid field to either zero, or the lowest
@@ -259,6 +306,7 @@ heap_page_prune(Relation relation, Buffer buffer, TransactionId OldestXmin,
 									prstate.redirected, prstate.nredirected,
 									prstate.nowdead, prstate.ndead,
 									prstate.nowunused, prstate.nunused,
+									prstate.frozen, prstate.nfrozen,
 									prstate.latestRemovedXid);
 
 			PageSetLSN(BufferGetPage(buffer), recptr);
@@ -657,6 +705,84 @@ heap_prune_record_unused(PruneState *prstate, OffsetNumber offnum)
 	prstate->marked[offnum] = true;
 }
 
+/*
+ * Decide whether to freeze the tuples that will remain on the page after
+ * pruning, and if so, fill prstate->frozen with the freeze plans.
+ *
+ * We only do this if every surviving tuple can be frozen: a page that is
+ * only partially frozen still has to be visited by an anti-wraparound
+ * VACUUM, so freezing some of its tuples now would buy us little.  To keep
+ * this cheap and safe, we only consider tuples that are plainly live, i.e.
+ * have a committed xmin older than FreezeLimit and no xmax at all; anything
+ * else, including multixacts and tuples moved by old-style VACUUM FULL, is
+ * left for VACUUM to deal with.
+ */
+static void
+heap_prune_prepare_freeze(Relation relation, Buffer buffer,
+						  TransactionId OldestXmin,
+						  TransactionId FreezeLimit,
+						  PruneState *prstate)
+{
+	Page		page = BufferGetPage(buffer);
+	OffsetNumber offnum,
+				maxoff;
+	TransactionId newestFrozenXid = InvalidTransactionId;
+	int			nfrozen = 0;
+
+	maxoff = PageGetMaxOffsetNumber(page);
+	for (offnum = FirstOffsetNumber;
+		 offnum <= maxoff;
+		 offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+		HeapTupleData tup;
+		HeapTupleHeader htup;
+		TransactionId xmin;
+		bool		totally_frozen;
+
+		/* Ignore items that are about to go away or be redirected */
+		if (prstate->marked[offnum] || !ItemIdIsNormal(itemid))
+			continue;
+
+		htup = (HeapTupleHeader) PageGetItem(page, itemid);
+		tup.t_data = htup;
+		tup.t_len = ItemIdGetLength(itemid);
+		tup.t_tableOid = RelationGetRelid(relation);
+		ItemPointerSet(&(tup.t_self), BufferGetBlockNumber(buffer), offnum);
+
+		if (HeapTupleSatisfiesVacuum(&tup, OldestXmin, buffer) != HEAPTUPLE_LIVE)
+			return;
+		if (!HeapTupleHeaderXminCommitted(htup) ||
+			!(htup->t_infomask & HEAP_XMAX_INVALID) ||
+			(htup->t_infomask & (HEAP_XMAX_IS_MULTI | HEAP_MOVED)))
+			return;
+
+		xmin = HeapTupleHeaderGetXmin(htup);
+		if (!HeapTupleHeaderXminFrozen(htup) &&
+			!TransactionIdPrecedes(xmin, FreezeLimit))
+			return;
+
+		if (heap_prepare_freeze_tuple(htup, FreezeLimit, InvalidMultiXactId,
+									  &prstate->frozen[nfrozen],
+									  &totally_frozen))
+		{
+			prstate->frozen[nfrozen++].offset = offnum;
+			if (TransactionIdFollows(xmin, newestFrozenXid))
+				newestFrozenXid = xmin;
+		}
+	}
+
+	/*
+	 * Freezing removes the xmin, so a hot standby query that can't see it
+	 * yet would start seeing the tuple; treat it like a removal for conflict
+	 * purposes, as heap_xlog_freeze_page does.
+	 */
+	if (TransactionIdFollows(newestFrozenXid, prstate->latestRemovedXid))
+		prstate->latestRemovedXid = newestFrozenXid;
+
+	prstate->nfrozen = nfrozen;
+}
+
 
 /*
  * Perform the actual page changes needed by heap_page_prune.
@@ -671,7 +797,8 @@ void
 heap_page_prune_execute(Buffer buffer,
 						OffsetNumber *redirected, int nredirected,
 						OffsetNumber *nowdead, int ndead,
-						OffsetNumber *nowunused, int nunused)
+						OffsetNumber *nowunused, int nunused,
+						xl_heap_freeze_tuple *frozen, int nfrozen)
 {
 	Page		page = (Page) BufferGetPage(buffer);
 	OffsetNumber *offnum;
@@ -713,6 +840,15 @@ heap_page_prune_execute(Buffer buffer,
 	 * whether it has free pointers.
 	 */
 	PageRepairFragmentation(page);
+
+	/* Freeze the surviving tuples that were chosen for it */
+	for (i = 0; i < nfrozen; i++)
+	{
+		ItemId		lp = PageGetItemId(page, frozen[i].offset);
+		HeapTupleHeader htup = (HeapTupleHeader) PageGetItem(page, lp);
+
+		heap_execute_freeze_tuple(htup, &frozen[i]);
+	}
 }
 
 
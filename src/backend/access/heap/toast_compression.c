@@ -0,0 +1,355 @@
+/*-------------------------------------------------------------------------
+ *
+ * toast_compression.c
+ *	  Compression methods for in-line compressed TOAST data.
+ *
+ * pglz is always available.  lz4 and zstd are available only if the server
+ * was built with --with-lz4 or --with-zstd respectively; trying to compress
+ * or decompress data with a method that isn't compiled in raises an error.
+ *
+ * The routines here only deal with the compressed payload.  The caller is
+ * responsible for deciding whether the result is worth keeping and for
+ * filling in the raw size and method ID (see toast_compress_datum).
+ *
+ * Copyright (c) 2015, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/heap/toast_compression.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "access/toast_compression.h"
+#include "common/pg_lzcompress.h"
+
+
+/* GUC */
+int			default_toast_compression = TOAST_PGLZ_COMPRESSION_ID;
+
+#define NO_METHOD_SUPPORT(method) \
+	ereport(ERROR, \
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED), \
+			 errmsg("compression method %s not supported", method), \
+			 errdetail("This functionality requires the server to be built with %s support.", \
+					   method)))
+
+#ifdef USE_ZSTD
+/*
+ * zstd compression level used for TOAST data.  zstd's default level already
+ * compresses considerably better than pglz while still being faster.
+ */
+#define TOAST_ZSTD_LEVEL	3
+
+/*
+ * Creating a zstd context allocates a fair amount of memory, so we keep one
+ * compression and one decompression context around for the life of the
+ * backend.  They are malloc'd by libzstd, not palloc'd.
+ */
+static ZSTD_CCtx *zstd_cctx = NULL;
+static ZSTD_DCtx *zstd_dctx = NULL;
+#endif
+
+
+/*
+ * Compress a varlena using pglz.
+ *
+ * Returns the compressed varlena, or NULL if the input is outside the range
+ * pglz is willing to compress or if pglz gave up on it.
+ */
+struct varlena *
+pglz_compress_datum(const struct varlena * value)
+{
+	int32		valsize = VARSIZE_ANY_EXHDR(value);
+	int32		len;
+	struct varlena *tmp;
+
+	/*
+	 * No point in wasting a palloc cycle if value size is out of the allowed
+	 * range for compression
+	 */
+	if (valsize < PGLZ_strategy_default->min_input_size ||
+		valsize > PGLZ_strategy_default->max_input_size)
+		return NULL;
+
+	tmp = (struct varlena *) palloc(PGLZ_MAX_OUTPUT(valsize) +
+									TOAST_COMPRESS_HDRSZ);
+
+	len = pglz_compress(VARDATA_ANY(value),
+						valsize,
+						TOAST_COMPRESS_RAWDATA(tmp),
+						PGLZ_strategy_default);
+	if (len < 0)
+	{
+		pfree(tmp);
+		return NULL;
+	}
+
+	SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
+
+	return tmp;
+}
+
+/*
+ * Decompress a varlena that was compressed using pglz.
+ */
+struct varlena *
+pglz_decompress_datum(const struct varlena * value)
+{
+	struct varlena *result;
+	int32		rawsize = TOAST_COMPRESS_RAWSIZE(value);
+
+	result = (struct varlena *) palloc(rawsize + VARHDRSZ);
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	if (pglz_decompress(TOAST_COMPRESS_RAWDATA(value),
+						VARSIZE(value) - TOAST_COMPRESS_HDRSZ,
+						VARDATA(result),
+						rawsize) < 0)
+		elog(ERROR, "compressed data is corrupted");
+
+	return result;
+}
+
+/*
+ * Compress a varlena using lz4.
+ */
+struct varlena *
+lz4_compress_datum(const struct varlena * value)
+{
+#ifndef USE_LZ4
+	NO_METHOD_SUPPORT("lz4");
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		valsize = VARSIZE_ANY_EXHDR(value);
+	int32		max_size = LZ4_compressBound(valsize);
+	int32		len;
+	struct varlena *tmp;
+
+	tmp = (struct varlena *) palloc(max_size + TOAST_COMPRESS_HDRSZ);
+
+	/* with a buffer of LZ4_compressBound() bytes, this can't fail */
+	len = LZ4_compress_default(VARDATA_ANY(value),
+							   TOAST_COMPRESS_RAWDATA(tmp),
+							   valsize, max_size);
+	if (len <= 0)
+		elog(ERROR, "lz4 compression failed");
+
+	SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
+
+	return tmp;
+#endif
+}
+
+/*
+ * Decompress a varlena that was compressed using lz4.
+ */
+struct varlena *
+lz4_decompress_datum(const struct varlena * value)
+{
+#ifndef USE_LZ4
+	NO_METHOD_SUPPORT("lz4");
+	return NULL;				/* keep compiler quiet */
+#else
+	struct varlena *result;
+	int32		rawsize = TOAST_COMPRESS_RAWSIZE(value);
+	int			len;
+
+	result = (struct varlena *) palloc(rawsize + VARHDRSZ);
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	len = LZ4_decompress_safe(TOAST_COMPRESS_RAWDATA(value),
+							  VARDATA(result),
+							  VARSIZE(value) - TOAST_COMPRESS_HDRSZ,
+							  rawsize);
+	if (len != rawsize)
+		elog(ERROR, "compressed lz4 data is corrupted");
+
+	return result;
+#endif
+}
+
+/*
+ * Decompress only the first slicelength bytes of a varlena that was
+ * compressed using lz4.
+ *
+ * lz4 can stop decoding as soon as enough output has been produced, which
+ * makes fetching a prefix of a large compressed value much cheaper than
+ * decompressing all of it.
+ */
+struct varlena *
+lz4_decompress_datum_slice(const struct varlena * value, int32 slicelength)
+{
+#ifndef USE_LZ4
+	NO_METHOD_SUPPORT("lz4");
+	return NULL;				/* keep compiler quiet */
+#else
+	struct varlena *result;
+	int			len;
+
+	Assert(slicelength >= 0 && slicelength <= TOAST_COMPRESS_RAWSIZE(value));
+
+	result = (struct varlena *) palloc(slicelength + VARHDRSZ);
+
+	len = LZ4_decompress_safe_partial(TOAST_COMPRESS_RAWDATA(value),
+									  VARDATA(result),
+									  VARSIZE(value) - TOAST_COMPRESS_HDRSZ,
+									  slicelength,
+									  slicelength);
+	if (len < 0)
+		elog(ERROR, "compressed lz4 data is corrupted");
+
+	SET_VARSIZE(result, len + VARHDRSZ);
+
+	return result;
+#endif
+}
+
+/*
+ * Compress a varlena using zstd.
+ */
+struct varlena *
+zstd_compress_datum(const struct varlena * value)
+{
+#ifndef USE_ZSTD
+	NO_METHOD_SUPPORT("zstd");
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		valsize = VARSIZE_ANY_EXHDR(value);
+	size_t		max_size = ZSTD_compressBound(valsize);
+	size_t		len;
+	struct varlena *tmp;
+
+	if (zstd_cctx == NULL)
+	{
+		zstd_cctx = ZSTD_createCCtx();
+		if (zstd_cctx == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+	}
+
+	tmp = (struct varlena *) palloc(max_size + TOAST_COMPRESS_HDRSZ);
+
+	len = ZSTD_compressCCtx(zstd_cctx,
+							TOAST_COMPRESS_RAWDATA(tmp), max_size,
+							VARDATA_ANY(value), valsize,
+							TOAST_ZSTD_LEVEL);
+	if (ZSTD_isError(len))
+		elog(ERROR, "zstd compression failed: %s", ZSTD_getErrorName(len));
+
+	SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
+
+	return tmp;
+#endif
+}
+
+/*
+ * Decompress a varlena that was compressed using zstd.
+ */
+struct varlena *
+zstd_decompress_datum(const struct varlena * value)
+{
+#ifndef USE_ZSTD
+	NO_METHOD_SUPPORT("zstd");
+	return NULL;				/* keep compiler quiet */
+#else
+	struct varlena *result;
+	int32		rawsize = TOAST_COMPRESS_RAWSIZE(value);
+	size_t		len;
+
+	if (zstd_dctx == NULL)
+	{
+		zstd_dctx = ZSTD_createDCtx();
+		if (zstd_dctx == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+	}
+
+	result = (struct varlena *) palloc(rawsize + VARHDRSZ);
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	len = ZSTD_decompressDCtx(zstd_dctx,
+							  VARDATA(result), rawsize,
+							  TOAST_COMPRESS_RAWDATA(value),
+							  VARSIZE(value) - TOAST_COMPRESS_HDRSZ);
+	if (ZSTD_isError(len) || len != (size_t) rawsize)
+		elog(ERROR, "compressed zstd data is corrupted");
+
+	return result;
+#endif
+}
+
+/*
+ * Look up a compression method by name.
+ *
+ * Returns TOAST_INVALID_COMPRESSION_ID if the name isn't recognized.  Methods
+ * that are known but not compiled into this server are still recognized.
+ */
+int
+CompressionNameToMethod(const char *compression)
+{
+	if (pg_strcasecmp(compression, "pglz") == 0)
+		return TOAST_PGLZ_COMPRESSION_ID;
+	if (pg_strcasecmp(compression, "lz4") == 0)
+		return TOAST_LZ4_COMPRESSION_ID;
+	if (pg_strcasecmp(compression, "zstd") == 0)
+		return TOAST_ZSTD_COMPRESSION_ID;
+	return TOAST_INVALID_COMPRESSION_ID;
+}
+
+/*
+ * Get the name of a compression method, for messages.
+ */
+const char *
+GetCompressionMethodName(int cmethod)
+{
+	switch (cmethod)
+	{
+		case TOAST_PGLZ_COMPRESSION_ID:
+			return "pglz";
+		case TOAST_LZ4_COMPRESSION_ID:
+			return "lz4";
+		case TOAST_ZSTD_COMPRESSION_ID:
+			return "zstd";
+		default:
+			elog(ERROR, "invalid compression method %d", cmethod);
+			return NULL;		/* keep compiler quiet */
+	}
+}
+
+/*
+ * Validator for the "compression" attribute option.
+ */
+void
+validateCompressionOption(char *value)
+{
+	int			cmethod;
+
+	cmethod = value ? CompressionNameToMethod(value) :
+		TOAST_INVALID_COMPRESSION_ID;
+
+	if (cmethod == TOAST_INVALID_COMPRESSION_ID)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for \"compression\" option"),
+				 errdetail("Valid values are \"pglz\", \"lz4\", and \"zstd\".")));
+
+#ifndef USE_LZ4
+	if (cmethod == TOAST_LZ4_COMPRESSION_ID)
+		NO_METHOD_SUPPORT("lz4");
+#endif
+#ifndef USE_ZSTD
+	if (cmethod == TOAST_ZSTD_COMPRESSION_ID)
+		NO_METHOD_SUPPORT("zstd");
+#endif
+}
@@ -32,11 +32,12 @@
 
 #include "access/genam.h"
 #include "access/heapam.h"
+#include "access/toast_compression.h"
 #include "access/tuptoaster.h"
 #include "access/xact.h"
 #include "catalog/catalog.h"
-#include "common/pg_lzcompress.h"
 #include "miscadmin.h"
+#include "utils/attoptcache.h"
 #include "utils/expandeddatum.h"
 #include "utils/fmgroids.h"
 #include "utils/rel.h"
@@ -46,26 +47,6 @@
 
 #undef TOAST_DEBUG
 
-/*
- *	The information at the start of the compressed toast data.
- */
-typedef struct toast_compress_header
-{
-	int32		vl_len_;		/* varlena header (do not touch directly!) */
-	int32		rawsize;
-} toast_compress_header;
-
-/*
- * Utilities for manipulation of header information for compressed
- * toast entries.
- */
-#define TOAST_COMPRESS_HDRSZ		((int32) sizeof(toast_compress_header))
-#define TOAST_COMPRESS_RAWSIZE(ptr) (((toast_compress_header *) (ptr))->rawsize)
-#define TOAST_COMPRESS_RAWDATA(ptr) \
-	(((char *) (ptr)) + TOAST_COMPRESS_HDRSZ)
-#define TOAST_COMPRESS_SET_RAWSIZE(ptr, len) \
-	(((toast_compress_header *) (ptr))->rawsize = (len))
-
 static void toast_delete_datum(Relation rel, Datum value);
 static Datum toast_save_datum(Relation rel, Datum value,
 				 struct varlena * oldexternal, int options);
@@ -75,6 +56,9 @@ static struct varlena *toast_fetch_datum(struct varlena * attr);
 static struct varlena *toast_fetch_datum_slice(struct varlena * attr,
 						int32 sliceoffset, int32 length);
 static struct varlena *toast_decompress_datum(struct varlena * attr);
+static struct varlena *toast_decompress_datum_slice(struct varlena * attr,
+							 int32 slicelength);
+static int	toast_get_compression_method(Relation rel, int attnum);
 static int toast_open_indexes(Relation toastrel,
 				   LOCKMODE lock,
 				   Relation **toastidxs,
@@ -300,7 +284,16 @@ heap_tuple_untoast_attr_slice(struct varlena * attr,
 	{
 		struct varlena *tmp = preslice;
 
-		preslice = toast_decompress_datum(tmp);
+		/*
+		 * If only a prefix of the value is wanted, the compression method may
+		 * be able to stop early.
+		 */
+		if (slicelength >= 0 &&
+			(int64) sliceoffset + slicelength < VARRAWSIZE_4B_C(tmp))
+			preslice = toast_decompress_datum_slice(tmp,
+													sliceoffset + slicelength);
+		else
+			preslice = toast_decompress_datum(tmp);
 
 		if (tmp != attr)
 			pfree(tmp);
@@ -772,7 +765,8 @@ toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtup,
 		if (att[i]->attstorage == 'x')
 		{
 			old_value = toast_values[i];
-			new_value = toast_compress_datum(old_value);
+			new_value = toast_compress_datum(old_value,
+									toast_get_compression_method(rel, i + 1));
 
 			if (DatumGetPointer(new_value) != NULL)
 			{
@@ -911,7 +905,8 @@ toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtup,
 		 */
 		i = biggest_attno;
 		old_value = toast_values[i];
-		new_value = toast_compress_datum(old_value);
+		new_value = toast_compress_datum(old_value,
+									toast_get_compression_method(rel, i + 1));
 
 		if (DatumGetPointer(new_value) != NULL)
 		{
@@ -1289,7 +1284,8 @@ toast_flatten_tuple_to_datum(HeapTupleHeader tup,
 /* ----------
  * toast_compress_datum -
  *
- *	Create a compressed version of a varlena datum
+ *	Create a compressed version of a varlena datum, using the given
+ *	compression method
  *
  *	If we fail (ie, compressed result is actually bigger than original)
  *	then return NULL.  We must not use compressed data if it'd expand
@@ -1300,28 +1296,38 @@ toast_flatten_tuple_to_datum(HeapTupleHeader tup,
  * ----------
  */
 Datum
-toast_compress_datum(Datum value)
+toast_compress_datum(Datum value, int cmethod)
 {
+	struct varlena *val = (struct varlena *) DatumGetPointer(value);
 	struct varlena *tmp;
-	int32		valsize = VARSIZE_ANY_EXHDR(DatumGetPointer(value));
+	int32		valsize = VARSIZE_ANY_EXHDR(val);
 	int32		len;
 
-	Assert(!VARATT_IS_EXTERNAL(DatumGetPointer(value)));
-	Assert(!VARATT_IS_COMPRESSED(DatumGetPointer(value)));
+	Assert(!VARATT_IS_EXTERNAL(val));
+	Assert(!VARATT_IS_COMPRESSED(val));
 
-	/*
-	 * No point in wasting a palloc cycle if value size is out of the allowed
-	 * range for compression
-	 */
-	if (valsize < PGLZ_strategy_default->min_input_size ||
-		valsize > PGLZ_strategy_default->max_input_size)
-		return PointerGetDatum(NULL);
+	switch (cmethod)
+	{
+		case TOAST_PGLZ_COMPRESSION_ID:
+			tmp = pglz_compress_datum(val);
+			break;
+		case TOAST_LZ4_COMPRESSION_ID:
+			tmp = lz4_compress_datum(val);
+			break;
+		case TOAST_ZSTD_COMPRESSION_ID:
+			tmp = zstd_compress_datum(val);
+			break;
+		default:
+			elog(ERROR, "invalid compression method %d", cmethod);
+			tmp = NULL;			/* keep compiler quiet */
+			break;
+	}
 
-	tmp = (struct varlena *) palloc(PGLZ_MAX_OUTPUT(valsize) +
-									TOAST_COMPRESS_HDRSZ);
+	if (tmp == NULL)
+		return PointerGetDatum(NULL);
 
 	/*
-	 * We recheck the actual size even if pglz_compress() reports success,
+	 * We recheck the actual size even if the compressor reports success,
 	 * because it might be satisfied with having saved as little as one byte
 	 * in the compressed data --- which could turn into a net loss once you
 	 * consider header and alignment padding.  Worst case, the compressed
@@ -1330,15 +1336,10 @@ toast_compress_datum(Datum value)
 	 * only one header byte and no padding if the value is short enough.  So
 	 * we insist on a savings of more than 2 bytes to ensure we have a gain.
 	 */
-	len = pglz_compress(VARDATA_ANY(DatumGetPointer(value)),
-						valsize,
-						TOAST_COMPRESS_RAWDATA(tmp),
-						PGLZ_strategy_default);
-	if (len >= 0 &&
-		len + TOAST_COMPRESS_HDRSZ < valsize - 2)
+	len = VARSIZE(tmp);
+	if (len < valsize - 2)
 	{
-		TOAST_COMPRESS_SET_RAWSIZE(tmp, valsize);
-		SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
+		TOAST_COMPRESS_SET_SIZE_AND_METHOD(tmp, valsize, cmethod);
 		/* successful compression */
 		return PointerGetDatum(tmp);
 	}
@@ -1350,6 +1351,42 @@ toast_compress_datum(Datum value)
 	}
 }
 
+/* ----------
+ * toast_get_compression_method
+ *
+ *	Return the compression method to use for the given attribute of rel:
+ *	the column's "compression" option if it has one, otherwise
+ *	default_toast_compression.  System catalogs always use the default,
+ *	so that we never need a syscache lookup while toasting catalog tuples.
+ * ----------
+ */
+static int
+toast_get_compression_method(Relation rel, int attnum)
+{
+	AttributeOpts *aopt;
+	int			cmethod = default_toast_compression;
+
+	if (IsSystemRelation(rel))
+		return cmethod;
+
+	aopt = get_attribute_options(RelationGetRelid(rel), attnum);
+	if (aopt != NULL)
+	{
+		if (aopt->compression_offset != 0)
+		{
+			int			attmethod;
+
+			attmethod = CompressionNameToMethod((char *) aopt +
+												aopt->compression_offset);
+			if (attmethod != TOAST_INVALID_COMPRESSION_ID)
+				cmethod = attmethod;
+		}
+		pfree(aopt);
+	}
+
+	return cmethod;
+}
+
 
 /* ----------
  * toast_get_valid_index
@@ -2194,21 +2231,40 @@ toast_fetch_datum_slice(struct varlena * attr, int32 sliceoffset, int32 length)
 static struct varlena *
 toast_decompress_datum(struct varlena * attr)
 {
-	struct varlena *result;
-
 	Assert(VARATT_IS_COMPRESSED(attr));
 
-	result = (struct varlena *)
-		palloc(TOAST_COMPRESS_RAWSIZE(attr) + VARHDRSZ);
-	SET_VARSIZE(result, TOAST_COMPRESS_RAWSIZE(attr) + VARHDRSZ);
+	switch (TOAST_COMPRESS_METHOD(attr))
+	{
+		case TOAST_PGLZ_COMPRESSION_ID:
+			return pglz_decompress_datum(attr);
+		case TOAST_LZ4_COMPRESSION_ID:
+			return lz4_decompress_datum(attr);
+		case TOAST_ZSTD_COMPRESSION_ID:
+			return zstd_decompress_datum(attr);
+		default:
+			elog(ERROR, "invalid compression method %u",
+				 TOAST_COMPRESS_METHOD(attr));
+			return NULL;		/* keep compiler quiet */
+	}
+}
 
-	if (pglz_decompress(TOAST_COMPRESS_RAWDATA(attr),
-						VARSIZE(attr) - TOAST_COMPRESS_HDRSZ,
-						VARDATA(result),
-						TOAST_COMPRESS_RAWSIZE(attr)) < 0)
-		elog(ERROR, "compressed data is corrupted");
 
-	return result;
+/* ----------
+ * toast_decompress_datum_slice -
+ *
+ * Decompress the front of a compressed version of a varlena datum.
+ * The result may contain more than slicelength bytes of data, if the
+ * compression method can't stop early; callers must cope with that.
+ */
+static struct varlena *
+toast_decompress_datum_slice(struct varlena * attr, int32 slicelength)
+{
+	Assert(VARATT_IS_COMPRESSED(attr));
+
+	if (TOAST_COMPRESS_METHOD(attr) == TOAST_LZ4_COMPRESSION_ID)
+		return lz4_decompress_datum_slice(attr, slicelength);
+
+	return toast_decompress_datum(attr);
 }
 
 
@@ -316,7 +316,11 @@ btgettuple(PG_FUNCTION_ARGS)
 
 		/* If we have a tuple, return it ... */
 		if (res)
+		{
+			/* ... but first start reading heap pages we'll need soon */
+			_bt_prefetch_heap(scan, dir);
 			break;
+		}
 		/* ... otherwise see if we have more array keys to deal with */
 	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
 
@@ -418,6 +422,8 @@ btbeginscan(PG_FUNCTION_ARGS)
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 
+	so->lastPrefetchBlock = InvalidBlockNumber;
+
 	/*
 	 * We don't know yet whether the scan will be index-only, so we do not
 	 * allocate the tuple workspace arrays until btrescan.  However, we set up
@@ -34,6 +34,8 @@ static Buffer _bt_walk_left(Relation rel, Buffer buf);
 static bool _bt_endpoint(IndexScanDesc scan, ScanDirection dir);
 static void _bt_drop_lock_and_maybe_pin(IndexScanDesc scan, BTScanPos sp);
 
+/* GUC parameter */
+int			index_prefetch_distance = 0;
 
 /*
  *	_bt_drop_lock_and_maybe_pin()
@@ -1135,6 +1137,72 @@ _bt_next(IndexScanDesc scan, ScanDirection dir)
 	return true;
 }
 
+/*
+ *	_bt_prefetch_heap() -- Prefetch heap pages for upcoming items in a scan.
+ *
+ *		Called by btgettuple after positioning the scan on a new item.  We
+ *		look ahead through the items already collected from the current leaf
+ *		page, up to index_prefetch_distance items beyond the current one, and
+ *		issue prefetch requests for the heap pages they point to, so that the
+ *		reads are already in flight when the executor gets to them.  Since
+ *		the items' heap pages are visited in index order, the reads of a
+ *		poorly correlated index would otherwise be issued one at a time.
+ *
+ *		We remember the last block prefetched, so that consecutive items on
+ *		the same heap page, as with a well correlated index, cost little.
+ *		Index-only scans usually don't need to visit the heap at all, so we
+ *		don't prefetch for them.
+ */
+void
+_bt_prefetch_heap(IndexScanDesc scan, ScanDirection dir)
+{
+#ifdef USE_PREFETCH
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTScanPos	pos = &so->currPos;
+	int			limit;
+	BlockNumber blkno;
+
+	if (index_prefetch_distance <= 0 || scan->xs_want_itup ||
+		scan->heapRelation == NULL)
+		return;
+
+	if (ScanDirectionIsForward(dir))
+	{
+		limit = Min(pos->itemIndex + index_prefetch_distance, pos->lastItem);
+		if (pos->prefetchItem < pos->itemIndex)
+			pos->prefetchItem = pos->itemIndex;
+
+		while (pos->prefetchItem < limit)
+		{
+			pos->prefetchItem++;
+			blkno = ItemPointerGetBlockNumber(&pos->items[pos->prefetchItem].heapTid);
+			if (blkno != so->lastPrefetchBlock)
+			{
+				PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+				so->lastPrefetchBlock = blkno;
+			}
+		}
+	}
+	else
+	{
+		limit = Max(pos->itemIndex - index_prefetch_distance, pos->firstItem);
+		if (pos->prefetchItem > pos->itemIndex)
+			pos->prefetchItem = pos->itemIndex;
+
+		while (pos->prefetchItem > limit)
+		{
+			pos->prefetchItem--;
+			blkno = ItemPointerGetBlockNumber(&pos->items[pos->prefetchItem].heapTid);
+			if (blkno != so->lastPrefetchBlock)
+			{
+				PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+				so->lastPrefetchBlock = blkno;
+			}
+		}
+	}
+#endif   /* USE_PREFETCH */
+}
+
 /*
  *	_bt_readpage() -- Load data from current index page into so->currPos
  *
@@ -1232,6 +1300,7 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 		so->currPos.firstItem = 0;
 		so->currPos.lastItem = itemIndex - 1;
 		so->currPos.itemIndex = 0;
+		so->currPos.prefetchItem = 0;
 	}
 	else
 	{
@@ -1263,6 +1332,7 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 		so->currPos.firstItem = itemIndex;
 		so->currPos.lastItem = MaxIndexTuplesPerPage - 1;
 		so->currPos.itemIndex = MaxIndexTuplesPerPage - 1;
+		so->currPos.prefetchItem = MaxIndexTuplesPerPage - 1;
 	}
 
 	return (so->currPos.firstItem <= so->currPos.lastItem);
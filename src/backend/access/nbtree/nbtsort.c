@@ -456,6 +456,7 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 	OffsetNumber last_off;
 	Size		pgspc;
 	Size		itupsz;
+	bool		truncate_hikey;
 
 	/*
 	 * This is a handy place to check for cancel interrupts during the btree
@@ -467,6 +468,14 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 	nblkno = state->btps_blkno;
 	last_off = state->btps_lastoff;
 
+	/*
+	 * Leaf tuples may carry included (non-key) columns, which we strip from
+	 * the high keys and downlinks that are derived from them.
+	 */
+	truncate_hikey = (state->btps_level == 0 &&
+					  IndexRelationGetNumberOfKeyAttributes(wstate->index) !=
+					  IndexRelationGetNumberOfAttributes(wstate->index));
+
 	pgspc = PageGetFreeSpace(npage);
 	itupsz = IndexTupleDSize(*itup);
 	itupsz = MAXALIGN(itupsz);
@@ -537,6 +546,21 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		ItemIdSetUnused(ii);	/* redundant */
 		((PageHeader) opage)->pd_lower -= sizeof(ItemIdData);
 
+		/*
+		 * On the leaf level, replace the high key with a truncated copy.
+		 * Note that this invalidates oitup, so use the copy from now on.
+		 */
+		if (truncate_hikey)
+		{
+			IndexTuple	hikey;
+
+			hikey = _bt_nonkey_truncate(wstate->index, oitup);
+			PageIndexTupleDelete(opage, P_HIKEY);
+			_bt_sortaddtup(opage, MAXALIGN(IndexTupleSize(hikey)), hikey,
+						   P_HIKEY);
+			oitup = hikey;
+		}
+
 		/*
 		 * Link the old page into its parent, using its minimum key. If we
 		 * don't have a parent, we have to create one; this adds a new btree
@@ -553,9 +577,13 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		/*
 		 * Save a copy of the minimum key for the new page.  We have to copy
 		 * it off the old page, not the new one, in case we are not at leaf
-		 * level.
+		 * level.  If we truncated the high key, oitup is already a private
+		 * copy and can be used as is.
 		 */
-		state->btps_minkey = CopyIndexTuple(oitup);
+		if (truncate_hikey)
+			state->btps_minkey = oitup;
+		else
+			state->btps_minkey = CopyIndexTuple(oitup);
 
 		/*
 		 * Set the sibling links for both pages.
@@ -590,7 +618,10 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 	if (last_off == P_HIKEY)
 	{
 		Assert(state->btps_minkey == NULL);
-		state->btps_minkey = CopyIndexTuple(itup);
+		if (truncate_hikey)
+			state->btps_minkey = _bt_nonkey_truncate(wstate->index, itup);
+		else
+			state->btps_minkey = CopyIndexTuple(itup);
 	}
 
 	/*
@@ -685,7 +716,7 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 				load1;
 	TupleDesc	tupdes = RelationGetDescr(wstate->index);
 	int			i,
-				keysz = RelationGetNumberOfAttributes(wstate->index);
+				keysz = IndexRelationGetNumberOfKeyAttributes(wstate->index);
 	ScanKey		indexScanKey = NULL;
 	SortSupport sortKeys;
 
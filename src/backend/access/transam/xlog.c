@@ -4506,6 +4506,28 @@ XLOGChooseNumBuffers(void)
 	return xbuffers;
 }
 
+/*
+ * GUC check_hook for page_compression
+ *
+ * md.c rewrites a compressed page as a whole even when only hint bits have
+ * changed, and a torn write of it leaves the page impossible to decompress.
+ * The full-page image that repairs such a page after a crash is only
+ * guaranteed to exist if hint bit changes are WAL-logged, so insist on that.
+ * Until the control file has been read we can't tell whether data checksums
+ * are enabled; StartupXLOG checks again then.
+ */
+bool
+check_page_compression(int *newval, void **extra, GucSource source)
+{
+	if (*newval != PAGE_COMPRESSION_OFF && ControlFile != NULL &&
+		!XLogHintBitIsNeeded())
+	{
+		GUC_check_errdetail("Page compression requires data checksums or wal_log_hints.");
+		return false;
+	}
+	return true;
+}
+
 /*
  * GUC check_hook for wal_buffers
  */
@@ -5898,6 +5920,12 @@ StartupXLOG(void)
 		ereport(FATAL,
 				(errmsg("control file contains invalid data")));
 
+	/* See check_page_compression */
+	if (page_compression != PAGE_COMPRESSION_OFF && !XLogHintBitIsNeeded())
+		ereport(FATAL,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("page_compression requires data checksums or wal_log_hints")));
+
 	if (ControlFile->state == DB_SHUTDOWNED)
 	{
 		/* This is the expected case, so don't be chatty in standalone mode */
@@ -41,6 +41,7 @@
 #include "catalog/heap.h"
 #include "catalog/index.h"
 #include "catalog/objectaccess.h"
+#include "catalog/partition.h"
 #include "catalog/pg_attrdef.h"
 #include "catalog/pg_collation.h"
 #include "catalog/pg_constraint.h"
@@ -1410,8 +1411,15 @@ RelationRemoveInheritance(Oid relid)
 							  NULL, 1, &key);
 
 	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		Oid			parentOid = ((Form_pg_inherits) GETSTRUCT(tuple))->inhparent;
+
 		simple_heap_delete(catalogRelation, &tuple->t_self);
 
+		/* the parent's partition bounds no longer include this child */
+		CacheInvalidateRelcacheByRelid(parentOid);
+	}
+
 	systable_endscan(scan);
 	heap_close(catalogRelation, RowExclusiveLock);
 }
@@ -2064,6 +2072,9 @@ StoreRelCheck(Relation rel, char *ccname, Node *expr,
 							  is_no_inherit,	/* connoinherit */
 							  is_internal);		/* internally constructed? */
 
+	/* the new constraint may change the partition bounds of rel's parents */
+	CacheInvalidatePartitionBounds(RelationGetRelid(rel));
+
 	pfree(ccbin);
 	pfree(ccsrc);
 
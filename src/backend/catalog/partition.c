@@ -0,0 +1,915 @@
+/*-------------------------------------------------------------------------
+ *
+ * partition.c
+ *	  Partition bounds of inheritance parents, for fast partition pruning.
+ *
+ * A table partitioned by inheritance describes the contents of each child
+ * with CHECK constraints on the partition key, and the planner normally
+ * excludes children by trying to refute each child's constraints against
+ * the query's quals.  That costs time linear in the number of children,
+ * which gets expensive with many partitions, and can't do anything about
+ * quals whose values are only known at execution time.
+ *
+ * Here we instead derive the key ranges of all children from their CHECK
+ * constraints once, and cache them sorted in the parent's relcache entry.
+ * The children that may contain rows matching a set of conditions on the
+ * key can then be found by binary search, both by the planner and, for
+ * conditions that compare the key with parameters, by the executor.
+ *
+ * Only simple constraints are understood: comparisons of a column with a
+ * constant using an operator of the column's default btree operator family,
+ * and "column = ANY (array constant)".  Anything else is ignored, which is
+ * safe since ignoring a constraint can only make a child's range wider.
+ * Since CHECK constraints are inherited, a child's range also applies to
+ * all of its own descendants.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/catalog/partition.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/nbtree.h"
+#include "catalog/indexing.h"
+#include "catalog/partition.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_constraint.h"
+#include "catalog/pg_inherits.h"
+#include "catalog/pg_inherits_fn.h"
+#include "commands/defrem.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/fmgroids.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/tqual.h"
+
+
+/* Information about a parent column that might be the partition key */
+typedef struct KeyCandidate
+{
+	bool		checked;		/* have we filled in the rest yet? */
+	bool		usable;			/* does it have a default btree opclass? */
+	Oid			keytype;
+	Oid			keycoll;
+	Oid			opfamily;
+	int			nchildren;		/* number of children constraining it */
+} KeyCandidate;
+
+/* A CHECK constraint conjunct usable for deriving a child's bounds */
+typedef struct KeyCond
+{
+	AttrNumber	attno;			/* parent column number */
+	int			strategy;		/* btree strategy of the operator */
+	bool		is_array;		/* "= ANY (array)"? */
+	Datum		value;			/* comparison value, or the array */
+} KeyCond;
+
+static PartitionBoundInfo *build_partition_bounds(Relation parent);
+static List *get_child_key_conds(Relation parent, Oid childOid,
+					KeyCandidate *candidates);
+static List *flatten_check_constraint(Node *node, List *result);
+static bool decompose_key_clause(Expr *clause, Index varno, AttrNumber *attno,
+					 Oid *opno, Oid *inputcollid, Expr **value,
+					 bool *is_array);
+static int	key_op_strategy(Oid opno, Oid opfamily, Oid keytype);
+static void range_restrict(PartitionBoundInfo *bounds, PartitionRange *range,
+			   int strategy, Datum value);
+static bool range_is_empty(PartitionBoundInfo *bounds, PartitionRange *range);
+static bool range_below(PartitionBoundInfo *bounds, PartitionRange *range,
+			PartitionRange *query);
+static bool range_above(PartitionBoundInfo *bounds, PartitionRange *range,
+			PartitionRange *query);
+static int	range_lower_cmp(const void *a, const void *b, void *arg);
+static int	oid_cmp(const void *p1, const void *p2);
+
+#define partition_cmp(bounds, a, b) \
+	DatumGetInt32(FunctionCall2Coll(&(bounds)->cmpfn, (bounds)->keycoll, \
+									(a), (b)))
+
+
+/*
+ * RelationGetPartitionBounds
+ *		Get the partition bounds of an inheritance parent.
+ *
+ * Returns NULL if the relation has no children, or if its children's CHECK
+ * constraints don't describe them in a way we can use.  The result points
+ * into the relcache entry, so it mustn't be modified, and it mustn't be
+ * used after anything that could process an invalidation message.
+ */
+PartitionBoundInfo *
+RelationGetPartitionBounds(Relation rel)
+{
+	if (!rel->rd_partboundvalid)
+	{
+		if (rel->rd_partcxt)
+			MemoryContextDelete(rel->rd_partcxt);
+		rel->rd_partcxt = NULL;
+		rel->rd_partbound = NULL;
+
+		if (rel->rd_rel->relhassubclass)
+		{
+			MemoryContext tmpcxt;
+			MemoryContext oldcxt;
+			PartitionBoundInfo *bounds;
+
+			/* do the work in a scratch context, then copy out the result */
+			tmpcxt = AllocSetContextCreate(CurrentMemoryContext,
+										   "partition bounds build",
+										   ALLOCSET_DEFAULT_MINSIZE,
+										   ALLOCSET_DEFAULT_INITSIZE,
+										   ALLOCSET_DEFAULT_MAXSIZE);
+			oldcxt = MemoryContextSwitchTo(tmpcxt);
+
+			bounds = build_partition_bounds(rel);
+
+			if (bounds)
+			{
+				MemoryContext partcxt;
+				PartitionBoundInfo *result;
+				int			i;
+
+				partcxt = AllocSetContextCreate(CacheMemoryContext,
+												RelationGetRelationName(rel),
+												ALLOCSET_SMALL_MINSIZE,
+												ALLOCSET_SMALL_INITSIZE,
+												ALLOCSET_SMALL_MAXSIZE);
+				MemoryContextSwitchTo(partcxt);
+
+				result = (PartitionBoundInfo *) palloc(sizeof(PartitionBoundInfo));
+				memcpy(result, bounds, sizeof(PartitionBoundInfo));
+				fmgr_info_cxt(bounds->cmpfn.fn_oid, &result->cmpfn, partcxt);
+
+				result->children = (Oid *)
+					palloc(Max(bounds->nchildren, 1) * sizeof(Oid));
+				memcpy(result->children, bounds->children,
+					   bounds->nchildren * sizeof(Oid));
+
+				result->ranges = (PartitionRange *)
+					palloc(Max(bounds->nranges, 1) * sizeof(PartitionRange));
+				for (i = 0; i < bounds->nranges; i++)
+				{
+					PartitionRange *range = &result->ranges[i];
+
+					*range = bounds->ranges[i];
+					if (!range->lo_inf)
+						range->lo = datumCopy(range->lo, bounds->typbyval,
+											  bounds->typlen);
+					if (!range->hi_inf)
+						range->hi = datumCopy(range->hi, bounds->typbyval,
+											  bounds->typlen);
+				}
+
+				rel->rd_partcxt = partcxt;
+				rel->rd_partbound = result;
+			}
+
+			MemoryContextSwitchTo(oldcxt);
+			MemoryContextDelete(tmpcxt);
+		}
+
+		rel->rd_partboundvalid = true;
+	}
+
+	return rel->rd_partbound;
+}
+
+/*
+ * Derive the partition bounds of a parent from its children's CHECK
+ * constraints.  Everything is allocated in the current memory context.
+ */
+static PartitionBoundInfo *
+build_partition_bounds(Relation parent)
+{
+	int			natts = RelationGetNumberOfAttributes(parent);
+	KeyCandidate *candidates;
+	List	   *children;
+	List	  **childconds;
+	PartitionBoundInfo *bounds;
+	KeyCandidate *key;
+	AttrNumber	keyattno = InvalidAttrNumber;
+	int			maxranges;
+	int			nranges;
+	int			nchildren;
+	int			i;
+	ListCell   *lc;
+
+	children = find_inheritance_children(RelationGetRelid(parent), NoLock);
+	if (children == NIL)
+		return NULL;
+
+	/*
+	 * Collect the usable constraint conjuncts of every child, and pick the
+	 * column constrained in the most children as the partition key.
+	 */
+	candidates = (KeyCandidate *) palloc0((natts + 1) * sizeof(KeyCandidate));
+	childconds = (List **) palloc(list_length(children) * sizeof(List *));
+
+	i = 0;
+	foreach(lc, children)
+		childconds[i++] = get_child_key_conds(parent, lfirst_oid(lc),
+											  candidates);
+
+	for (i = 1; i <= natts; i++)
+	{
+		if (candidates[i].nchildren > 0 &&
+			(keyattno == InvalidAttrNumber ||
+			 candidates[i].nchildren > candidates[keyattno].nchildren))
+			keyattno = i;
+	}
+	if (keyattno == InvalidAttrNumber)
+		return NULL;
+	key = &candidates[keyattno];
+
+	bounds = (PartitionBoundInfo *) palloc0(sizeof(PartitionBoundInfo));
+	bounds->key = keyattno;
+	bounds->keytype = key->keytype;
+	bounds->keycoll = key->keycoll;
+	bounds->opfamily = key->opfamily;
+	fmgr_info(get_opfamily_proc(key->opfamily, key->keytype, key->keytype,
+								BTORDER_PROC),
+			  &bounds->cmpfn);
+	get_typlenbyval(key->keytype, &bounds->typlen, &bounds->typbyval);
+	bounds->children = (Oid *) palloc(key->nchildren * sizeof(Oid));
+
+	maxranges = 16;
+	bounds->ranges = (PartitionRange *)
+		palloc(maxranges * sizeof(PartitionRange));
+
+	/*
+	 * Compute the range of each child that constrains the key.  A child with
+	 * several range conditions gets their intersection; an array condition
+	 * turns it into a list of single values, clipped to that intersection.
+	 * (If there's more than one array condition, we just use the first.)
+	 */
+	nchildren = 0;
+	nranges = 0;
+	i = 0;
+	foreach(lc, children)
+	{
+		Oid			childOid = lfirst_oid(lc);
+		List	   *conds = childconds[i++];
+		PartitionRange range;
+		KeyCond    *arraycond = NULL;
+		bool		found = false;
+		ListCell   *lc2;
+
+		memset(&range, 0, sizeof(range));
+		range.lo_inf = range.hi_inf = true;
+		range.child = nchildren;
+
+		foreach(lc2, conds)
+		{
+			KeyCond    *cond = (KeyCond *) lfirst(lc2);
+
+			if (cond->attno != keyattno)
+				continue;
+			found = true;
+			if (cond->is_array)
+			{
+				if (arraycond == NULL)
+					arraycond = cond;
+			}
+			else
+				range_restrict(bounds, &range, cond->strategy, cond->value);
+		}
+		if (!found)
+			continue;			/* child isn't bounded on the key */
+
+		bounds->children[nchildren++] = childOid;
+
+		if (arraycond)
+		{
+			ArrayType  *arr = DatumGetArrayTypeP(arraycond->value);
+			int16		elmlen;
+			bool		elmbyval;
+			char		elmalign;
+			Datum	   *elems;
+			bool	   *elemnulls;
+			int			nelems;
+			int			j;
+
+			get_typlenbyvalalign(ARR_ELEMTYPE(arr),
+								 &elmlen, &elmbyval, &elmalign);
+			deconstruct_array(arr, ARR_ELEMTYPE(arr),
+							  elmlen, elmbyval, elmalign,
+							  &elems, &elemnulls, &nelems);
+
+			for (j = 0; j < nelems; j++)
+			{
+				PartitionRange point = range;
+
+				if (elemnulls[j])
+					continue;
+				range_restrict(bounds, &point, BTEqualStrategyNumber,
+							   elems[j]);
+				if (range_is_empty(bounds, &point))
+					continue;
+				if (nranges >= maxranges)
+				{
+					maxranges *= 2;
+					bounds->ranges = (PartitionRange *)
+						repalloc(bounds->ranges,
+								 maxranges * sizeof(PartitionRange));
+				}
+				bounds->ranges[nranges++] = point;
+			}
+		}
+		else if (!range_is_empty(bounds, &range))
+		{
+			if (nranges >= maxranges)
+			{
+				maxranges *= 2;
+				bounds->ranges = (PartitionRange *)
+					repalloc(bounds->ranges,
+							 maxranges * sizeof(PartitionRange));
+			}
+			bounds->ranges[nranges++] = range;
+		}
+	}
+	Assert(nchildren == key->nchildren);
+	bounds->nchildren = nchildren;
+
+	/*
+	 * Sort the ranges by lower bound, and merge overlapping ranges of the
+	 * same child.  If ranges of different children overlap, a key value
+	 * could be in more than one child, and a binary search can't find them
+	 * all; give up in that case and let constraint exclusion handle it.
+	 */
+	if (nranges > 1)
+	{
+		int			nmerged = 0;
+
+		qsort_arg(bounds->ranges, nranges, sizeof(PartitionRange),
+				  range_lower_cmp, bounds);
+
+		for (i = 0; i < nranges; i++)
+		{
+			PartitionRange *range = &bounds->ranges[i];
+			PartitionRange *prev;
+			int			cmp;
+
+			if (nmerged == 0)
+			{
+				bounds->ranges[nmerged++] = *range;
+				continue;
+			}
+
+			prev = &bounds->ranges[nmerged - 1];
+			if (!prev->hi_inf && !range->lo_inf)
+			{
+				cmp = partition_cmp(bounds, range->lo, prev->hi);
+				if (cmp > 0 || (cmp == 0 && !(prev->hi_incl && range->lo_incl)))
+				{
+					/* no overlap */
+					bounds->ranges[nmerged++] = *range;
+					continue;
+				}
+			}
+
+			if (prev->child != range->child)
+				return NULL;
+
+			/* extend prev to cover range, if it doesn't already */
+			if (prev->hi_inf)
+				continue;
+			if (range->hi_inf)
+			{
+				prev->hi_inf = true;
+				continue;
+			}
+			cmp = partition_cmp(bounds, range->hi, prev->hi);
+			if (cmp > 0 || (cmp == 0 && range->hi_incl))
+			{
+				prev->hi = range->hi;
+				prev->hi_incl = range->hi_incl;
+			}
+		}
+		nranges = nmerged;
+	}
+	bounds->nranges = nranges;
+
+	return bounds;
+}
+
+/*
+ * Collect the conjuncts of a child's CHECK constraints that compare one of
+ * the parent's columns with a constant in a way we understand, as a list
+ * of KeyConds.  Each column that appears gets its nchildren count bumped.
+ *
+ * NO INHERIT constraints are ignored, since they don't hold for the child's
+ * own children.
+ */
+static List *
+get_child_key_conds(Relation parent, Oid childOid, KeyCandidate *candidates)
+{
+	TupleDesc	parentdesc = RelationGetDescr(parent);
+	List	   *result = NIL;
+	Bitmapset  *attnos = NULL;
+	Relation	conrel;
+	SysScanDesc conscan;
+	ScanKeyData skey[1];
+	HeapTuple	htup;
+	int			attno;
+
+	ScanKeyInit(&skey[0],
+				Anum_pg_constraint_conrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(childOid));
+
+	conrel = heap_open(ConstraintRelationId, AccessShareLock);
+	conscan = systable_beginscan(conrel, ConstraintRelidIndexId, true,
+								 NULL, 1, skey);
+
+	while (HeapTupleIsValid(htup = systable_getnext(conscan)))
+	{
+		Form_pg_constraint conform = (Form_pg_constraint) GETSTRUCT(htup);
+		Datum		val;
+		bool		isnull;
+		char	   *s;
+		Node	   *conexpr;
+		List	   *clauses;
+		ListCell   *lc;
+
+		if (conform->contype != CONSTRAINT_CHECK ||
+			!conform->convalidated || conform->connoinherit)
+			continue;
+
+		val = fastgetattr(htup, Anum_pg_constraint_conbin,
+						  conrel->rd_att, &isnull);
+		if (isnull)
+			elog(ERROR, "null conbin for constraint %u",
+				 HeapTupleGetOid(htup));
+
+		s = TextDatumGetCString(val);
+		conexpr = eval_const_expressions(NULL, stringToNode(s));
+		clauses = flatten_check_constraint(conexpr, NIL);
+
+		foreach(lc, clauses)
+		{
+			Expr	   *clause = (Expr *) lfirst(lc);
+			AttrNumber	childattno;
+			Oid			opno;
+			Oid			inputcollid;
+			Expr	   *value;
+			bool		is_array;
+			char	   *attname;
+			KeyCandidate *cand;
+			KeyCond    *cond;
+			int			strategy;
+
+			if (!decompose_key_clause(clause, 1, &childattno, &opno,
+									  &inputcollid, &value, &is_array))
+				continue;
+			if (!IsA(value, Const) || ((Const *) value)->constisnull)
+				continue;
+
+			/* match the child's column to the parent's by name */
+			attname = get_attname(childOid, childattno);
+			if (attname == NULL)
+				continue;
+			attno = get_attnum(RelationGetRelid(parent), attname);
+			if (attno <= 0 || attno > parentdesc->natts)
+				continue;
+
+			cand = &candidates[attno];
+			if (!cand->checked)
+			{
+				Form_pg_attribute attr = parentdesc->attrs[attno - 1];
+				Oid			opclass;
+
+				cand->checked = true;
+				opclass = attr->attisdropped ? InvalidOid :
+					GetDefaultOpClass(attr->atttypid, BTREE_AM_OID);
+				if (OidIsValid(opclass))
+				{
+					cand->usable = true;
+					cand->keytype = get_opclass_input_type(opclass);
+					cand->keycoll = attr->attcollation;
+					cand->opfamily = get_opclass_family(opclass);
+				}
+			}
+			if (!cand->usable || inputcollid != cand->keycoll)
+				continue;
+
+			strategy = key_op_strategy(opno, cand->opfamily, cand->keytype);
+			if (strategy == 0 ||
+				(is_array && strategy != BTEqualStrategyNumber))
+				continue;
+
+			cond = (KeyCond *) palloc(sizeof(KeyCond));
+			cond->attno = attno;
+			cond->strategy = strategy;
+			cond->is_array = is_array;
+			cond->value = ((Const *) value)->constvalue;
+			result = lappend(result, cond);
+
+			attnos = bms_add_member(attnos, attno);
+		}
+	}
+
+	systable_endscan(conscan);
+	heap_close(conrel, AccessShareLock);
+
+	while ((attno = bms_first_member(attnos)) >= 0)
+		candidates[attno].nchildren++;
+
+	return result;
+}
+
+/*
+ * Append the top-level AND'ed conditions of a constraint expression to
+ * result.
+ */
+static List *
+flatten_check_constraint(Node *node, List *result)
+{
+	if (and_clause(node))
+	{
+		ListCell   *lc;
+
+		foreach(lc, ((BoolExpr *) node)->args)
+			result = flatten_check_constraint((Node *) lfirst(lc), result);
+	}
+	else
+		result = lappend(result, node);
+
+	return result;
+}
+
+/*
+ * Check whether clause has the form "Var op expr", "expr op Var" or
+ * "Var op ANY (expr)", where the Var is a user column of range table entry
+ * varno.  If so, return the column number, the operator (commuted if
+ * needed so the Var is on the left), the input collation and the other
+ * argument.  The caller must check the operator and the other argument.
+ */
+static bool
+decompose_key_clause(Expr *clause, Index varno, AttrNumber *attno,
+					 Oid *opno, Oid *inputcollid, Expr **value,
+					 bool *is_array)
+{
+	Expr	   *leftop;
+	Expr	   *rightop;
+
+	if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *opclause = (OpExpr *) clause;
+
+		if (list_length(opclause->args) != 2)
+			return false;
+		leftop = (Expr *) linitial(opclause->args);
+		rightop = (Expr *) lsecond(opclause->args);
+		*opno = opclause->opno;
+		*inputcollid = opclause->inputcollid;
+		*is_array = false;
+	}
+	else if (IsA(clause, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) clause;
+
+		if (!saop->useOr)
+			return false;
+		leftop = (Expr *) linitial(saop->args);
+		rightop = (Expr *) lsecond(saop->args);
+		*opno = saop->opno;
+		*inputcollid = saop->inputcollid;
+		*is_array = true;
+	}
+	else
+		return false;
+
+	/* binary-compatible casts of the column don't matter */
+	while (leftop && IsA(leftop, RelabelType))
+		leftop = ((RelabelType *) leftop)->arg;
+
+	if (!(leftop && IsA(leftop, Var) && ((Var *) leftop)->varno == varno &&
+		  ((Var *) leftop)->varlevelsup == 0 &&
+		  ((Var *) leftop)->varattno > 0))
+	{
+		if (*is_array)
+			return false;
+
+		/* try it the other way around */
+		while (rightop && IsA(rightop, RelabelType))
+			rightop = ((RelabelType *) rightop)->arg;
+		if (!(rightop && IsA(rightop, Var) &&
+			  ((Var *) rightop)->varno == varno &&
+			  ((Var *) rightop)->varlevelsup == 0 &&
+			  ((Var *) rightop)->varattno > 0))
+			return false;
+
+		*opno = get_commutator(*opno);
+		if (!OidIsValid(*opno))
+			return false;
+		*attno = ((Var *) rightop)->varattno;
+		*value = (Expr *) linitial(((OpExpr *) clause)->args);
+		return true;
+	}
+
+	*attno = ((Var *) leftop)->varattno;
+	*value = rightop;
+	return true;
+}
+
+/*
+ * Get the btree strategy number of an operator comparing two values of
+ * keytype in opfamily, or 0 if it isn't such an operator.
+ */
+static int
+key_op_strategy(Oid opno, Oid opfamily, Oid keytype)
+{
+	int			strategy;
+	Oid			lefttype;
+	Oid			righttype;
+
+	if (!op_in_opfamily(opno, opfamily))
+		return 0;
+	get_op_opfamily_properties(opno, opfamily, false,
+							   &strategy, &lefttype, &righttype);
+	if (lefttype != keytype || righttype != keytype)
+		return 0;
+	return strategy;
+}
+
+/*
+ * Narrow range down to the values that also satisfy "key op value", where
+ * op has the given btree strategy.
+ */
+static void
+range_restrict(PartitionBoundInfo *bounds, PartitionRange *range,
+			   int strategy, Datum value)
+{
+	int			cmp;
+
+	if (strategy == BTLessStrategyNumber ||
+		strategy == BTLessEqualStrategyNumber ||
+		strategy == BTEqualStrategyNumber)
+	{
+		bool		incl = (strategy != BTLessStrategyNumber);
+
+		cmp = range->hi_inf ? -1 : partition_cmp(bounds, value, range->hi);
+		if (cmp < 0 || (cmp == 0 && !incl))
+		{
+			range->hi = value;
+			range->hi_inf = false;
+			range->hi_incl = incl;
+		}
+	}
+
+	if (strategy == BTGreaterStrategyNumber ||
+		strategy == BTGreaterEqualStrategyNumber ||
+		strategy == BTEqualStrategyNumber)
+	{
+		bool		incl = (strategy != BTGreaterStrategyNumber);
+
+		cmp = range->lo_inf ? 1 : partition_cmp(bounds, value, range->lo);
+		if (cmp > 0 || (cmp == 0 && !incl))
+		{
+			range->lo = value;
+			range->lo_inf = false;
+			range->lo_incl = incl;
+		}
+	}
+}
+
+/*
+ * Does range contain no values at all?
+ */
+static bool
+range_is_empty(PartitionBoundInfo *bounds, PartitionRange *range)
+{
+	int			cmp;
+
+	if (range->lo_inf || range->hi_inf)
+		return false;
+	cmp = partition_cmp(bounds, range->lo, range->hi);
+	return cmp > 0 || (cmp == 0 && !(range->lo_incl && range->hi_incl));
+}
+
+/*
+ * Are all values in range less than all values in query?
+ */
+static bool
+range_below(PartitionBoundInfo *bounds, PartitionRange *range,
+			PartitionRange *query)
+{
+	int			cmp;
+
+	if (range->hi_inf || query->lo_inf)
+		return false;
+	cmp = partition_cmp(bounds, range->hi, query->lo);
+	return cmp < 0 || (cmp == 0 && !(range->hi_incl && query->lo_incl));
+}
+
+/*
+ * Are all values in range greater than all values in query?
+ */
+static bool
+range_above(PartitionBoundInfo *bounds, PartitionRange *range,
+			PartitionRange *query)
+{
+	int			cmp;
+
+	if (range->lo_inf || query->hi_inf)
+		return false;
+	cmp = partition_cmp(bounds, range->lo, query->hi);
+	return cmp > 0 || (cmp == 0 && !(range->lo_incl && query->hi_incl));
+}
+
+/*
+ * qsort_arg comparator to sort PartitionRanges by lower bound
+ */
+static int
+range_lower_cmp(const void *a, const void *b, void *arg)
+{
+	const PartitionRange *ra = (const PartitionRange *) a;
+	const PartitionRange *rb = (const PartitionRange *) b;
+	PartitionBoundInfo *bounds = (PartitionBoundInfo *) arg;
+	int			cmp;
+
+	if (ra->lo_inf || rb->lo_inf)
+		return (int) rb->lo_inf - (int) ra->lo_inf;
+	cmp = partition_cmp(bounds, ra->lo, rb->lo);
+	if (cmp != 0)
+		return cmp;
+	return (int) rb->lo_incl - (int) ra->lo_incl;
+}
+
+/*
+ * partition_match_clause
+ *		Check whether a clause restricts the partition key.
+ *
+ * The clause must be a strict comparison of the key column of range table
+ * entry varno with some other expression, or "key = ANY (expression)", using
+ * an operator that the partition bounds can be searched with.  If so, we
+ * return the operator's btree strategy and the expression, which the caller
+ * must still check to be suitable for its purposes.
+ */
+bool
+partition_match_clause(PartitionBoundInfo *bounds, Index varno, Expr *clause,
+					   int *strategy, Expr **value, bool *is_array)
+{
+	AttrNumber	attno;
+	Oid			opno;
+	Oid			inputcollid;
+
+	if (!decompose_key_clause(clause, varno, &attno, &opno, &inputcollid,
+							  value, is_array))
+		return false;
+	if (attno != bounds->key || inputcollid != bounds->keycoll)
+		return false;
+
+	*strategy = key_op_strategy(opno, bounds->opfamily, bounds->keytype);
+	if (*strategy == 0 ||
+		(*is_array && *strategy != BTEqualStrategyNumber))
+		return false;
+
+	return true;
+}
+
+/*
+ * partition_prune
+ *		Find the children that may contain rows satisfying all of a set of
+ *		conditions "key op value", op having btree strategy strategies[i].
+ *
+ * Returns a palloc'd array with an entry for each bounded child, true if
+ * the child may contain matching rows.  Since the conditions are strict, a
+ * null value means nothing matches.
+ */
+bool *
+partition_prune(PartitionBoundInfo *bounds, int nconds,
+				const int *strategies, const Datum *values,
+				const bool *isnulls)
+{
+	bool	   *result;
+	PartitionRange query;
+	int			lo;
+	int			hi;
+	int			i;
+
+	result = (bool *) palloc0(Max(bounds->nchildren, 1) * sizeof(bool));
+
+	memset(&query, 0, sizeof(query));
+	query.lo_inf = query.hi_inf = true;
+	for (i = 0; i < nconds; i++)
+	{
+		if (isnulls[i])
+			return result;
+		range_restrict(bounds, &query, strategies[i], values[i]);
+	}
+	if (range_is_empty(bounds, &query))
+		return result;
+
+	/*
+	 * The ranges are sorted and don't overlap, so binary search for the
+	 * first one that isn't entirely below the query range; from there on,
+	 * every range up to the first one entirely above it matches.
+	 */
+	lo = 0;
+	hi = bounds->nranges;
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (range_below(bounds, &bounds->ranges[mid], &query))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (i = lo; i < bounds->nranges; i++)
+	{
+		PartitionRange *range = &bounds->ranges[i];
+
+		if (range_above(bounds, range, &query))
+			break;
+		result[range->child] = true;
+	}
+
+	return result;
+}
+
+/*
+ * partition_child_index
+ *		Find a child's entry in the bounds' children array.
+ *
+ * Returns -1 if the child isn't bounded on the key, in which case it must
+ * never be pruned.
+ */
+int
+partition_child_index(PartitionBoundInfo *bounds, Oid childOid)
+{
+	Oid		   *found;
+
+	found = (Oid *) bsearch(&childOid, bounds->children, bounds->nchildren,
+							sizeof(Oid), oid_cmp);
+	if (found == NULL)
+		return -1;
+	return found - bounds->children;
+}
+
+static int
+oid_cmp(const void *p1, const void *p2)
+{
+	Oid			v1 = *((const Oid *) p1);
+	Oid			v2 = *((const Oid *) p2);
+
+	if (v1 < v2)
+		return -1;
+	if (v1 > v2)
+		return 1;
+	return 0;
+}
+
+/*
+ * CacheInvalidatePartitionBounds
+ *		Invalidate the cached partition bounds of relid's parents.
+ *
+ * This must be called whenever something that the parents' bounds are
+ * derived from changes: a CHECK constraint of relid is added, dropped or
+ * validated, or relid stops being a child.  The parents' relcache entries
+ * are invalidated, which also forces replanning of plans that pruned
+ * children using the old bounds.
+ */
+void
+CacheInvalidatePartitionBounds(Oid relid)
+{
+	Relation	inhrel;
+	SysScanDesc scan;
+	ScanKeyData key[1];
+	HeapTuple	inheritsTuple;
+
+	ScanKeyInit(&key[0],
+				Anum_pg_inherits_inhrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+
+	inhrel = heap_open(InheritsRelationId, AccessShareLock);
+	scan = systable_beginscan(inhrel, InheritsRelidSeqnoIndexId, true,
+							  NULL, 1, key);
+
+	while ((inheritsTuple = systable_getnext(scan)) != NULL)
+	{
+		Oid			parentOid;
+
+		parentOid = ((Form_pg_inherits) GETSTRUCT(inheritsTuple))->inhparent;
+		CacheInvalidateRelcacheByRelid(parentOid);
+	}
+
+	systable_endscan(scan);
+	heap_close(inhrel, AccessShareLock);
+}
@@ -20,6 +20,7 @@
 #include "catalog/dependency.h"
 #include "catalog/indexing.h"
 #include "catalog/objectaccess.h"
+#include "catalog/partition.h"
 #include "catalog/pg_constraint.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_type.h"
@@ -589,6 +590,9 @@ RemoveConstraintById(Oid conId)
 			heap_freetuple(relTup);
 
 			heap_close(pgrel, RowExclusiveLock);
+
+			/* and the parents' partition bounds may be derived from it */
+			CacheInvalidatePartitionBounds(con->conrelid);
 		}
 
 		/* Keep lock on constraint's rel until end of xact */
@@ -29,6 +29,7 @@
 #include "catalog/indexing.h"
 #include "catalog/namespace.h"
 #include "catalog/objectaccess.h"
+#include "catalog/partition.h"
 #include "catalog/pg_collation.h"
 #include "catalog/pg_constraint.h"
 #include "catalog/pg_depend.h"
@@ -2052,9 +2053,12 @@ StoreCatalogInheritance1(Oid relationId, Oid parentOid,
 								 parentOid, false);
 
 	/*
-	 * Mark the parent as having subclasses.
+	 * Mark the parent as having subclasses, and make it recompute its
+	 * partition bounds to include the new child.  (SetRelationHasSubclass
+	 * doesn't send an invalidation if the flag was already set.)
 	 */
 	SetRelationHasSubclass(parentOid, true);
+	CacheInvalidateRelcacheByRelid(parentOid);
 }
 
 /*
@@ -6883,9 +6887,10 @@ ATExecValidateConstraint(Relation rel, char *constrName, bool recurse,
 
 			/*
 			 * Invalidate relcache so that others see the new validated
-			 * constraint.
+			 * constraint.  The parents' partition bounds may now use it, too.
 			 */
 			CacheInvalidateRelcache(rel);
+			CacheInvalidatePartitionBounds(RelationGetRelid(rel));
 		}
 
 		/*
@@ -7117,7 +7122,7 @@ transformFkeyCheckAttrs(Relation pkrel,
 		 * partial index; forget it if there are any expressions, too. Invalid
 		 * indexes are out as well.
 		 */
-		if (indexStruct->indnatts == numattrs &&
+		if (indexStruct->indnkeyatts == numattrs &&
 			indexStruct->indisunique &&
 			IndexIsValid(indexStruct) &&
 			heap_attisnull(indexTuple, Anum_pg_index_indpred) &&
@@ -8248,6 +8253,21 @@ ATExecAlterColumnType(AlteredTableInfo *tab, Relation rel,
 								   colName)));
 				break;
 
+			case OCLASS_STATISTIC_EXT:
+
+				/*
+				 * The data of a statistics object is serialized using the
+				 * column's type, so it would have to be thrown away and
+				 * rebuilt.  Make the user drop and recreate it instead.
+				 */
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("cannot alter type of a column used by a statistics object"),
+						 errdetail("%s depends on column \"%s\"",
+								   getObjectDescription(&foundObject),
+								   colName)));
+				break;
+
 			case OCLASS_DEFAULT:
 
 				/*
@@ -8722,7 +8742,8 @@ TryReuseIndex(Oid oldId, IndexStmt *stmt)
 {
 	if (CheckIndexCompatible(oldId,
 							 stmt->accessMethod,
-							 stmt->indexParams,
+							 list_concat(list_copy(stmt->indexParams),
+										 list_copy(stmt->indexIncludingParams)),
 							 stmt->excludeOpNames))
 	{
 		Relation	irel = index_open(oldId, NoLock);
@@ -10352,6 +10373,9 @@ ATExecDropInherit(Relation rel, RangeVar *parent, LOCKMODE lockmode)
 						RelationGetRelationName(parent_rel),
 						RelationGetRelationName(rel))));
 
+	/* the parent's partition bounds no longer include this child */
+	CacheInvalidateRelcache(parent_rel);
+
 	/*
 	 * Search through child columns looking for ones matching parent rel
 	 */
@@ -10908,7 +10932,7 @@ ATExecReplicaIdentity(Relation rel, ReplicaIdentityStmt *stmt, LOCKMODE lockmode
 						RelationGetRelationName(indexRel))));
 
 	/* Check index for nullable columns. */
-	for (key = 0; key < indexRel->rd_index->indnatts; key++)
+	for (key = 0; key < indexRel->rd_index->indnkeyatts; key++)
 	{
 		int16		attno = indexRel->rd_index->indkey.values[key];
 		Form_pg_attribute attr;
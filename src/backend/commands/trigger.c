@@ -4796,6 +4796,36 @@ AfterTriggerPendingOnRel(Oid relid)
 	return false;
 }
 
+/* ----------
+ * AfterTriggerEventsPending()
+ *		Test to see if there are any after-trigger events queued at all.
+ *
+ * This is a cheap, conservative cousin of AfterTriggerPendingOnRel, used by
+ * the planner to decide whether it may rely on foreign key constraints
+ * holding.  Since RI checks are themselves AFTER triggers, a constraint is
+ * only known to hold while nothing is left in the queue.  We don't bother
+ * to look inside the chunks: events already marked DONE are normally
+ * deleted along with their chunk, and a false positive merely costs a
+ * missed optimization.
+ * ----------
+ */
+bool
+AfterTriggerEventsPending(void)
+{
+	int			depth;
+
+	if (afterTriggers.events.head != NULL)
+		return true;
+
+	for (depth = 0; depth <= afterTriggers.query_depth && depth < afterTriggers.maxquerydepth; depth++)
+	{
+		if (afterTriggers.query_stack[depth].head != NULL)
+			return true;
+	}
+
+	return false;
+}
+
 
 /* ----------
  * AfterTriggerSaveEvent()
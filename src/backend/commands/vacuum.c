@@ -58,6 +58,8 @@ int			vacuum_freeze_min_age;
 int			vacuum_freeze_table_age;
 int			vacuum_multixact_freeze_min_age;
 int			vacuum_multixact_freeze_table_age;
+int			vacuum_parallel_workers;
+int			vacuum_max_blocks;
 
 
 /* A few variables that don't seem worth passing around as parameters */
@@ -117,6 +119,14 @@ ExecVacuum(VacuumStmt *vacstmt, bool isTopLevel)
 	/* user-invoked vacuum never uses this parameter */
 	params.log_min_duration = -1;
 
+	/* parallel index vacuuming only if requested */
+	if (vacstmt->options & VACOPT_PARALLEL)
+		params.nworkers = vacuum_parallel_workers;
+	else
+		params.nworkers = 0;
+
+	params.max_blocks = vacuum_max_blocks;
+
 	/* Now go through the common routine */
 	vacuum(vacstmt->options, vacstmt->relation, InvalidOid, &params,
 		   vacstmt->va_cols, NULL, isTopLevel);
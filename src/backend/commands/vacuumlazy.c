@@ -12,16 +12,36 @@
  *
  * We are willing to use at most maintenance_work_mem (or perhaps
  * autovacuum_work_mem) memory space to keep track of dead tuples.  We
- * initially allocate an array of TIDs of that size, with an upper limit that
- * depends on table size (this limit ensures we don't allocate a huge area
- * uselessly for vacuuming small tables).  If the array threatens to overflow,
- * we suspend the heap scan phase and perform a pass of index cleanup and page
- * compaction, then resume the heap scan with an empty TID array.
+ * initially allocate a dead-tuple store of that size, with an upper limit
+ * that depends on table size (this limit ensures we don't allocate a huge
+ * area uselessly for vacuuming small tables).  If the store threatens to
+ * overflow, we suspend the heap scan phase and perform a pass of index
+ * cleanup and page compaction, then resume the heap scan with an empty store.
+ *
+ * The store is not an array of TIDs but a sequence of per-page records, in
+ * block number order, each holding the dead offsets on that page either as
+ * a bitmap or as an array of offset numbers, whichever is smaller.  Apart
+ * from pages with just one or two dead tuples, that takes less space than
+ * six bytes per dead tuple, and never more than a few dozen bytes per page.
+ * The store is allocated as a huge chunk, so it isn't limited to 1GB.
+ * Before index vacuuming starts, a small directory with one entry per
+ * DEAD_BLOCKS_PER_BUCKET heap blocks is appended to the records, so that
+ * lazy_tid_reaped() need only examine a bounded number of records for each
+ * index tuple.  The whole store is one contiguous chunk addressed by offsets,
+ * so it can be copied as-is into dynamic shared memory.
  *
  * If we're processing a table with no indexes, we can just vacuum each page
  * as we go; there's no need to save up multiple tuples to minimize the number
  * of index scans performed.  So we don't use maintenance_work_mem memory for
- * the TID array, just enough to hold as many heap tuples as fit on one page.
+ * the store, just enough to hold the dead tuples of one page.
+ *
+ * If parallel workers were requested and the relation has more than one
+ * index, each round of index vacuuming and the final index cleanup are
+ * spread across a set of parallel workers.  The TID array is copied into the
+ * parallel context's dynamic shared memory segment for the duration of the
+ * round, and the leader and workers claim indexes one at a time until all
+ * have been processed.  Updating index statistics in pg_class is not allowed
+ * in parallel mode, so the leader does that after the workers have exited.
  *
  *
  * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
@@ -42,8 +62,10 @@
 #include "access/heapam_xlog.h"
 #include "access/htup_details.h"
 #include "access/multixact.h"
+#include "access/parallel.h"
 #include "access/transam.h"
 #include "access/visibilitymap.h"
+#include "access/xact.h"
 #include "access/xlog.h"
 #include "catalog/catalog.h"
 #include "catalog/storage.h"
@@ -51,6 +73,7 @@
 #include "commands/vacuum.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "port/atomics.h"
 #include "portability/instr_time.h"
 #include "postmaster/autovacuum.h"
 #include "storage/bufmgr.h"
@@ -85,11 +108,65 @@
 #define VACUUM_TRUNCATE_LOCK_TIMEOUT			5000	/* ms */
 
 /*
- * Guesstimation of number of dead tuples per page.  This is used to
- * provide an upper limit to memory allocated when vacuuming small
- * tables.
+ * Number of heap blocks covered by each entry of the dead-tuple store's
+ * directory.  This bounds the number of page records lazy_tid_reaped() has
+ * to look at.
+ */
+#define DEAD_BLOCKS_PER_BUCKET	32
+
+/*
+ * Dead tuples of one heap page, as stored in LVDeadTuples.  If nbytes is not
+ * zero, data is a bitmap in which bit (off - 1) is set if offset number off
+ * is dead; the bitmap is only as long as needed to cover the highest dead
+ * offset on the page.  Otherwise, data is an array of the ntuples dead
+ * offset numbers in ascending order.  A page with a few dead tuples at high
+ * offsets is stored more compactly that way.
  */
-#define LAZY_ALLOC_TUPLES		MaxHeapTuplesPerPage
+typedef struct LVDeadBlock
+{
+	BlockNumber blkno;
+	uint16		nbytes;			/* length of bitmap, or 0 if an array */
+	uint16		ntuples;		/* # of dead tuples */
+	uint8		data[FLEXIBLE_ARRAY_MEMBER];
+} LVDeadBlock;
+
+#define DeadBlockBitmap(dblk)	((dblk)->data)
+#define DeadBlockOffsets(dblk)	((OffsetNumber *) (dblk)->data)
+#define DeadBlockDataLen(dblk) \
+	((dblk)->nbytes != 0 ? (dblk)->nbytes : \
+	 (dblk)->ntuples * sizeof(OffsetNumber))
+
+#define SizeOfDeadBlock(datalen) \
+	INTALIGN(offsetof(LVDeadBlock, data) + (datalen))
+/* the bitmap for a page is never longer than this, nor is a smaller array */
+#define MaxDeadBlockSize \
+	SizeOfDeadBlock((MaxHeapTuplesPerPage + BITS_PER_BYTE - 1) / BITS_PER_BYTE)
+
+/*
+ * The dead-tuple store.  The data area follows the header; it holds
+ * used_bytes of LVDeadBlock records, in block number order, followed (once
+ * lazy_build_dead_tuple_directory has been called) by a MAXALIGN'd directory
+ * of ndirectory offsets.  Directory entry i is the offset of the first record
+ * whose block is at least first_block + i * DEAD_BLOCKS_PER_BUCKET.
+ */
+typedef struct LVDeadTuples
+{
+	Size		max_bytes;		/* size of data area */
+	Size		used_bytes;		/* bytes of block records */
+	int64		num_tuples;		/* # of dead tuples recorded */
+	int			num_blocks;		/* # of block records */
+	int			ndirectory;		/* # of directory entries */
+	BlockNumber first_block;	/* first and last blocks recorded, valid */
+	BlockNumber last_block;		/* only if num_blocks > 0 */
+} LVDeadTuples;
+
+#define LVDeadTuplesData(dt) \
+	((char *) (dt) + MAXALIGN(sizeof(LVDeadTuples)))
+#define LVDeadTuplesDirectory(dt) \
+	((Size *) (LVDeadTuplesData(dt) + MAXALIGN((dt)->used_bytes)))
+/* directory space needed if the last record is for block blkno */
+#define LVDeadTuplesDirectorySize(first, blkno) \
+	((((blkno) - (first)) / DEAD_BLOCKS_PER_BUCKET + 1) * sizeof(Size))
 
 /*
  * Before we consider skipping a page that's marked as clean in
@@ -97,6 +174,14 @@
  */
 #define SKIP_PAGES_THRESHOLD	((BlockNumber) 32)
 
+/*
+ * How often, in heap blocks, to tell the stats collector how far the scan
+ * has got.  If VACUUM is interrupted, the next one starts from the last
+ * point reported.
+ */
+#define VACUUM_RESUME_REPORT_INTERVAL \
+	((BlockNumber) ((1024 * 1024 * 1024) / BLCKSZ))
+
 typedef struct LVRelStats
 {
 	/* hasindex = true means two-pass strategy; false means one-pass */
@@ -106,6 +191,7 @@ typedef struct LVRelStats
 	BlockNumber rel_pages;		/* total number of pages */
 	BlockNumber scanned_pages;	/* number of pages we examined */
 	BlockNumber pinskipped_pages;		/* # of pages we skipped due to a pin */
+	BlockNumber frozenskipped_pages;	/* # of frozen pages we skipped */
 	double		scanned_tuples; /* counts only tuples on scanned pages */
 	double		old_rel_tuples; /* previous value of pg_class.reltuples */
 	double		new_rel_tuples; /* new estimated total # of tuples */
@@ -113,17 +199,58 @@ typedef struct LVRelStats
 	BlockNumber pages_removed;
 	double		tuples_deleted;
 	BlockNumber nonempty_pages; /* actually, last nonempty page + 1 */
-	/* List of TIDs of tuples we intend to delete */
-	/* NB: this list is ordered by TID address */
-	int			num_dead_tuples;	/* current # of entries */
-	int			max_dead_tuples;	/* # slots allocated in array */
-	ItemPointer dead_tuples;	/* array of ItemPointerData */
+	/* Portion of the rel to scan; see lazy_vacuum_rel */
+	BlockNumber scan_start;		/* first block to scan */
+	BlockNumber max_blocks;		/* max # of blocks to scan, 0 = no limit */
+	BlockNumber resume_block;	/* where the next VACUUM starts, 0 if we
+								 * reached the end of the rel */
+	bool		partial_scan;	/* true if we didn't cover the whole rel */
+	/* TIDs of tuples we intend to delete, ordered by TID address */
+	LVDeadTuples *dead_tuples;
 	int			num_index_scans;
 	TransactionId latestRemovedXid;
 	bool		lock_waiter_detected;
 } LVRelStats;
 
 
+/*
+ * DSM keys for parallel index vacuuming.
+ */
+#define PARALLEL_VACUUM_KEY_SHARED			1
+#define PARALLEL_VACUUM_KEY_INDSTATS		2
+#define PARALLEL_VACUUM_KEY_DEAD_TUPLES		3
+
+/*
+ * Shared state for one round of parallel index vacuuming.  This carries the
+ * parts of the leader's LVRelStats and vacuum settings that the index
+ * vacuuming code needs, plus the counter used to hand out indexes.
+ */
+typedef struct LVShared
+{
+	bool		for_cleanup;	/* cleanup round rather than bulk delete? */
+	int			elevel;
+	int			cost_delay;		/* leader's VacuumCostDelay */
+	int			cost_limit;		/* leader's VacuumCostLimit */
+	BlockNumber rel_pages;
+	BlockNumber scanned_pages;
+	double		old_rel_tuples;
+	double		new_rel_tuples;
+	int			nindexes;
+	pg_atomic_uint32 nextidx;	/* next index to be processed */
+} LVShared;
+
+/*
+ * Per-index slot in shared memory.  The index AMs' bulk-delete results are
+ * flat structs, so they can be passed back and forth by value.
+ */
+typedef struct LVIndStats
+{
+	Oid			indexoid;
+	bool		updated;		/* is stats valid? */
+	IndexBulkDeleteResult stats;
+} LVIndStats;
+
+
 /* A few variables that don't seem worth passing around as parameters */
 static int	elevel = -1;
 
@@ -136,27 +263,54 @@ static BufferAccessStrategy vac_strategy;
 
 /* non-export function prototypes */
 static void lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
-			   Relation *Irel, int nindexes, bool scan_all);
+			   Relation *Irel, int nindexes, int nworkers, bool scan_all);
 static void lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats);
 static bool lazy_check_needs_freeze(Buffer buf);
+static void lazy_report_resume_point(Relation onerel, LVRelStats *vacrelstats,
+						 BlockNumber blkno);
 static void lazy_vacuum_index(Relation indrel,
 				  IndexBulkDeleteResult **stats,
 				  LVRelStats *vacrelstats);
 static void lazy_cleanup_index(Relation indrel,
 				   IndexBulkDeleteResult *stats,
 				   LVRelStats *vacrelstats);
-static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
-				 int tupindex, LVRelStats *vacrelstats, Buffer *vmbuffer);
+static IndexBulkDeleteResult *lazy_do_cleanup_index(Relation indrel,
+					  IndexBulkDeleteResult *stats,
+					  LVRelStats *vacrelstats);
+static void lazy_update_index_stats(Relation indrel,
+						IndexBulkDeleteResult *stats, PGRUsage *ru0);
+static void lazy_vacuum_all_indexes(Relation *Irel,
+						IndexBulkDeleteResult **indstats,
+						LVRelStats *vacrelstats, int nindexes, int nworkers);
+static void lazy_cleanup_all_indexes(Relation *Irel,
+						 IndexBulkDeleteResult **indstats,
+						 LVRelStats *vacrelstats, int nindexes, int nworkers);
+static void lazy_parallel_vacuum_indexes(Relation *Irel,
+							 IndexBulkDeleteResult **indstats,
+							 LVRelStats *vacrelstats, int nindexes,
+							 int nworkers, bool for_cleanup);
+static void lazy_parallel_process_indexes(Relation *Irel, LVShared *lvshared,
+							  LVIndStats *lvindstats,
+							  LVRelStats *vacrelstats);
+static void lazy_parallel_vacuum_main(dsm_segment *seg, shm_toc *toc);
+static void lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
+				 LVDeadBlock *dblk, LVRelStats *vacrelstats, Buffer *vmbuffer);
 static void lazy_truncate_heap(Relation onerel, LVRelStats *vacrelstats);
 static BlockNumber count_nondeletable_pages(Relation onerel,
 						 LVRelStats *vacrelstats);
 static void lazy_space_alloc(LVRelStats *vacrelstats, BlockNumber relblocks);
-static void lazy_record_dead_tuple(LVRelStats *vacrelstats,
-					   ItemPointer itemptr);
+static void lazy_record_dead_tuples(LVRelStats *vacrelstats,
+						BlockNumber blkno, OffsetNumber *offsets,
+						int noffsets);
+static bool lazy_dead_tuples_full(LVDeadTuples *dt, BlockNumber blkno);
+static int	lazy_dead_block_offsets(LVDeadBlock *dblk, OffsetNumber *offsets);
+static bool lazy_dead_block_contains(LVDeadBlock *dblk, OffsetNumber offnum);
+static void lazy_reset_dead_tuples(LVDeadTuples *dt);
+static void lazy_build_dead_tuple_directory(LVDeadTuples *dt);
+static Size lazy_dead_tuples_size(LVDeadTuples *dt);
 static bool lazy_tid_reaped(ItemPointer itemptr, void *state);
-static int	vac_cmp_itemptr(const void *left, const void *right);
 static bool heap_page_is_all_visible(Relation rel, Buffer buf,
-						 TransactionId *visibility_cutoff_xid);
+						 TransactionId *visibility_cutoff_xid, bool *all_frozen);
 
 
 /*
@@ -175,6 +329,7 @@ lazy_vacuum_rel(Relation onerel, int options, VacuumParams *params,
 	LVRelStats *vacrelstats;
 	Relation   *Irel;
 	int			nindexes;
+	int			nworkers;
 	BlockNumber possibly_freeable;
 	PGRUsage	ru0;
 	TimestampTz starttime = 0;
@@ -236,24 +391,59 @@ lazy_vacuum_rel(Relation onerel, int options, VacuumParams *params,
 	vacrelstats->pages_removed = 0;
 	vacrelstats->lock_waiter_detected = false;
 
+	/*
+	 * Unless we have to scan all pages, continue where the previous VACUUM
+	 * of the table stopped, whether it was interrupted or stopped on purpose
+	 * at max_blocks, and stop at max_blocks ourselves.  A scan_all VACUUM
+	 * always covers the whole table, since otherwise it couldn't advance
+	 * relfrozenxid.  A manual VACUUM without a block limit does too, since
+	 * whoever issued it expects the whole table to be processed.
+	 */
+	vacrelstats->scan_start = 0;
+	vacrelstats->max_blocks = 0;
+	if (!scan_all)
+	{
+		vacrelstats->max_blocks = params->max_blocks;
+		if (params->max_blocks > 0 || IsAutoVacuumWorkerProcess())
+		{
+			PgStat_StatTabEntry *tabentry;
+
+			tabentry = pgstat_fetch_stat_tabentry(RelationGetRelid(onerel));
+			if (tabentry != NULL)
+				vacrelstats->scan_start = tabentry->vacuum_resume_block;
+		}
+	}
+
 	/* Open all indexes of the relation */
 	vac_open_indexes(onerel, RowExclusiveLock, &nindexes, &Irel);
 	vacrelstats->hasindex = (nindexes > 0);
 
+	/*
+	 * Decide how many parallel workers to use for index vacuuming.  The
+	 * leader processes indexes too, so more than one worker per additional
+	 * index would be useless.  Workers can't see our local buffers, so
+	 * indexes on temporary tables are always vacuumed serially.
+	 */
+	nworkers = 0;
+	if (params->nworkers > 0 && nindexes > 1 &&
+		!RelationUsesLocalBuffers(onerel))
+		nworkers = Min(params->nworkers, nindexes - 1);
+
 	/* Do the vacuuming */
-	lazy_scan_heap(onerel, vacrelstats, Irel, nindexes, scan_all);
+	lazy_scan_heap(onerel, vacrelstats, Irel, nindexes, nworkers, scan_all);
 
 	/* Done with indexes */
 	vac_close_indexes(nindexes, Irel, NoLock);
 
 	/*
-	 * Compute whether we actually scanned the whole relation. If we did, we
-	 * can adjust relfrozenxid and relminmxid.
+	 * Compute whether we actually scanned all the unfrozen pages. If we did,
+	 * we can adjust relfrozenxid and relminmxid.
 	 *
 	 * NB: We need to check this before truncating the relation, because that
 	 * will change ->rel_pages.
 	 */
-	if (vacrelstats->scanned_pages < vacrelstats->rel_pages)
+	if ((vacrelstats->scanned_pages + vacrelstats->frozenskipped_pages)
+		< vacrelstats->rel_pages)
 	{
 		Assert(!scan_all);
 		scanned_all = false;
@@ -265,10 +455,13 @@ lazy_vacuum_rel(Relation onerel, int options, VacuumParams *params,
 	 * Optionally truncate the relation.
 	 *
 	 * Don't even think about it unless we have a shot at releasing a goodly
-	 * number of pages.  Otherwise, the time taken isn't worth it.
+	 * number of pages.  Otherwise, the time taken isn't worth it.  Nor if we
+	 * stopped short of the end of the relation, since then we don't know
+	 * whether the last pages are empty.
 	 */
 	possibly_freeable = vacrelstats->rel_pages - vacrelstats->nonempty_pages;
-	if (possibly_freeable > 0 &&
+	if (vacrelstats->resume_block == 0 &&
+		possibly_freeable > 0 &&
 		(possibly_freeable >= REL_TRUNCATE_MINIMUM ||
 		 possibly_freeable >= vacrelstats->rel_pages / REL_TRUNCATE_FRACTION))
 		lazy_truncate_heap(onerel, vacrelstats);
@@ -290,8 +483,9 @@ lazy_vacuum_rel(Relation onerel, int options, VacuumParams *params,
 	 * is all-visible we'd definitely like to know that.  But clamp the value
 	 * to be not more than what we're setting relpages to.
 	 *
-	 * Also, don't change relfrozenxid/relminmxid if we skipped any pages,
-	 * since then we don't know for certain that all tuples have a newer xmin.
+	 * Also, don't change relfrozenxid/relminmxid if we skipped any pages
+	 * that weren't all-frozen, since then we don't know for certain that all
+	 * tuples have a newer xmin.
 	 */
 	new_rel_pages = vacrelstats->rel_pages;
 	new_rel_tuples = vacrelstats->new_rel_tuples;
@@ -301,7 +495,7 @@ lazy_vacuum_rel(Relation onerel, int options, VacuumParams *params,
 		new_rel_tuples = vacrelstats->old_rel_tuples;
 	}
 
-	new_rel_allvisible = visibilitymap_count(onerel);
+	visibilitymap_count(onerel, &new_rel_allvisible, NULL);
 	if (new_rel_allvisible > new_rel_pages)
 		new_rel_allvisible = new_rel_pages;
 
@@ -325,7 +519,9 @@ lazy_vacuum_rel(Relation onerel, int options, VacuumParams *params,
 	pgstat_report_vacuum(RelationGetRelid(onerel),
 						 onerel->rd_rel->relisshared,
 						 new_live_tuples,
-						 vacrelstats->new_dead_tuples);
+						 vacrelstats->new_dead_tuples,
+						 vacrelstats->resume_block,
+						 vacrelstats->partial_scan);
 
 	/* and log the action if appropriate */
 	if (IsAutoVacuumWorkerProcess() && params->log_min_duration >= 0)
@@ -418,6 +614,29 @@ vacuum_log_cleanup_info(Relation rel, LVRelStats *vacrelstats)
 		(void) log_heap_cleanup_info(rel->rd_node, vacrelstats->latestRemovedXid);
 }
 
+/*
+ *	lazy_report_resume_point() -- save how far lazy_scan_heap has got
+ *
+ *		All blocks before blkno have been scanned.  Those whose dead tuples
+ *		are still waiting for index vacuuming will have to be scanned again
+ *		by the next VACUUM if this one doesn't finish, so the resume point is
+ *		the first of them, if any.
+ */
+static void
+lazy_report_resume_point(Relation onerel, LVRelStats *vacrelstats,
+						 BlockNumber blkno)
+{
+	LVDeadTuples *dt = vacrelstats->dead_tuples;
+	BlockNumber resume_block = blkno;
+
+	if (dt->num_blocks > 0 && dt->first_block < resume_block)
+		resume_block = dt->first_block;
+
+	pgstat_report_vacuum_resume(RelationGetRelid(onerel),
+								onerel->rd_rel->relisshared,
+								resume_block);
+}
+
 /*
  *	lazy_scan_heap() -- scan an open heap relation
  *
@@ -433,13 +652,23 @@ vacuum_log_cleanup_info(Relation rel, LVRelStats *vacrelstats)
  *		If there are no indexes then we can reclaim line pointers on the fly;
  *		dead line pointers need only be retained until all index pointers that
  *		reference them have been killed.
+ *
+ *		Only the blocks from vacrelstats->scan_start on are scanned, and at
+ *		most vacrelstats->max_blocks of them if that's set.  We set
+ *		vacrelstats->resume_block to where the next VACUUM should start, and
+ *		vacrelstats->partial_scan if some blocks were left out.  When a scan
+ *		that started partway reaches the end of the relation, the next one
+ *		wraps around to block 0 to cover the blocks this one didn't.
  */
 static void
 lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
-			   Relation *Irel, int nindexes, bool scan_all)
+			   Relation *Irel, int nindexes, int nworkers, bool scan_all)
 {
 	BlockNumber nblocks,
+				startblk,
+				endblk,
 				blkno;
+	BlockNumber next_resume_report;
 	HeapTupleData tuple;
 	char	   *relname;
 	BlockNumber empty_pages,
@@ -452,8 +681,8 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 	int			i;
 	PGRUsage	ru0;
 	Buffer		vmbuffer = InvalidBuffer;
-	BlockNumber next_not_all_visible_block;
-	bool		skipping_all_visible_blocks;
+	BlockNumber next_unskippable_block;
+	bool		skipping_blocks;
 	xl_heap_freeze_tuple *frozen;
 	StringInfoData buf;
 
@@ -474,10 +703,30 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 	nblocks = RelationGetNumberOfBlocks(onerel);
 	vacrelstats->rel_pages = nblocks;
 	vacrelstats->scanned_pages = 0;
-	vacrelstats->nonempty_pages = 0;
 	vacrelstats->latestRemovedXid = InvalidTransactionId;
 
-	lazy_space_alloc(vacrelstats, nblocks);
+	/*
+	 * Work out which blocks to scan.  The resume point could be past the end
+	 * if the relation has been truncated since it was saved; just start over
+	 * in that case.
+	 */
+	startblk = vacrelstats->scan_start;
+	if (startblk >= nblocks)
+		startblk = 0;
+	endblk = nblocks;
+	if (vacrelstats->max_blocks > 0 &&
+		endblk - startblk > vacrelstats->max_blocks)
+		endblk = startblk + vacrelstats->max_blocks;
+	if (startblk > 0)
+		ereport(elevel,
+				(errmsg("resuming vacuum of \"%s\" at block %u",
+						relname, startblk)));
+	next_resume_report = startblk + VACUUM_RESUME_REPORT_INTERVAL;
+
+	/* we haven't looked at the blocks before startblk, so assume they're used */
+	vacrelstats->nonempty_pages = startblk;
+
+	lazy_space_alloc(vacrelstats, endblk - startblk);
 	frozen = palloc(sizeof(xl_heap_freeze_tuple) * MaxHeapTuplesPerPage);
 
 	/*
@@ -490,41 +739,57 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 	 * relfrozenxid, so we only want to do it if we can skip a goodly number
 	 * of pages.
 	 *
-	 * Before entering the main loop, establish the invariant that
-	 * next_not_all_visible_block is the next block number >= blkno that's not
-	 * all-visible according to the visibility map, or nblocks if there's no
-	 * such block.  Also, we set up the skipping_all_visible_blocks flag,
-	 * which is needed because we need hysteresis in the decision: once we've
-	 * started skipping blocks, we may as well skip everything up to the next
-	 * not-all-visible block.
+	 * When scan_all is true, we can't skip pages just because they're
+	 * all-visible, but we can still skip pages that are all-frozen, since
+	 * such pages do not need freezing and do not affect the value that we can
+	 * safely set for relfrozenxid or relminmxid.
 	 *
-	 * Note: if scan_all is true, we won't actually skip any pages; but we
-	 * maintain next_not_all_visible_block anyway, so as to set up the
-	 * all_visible_according_to_vm flag correctly for each page.
+	 * Before entering the main loop, establish the invariant that
+	 * next_unskippable_block is the next block number >= blkno that we can't
+	 * skip based on the visibility map, either all-visible for a regular scan
+	 * or all-frozen for a scan_all scan.  We set it to endblk if there's no
+	 * such block.  We also set up the skipping_blocks flag correctly at this
+	 * stage.
 	 *
-	 * Note: The value returned by visibilitymap_test could be slightly
+	 * Note: The value returned by visibilitymap_get_status could be slightly
 	 * out-of-date, since we make this test before reading the corresponding
 	 * heap page or locking the buffer.  This is OK.  If we mistakenly think
-	 * that the page is all-visible when in fact the flag's just been cleared,
-	 * we might fail to vacuum the page.  But it's OK to skip pages when
-	 * scan_all is not set, so no great harm done; the next vacuum will find
-	 * them.  If we make the reverse mistake and vacuum a page unnecessarily,
-	 * it'll just be a no-op.
+	 * that the page is all-visible or all-frozen when in fact the flag's just
+	 * been cleared, we might fail to vacuum the page.  It's easy to see that
+	 * skipping a page when scan_all is not set is not a very big deal; we
+	 * might leave some dead tuples lying around, but the next vacuum will
+	 * find them.  But even when scan_all is set, it's still OK if we miss a
+	 * page whose all-frozen marking has just been cleared.  Any new XIDs just
+	 * added to that page are necessarily newer than the GlobalXmin we
+	 * computed, so they'll have no effect on the value to which we can safely
+	 * set relfrozenxid.  A similar argument applies for MXIDs and relminmxid.
 	 */
-	for (next_not_all_visible_block = 0;
-		 next_not_all_visible_block < nblocks;
-		 next_not_all_visible_block++)
+	for (next_unskippable_block = startblk;
+		 next_unskippable_block < endblk;
+		 next_unskippable_block++)
 	{
-		if (!visibilitymap_test(onerel, next_not_all_visible_block, &vmbuffer))
-			break;
+		uint8		vmstatus;
+
+		vmstatus = visibilitymap_get_status(onerel, next_unskippable_block,
+											&vmbuffer);
+		if (scan_all)
+		{
+			if ((vmstatus & VISIBILITYMAP_ALL_FROZEN) == 0)
+				break;
+		}
+		else
+		{
+			if ((vmstatus & VISIBILITYMAP_ALL_VISIBLE) == 0)
+				break;
+		}
 		vacuum_delay_point();
 	}
-	if (next_not_all_visible_block >= SKIP_PAGES_THRESHOLD)
-		skipping_all_visible_blocks = true;
+	if (next_unskippable_block - startblk >= SKIP_PAGES_THRESHOLD)
+		skipping_blocks = true;
 	else
-		skipping_all_visible_blocks = false;
+		skipping_blocks = false;
 
-	for (blkno = 0; blkno < nblocks; blkno++)
+	for (blkno = startblk; blkno < endblk; blkno++)
 	{
 		Buffer		buf;
 		Page		page;
@@ -532,43 +797,88 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 					maxoff;
 		bool		tupgone,
 					hastup;
-		int			prev_dead_count;
+		OffsetNumber deadoffsets[MaxHeapTuplesPerPage];
+		int			ndead;
 		int			nfrozen;
 		Size		freespace;
-		bool		all_visible_according_to_vm;
+		bool		all_visible_according_to_vm = false;
 		bool		all_visible;
+		bool		all_frozen = true;	/* provided all_visible is also true */
 		bool		has_dead_tuples;
 		TransactionId visibility_cutoff_xid = InvalidTransactionId;
 
-		if (blkno == next_not_all_visible_block)
+		/* Every so often, save our position in case we're interrupted */
+		if (blkno >= next_resume_report)
+		{
+			lazy_report_resume_point(onerel, vacrelstats, blkno);
+			next_resume_report = blkno + VACUUM_RESUME_REPORT_INTERVAL;
+		}
+
+		if (blkno == next_unskippable_block)
 		{
-			/* Time to advance next_not_all_visible_block */
-			for (next_not_all_visible_block++;
-				 next_not_all_visible_block < nblocks;
-				 next_not_all_visible_block++)
+			/* Time to advance next_unskippable_block */
+			for (next_unskippable_block++;
+				 next_unskippable_block < endblk;
+				 next_unskippable_block++)
 			{
-				if (!visibilitymap_test(onerel, next_not_all_visible_block,
-										&vmbuffer))
-					break;
+				uint8		vmskipflags;
+
+				vmskipflags = visibilitymap_get_status(onerel,
+													   next_unskippable_block,
+													   &vmbuffer);
+				if (scan_all)
+				{
+					if ((vmskipflags & VISIBILITYMAP_ALL_FROZEN) == 0)
+						break;
+				}
+				else
+				{
+					if ((vmskipflags & VISIBILITYMAP_ALL_VISIBLE) == 0)
+						break;
+				}
 				vacuum_delay_point();
 			}
 
 			/*
 			 * We know we can't skip the current block.  But set up
-			 * skipping_all_visible_blocks to do the right thing at the
-			 * following blocks.
+			 * skipping_blocks to do the right thing at the following blocks.
 			 */
-			if (next_not_all_visible_block - blkno > SKIP_PAGES_THRESHOLD)
-				skipping_all_visible_blocks = true;
+			if (next_unskippable_block - blkno > SKIP_PAGES_THRESHOLD)
+				skipping_blocks = true;
 			else
-				skipping_all_visible_blocks = false;
-			all_visible_according_to_vm = false;
+				skipping_blocks = false;
+
+			/*
+			 * Normally, the fact that we can't skip this block must mean that
+			 * it's not all-visible.  But in a scan_all vacuum we know only
+			 * that it's not all-frozen, so it might still be all-visible.
+			 */
+			if (scan_all && VM_ALL_VISIBLE(onerel, blkno, &vmbuffer))
+				all_visible_according_to_vm = true;
 		}
 		else
 		{
-			/* Current block is all-visible */
-			if (skipping_all_visible_blocks && !scan_all)
+			/*
+			 * The current block is potentially skippable; if we've seen a
+			 * long enough run of skippable blocks to justify skipping it,
+			 * then do so.
+			 */
+			if (skipping_blocks)
+			{
+				/*
+				 * Tricky, tricky.  If this is a scan_all vacuum, the page
+				 * must have been all-frozen at the time we checked whether it
+				 * was skippable, but it might not be any more.  We must be
+				 * careful to count it as a skipped all-frozen page in that
+				 * case, or else we'll think we can't update relfrozenxid and
+				 * relminmxid.  If it's not a scan_all vacuum, we don't know
+				 * whether it was all-frozen, so we have to recheck; but in
+				 * this case an approximate answer is OK.
+				 */
+				if (scan_all || VM_ALL_FROZEN(onerel, blkno, &vmbuffer))
+					vacrelstats->frozenskipped_pages++;
 				continue;
+			}
 			all_visible_according_to_vm = true;
 		}
 
@@ -578,8 +888,7 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 		 * If we are close to overrunning the available space for dead-tuple
 		 * TIDs, pause and do a cycle of vacuuming before we tackle this page.
 		 */
-		if ((vacrelstats->max_dead_tuples - vacrelstats->num_dead_tuples) < MaxHeapTuplesPerPage &&
-			vacrelstats->num_dead_tuples > 0)
+		if (lazy_dead_tuples_full(vacrelstats->dead_tuples, blkno))
 		{
 			/*
 			 * Before beginning index vacuuming, we release any pin we may
@@ -597,10 +906,8 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 			vacuum_log_cleanup_info(onerel, vacrelstats);
 
 			/* Remove index entries */
-			for (i = 0; i < nindexes; i++)
-				lazy_vacuum_index(Irel[i],
-								  &indstats[i],
-								  vacrelstats);
+			lazy_vacuum_all_indexes(Irel, indstats, vacrelstats,
+									nindexes, nworkers);
 			/* Remove tuples from heap */
 			lazy_vacuum_heap(onerel, vacrelstats);
 
@@ -609,17 +916,20 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 			 * not to reset latestRemovedXid since we want that value to be
 			 * valid.
 			 */
-			vacrelstats->num_dead_tuples = 0;
+			lazy_reset_dead_tuples(vacrelstats->dead_tuples);
 			vacrelstats->num_index_scans++;
+
+			/* Everything before this block is done now */
+			lazy_report_resume_point(onerel, vacrelstats, blkno);
 		}
 
 		/*
 		 * Pin the visibility map page in case we need to mark the page
 		 * all-visible.  In most cases this will be very cheap, because we'll
 		 * already have the correct page pinned anyway.  However, it's
-		 * possible that (a) next_not_all_visible_block is covered by a
-		 * different VM page than the current block or (b) we released our pin
-		 * and did a cycle of index vacuuming.
+		 * possible that (a) next_unskippable_block is covered by a different
+		 * VM page than the current block or (b) we released our pin and did a
+		 * cycle of index vacuuming.
 		 */
 		visibilitymap_pin(onerel, blkno, &vmbuffer);
 
@@ -740,7 +1050,8 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 
 				PageSetAllVisible(page);
 				visibilitymap_set(onerel, blkno, buf, InvalidXLogRecPtr,
-								  vmbuffer, InvalidTransactionId);
+								  vmbuffer, InvalidTransactionId,
+					   VISIBILITYMAP_ALL_VISIBLE | VISIBILITYMAP_ALL_FROZEN);
 				END_CRIT_SECTION();
 			}
 
@@ -753,8 +1064,11 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 		 * Prune all HOT-update chains in this page.
 		 *
 		 * We count tuples removed by the pruning step as removed by VACUUM.
+		 * We do our own freezing below, so don't ask for opportunistic
+		 * freezing here.
 		 */
-		tups_vacuumed += heap_page_prune(onerel, buf, OldestXmin, false,
+		tups_vacuumed += heap_page_prune(onerel, buf, OldestXmin,
+										 InvalidTransactionId, false,
 										 &vacrelstats->latestRemovedXid);
 
 		/*
@@ -765,7 +1079,7 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 		has_dead_tuples = false;
 		nfrozen = 0;
 		hastup = false;
-		prev_dead_count = vacrelstats->num_dead_tuples;
+		ndead = 0;
 		maxoff = PageGetMaxOffsetNumber(page);
 
 		/*
@@ -804,7 +1118,7 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 			 */
 			if (ItemIdIsDead(itemid))
 			{
-				lazy_record_dead_tuple(vacrelstats, &(tuple.t_self));
+				deadoffsets[ndead++] = offnum;
 				all_visible = false;
 				continue;
 			}
@@ -909,7 +1223,7 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 
 			if (tupgone)
 			{
-				lazy_record_dead_tuple(vacrelstats, &(tuple.t_self));
+				deadoffsets[ndead++] = offnum;
 				HeapTupleHeaderAdvanceLatestRemovedXid(tuple.t_data,
 											 &vacrelstats->latestRemovedXid);
 				tups_vacuumed += 1;
@@ -917,6 +1231,8 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 			}
 			else
 			{
+				bool		tuple_totally_frozen;
+
 				num_tuples += 1;
 				hastup = true;
 
@@ -925,11 +1241,19 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 				 * freezing.  Note we already have exclusive buffer lock.
 				 */
 				if (heap_prepare_freeze_tuple(tuple.t_data, FreezeLimit,
-										  MultiXactCutoff, &frozen[nfrozen]))
+										   MultiXactCutoff, &frozen[nfrozen],
+											  &tuple_totally_frozen))
 					frozen[nfrozen++].offset = offnum;
+
+				if (!tuple_totally_frozen)
+					all_frozen = false;
 			}
 		}						/* scan along page */
 
+		/* Remember the page's dead tuples, if any */
+		if (ndead > 0)
+			lazy_record_dead_tuples(vacrelstats, blkno, deadoffsets, ndead);
+
 		/*
 		 * If we froze any tuples, mark the buffer dirty, and write a WAL
 		 * record recording the changes.  We must log the changes to be
@@ -971,10 +1295,12 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 		 * instead of doing a second scan.
 		 */
 		if (nindexes == 0 &&
-			vacrelstats->num_dead_tuples > 0)
+			vacrelstats->dead_tuples->num_blocks > 0)
 		{
 			/* Remove tuples from heap */
-			lazy_vacuum_page(onerel, blkno, buf, 0, vacrelstats, &vmbuffer);
+			lazy_vacuum_page(onerel, blkno, buf,
+						(LVDeadBlock *) LVDeadTuplesData(vacrelstats->dead_tuples),
+							 vacrelstats, &vmbuffer);
 			has_dead_tuples = false;
 
 			/*
@@ -982,7 +1308,7 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 			 * not to reset latestRemovedXid since we want that value to be
 			 * valid.
 			 */
-			vacrelstats->num_dead_tuples = 0;
+			lazy_reset_dead_tuples(vacrelstats->dead_tuples);
 			vacuumed_pages++;
 		}
 
@@ -991,6 +1317,11 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 		/* mark page all-visible, if appropriate */
 		if (all_visible && !all_visible_according_to_vm)
 		{
+			uint8		flags = VISIBILITYMAP_ALL_VISIBLE;
+
+			if (all_frozen)
+				flags |= VISIBILITYMAP_ALL_FROZEN;
+
 			/*
 			 * It should never be the case that the visibility map page is set
 			 * while the page-level bit is clear, but the reverse is allowed
@@ -1007,7 +1338,7 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 			PageSetAllVisible(page);
 			MarkBufferDirty(buf);
 			visibilitymap_set(onerel, blkno, buf, InvalidXLogRecPtr,
-							  vmbuffer, visibility_cutoff_xid);
+							  vmbuffer, visibility_cutoff_xid, flags);
 		}
 
 		/*
@@ -1018,11 +1349,12 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 		 * that something bad has happened.
 		 */
 		else if (all_visible_according_to_vm && !PageIsAllVisible(page)
-				 && visibilitymap_test(onerel, blkno, &vmbuffer))
+				 && VM_ALL_VISIBLE(onerel, blkno, &vmbuffer))
 		{
 			elog(WARNING, "page is not marked all-visible but visibility map bit is set in relation \"%s\" page %u",
 				 relname, blkno);
-			visibilitymap_clear(onerel, blkno, vmbuffer);
+			visibilitymap_clear(onerel, blkno, vmbuffer,
+								VISIBILITYMAP_VALID_BITS);
 		}
 
 		/*
@@ -1044,7 +1376,26 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 				 relname, blkno);
 			PageClearAllVisible(page);
 			MarkBufferDirty(buf);
-			visibilitymap_clear(onerel, blkno, vmbuffer);
+			visibilitymap_clear(onerel, blkno, vmbuffer,
+								VISIBILITYMAP_VALID_BITS);
+		}
+
+		/*
+		 * If the all-visible page turns out to be all-frozen but not marked,
+		 * we should so mark it.  Note that all_frozen is only valid if
+		 * all_visible is true, so we must check both.
+		 */
+		else if (all_visible_according_to_vm && all_visible && all_frozen &&
+				 !VM_ALL_FROZEN(onerel, blkno, &vmbuffer))
+		{
+			/*
+			 * We can pass InvalidTransactionId as the cutoff XID here,
+			 * because setting the all-frozen bit doesn't cause recovery
+			 * conflicts.
+			 */
+			visibilitymap_set(onerel, blkno, buf, InvalidXLogRecPtr,
+							  vmbuffer, InvalidTransactionId,
+							  VISIBILITYMAP_ALL_VISIBLE | VISIBILITYMAP_ALL_FROZEN);
 		}
 
 		UnlockReleaseBuffer(buf);
@@ -1060,12 +1411,24 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 		 * page, so remember its free space as-is.  (This path will always be
 		 * taken if there are no indexes.)
 		 */
-		if (vacrelstats->num_dead_tuples == prev_dead_count)
+		if (ndead == 0 || nindexes == 0)
 			RecordPageWithFreeSpace(onerel, blkno, freespace);
 	}
 
 	pfree(frozen);
 
+	/* Tell the next VACUUM where to start */
+	if (endblk < nblocks)
+	{
+		vacrelstats->resume_block = endblk;
+		ereport(elevel,
+				(errmsg("stopping vacuum of \"%s\" at block %u of %u",
+						relname, endblk, nblocks)));
+	}
+	else
+		vacrelstats->resume_block = 0;
+	vacrelstats->partial_scan = (startblk > 0 || endblk < nblocks);
+
 	/* save stats for use later */
 	vacrelstats->scanned_tuples = num_tuples;
 	vacrelstats->tuples_deleted = tups_vacuumed;
@@ -1088,24 +1451,21 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 
 	/* If any tuples need to be deleted, perform final vacuum cycle */
 	/* XXX put a threshold on min number of tuples here? */
-	if (vacrelstats->num_dead_tuples > 0)
+	if (vacrelstats->dead_tuples->num_blocks > 0)
 	{
 		/* Log cleanup info before we touch indexes */
 		vacuum_log_cleanup_info(onerel, vacrelstats);
 
 		/* Remove index entries */
-		for (i = 0; i < nindexes; i++)
-			lazy_vacuum_index(Irel[i],
-							  &indstats[i],
-							  vacrelstats);
+		lazy_vacuum_all_indexes(Irel, indstats, vacrelstats,
+								nindexes, nworkers);
 		/* Remove tuples from heap */
 		lazy_vacuum_heap(onerel, vacrelstats);
 		vacrelstats->num_index_scans++;
 	}
 
 	/* Do post-vacuum cleanup and statistics update for each index */
-	for (i = 0; i < nindexes; i++)
-		lazy_cleanup_index(Irel[i], indstats[i], vacrelstats);
+	lazy_cleanup_all_indexes(Irel, indstats, vacrelstats, nindexes, nworkers);
 
 	/* If no indexes, make log report that lazy_vacuum_heap would've made */
 	if (vacuumed_pages)
@@ -1126,6 +1486,8 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 					 nunused);
 	appendStringInfo(&buf, _("Skipped %u pages due to buffer pins.\n"),
 					 vacrelstats->pinskipped_pages);
+	appendStringInfo(&buf, _("Skipped %u frozen pages.\n"),
+					 vacrelstats->frozenskipped_pages);
 	appendStringInfo(&buf, _("%u pages are entirely empty.\n"),
 					 empty_pages);
 	appendStringInfo(&buf, _("%s."),
@@ -1155,35 +1517,38 @@ lazy_scan_heap(Relation onerel, LVRelStats *vacrelstats,
 static void
 lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats)
 {
-	int			tupindex;
+	LVDeadTuples *dt = vacrelstats->dead_tuples;
+	Size		off;
+	double		ntuples;
 	int			npages;
 	PGRUsage	ru0;
 	Buffer		vmbuffer = InvalidBuffer;
 
 	pg_rusage_init(&ru0);
 	npages = 0;
+	ntuples = 0;
 
-	tupindex = 0;
-	while (tupindex < vacrelstats->num_dead_tuples)
+	for (off = 0; off < dt->used_bytes;)
 	{
-		BlockNumber tblk;
+		LVDeadBlock *dblk = (LVDeadBlock *) (LVDeadTuplesData(dt) + off);
+		BlockNumber tblk = dblk->blkno;
 		Buffer		buf;
 		Page		page;
 		Size		freespace;
 
 		vacuum_delay_point();
 
-		tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
+		off += SizeOfDeadBlock(DeadBlockDataLen(dblk));
+
 		buf = ReadBufferExtended(onerel, MAIN_FORKNUM, tblk, RBM_NORMAL,
 								 vac_strategy);
 		if (!ConditionalLockBufferForCleanup(buf))
 		{
 			ReleaseBuffer(buf);
-			++tupindex;
 			continue;
 		}
-		tupindex = lazy_vacuum_page(onerel, tblk, buf, tupindex, vacrelstats,
-									&vmbuffer);
+		lazy_vacuum_page(onerel, tblk, buf, dblk, vacrelstats, &vmbuffer);
+		ntuples += dblk->ntuples;
 
 		/* Now that we've compacted the page, record its available space */
 		page = BufferGetPage(buf);
@@ -1201,9 +1566,9 @@ lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats)
 	}
 
 	ereport(elevel,
-			(errmsg("\"%s\": removed %d row versions in %d pages",
+			(errmsg("\"%s\": removed %.0f row versions in %d pages",
 					RelationGetRelationName(onerel),
-					tupindex, npages),
+					ntuples, npages),
 			 errdetail("%s.",
 					   pg_rusage_show(&ru0))));
 }
@@ -1214,34 +1579,31 @@ lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats)
  *
  * Caller must hold pin and buffer cleanup lock on the buffer.
  *
- * tupindex is the index in vacrelstats->dead_tuples of the first dead
- * tuple for this page.  We assume the rest follow sequentially.
- * The return value is the first tupindex after the tuples of this page.
+ * dblk is the dead-tuple store's record for this page.
  */
-static int
+static void
 lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
-				 int tupindex, LVRelStats *vacrelstats, Buffer *vmbuffer)
+				 LVDeadBlock *dblk, LVRelStats *vacrelstats, Buffer *vmbuffer)
 {
 	Page		page = BufferGetPage(buffer);
 	OffsetNumber unused[MaxOffsetNumber];
-	int			uncnt = 0;
+	int			uncnt;
+	int			i;
 	TransactionId visibility_cutoff_xid;
+	bool		all_frozen;
+
+	Assert(dblk->blkno == blkno);
+
+	uncnt = lazy_dead_block_offsets(dblk, unused);
 
 	START_CRIT_SECTION();
 
-	for (; tupindex < vacrelstats->num_dead_tuples; tupindex++)
+	for (i = 0; i < uncnt; i++)
 	{
-		BlockNumber tblk;
-		OffsetNumber toff;
 		ItemId		itemid;
 
-		tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
-		if (tblk != blkno)
-			break;				/* past end of tuples for this block */
-		toff = ItemPointerGetOffsetNumber(&vacrelstats->dead_tuples[tupindex]);
-		itemid = PageGetItemId(page, toff);
+		itemid = PageGetItemId(page, unused[i]);
 		ItemIdSetUnused(itemid);
-		unused[uncnt++] = toff;
 	}
 
 	PageRepairFragmentation(page);
@@ -1259,6 +1621,7 @@ lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
 		recptr = log_heap_clean(onerel, buffer,
 								NULL, 0, NULL, 0,
 								unused, uncnt,
+								NULL, 0,
 								vacrelstats->latestRemovedXid);
 		PageSetLSN(page, recptr);
 	}
@@ -1277,22 +1640,32 @@ lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
 	 * dirty, exclusively locked, and, if needed, a full page image has been
 	 * emitted in the log_heap_clean() above.
 	 */
-	if (heap_page_is_all_visible(onerel, buffer, &visibility_cutoff_xid))
+	if (heap_page_is_all_visible(onerel, buffer, &visibility_cutoff_xid,
+								 &all_frozen))
 		PageSetAllVisible(page);
 
 	/*
 	 * All the changes to the heap page have been done. If the all-visible
-	 * flag is now set, also set the VM bit.
+	 * flag is now set, also set the VM all-visible bit (and, if possible, the
+	 * all-frozen bit) unless this has already been done previously.
 	 */
-	if (PageIsAllVisible(page) &&
-		!visibilitymap_test(onerel, blkno, vmbuffer))
+	if (PageIsAllVisible(page))
 	{
+		uint8		vm_status = visibilitymap_get_status(onerel, blkno, vmbuffer);
+		uint8		flags = 0;
+
+		/* Work out which of the VM bits still need to be set */
+		if ((vm_status & VISIBILITYMAP_ALL_VISIBLE) == 0)
+			flags |= VISIBILITYMAP_ALL_VISIBLE;
+		if ((vm_status & VISIBILITYMAP_ALL_FROZEN) == 0 && all_frozen)
+			flags |= VISIBILITYMAP_ALL_FROZEN;
+
 		Assert(BufferIsValid(*vmbuffer));
-		visibilitymap_set(onerel, blkno, buffer, InvalidXLogRecPtr, *vmbuffer,
-						  visibility_cutoff_xid);
+		if (flags != 0)
+			visibilitymap_set(onerel, blkno, buffer, InvalidXLogRecPtr,
+							  *vmbuffer, visibility_cutoff_xid,
+							  flags | VISIBILITYMAP_ALL_VISIBLE);
 	}
-
-	return tupindex;
 }
 
 /*
@@ -1368,9 +1741,9 @@ lazy_vacuum_index(Relation indrel,
 							   lazy_tid_reaped, (void *) vacrelstats);
 
 	ereport(elevel,
-			(errmsg("scanned index \"%s\" to remove %d row versions",
+			(errmsg("scanned index \"%s\" to remove %.0f row versions",
 					RelationGetRelationName(indrel),
-					vacrelstats->num_dead_tuples),
+					(double) vacrelstats->dead_tuples->num_tuples),
 			 errdetail("%s.", pg_rusage_show(&ru0))));
 }
 
@@ -1382,11 +1755,27 @@ lazy_cleanup_index(Relation indrel,
 				   IndexBulkDeleteResult *stats,
 				   LVRelStats *vacrelstats)
 {
-	IndexVacuumInfo ivinfo;
 	PGRUsage	ru0;
 
 	pg_rusage_init(&ru0);
 
+	stats = lazy_do_cleanup_index(indrel, stats, vacrelstats);
+	lazy_update_index_stats(indrel, stats, &ru0);
+}
+
+/*
+ *	lazy_do_cleanup_index() -- call the index AM's cleanup routine.
+ *
+ *		This is the part of lazy_cleanup_index() that is safe to run in a
+ *		parallel worker.
+ */
+static IndexBulkDeleteResult *
+lazy_do_cleanup_index(Relation indrel,
+					  IndexBulkDeleteResult *stats,
+					  LVRelStats *vacrelstats)
+{
+	IndexVacuumInfo ivinfo;
+
 	ivinfo.index = indrel;
 	ivinfo.analyze_only = false;
 	ivinfo.estimated_count = (vacrelstats->scanned_pages < vacrelstats->rel_pages);
@@ -1394,8 +1783,17 @@ lazy_cleanup_index(Relation indrel,
 	ivinfo.num_heap_tuples = vacrelstats->new_rel_tuples;
 	ivinfo.strategy = vac_strategy;
 
-	stats = index_vacuum_cleanup(&ivinfo, stats);
+	return index_vacuum_cleanup(&ivinfo, stats);
+}
 
+/*
+ *	lazy_update_index_stats() -- update pg_class for one index after cleanup,
+ *		report, and free the cleanup results.
+ */
+static void
+lazy_update_index_stats(Relation indrel, IndexBulkDeleteResult *stats,
+						PGRUsage *ru0)
+{
 	if (!stats)
 		return;
 
@@ -1423,11 +1821,262 @@ lazy_cleanup_index(Relation indrel,
 					   "%s.",
 					   stats->tuples_removed,
 					   stats->pages_deleted, stats->pages_free,
-					   pg_rusage_show(&ru0))));
+					   pg_rusage_show(ru0))));
 
 	pfree(stats);
 }
 
+/*
+ *	lazy_vacuum_all_indexes() -- remove the current dead tuples from every
+ *		index, in parallel if we were asked to use workers.
+ */
+static void
+lazy_vacuum_all_indexes(Relation *Irel, IndexBulkDeleteResult **indstats,
+						LVRelStats *vacrelstats, int nindexes, int nworkers)
+{
+	int			i;
+
+	/* Set up the store for lookups by lazy_tid_reaped */
+	lazy_build_dead_tuple_directory(vacrelstats->dead_tuples);
+
+	if (nworkers > 0)
+	{
+		lazy_parallel_vacuum_indexes(Irel, indstats, vacrelstats, nindexes,
+									 nworkers, false);
+		return;
+	}
+
+	for (i = 0; i < nindexes; i++)
+		lazy_vacuum_index(Irel[i],
+						  &indstats[i],
+						  vacrelstats);
+}
+
+/*
+ *	lazy_cleanup_all_indexes() -- do post-vacuum cleanup for every index,
+ *		in parallel if we were asked to use workers.
+ */
+static void
+lazy_cleanup_all_indexes(Relation *Irel, IndexBulkDeleteResult **indstats,
+						 LVRelStats *vacrelstats, int nindexes, int nworkers)
+{
+	int			i;
+
+	if (nworkers > 0)
+	{
+		PGRUsage	ru0;
+
+		pg_rusage_init(&ru0);
+
+		lazy_parallel_vacuum_indexes(Irel, indstats, vacrelstats, nindexes,
+									 nworkers, true);
+
+		/* pg_class can't be updated in parallel mode, so do it now */
+		for (i = 0; i < nindexes; i++)
+			lazy_update_index_stats(Irel[i], indstats[i], &ru0);
+		return;
+	}
+
+	for (i = 0; i < nindexes; i++)
+		lazy_cleanup_index(Irel[i], indstats[i], vacrelstats);
+}
+
+/*
+ *	lazy_parallel_vacuum_indexes() -- bulk-delete or clean up all indexes
+ *		using parallel workers.
+ *
+ *		The leader processes indexes alongside the workers, so this works
+ *		correctly even if no workers can be launched.  On return, indstats
+ *		holds the results for each index, as if the indexes had been
+ *		processed serially.
+ */
+static void
+lazy_parallel_vacuum_indexes(Relation *Irel, IndexBulkDeleteResult **indstats,
+							 LVRelStats *vacrelstats, int nindexes,
+							 int nworkers, bool for_cleanup)
+{
+	ParallelContext *pcxt;
+	LVShared   *lvshared;
+	LVIndStats *lvindstats;
+	Size		indstats_size;
+	Size		dead_tuples_size = 0;
+	int			i;
+
+	indstats_size = mul_size(sizeof(LVIndStats), nindexes);
+	if (!for_cleanup)
+		dead_tuples_size = lazy_dead_tuples_size(vacrelstats->dead_tuples);
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext(lazy_parallel_vacuum_main, nworkers);
+
+	/* Estimate space for shared state, index stats, and dead tuples */
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(LVShared));
+	shm_toc_estimate_chunk(&pcxt->estimator, indstats_size);
+	if (!for_cleanup)
+	{
+		shm_toc_estimate_chunk(&pcxt->estimator, dead_tuples_size);
+		shm_toc_estimate_keys(&pcxt->estimator, 3);
+	}
+	else
+		shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+	InitializeParallelDSM(pcxt);
+
+	lvshared = (LVShared *) shm_toc_allocate(pcxt->toc, sizeof(LVShared));
+	lvshared->for_cleanup = for_cleanup;
+	lvshared->elevel = elevel;
+	lvshared->cost_delay = VacuumCostDelay;
+	lvshared->cost_limit = VacuumCostLimit;
+	lvshared->rel_pages = vacrelstats->rel_pages;
+	lvshared->scanned_pages = vacrelstats->scanned_pages;
+	lvshared->old_rel_tuples = vacrelstats->old_rel_tuples;
+	lvshared->new_rel_tuples = vacrelstats->new_rel_tuples;
+	lvshared->nindexes = nindexes;
+	pg_atomic_init_u32(&lvshared->nextidx, 0);
+	shm_toc_insert(pcxt->toc, PARALLEL_VACUUM_KEY_SHARED, lvshared);
+
+	lvindstats = (LVIndStats *) shm_toc_allocate(pcxt->toc, indstats_size);
+	for (i = 0; i < nindexes; i++)
+	{
+		lvindstats[i].indexoid = RelationGetRelid(Irel[i]);
+		lvindstats[i].updated = (indstats[i] != NULL);
+		if (indstats[i] != NULL)
+			memcpy(&lvindstats[i].stats, indstats[i],
+				   sizeof(IndexBulkDeleteResult));
+	}
+	shm_toc_insert(pcxt->toc, PARALLEL_VACUUM_KEY_INDSTATS, lvindstats);
+
+	if (!for_cleanup)
+	{
+		LVDeadTuples *dead_tuples;
+
+		/* The store is position-independent, so a flat copy will do */
+		dead_tuples = (LVDeadTuples *) shm_toc_allocate(pcxt->toc,
+														dead_tuples_size);
+		memcpy(dead_tuples, vacrelstats->dead_tuples, dead_tuples_size);
+		shm_toc_insert(pcxt->toc, PARALLEL_VACUUM_KEY_DEAD_TUPLES,
+					   dead_tuples);
+	}
+
+	LaunchParallelWorkers(pcxt);
+
+	/* Process indexes ourselves until there are none left */
+	lazy_parallel_process_indexes(Irel, lvshared, lvindstats, vacrelstats);
+
+	WaitForParallelWorkersToFinish(pcxt);
+
+	/* Copy the results back before the segment goes away */
+	for (i = 0; i < nindexes; i++)
+	{
+		if (!lvindstats[i].updated)
+			continue;
+		if (indstats[i] == NULL)
+			indstats[i] = (IndexBulkDeleteResult *)
+				palloc(sizeof(IndexBulkDeleteResult));
+		memcpy(indstats[i], &lvindstats[i].stats,
+			   sizeof(IndexBulkDeleteResult));
+	}
+
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+}
+
+/*
+ *	lazy_parallel_process_indexes() -- claim and process indexes until none
+ *		are left.
+ *
+ *		Called by the leader, which passes its open index relations, and by
+ *		each worker, which passes NULL and opens the indexes itself.
+ */
+static void
+lazy_parallel_process_indexes(Relation *Irel, LVShared *lvshared,
+							  LVIndStats *lvindstats, LVRelStats *vacrelstats)
+{
+	for (;;)
+	{
+		uint32		idx = pg_atomic_fetch_add_u32(&lvshared->nextidx, 1);
+		Relation	indrel;
+		IndexBulkDeleteResult *stats = NULL;
+
+		if (idx >= lvshared->nindexes)
+			break;
+
+		/*
+		 * A worker relies on the RowExclusiveLock that the leader holds on
+		 * the index for the whole vacuum.  Heavyweight locks aren't shared
+		 * with parallel workers, so taking our own could deadlock against a
+		 * waiter queued behind the leader.
+		 */
+		if (Irel != NULL)
+			indrel = Irel[idx];
+		else
+			indrel = index_open(lvindstats[idx].indexoid, NoLock);
+
+		if (lvindstats[idx].updated)
+		{
+			stats = (IndexBulkDeleteResult *)
+				palloc(sizeof(IndexBulkDeleteResult));
+			memcpy(stats, &lvindstats[idx].stats,
+				   sizeof(IndexBulkDeleteResult));
+		}
+
+		if (lvshared->for_cleanup)
+			stats = lazy_do_cleanup_index(indrel, stats, vacrelstats);
+		else
+			lazy_vacuum_index(indrel, &stats, vacrelstats);
+
+		if (stats != NULL)
+		{
+			memcpy(&lvindstats[idx].stats, stats,
+				   sizeof(IndexBulkDeleteResult));
+			lvindstats[idx].updated = true;
+			pfree(stats);
+		}
+
+		if (Irel == NULL)
+			index_close(indrel, NoLock);
+	}
+}
+
+/*
+ *	lazy_parallel_vacuum_main() -- entry point for parallel vacuum workers.
+ */
+static void
+lazy_parallel_vacuum_main(dsm_segment *seg, shm_toc *toc)
+{
+	LVShared   *lvshared;
+	LVIndStats *lvindstats;
+	LVRelStats	vacrelstats;
+
+	lvshared = (LVShared *) shm_toc_lookup(toc, PARALLEL_VACUUM_KEY_SHARED);
+	lvindstats = (LVIndStats *) shm_toc_lookup(toc,
+											   PARALLEL_VACUUM_KEY_INDSTATS);
+
+	/* Set up just enough of an LVRelStats for the index vacuuming code */
+	MemSet(&vacrelstats, 0, sizeof(LVRelStats));
+	vacrelstats.hasindex = true;
+	vacrelstats.rel_pages = lvshared->rel_pages;
+	vacrelstats.scanned_pages = lvshared->scanned_pages;
+	vacrelstats.old_rel_tuples = lvshared->old_rel_tuples;
+	vacrelstats.new_rel_tuples = lvshared->new_rel_tuples;
+	if (!lvshared->for_cleanup)
+		vacrelstats.dead_tuples = (LVDeadTuples *)
+			shm_toc_lookup(toc, PARALLEL_VACUUM_KEY_DEAD_TUPLES);
+
+	elevel = lvshared->elevel;
+	vac_strategy = GetAccessStrategy(BAS_VACUUM);
+
+	/* Each worker applies the leader's cost-based delay on its own */
+	VacuumCostDelay = lvshared->cost_delay;
+	VacuumCostLimit = lvshared->cost_limit;
+	VacuumCostActive = (VacuumCostDelay > 0);
+	VacuumCostBalance = 0;
+
+	lazy_parallel_process_indexes(NULL, lvshared, lvindstats, &vacrelstats);
+
+	FreeAccessStrategy(vac_strategy);
+}
+
 /*
  * lazy_truncate_heap - try to truncate off any empty pages at the end
  */
@@ -1676,113 +2325,302 @@ count_nondeletable_pages(Relation onerel, LVRelStats *vacrelstats)
 static void
 lazy_space_alloc(LVRelStats *vacrelstats, BlockNumber relblocks)
 {
-	long		maxtuples;
+	LVDeadTuples *dt;
+	Size		maxbytes;
+	Size		minbytes;
 	int			vac_work_mem = IsAutoVacuumWorkerProcess() &&
 	autovacuum_work_mem != -1 ?
 	autovacuum_work_mem : maintenance_work_mem;
 
+	/* enough for one page's record, its directory entry, and alignment */
+	minbytes = MAXALIGN(MaxDeadBlockSize) + sizeof(Size);
+
 	if (vacrelstats->hasindex)
 	{
-		maxtuples = (vac_work_mem * 1024L) / sizeof(ItemPointerData);
-		maxtuples = Min(maxtuples, INT_MAX);
-		maxtuples = Min(maxtuples, MaxAllocSize / sizeof(ItemPointerData));
+		maxbytes = (Size) vac_work_mem * 1024;
 
-		/* curious coding here to ensure the multiplication can't overflow */
-		if ((BlockNumber) (maxtuples / LAZY_ALLOC_TUPLES) > relblocks)
-			maxtuples = relblocks * LAZY_ALLOC_TUPLES;
+		/* no point in allocating more than every page could need */
+		if (maxbytes / (MaxDeadBlockSize + sizeof(Size)) > (Size) relblocks)
+			maxbytes = (Size) relblocks * (MaxDeadBlockSize + sizeof(Size));
 
 		/* stay sane if small maintenance_work_mem */
-		maxtuples = Max(maxtuples, MaxHeapTuplesPerPage);
+		maxbytes = Max(maxbytes, minbytes);
 	}
 	else
 	{
-		maxtuples = MaxHeapTuplesPerPage;
+		maxbytes = minbytes;
 	}
 
-	vacrelstats->num_dead_tuples = 0;
-	vacrelstats->max_dead_tuples = (int) maxtuples;
-	vacrelstats->dead_tuples = (ItemPointer)
-		palloc(maxtuples * sizeof(ItemPointerData));
+	dt = (LVDeadTuples *) MemoryContextAllocHuge(CurrentMemoryContext,
+							   MAXALIGN(sizeof(LVDeadTuples)) + maxbytes);
+	dt->max_bytes = maxbytes;
+	lazy_reset_dead_tuples(dt);
+	vacrelstats->dead_tuples = dt;
 }
 
 /*
- * lazy_record_dead_tuple - remember one deletable tuple
+ * lazy_reset_dead_tuples - forget all the tuples in the dead-tuple store
  */
 static void
-lazy_record_dead_tuple(LVRelStats *vacrelstats,
-					   ItemPointer itemptr)
+lazy_reset_dead_tuples(LVDeadTuples *dt)
 {
+	dt->used_bytes = 0;
+	dt->num_tuples = 0;
+	dt->num_blocks = 0;
+	dt->ndirectory = 0;
+	dt->first_block = InvalidBlockNumber;
+	dt->last_block = InvalidBlockNumber;
+}
+
+/*
+ * lazy_dead_tuples_full - is the dead-tuple store too full for another page?
+ *
+ * Returns true if the store holds some tuples and there's no guarantee that
+ * all the dead tuples of block blkno would still fit.
+ */
+static bool
+lazy_dead_tuples_full(LVDeadTuples *dt, BlockNumber blkno)
+{
+	if (dt->num_blocks == 0)
+		return false;
+
+	return MAXALIGN(dt->used_bytes + MaxDeadBlockSize) +
+		LVDeadTuplesDirectorySize(dt->first_block, blkno) > dt->max_bytes;
+}
+
+/*
+ * lazy_record_dead_tuples - remember the deletable tuples of one page
+ *
+ * offsets must be in ascending order, and pages must be recorded in block
+ * number order.
+ */
+static void
+lazy_record_dead_tuples(LVRelStats *vacrelstats, BlockNumber blkno,
+						OffsetNumber *offsets, int noffsets)
+{
+	LVDeadTuples *dt = vacrelstats->dead_tuples;
+	BlockNumber first_block;
+	LVDeadBlock *dblk;
+	int			nbytes;
+	int			datalen;
+	int			i;
+
+	Assert(noffsets > 0);
+	Assert(dt->num_blocks == 0 || blkno > dt->last_block);
+
+	first_block = (dt->num_blocks > 0) ? dt->first_block : blkno;
+
+	/* use a bitmap unless an array of offsets is shorter */
+	nbytes = (offsets[noffsets - 1] + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+	if (noffsets * sizeof(OffsetNumber) < nbytes)
+	{
+		nbytes = 0;
+		datalen = noffsets * sizeof(OffsetNumber);
+	}
+	else
+		datalen = nbytes;
+
 	/*
-	 * The array shouldn't overflow under normal behavior, but perhaps it
-	 * could if we are given a really small maintenance_work_mem. In that
-	 * case, just forget the last few tuples (we'll get 'em next time).
+	 * The store shouldn't overflow under normal behavior, since the caller
+	 * checks for room before each page, but perhaps it could if we are given
+	 * a really small maintenance_work_mem.  In that case, just forget this
+	 * page's tuples (we'll get 'em next time).
 	 */
-	if (vacrelstats->num_dead_tuples < vacrelstats->max_dead_tuples)
+	if (MAXALIGN(dt->used_bytes + SizeOfDeadBlock(datalen)) +
+		LVDeadTuplesDirectorySize(first_block, blkno) > dt->max_bytes)
+		return;
+
+	dblk = (LVDeadBlock *) (LVDeadTuplesData(dt) + dt->used_bytes);
+	dblk->blkno = blkno;
+	dblk->nbytes = (uint16) nbytes;
+	dblk->ntuples = (uint16) noffsets;
+	if (nbytes == 0)
+		memcpy(DeadBlockOffsets(dblk), offsets, datalen);
+	else
 	{
-		vacrelstats->dead_tuples[vacrelstats->num_dead_tuples] = *itemptr;
-		vacrelstats->num_dead_tuples++;
+		uint8	   *bitmap = DeadBlockBitmap(dblk);
+
+		memset(bitmap, 0, nbytes);
+		for (i = 0; i < noffsets; i++)
+		{
+			int			bit = offsets[i] - 1;
+
+			bitmap[bit / BITS_PER_BYTE] |= 1 << (bit % BITS_PER_BYTE);
+		}
 	}
+
+	dt->first_block = first_block;
+	dt->last_block = blkno;
+	dt->num_blocks++;
+	dt->num_tuples += noffsets;
+	dt->used_bytes += SizeOfDeadBlock(datalen);
 }
 
 /*
- *	lazy_tid_reaped() -- is a particular tid deletable?
- *
- *		This has the right signature to be an IndexBulkDeleteCallback.
+ * lazy_dead_block_offsets - extract the dead offsets of a page's record
  *
- *		Assumes dead_tuples array is in sorted order.
+ * The offsets are stored into the caller's array in ascending order, and
+ * their number is returned.
+ */
+static int
+lazy_dead_block_offsets(LVDeadBlock *dblk, OffsetNumber *offsets)
+{
+	uint8	   *bitmap;
+	int			n = 0;
+	int			i;
+
+	if (dblk->nbytes == 0)
+	{
+		memcpy(offsets, DeadBlockOffsets(dblk),
+			   dblk->ntuples * sizeof(OffsetNumber));
+		return dblk->ntuples;
+	}
+
+	bitmap = DeadBlockBitmap(dblk);
+	for (i = 0; i < dblk->nbytes * BITS_PER_BYTE; i++)
+	{
+		if (bitmap[i / BITS_PER_BYTE] & (1 << (i % BITS_PER_BYTE)))
+			offsets[n++] = (OffsetNumber) (i + 1);
+	}
+	Assert(n == dblk->ntuples);
+	return n;
+}
+
+/*
+ * lazy_dead_block_contains - is the given offset dead according to a page's
+ * record?
  */
 static bool
-lazy_tid_reaped(ItemPointer itemptr, void *state)
+lazy_dead_block_contains(LVDeadBlock *dblk, OffsetNumber offnum)
 {
-	LVRelStats *vacrelstats = (LVRelStats *) state;
-	ItemPointer res;
+	int			bit = offnum - 1;
+
+	if (dblk->nbytes == 0)
+	{
+		OffsetNumber *offsets = DeadBlockOffsets(dblk);
+		int			lo = 0;
+		int			hi = dblk->ntuples;
 
-	res = (ItemPointer) bsearch((void *) itemptr,
-								(void *) vacrelstats->dead_tuples,
-								vacrelstats->num_dead_tuples,
-								sizeof(ItemPointerData),
-								vac_cmp_itemptr);
+		/* binary search the sorted array */
+		while (lo < hi)
+		{
+			int			mid = lo + (hi - lo) / 2;
+
+			if (offsets[mid] < offnum)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo < dblk->ntuples && offsets[lo] == offnum;
+	}
 
-	return (res != NULL);
+	if (bit < 0 || bit >= dblk->nbytes * BITS_PER_BYTE)
+		return false;
+	return (DeadBlockBitmap(dblk)[bit / BITS_PER_BYTE] &
+			(1 << (bit % BITS_PER_BYTE))) != 0;
 }
 
 /*
- * Comparator routines for use with qsort() and bsearch().
+ * lazy_build_dead_tuple_directory - set up the store for lazy_tid_reaped
+ *
+ * lazy_record_dead_tuples made sure there is room for the directory.
  */
-static int
-vac_cmp_itemptr(const void *left, const void *right)
+static void
+lazy_build_dead_tuple_directory(LVDeadTuples *dt)
 {
-	BlockNumber lblk,
-				rblk;
-	OffsetNumber loff,
-				roff;
+	char	   *data = LVDeadTuplesData(dt);
+	Size	   *directory = LVDeadTuplesDirectory(dt);
+	Size		off = 0;
+	int			i;
 
-	lblk = ItemPointerGetBlockNumber((ItemPointer) left);
-	rblk = ItemPointerGetBlockNumber((ItemPointer) right);
+	if (dt->num_blocks == 0)
+	{
+		dt->ndirectory = 0;
+		return;
+	}
+
+	dt->ndirectory = (dt->last_block - dt->first_block) /
+		DEAD_BLOCKS_PER_BUCKET + 1;
+	for (i = 0; i < dt->ndirectory; i++)
+	{
+		BlockNumber bucket_start = dt->first_block + i * DEAD_BLOCKS_PER_BUCKET;
+
+		while (off < dt->used_bytes)
+		{
+			LVDeadBlock *dblk = (LVDeadBlock *) (data + off);
+
+			if (dblk->blkno >= bucket_start)
+				break;
+			off += SizeOfDeadBlock(DeadBlockDataLen(dblk));
+		}
+		directory[i] = off;
+	}
+}
+
+/*
+ * lazy_dead_tuples_size - bytes in use by the dead-tuple store, including
+ * its header and directory
+ */
+static Size
+lazy_dead_tuples_size(LVDeadTuples *dt)
+{
+	return MAXALIGN(sizeof(LVDeadTuples)) + MAXALIGN(dt->used_bytes) +
+		dt->ndirectory * sizeof(Size);
+}
+
+/*
+ *	lazy_tid_reaped() -- is a particular tid deletable?
+ *
+ *		This has the right signature to be an IndexBulkDeleteCallback.
+ *
+ *		Assumes lazy_build_dead_tuple_directory has been called.
+ */
+static bool
+lazy_tid_reaped(ItemPointer itemptr, void *state)
+{
+	LVRelStats *vacrelstats = (LVRelStats *) state;
+	LVDeadTuples *dt = vacrelstats->dead_tuples;
+	BlockNumber blkno = ItemPointerGetBlockNumber(itemptr);
+	char	   *data = LVDeadTuplesData(dt);
+	Size	   *directory = LVDeadTuplesDirectory(dt);
+	int			bucket;
+	Size		off;
+	Size		end;
+
+	if (dt->num_blocks == 0 ||
+		blkno < dt->first_block || blkno > dt->last_block)
+		return false;
 
-	if (lblk < rblk)
-		return -1;
-	if (lblk > rblk)
-		return 1;
+	/* At most DEAD_BLOCKS_PER_BUCKET records to look at */
+	bucket = (blkno - dt->first_block) / DEAD_BLOCKS_PER_BUCKET;
+	off = directory[bucket];
+	end = (bucket + 1 < dt->ndirectory) ? directory[bucket + 1] : dt->used_bytes;
 
-	loff = ItemPointerGetOffsetNumber((ItemPointer) left);
-	roff = ItemPointerGetOffsetNumber((ItemPointer) right);
+	while (off < end)
+	{
+		LVDeadBlock *dblk = (LVDeadBlock *) (data + off);
 
-	if (loff < roff)
-		return -1;
-	if (loff > roff)
-		return 1;
+		if (dblk->blkno == blkno)
+			return lazy_dead_block_contains(dblk,
+										ItemPointerGetOffsetNumber(itemptr));
+		if (dblk->blkno > blkno)
+			break;
+		off += SizeOfDeadBlock(DeadBlockDataLen(dblk));
+	}
 
-	return 0;
+	return false;
 }
 
 /*
  * Check if every tuple in the given page is visible to all current and future
  * transactions. Also return the visibility_cutoff_xid which is the highest
- * xmin amongst the visible tuples.
+ * xmin amongst the visible tuples.  Set *all_frozen to true if every tuple
+ * on this page is frozen.
  */
 static bool
-heap_page_is_all_visible(Relation rel, Buffer buf, TransactionId *visibility_cutoff_xid)
+heap_page_is_all_visible(Relation rel, Buffer buf,
+						 TransactionId *visibility_cutoff_xid,
+						 bool *all_frozen)
 {
 	Page		page = BufferGetPage(buf);
 	BlockNumber blockno = BufferGetBlockNumber(buf);
@@ -1791,6 +2629,7 @@ heap_page_is_all_visible(Relation rel, Buffer buf, TransactionId *visibility_cut
 	bool		all_visible = true;
 
 	*visibility_cutoff_xid = InvalidTransactionId;
+	*all_frozen = true;
 
 	/*
 	 * This is a stripped down version of the line pointer scan in
@@ -1819,6 +2658,7 @@ heap_page_is_all_visible(Relation rel, Buffer buf, TransactionId *visibility_cut
 		if (ItemIdIsDead(itemid))
 		{
 			all_visible = false;
+			*all_frozen = false;
 			break;
 		}
 
@@ -1838,6 +2678,7 @@ heap_page_is_all_visible(Relation rel, Buffer buf, TransactionId *visibility_cut
 					if (!HeapTupleHeaderXminCommitted(tuple.t_data))
 					{
 						all_visible = false;
+						*all_frozen = false;
 						break;
 					}
 
@@ -1849,12 +2690,18 @@ heap_page_is_all_visible(Relation rel, Buffer buf, TransactionId *visibility_cut
 					if (!TransactionIdPrecedes(xmin, OldestXmin))
 					{
 						all_visible = false;
+						*all_frozen = false;
 						break;
 					}
 
 					/* Track newest xmin on page. */
 					if (TransactionIdFollows(xmin, *visibility_cutoff_xid))
 						*visibility_cutoff_xid = xmin;
+
+					/* Check whether this tuple is already frozen or not */
+					if (all_visible && *all_frozen &&
+						heap_tuple_needs_eventual_freeze(tuple.t_data))
+						*all_frozen = false;
 				}
 				break;
 
@@ -1862,8 +2709,11 @@ heap_page_is_all_visible(Relation rel, Buffer buf, TransactionId *visibility_cut
 			case HEAPTUPLE_RECENTLY_DEAD:
 			case HEAPTUPLE_INSERT_IN_PROGRESS:
 			case HEAPTUPLE_DELETE_IN_PROGRESS:
-				all_visible = false;
-				break;
+				{
+					all_visible = false;
+					*all_frozen = false;
+					break;
+				}
 
 			default:
 				elog(ERROR, "unexpected HeapTupleSatisfiesVacuum result");
@@ -44,6 +44,12 @@
  *	  aggregate.  These are always just passed as NULL.  Such arguments may be
  *	  needed to allow resolution of a polymorphic aggregate's result type.
  *
+ *	  When the planner splits aggregation into two stages, a partial Aggref
+ *	  (aggpartial) skips the finalfunc and returns the ending transvalue,
+ *	  while a combining Aggref (aggcombine) takes such transvalues as its
+ *	  only input and merges them using the aggregate's combinefunc, which
+ *	  then plays exactly the role of the transfunc described above.
+ *
  *	  We compute aggregate input expressions and run the transition functions
  *	  in a temporary econtext (aggstate->tmpcontext).  This is reset at least
  *	  once per input tuple, so when the transvalue datatype is
@@ -2311,8 +2317,28 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 						   get_func_name(aggref->aggfnoid));
 		InvokeFunctionExecuteHook(aggref->aggfnoid);
 
-		peraggstate->transfn_oid = transfn_oid = aggform->aggtransfn;
-		peraggstate->finalfn_oid = finalfn_oid = aggform->aggfinalfn;
+		/*
+		 * A combining aggregate receives transition states rather than
+		 * ordinary input values, and merges them with the combine function
+		 * in place of the transition function.  A partial aggregate returns
+		 * its transition state as it stands.
+		 */
+		if (aggref->aggcombine)
+		{
+			transfn_oid = aggform->aggcombinefn;
+			if (!OidIsValid(transfn_oid))
+				elog(ERROR, "combinefn not set for aggregate function %u",
+					 aggref->aggfnoid);
+		}
+		else
+			transfn_oid = aggform->aggtransfn;
+		peraggstate->transfn_oid = transfn_oid;
+
+		if (aggref->aggpartial)
+			finalfn_oid = InvalidOid;
+		else
+			finalfn_oid = aggform->aggfinalfn;
+		peraggstate->finalfn_oid = finalfn_oid;
 
 		/* Check that aggregate owner has permission to call component fns */
 		{
@@ -53,14 +53,31 @@
  *			  nil	nil		 Scan	 Scan	  Scan	   Scan
  *							  |		  |		   |		|
  *							person employee student student-emp
+ *
+ *		When an Append scans the children of an inheritance parent with
+ *		partition bounds, the planner may give it conditions comparing the
+ *		partition key with values that are only known at execution time
+ *		(see set_append_partition_pruning).  If those values don't depend
+ *		on PARAM_EXEC parameters, we evaluate them at startup and don't
+ *		even initialize the subplans of children that can't contain
+ *		matching rows.  Otherwise we initialize all subplans, and decide
+ *		which ones to run at the start of each scan.
  */
 
 #include "postgres.h"
 
+#include "access/heapam.h"
+#include "catalog/partition.h"
 #include "executor/execdebug.h"
 #include "executor/nodeAppend.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
 
 static bool exec_append_initialize_next(AppendState *appendstate);
+static void exec_append_prune(AppendState *appendstate, Append *node,
+				  List *childoids, bool *valid);
+static bool exec_append_param_walker(Node *node, Bitmapset **paramids);
 
 
 /* ----------------------------------------------------------------
@@ -105,6 +122,102 @@ exec_append_initialize_next(AppendState *appendstate)
 	}
 }
 
+/* ----------------------------------------------------------------
+ *		exec_append_prune
+ *
+ *		Evaluates the partition key conditions of the append node,
+ *		and sets valid[i] to whether the i'th of the children listed
+ *		in childoids may contain matching rows.
+ * ----------------------------------------------------------------
+ */
+static void
+exec_append_prune(AppendState *appendstate, Append *node,
+				  List *childoids, bool *valid)
+{
+	ExprContext *econtext = appendstate->ps.ps_ExprContext;
+	int			nconds = list_length(appendstate->as_prune_exprs);
+	int		   *strategies;
+	Datum	   *values;
+	bool	   *isnulls;
+	Relation	parentrel;
+	PartitionBoundInfo *bounds;
+	MemoryContext oldcontext;
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			i;
+
+	ResetExprContext(econtext);
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	strategies = (int *) palloc(nconds * sizeof(int));
+	values = (Datum *) palloc(nconds * sizeof(Datum));
+	isnulls = (bool *) palloc(nconds * sizeof(bool));
+
+	i = 0;
+	forboth(lc, appendstate->as_prune_exprs, lc2, node->part_strategies)
+	{
+		ExprState  *exprstate = (ExprState *) lfirst(lc);
+
+		strategies[i] = lfirst_int(lc2);
+		values[i] = ExecEvalExpr(exprstate, econtext, &isnulls[i], NULL);
+		i++;
+	}
+
+	/*
+	 * Fetch the bounds only now; evaluating the expressions could have
+	 * processed invalidation messages that freed them.  The plan holds a
+	 * lock on the parent, so it's still there.
+	 */
+	parentrel = relation_open(node->part_relid, NoLock);
+	bounds = RelationGetPartitionBounds(parentrel);
+
+	if (bounds == NULL)
+	{
+		/* shouldn't happen, but scan everything if it does */
+		for (i = 0; i < list_length(childoids); i++)
+			valid[i] = true;
+	}
+	else
+	{
+		bool	   *keep;
+
+		keep = partition_prune(bounds, nconds, strategies, values, isnulls);
+
+		i = 0;
+		foreach(lc, childoids)
+		{
+			int			j = partition_child_index(bounds, lfirst_oid(lc));
+
+			valid[i++] = (j < 0 || keep[j]);
+		}
+	}
+
+	relation_close(parentrel, NoLock);
+
+	MemoryContextSwitchTo(oldcontext);
+	ResetExprContext(econtext);
+}
+
+/*
+ * Collect the IDs of the PARAM_EXEC Params in an expression tree.
+ */
+static bool
+exec_append_param_walker(Node *node, Bitmapset **paramids)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+
+		if (param->paramkind == PARAM_EXEC)
+			*paramids = bms_add_member(*paramids, param->paramid);
+		return false;
+	}
+	return expression_tree_walker(node, exec_append_param_walker,
+								  (void *) paramids);
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitAppend
  *
@@ -121,34 +234,75 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 {
 	AppendState *appendstate = makeNode(AppendState);
 	PlanState **appendplanstates;
+	bool	   *valid = NULL;
 	int			nplans;
 	int			i;
+	int			j;
 	ListCell   *lc;
 
 	/* check for unsupported flags */
 	Assert(!(eflags & EXEC_FLAG_MARK));
 
-	/*
-	 * Set up empty vector of subplan states
-	 */
-	nplans = list_length(node->appendplans);
-
-	appendplanstates = (PlanState **) palloc0(nplans * sizeof(PlanState *));
-
 	/*
 	 * create new AppendState for our append node
 	 */
 	appendstate->ps.plan = (Plan *) node;
 	appendstate->ps.state = estate;
-	appendstate->appendplans = appendplanstates;
-	appendstate->as_nplans = nplans;
 
 	/*
 	 * Miscellaneous initialization
 	 *
 	 * Append plans don't have expression contexts because they never call
-	 * ExecQual or ExecProject.
+	 * ExecQual or ExecProject, unless they have partition key conditions to
+	 * evaluate.
+	 */
+	nplans = list_length(node->appendplans);
+
+	if (OidIsValid(node->part_relid))
+	{
+		ExecAssignExprContext(estate, &appendstate->ps);
+		appendstate->as_prune_exprs = (List *)
+			ExecInitExpr((Expr *) node->part_exprs, &appendstate->ps);
+		exec_append_param_walker((Node *) node->part_exprs,
+								 &appendstate->as_prune_params);
+
+		valid = (bool *) palloc(nplans * sizeof(bool));
+		if (appendstate->as_prune_params == NULL)
+		{
+			/* The values are known now, so prune once and for all */
+			exec_append_prune(appendstate, node, node->part_child_oids,
+							  valid);
+			for (i = 0; i < nplans; i++)
+			{
+				if (!valid[i])
+					appendstate->as_nremoved++;
+			}
+		}
+		else
+		{
+			/* Prune at the start of the first scan */
+			appendstate->as_valid = valid;
+			appendstate->as_prune_pending = true;
+			valid = NULL;
+		}
+	}
+
+	/*
+	 * Set up empty vector of subplan states.  If we removed all subplans,
+	 * we still initialize the first one, so that there's something for
+	 * EXPLAIN to look at, but we never run it.
 	 */
+	if (nplans > 0 && appendstate->as_nremoved == nplans)
+	{
+		appendstate->as_nremoved = nplans - 1;
+		valid[0] = true;
+		appendstate->as_valid = (bool *) palloc0(sizeof(bool));
+	}
+	nplans -= appendstate->as_nremoved;
+
+	appendplanstates = (PlanState **) palloc0(nplans * sizeof(PlanState *));
+	appendstate->appendplans = appendplanstates;
+	appendstate->as_nplans = nplans;
 
 	/*
 	 * append nodes still have Result slots, which hold pointers to tuples, so
@@ -161,12 +315,13 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	 * results into the array "appendplans".
 	 */
 	i = 0;
+	j = 0;
 	foreach(lc, node->appendplans)
 	{
 		Plan	   *initNode = (Plan *) lfirst(lc);
 
-		appendplanstates[i] = ExecInitNode(initNode, estate, eflags);
-		i++;
+		if (valid == NULL || valid[j++])
+			appendplanstates[i++] = ExecInitNode(initNode, estate, eflags);
 	}
 
 	/*
@@ -193,29 +348,42 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 TupleTableSlot *
 ExecAppend(AppendState *node)
 {
+	/*
+	 * If the partition key conditions depend on parameters that have
+	 * changed, find out which subplans we need to run this time.
+	 */
+	if (node->as_prune_pending)
+	{
+		Append	   *plan = (Append *) node->ps.plan;
+
+		exec_append_prune(node, plan, plan->part_child_oids, node->as_valid);
+		node->as_prune_pending = false;
+	}
+
 	for (;;)
 	{
 		PlanState  *subnode;
 		TupleTableSlot *result;
 
 		/*
-		 * figure out which subplan we are currently processing
-		 */
-		subnode = node->appendplans[node->as_whichplan];
-
-		/*
-		 * get a tuple from the subplan
+		 * figure out which subplan we are currently processing, and get a
+		 * tuple from it unless it has been pruned
 		 */
-		result = ExecProcNode(subnode);
-
-		if (!TupIsNull(result))
+		if (node->as_valid == NULL || node->as_valid[node->as_whichplan])
 		{
-			/*
-			 * If the subplan gave us something then return it as-is. We do
-			 * NOT make use of the result slot that was set up in
-			 * ExecInitAppend; there's no need for it.
-			 */
-			return result;
+			subnode = node->appendplans[node->as_whichplan];
+
+			result = ExecProcNode(subnode);
+
+			if (!TupIsNull(result))
+			{
+				/*
+				 * If the subplan gave us something then return it as-is. We
+				 * do NOT make use of the result slot that was set up in
+				 * ExecInitAppend; there's no need for it.
+				 */
+				return result;
+			}
 		}
 
 		/*
@@ -285,6 +453,12 @@ ExecReScanAppend(AppendState *node)
 		if (subnode->chgParam == NULL)
 			ExecReScan(subnode);
 	}
+
+	/* If the partition key conditions have changed, prune again */
+	if (node->as_prune_params &&
+		bms_overlap(node->ps.chgParam, node->as_prune_params))
+		node->as_prune_pending = true;
+
 	node->as_whichplan = 0;
 	exec_append_initialize_next(node);
 }
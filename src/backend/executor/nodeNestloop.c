@@ -17,15 +17,50 @@
  *		ExecNestLoop	 - process a nestloop join of two plans
  *		ExecInitNestLoop - initialize the join
  *		ExecEndNestLoop  - shut down the join
+ *
+ *	 NOTES
+ *		A nestloop whose inner side does not depend on the outer tuple is
+ *		chosen on the assumption that few outer rows will be seen.  When the
+ *		planner found hashable join clauses it passes them along, and if the
+ *		outer side produces more than adaptive_nestloop_factor times its
+ *		estimated row count, we read the inner side once into an in-memory
+ *		hash table and probe that for the remaining outer rows instead of
+ *		rescanning the inner plan.  The full join quals are still checked
+ *		against each candidate, and candidates are returned in inner scan
+ *		order, so the results are exactly those of the plain nestloop.  If
+ *		the inner side does not fit in work_mem we give up on the hash table
+ *		and carry on as before.
  */
 
 #include "postgres.h"
 
+#include "access/htup_details.h"
 #include "executor/execdebug.h"
 #include "executor/nodeNestloop.h"
+#include "miscadmin.h"
+#include "utils/dynahash.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 
 
+/* GUC parameter */
+double		adaptive_nestloop_factor = 100.0;
+
+/* An inner tuple stored in the hash table */
+typedef struct NestLoopHashEntryData
+{
+	struct NestLoopHashEntryData *next; /* link to next entry in same bucket */
+	uint32		hashvalue;		/* tuple's hash code */
+	MinimalTuple tuple;			/* the stored inner tuple */
+} NestLoopHashEntryData;
+
+static bool ExecNestLoopGetHashValue(ExprContext *econtext, List *hashkeys,
+						 FmgrInfo *hashfunctions, uint32 *hashvalue);
+static void ExecNestLoopBuildHash(NestLoopState *node);
+static void ExecNestLoopFreeHash(NestLoopState *node);
+static TupleTableSlot *ExecNestLoopNextHashed(NestLoopState *node);
+
+
 /* ----------------------------------------------------------------
  *		ExecNestLoop(node)
  *
@@ -135,6 +170,7 @@ ExecNestLoop(NestLoopState *node)
 			econtext->ecxt_outertuple = outerTupleSlot;
 			node->nl_NeedNewOuter = false;
 			node->nl_MatchedOuter = false;
+			node->nl_OuterRows += 1;
 
 			/*
 			 * fetch the values of any outer Vars that must be passed to the
@@ -160,10 +196,45 @@ ExecNestLoop(NestLoopState *node)
 			}
 
 			/*
-			 * now rescan the inner plan
+			 * If the outer side has turned out to be much bigger than the
+			 * planner thought, try to load the inner side into a hash table
+			 * so that we needn't rescan it for each remaining outer tuple.
 			 */
-			ENL1_printf("rescanning inner plan");
-			ExecReScan(innerPlan);
+			if (node->nl_HashStatus == NL_HASH_NONE &&
+				node->nl_SwitchThreshold > 0 &&
+				node->nl_OuterRows > node->nl_SwitchThreshold)
+				ExecNestLoopBuildHash(node);
+
+			if (node->nl_HashStatus == NL_HASH_ACTIVE)
+			{
+				uint32		hashvalue;
+
+				/*
+				 * Position at the start of the matching bucket.  An outer
+				 * tuple with a null join key cannot match anything, since
+				 * hashable operators are strict.
+				 */
+				ENL1_printf("probing inner hash table");
+				if (ExecNestLoopGetHashValue(econtext,
+											 node->nl_OuterHashKeys,
+											 node->nl_OuterHashFunctions,
+											 &hashvalue))
+				{
+					node->nl_CurHashValue = hashvalue;
+					node->nl_CurEntry =
+						node->nl_HashBuckets[hashvalue & (node->nl_NumBuckets - 1)];
+				}
+				else
+					node->nl_CurEntry = NULL;
+			}
+			else
+			{
+				/*
+				 * now rescan the inner plan
+				 */
+				ENL1_printf("rescanning inner plan");
+				ExecReScan(innerPlan);
+			}
 		}
 
 		/*
@@ -171,7 +242,10 @@ ExecNestLoop(NestLoopState *node)
 		 */
 		ENL1_printf("getting new inner tuple");
 
-		innerTupleSlot = ExecProcNode(innerPlan);
+		if (node->nl_HashStatus == NL_HASH_ACTIVE)
+			innerTupleSlot = ExecNestLoopNextHashed(node);
+		else
+			innerTupleSlot = ExecProcNode(innerPlan);
 		econtext->ecxt_innertuple = innerTupleSlot;
 
 		if (TupIsNull(innerTupleSlot))
@@ -288,6 +362,197 @@ ExecNestLoop(NestLoopState *node)
 	}
 }
 
+/*
+ * ExecNestLoopGetHashValue
+ *		Compute the hash value of the current outer or inner tuple
+ *
+ * Returns false if any of the hash keys is null; such a tuple cannot satisfy
+ * the (strict) hashable join clauses.
+ */
+static bool
+ExecNestLoopGetHashValue(ExprContext *econtext, List *hashkeys,
+						 FmgrInfo *hashfunctions, uint32 *hashvalue)
+{
+	uint32		hashkey = 0;
+	ListCell   *hk;
+	int			i = 0;
+	MemoryContext oldContext;
+
+	ResetExprContext(econtext);
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	foreach(hk, hashkeys)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(hk);
+		Datum		keyval;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step, as nodeHash.c does */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
+		if (isNull)
+		{
+			MemoryContextSwitchTo(oldContext);
+			return false;
+		}
+
+		hashkey ^= DatumGetUInt32(FunctionCall1(&hashfunctions[i], keyval));
+		i++;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	*hashvalue = hashkey;
+	return true;
+}
+
+/*
+ * ExecNestLoopBuildHash
+ *		Read the whole inner side into a hash table
+ *
+ * On success the node's HashStatus is set to NL_HASH_ACTIVE.  If the table
+ * would need more than work_mem, it is discarded and HashStatus is set to
+ * NL_HASH_FAILED, so that we don't try again until the next rescan.  Either
+ * way the inner plan has been run to completion, and must be rescanned
+ * before it is used again.
+ */
+static void
+ExecNestLoopBuildHash(NestLoopState *node)
+{
+	PlanState  *innerPlan = innerPlanState(node);
+	ExprContext *econtext = node->js.ps.ps_ExprContext;
+	Size		spaceAllowed = work_mem * 1024L;
+	Size		spaceUsed = 0;
+	double		ntuples = 0;
+	NestLoopHashEntry entries = NULL;
+	NestLoopHashEntry entry;
+	MemoryContext oldcxt;
+	long		nbuckets;
+
+	Assert(node->nl_HashContext == NULL);
+
+	node->nl_HashContext = AllocSetContextCreate(node->js.ps.state->es_query_cxt,
+												 "NestLoop hash table",
+												 ALLOCSET_DEFAULT_MINSIZE,
+												 ALLOCSET_DEFAULT_INITSIZE,
+												 ALLOCSET_DEFAULT_MAXSIZE);
+
+	/*
+	 * Load all inner tuples with non-null keys.  They are chained together in
+	 * reverse order of arrival for now; distributing them into buckets below
+	 * reverses them again, so each bucket ends up in inner scan order.
+	 */
+	ExecReScan(innerPlan);
+	for (;;)
+	{
+		TupleTableSlot *slot;
+		uint32		hashvalue;
+
+		slot = ExecProcNode(innerPlan);
+		if (TupIsNull(slot))
+			break;
+
+		econtext->ecxt_innertuple = slot;
+		if (!ExecNestLoopGetHashValue(econtext,
+									  node->nl_InnerHashKeys,
+									  node->nl_InnerHashFunctions,
+									  &hashvalue))
+			continue;
+
+		oldcxt = MemoryContextSwitchTo(node->nl_HashContext);
+		entry = (NestLoopHashEntry) palloc(sizeof(NestLoopHashEntryData));
+		entry->hashvalue = hashvalue;
+		entry->tuple = ExecCopySlotMinimalTuple(slot);
+		MemoryContextSwitchTo(oldcxt);
+
+		entry->next = entries;
+		entries = entry;
+		ntuples += 1;
+		spaceUsed += sizeof(NestLoopHashEntryData) + entry->tuple->t_len;
+		if (spaceUsed > spaceAllowed)
+			break;
+	}
+
+	nbuckets = (long) Min(ntuples, MaxAllocSize / sizeof(NestLoopHashEntry));
+	nbuckets = 1L << my_log2(Max(nbuckets, 1));
+	spaceUsed += nbuckets * sizeof(NestLoopHashEntry);
+
+	/* Remember what happened the first time, for EXPLAIN */
+	if (node->nl_SwitchedAt == 0)
+	{
+		node->nl_SwitchedAt = node->nl_OuterRows;
+		node->nl_HashedRows = ntuples;
+		node->nl_HashSpace = spaceUsed;
+		node->nl_HashAbandoned = (spaceUsed > spaceAllowed);
+	}
+
+	if (spaceUsed > spaceAllowed)
+	{
+		ExecNestLoopFreeHash(node);
+		node->nl_HashStatus = NL_HASH_FAILED;
+		return;
+	}
+
+	node->nl_NumBuckets = (int) nbuckets;
+	node->nl_HashBuckets = (NestLoopHashEntry *)
+		MemoryContextAllocZero(node->nl_HashContext,
+							   nbuckets * sizeof(NestLoopHashEntry));
+	while (entries != NULL)
+	{
+		int			bucketno;
+
+		entry = entries;
+		entries = entry->next;
+		bucketno = entry->hashvalue & (nbuckets - 1);
+		entry->next = node->nl_HashBuckets[bucketno];
+		node->nl_HashBuckets[bucketno] = entry;
+	}
+
+	node->nl_CurEntry = NULL;
+	node->nl_HashStatus = NL_HASH_ACTIVE;
+}
+
+/*
+ * ExecNestLoopFreeHash
+ *		Release the hash table, if any
+ */
+static void
+ExecNestLoopFreeHash(NestLoopState *node)
+{
+	if (node->nl_HashTupleSlot)
+		ExecClearTuple(node->nl_HashTupleSlot);
+	if (node->nl_HashContext)
+		MemoryContextDelete(node->nl_HashContext);
+	node->nl_HashContext = NULL;
+	node->nl_HashBuckets = NULL;
+	node->nl_NumBuckets = 0;
+	node->nl_CurEntry = NULL;
+}
+
+/*
+ * ExecNestLoopNextHashed
+ *		Return the next hashed inner tuple that may match the current outer
+ *		tuple, or NULL if there are no more
+ */
+static TupleTableSlot *
+ExecNestLoopNextHashed(NestLoopState *node)
+{
+	NestLoopHashEntry entry;
+
+	while ((entry = node->nl_CurEntry) != NULL)
+	{
+		node->nl_CurEntry = entry->next;
+		if (entry->hashvalue == node->nl_CurHashValue)
+			return ExecStoreMinimalTuple(entry->tuple,
+										 node->nl_HashTupleSlot,
+										 false);
+	}
+
+	return NULL;
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitNestLoop
  * ----------------------------------------------------------------
@@ -368,6 +633,58 @@ ExecInitNestLoop(NestLoop *node, EState *estate, int eflags)
 				 (int) node->join.jointype);
 	}
 
+	/*
+	 * If the planner gave us hashable join clauses, prepare to switch to a
+	 * hashed inner side should the outer side prove much larger than
+	 * estimated.
+	 */
+	if (node->hashclauses != NIL && adaptive_nestloop_factor > 0)
+	{
+		int			nkeys = list_length(node->hashclauses);
+		ListCell   *lc;
+		int			i = 0;
+
+		nlstate->nl_OuterHashFunctions =
+			(FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
+		nlstate->nl_InnerHashFunctions =
+			(FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
+
+		foreach(lc, node->hashclauses)
+		{
+			OpExpr	   *hclause = (OpExpr *) lfirst(lc);
+			Oid			left_hashfn;
+			Oid			right_hashfn;
+
+			Assert(IsA(hclause, OpExpr));
+			Assert(list_length(hclause->args) == 2);
+
+			if (!get_op_hash_functions(hclause->opno,
+									   &left_hashfn, &right_hashfn))
+				elog(ERROR, "could not find hash function for hash operator %u",
+					 hclause->opno);
+			fmgr_info(left_hashfn, &nlstate->nl_OuterHashFunctions[i]);
+			fmgr_info(right_hashfn, &nlstate->nl_InnerHashFunctions[i]);
+
+			nlstate->nl_OuterHashKeys =
+				lappend(nlstate->nl_OuterHashKeys,
+						ExecInitExpr((Expr *) linitial(hclause->args),
+									 (PlanState *) nlstate));
+			nlstate->nl_InnerHashKeys =
+				lappend(nlstate->nl_InnerHashKeys,
+						ExecInitExpr((Expr *) lsecond(hclause->args),
+									 (PlanState *) nlstate));
+			i++;
+		}
+
+		nlstate->nl_SwitchThreshold =
+			Max(outerPlan(node)->plan_rows, 1.0) * adaptive_nestloop_factor;
+
+		nlstate->nl_HashTupleSlot = ExecInitExtraTupleSlot(estate);
+		ExecSetSlotDescriptor(nlstate->nl_HashTupleSlot,
+							  ExecGetResultType(innerPlanState(nlstate)));
+	}
+	nlstate->nl_HashStatus = NL_HASH_NONE;
+
 	/*
 	 * initialize tuple type and projection info
 	 */
@@ -409,6 +726,11 @@ ExecEndNestLoop(NestLoopState *node)
 	 */
 	ExecClearTuple(node->js.ps.ps_ResultTupleSlot);
 
+	/*
+	 * free the hash table, if we built one
+	 */
+	ExecNestLoopFreeHash(node);
+
 	/*
 	 * close down subplans
 	 */
@@ -439,7 +761,13 @@ ExecReScanNestLoop(NestLoopState *node)
 	 * innerPlan is re-scanned for each new outer tuple and MUST NOT be
 	 * re-scanned from here or you'll get troubles from inner index scans when
 	 * outer Vars are used as run-time keys...
+	 *
+	 * Any hash table we built may no longer reflect the inner side, so throw
+	 * it away and start counting outer rows afresh.
 	 */
+	ExecNestLoopFreeHash(node);
+	node->nl_HashStatus = NL_HASH_NONE;
+	node->nl_OuterRows = 0;
 
 	node->js.ps.ps_TupFromTlist = false;
 	node->nl_NeedNewOuter = true;
@@ -0,0 +1,743 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeResultCache.c
+ *	  Routines to cache the results of a parameterized subplan.
+ *
+ * A ResultCache node sits on the inner side of a parameterized nestloop,
+ * above a subplan (typically an index scan) that depends on the values of
+ * some outer-side expressions.  When the outer side produces the same join
+ * key many times, rescanning the subplan for each outer row repeats the
+ * same work; instead we remember the rows returned for each distinct set of
+ * key values in a hash table, and return them from there on later rescans
+ * with the same key values.
+ *
+ * The cache is limited to work_mem.  When it is full, the least recently
+ * used entries are evicted.  If a single scan returns more rows than fit in
+ * work_mem on its own, we give up caching that scan's results and just pass
+ * the subplan's rows through ("bypass mode").
+ *
+ * An entry is only usable once its scan has run to completion; if the
+ * caller stops reading early, the incomplete entry is discarded at the next
+ * lookup for the same keys.  If the planner told us that the caller only
+ * ever wants one row per scan (semi and anti joins), an entry is complete
+ * after its first row.
+ *
+ * Since entries are keyed only by the values of the cache key expressions,
+ * the whole cache must be discarded if any other parameter the subplan
+ * depends on changes value.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeResultCache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+ * INTERFACE ROUTINES
+ *		ExecResultCache			- return rows from the cache or the subplan
+ *		ExecInitResultCache		- initialize node and subnodes
+ *		ExecEndResultCache		- shutdown node and subnodes
+ *		ExecReScanResultCache	- prepare for a scan with new key values
+ */
+#include "postgres.h"
+
+#include "executor/executor.h"
+#include "executor/nodeResultCache.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/datum.h"
+#include "utils/dynahash.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+
+/* Values of rc_status */
+#define RC_CACHE_LOOKUP				1	/* look up the current key values */
+#define RC_CACHE_FETCH_NEXT_TUPLE	2	/* return rows of a complete entry */
+#define RC_FILLING_CACHE			3	/* read subplan, adding to entry */
+#define RC_CACHE_BYPASS_MODE		4	/* read subplan, don't cache */
+#define RC_END_OF_SCAN				5	/* no more rows for these keys */
+
+typedef struct ResultCacheTupleData
+{
+	MinimalTuple mintuple;		/* a cached row */
+	struct ResultCacheTupleData *next;	/* next row of the same entry */
+} ResultCacheTupleData;
+
+typedef struct ResultCacheEntryData
+{
+	struct ResultCacheEntryData *next;	/* next entry in the same bucket */
+	dlist_node	lru_node;		/* position in the node's LRU list */
+	uint32		hashvalue;		/* hash of the key values */
+	Datum	   *keyvalues;		/* key values */
+	bool	   *keynulls;
+	ResultCacheTuple tuples;	/* cached rows, in subplan order */
+	ResultCacheTuple lasttuple; /* last row of the list */
+	Size		memsize;		/* space used by entry, keys and rows */
+	bool		complete;		/* did the scan run to completion? */
+} ResultCacheEntryData;
+
+static uint32 ExecResultCacheProbe(ResultCacheState *node);
+static ResultCacheEntry ExecResultCacheFind(ResultCacheState *node,
+					uint32 hashvalue);
+static ResultCacheEntry ExecResultCacheCreateEntry(ResultCacheState *node,
+						   uint32 hashvalue);
+static bool ExecResultCacheAddTuple(ResultCacheState *node,
+						TupleTableSlot *slot);
+static bool ExecResultCacheMakeRoom(ResultCacheState *node);
+static void ExecResultCacheRemoveEntry(ResultCacheState *node,
+						   ResultCacheEntry entry);
+static void ExecResultCacheGrowBuckets(ResultCacheState *node);
+static void ExecResultCachePurge(ResultCacheState *node);
+static bool collect_exec_params_walker(Node *node, Bitmapset **paramids);
+
+
+/* ----------------------------------------------------------------
+ *		ExecResultCache
+ *
+ *		On the first call after a rescan, look up the current key values.
+ *		If there is a complete entry for them, return its rows; otherwise
+ *		run the subplan, remembering its rows as they are returned.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecResultCache(ResultCacheState *node)
+{
+	PlanState  *outerNode = outerPlanState(node);
+	TupleTableSlot *slot;
+
+	switch (node->rc_status)
+	{
+		case RC_CACHE_LOOKUP:
+			{
+				uint32		hashvalue;
+				ResultCacheEntry entry;
+
+				hashvalue = ExecResultCacheProbe(node);
+				entry = ExecResultCacheFind(node, hashvalue);
+
+				if (entry != NULL && entry->complete)
+				{
+					node->rc_Hits++;
+
+					/* mark it most recently used */
+					dlist_delete(&entry->lru_node);
+					dlist_push_tail(&node->rc_LRUList, &entry->lru_node);
+
+					node->rc_CurEntry = entry;
+					node->rc_CurTuple = entry->tuples;
+					if (entry->tuples == NULL)
+					{
+						node->rc_status = RC_END_OF_SCAN;
+						return NULL;
+					}
+
+					node->rc_status = RC_CACHE_FETCH_NEXT_TUPLE;
+					return ExecStoreMinimalTuple(entry->tuples->mintuple,
+												 node->ps.ps_ResultTupleSlot,
+												 false);
+				}
+
+				node->rc_Misses++;
+
+				/*
+				 * An incomplete entry is left over from a scan that was
+				 * stopped early; we have to start it over.
+				 */
+				if (entry != NULL)
+					ExecResultCacheRemoveEntry(node, entry);
+
+				entry = ExecResultCacheCreateEntry(node, hashvalue);
+
+				slot = ExecProcNode(outerNode);
+				if (TupIsNull(slot))
+				{
+					if (entry != NULL)
+						entry->complete = true;
+					node->rc_status = RC_END_OF_SCAN;
+					return NULL;
+				}
+
+				if (entry == NULL || !ExecResultCacheAddTuple(node, slot))
+				{
+					node->rc_status = RC_CACHE_BYPASS_MODE;
+					return slot;
+				}
+
+				if (node->rc_SingleRow)
+				{
+					entry->complete = true;
+					node->rc_status = RC_END_OF_SCAN;
+				}
+				else
+					node->rc_status = RC_FILLING_CACHE;
+				return slot;
+			}
+
+		case RC_CACHE_FETCH_NEXT_TUPLE:
+			node->rc_CurTuple = node->rc_CurTuple->next;
+			if (node->rc_CurTuple == NULL)
+			{
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+			return ExecStoreMinimalTuple(node->rc_CurTuple->mintuple,
+										 node->ps.ps_ResultTupleSlot,
+										 false);
+
+		case RC_FILLING_CACHE:
+			slot = ExecProcNode(outerNode);
+			if (TupIsNull(slot))
+			{
+				node->rc_CurEntry->complete = true;
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+			if (!ExecResultCacheAddTuple(node, slot))
+				node->rc_status = RC_CACHE_BYPASS_MODE;
+			return slot;
+
+		case RC_CACHE_BYPASS_MODE:
+			slot = ExecProcNode(outerNode);
+			if (TupIsNull(slot))
+			{
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+			return slot;
+
+		case RC_END_OF_SCAN:
+			return NULL;
+
+		default:
+			elog(ERROR, "unrecognized result cache status: %d",
+				 node->rc_status);
+			return NULL;		/* keep compiler quiet */
+	}
+}
+
+/*
+ * ExecResultCacheProbe
+ *		Evaluate the cache keys for the current scan, and return their hash
+ *
+ * The key values are left in rc_ProbeValues/rc_ProbeNulls, in per-tuple
+ * memory.  Null keys are hashed and compared like any other value.
+ */
+static uint32
+ExecResultCacheProbe(ResultCacheState *node)
+{
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	uint32		hashkey = 0;
+	ListCell   *lc;
+	int			i = 0;
+	MemoryContext oldContext;
+
+	ResetExprContext(econtext);
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	foreach(lc, node->rc_KeyExprs)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(lc);
+
+		/* rotate hashkey left 1 bit at each step, as nodeHash.c does */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		node->rc_ProbeValues[i] = ExecEvalExpr(keyexpr, econtext,
+											   &node->rc_ProbeNulls[i], NULL);
+		if (!node->rc_ProbeNulls[i])
+			hashkey ^= DatumGetUInt32(FunctionCall1(&node->rc_HashFunctions[i],
+													node->rc_ProbeValues[i]));
+		i++;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return hashkey;
+}
+
+/*
+ * ExecResultCacheFind
+ *		Find the entry for the current key values, if any
+ */
+static ResultCacheEntry
+ExecResultCacheFind(ResultCacheState *node, uint32 hashvalue)
+{
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	ResultCacheEntry entry;
+	MemoryContext oldContext;
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	for (entry = node->rc_Buckets[hashvalue & (node->rc_NumBuckets - 1)];
+		 entry != NULL;
+		 entry = entry->next)
+	{
+		int			i;
+
+		if (entry->hashvalue != hashvalue)
+			continue;
+
+		for (i = 0; i < node->rc_NumKeys; i++)
+		{
+			if (entry->keynulls[i] != node->rc_ProbeNulls[i])
+				break;
+			if (entry->keynulls[i])
+				continue;
+			if (!DatumGetBool(FunctionCall2Coll(&node->rc_EqFunctions[i],
+												node->rc_Collations[i],
+												entry->keyvalues[i],
+												node->rc_ProbeValues[i])))
+				break;
+		}
+		if (i == node->rc_NumKeys)
+			break;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return entry;
+}
+
+/*
+ * ExecResultCacheCreateEntry
+ *		Make a new, empty entry for the current key values
+ *
+ * The new entry becomes rc_CurEntry.  Returns NULL if even the empty entry
+ * won't fit in memory.
+ */
+static ResultCacheEntry
+ExecResultCacheCreateEntry(ResultCacheState *node, uint32 hashvalue)
+{
+	ResultCacheEntry entry;
+	MemoryContext oldContext;
+	Size		size;
+	int			bucket;
+	int			i;
+
+	oldContext = MemoryContextSwitchTo(node->rc_TableContext);
+
+	entry = (ResultCacheEntry) palloc(sizeof(ResultCacheEntryData));
+	entry->keyvalues = (Datum *) palloc(node->rc_NumKeys * sizeof(Datum));
+	entry->keynulls = (bool *) palloc(node->rc_NumKeys * sizeof(bool));
+	size = GetMemoryChunkSpace(entry) +
+		GetMemoryChunkSpace(entry->keyvalues) +
+		GetMemoryChunkSpace(entry->keynulls);
+
+	for (i = 0; i < node->rc_NumKeys; i++)
+	{
+		entry->keynulls[i] = node->rc_ProbeNulls[i];
+		if (node->rc_ProbeNulls[i])
+			entry->keyvalues[i] = (Datum) 0;
+		else
+		{
+			entry->keyvalues[i] = datumCopy(node->rc_ProbeValues[i],
+											node->rc_KeyTypByVal[i],
+											node->rc_KeyTypLen[i]);
+			if (!node->rc_KeyTypByVal[i])
+				size += GetMemoryChunkSpace(DatumGetPointer(entry->keyvalues[i]));
+		}
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	entry->hashvalue = hashvalue;
+	entry->tuples = NULL;
+	entry->lasttuple = NULL;
+	entry->memsize = size;
+	entry->complete = false;
+
+	bucket = hashvalue & (node->rc_NumBuckets - 1);
+	entry->next = node->rc_Buckets[bucket];
+	node->rc_Buckets[bucket] = entry;
+	dlist_push_tail(&node->rc_LRUList, &entry->lru_node);
+	node->rc_NumEntries++;
+	node->rc_MemUsed += size;
+	node->rc_CurEntry = entry;
+
+	if (!ExecResultCacheMakeRoom(node))
+	{
+		ExecResultCacheRemoveEntry(node, entry);
+		node->rc_Overflows++;
+		return NULL;
+	}
+
+	if (node->rc_NumEntries > node->rc_NumBuckets)
+		ExecResultCacheGrowBuckets(node);
+
+	return entry;
+}
+
+/*
+ * ExecResultCacheAddTuple
+ *		Append a copy of the subplan's current row to rc_CurEntry
+ *
+ * If the entry no longer fits in memory, it is removed and false is
+ * returned; the caller should pass the rest of this scan's rows through
+ * without caching them.
+ */
+static bool
+ExecResultCacheAddTuple(ResultCacheState *node, TupleTableSlot *slot)
+{
+	ResultCacheEntry entry = node->rc_CurEntry;
+	ResultCacheTuple tuple;
+	MemoryContext oldContext;
+	Size		size;
+
+	oldContext = MemoryContextSwitchTo(node->rc_TableContext);
+	tuple = (ResultCacheTuple) palloc(sizeof(ResultCacheTupleData));
+	tuple->mintuple = ExecCopySlotMinimalTuple(slot);
+	tuple->next = NULL;
+	MemoryContextSwitchTo(oldContext);
+
+	if (entry->lasttuple == NULL)
+		entry->tuples = tuple;
+	else
+		entry->lasttuple->next = tuple;
+	entry->lasttuple = tuple;
+
+	size = GetMemoryChunkSpace(tuple) + GetMemoryChunkSpace(tuple->mintuple);
+	entry->memsize += size;
+	node->rc_MemUsed += size;
+
+	if (!ExecResultCacheMakeRoom(node))
+	{
+		ExecResultCacheRemoveEntry(node, entry);
+		node->rc_Overflows++;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * ExecResultCacheMakeRoom
+ *		Evict least recently used entries until we're within rc_MemLimit
+ *
+ * rc_CurEntry is never evicted.  Returns false if that entry on its own
+ * exceeds the limit.
+ */
+static bool
+ExecResultCacheMakeRoom(ResultCacheState *node)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &node->rc_LRUList)
+	{
+		ResultCacheEntry entry;
+
+		if (node->rc_MemUsed <= node->rc_MemLimit)
+			break;
+
+		entry = dlist_container(ResultCacheEntryData, lru_node, iter.cur);
+		if (entry == node->rc_CurEntry)
+			continue;
+
+		ExecResultCacheRemoveEntry(node, entry);
+		node->rc_Evictions++;
+	}
+
+	if (node->rc_MemUsed > node->rc_MemLimit)
+		return false;
+
+	if (node->rc_MemUsed > node->rc_MemPeak)
+		node->rc_MemPeak = node->rc_MemUsed;
+	return true;
+}
+
+/*
+ * ExecResultCacheRemoveEntry
+ *		Remove an entry from the cache and free its storage
+ */
+static void
+ExecResultCacheRemoveEntry(ResultCacheState *node, ResultCacheEntry entry)
+{
+	ResultCacheEntry *link;
+	ResultCacheTuple tuple;
+	int			i;
+
+	for (link = &node->rc_Buckets[entry->hashvalue & (node->rc_NumBuckets - 1)];
+		 *link != entry;
+		 link = &(*link)->next)
+		Assert(*link != NULL);
+	*link = entry->next;
+
+	dlist_delete(&entry->lru_node);
+
+	tuple = entry->tuples;
+	while (tuple != NULL)
+	{
+		ResultCacheTuple next = tuple->next;
+
+		pfree(tuple->mintuple);
+		pfree(tuple);
+		tuple = next;
+	}
+
+	for (i = 0; i < node->rc_NumKeys; i++)
+	{
+		if (!entry->keynulls[i] && !node->rc_KeyTypByVal[i])
+			pfree(DatumGetPointer(entry->keyvalues[i]));
+	}
+	pfree(entry->keyvalues);
+	pfree(entry->keynulls);
+
+	node->rc_MemUsed -= entry->memsize;
+	node->rc_NumEntries--;
+	if (node->rc_CurEntry == entry)
+		node->rc_CurEntry = NULL;
+
+	pfree(entry);
+}
+
+/*
+ * ExecResultCacheGrowBuckets
+ *		Double the number of hash buckets
+ */
+static void
+ExecResultCacheGrowBuckets(ResultCacheState *node)
+{
+	int			nbuckets = node->rc_NumBuckets * 2;
+	ResultCacheEntry *buckets;
+	int			i;
+
+	if ((Size) nbuckets * sizeof(ResultCacheEntry) > MaxAllocSize)
+		return;
+
+	buckets = (ResultCacheEntry *)
+		MemoryContextAllocZero(node->ps.state->es_query_cxt,
+							   nbuckets * sizeof(ResultCacheEntry));
+
+	for (i = 0; i < node->rc_NumBuckets; i++)
+	{
+		ResultCacheEntry entry = node->rc_Buckets[i];
+
+		while (entry != NULL)
+		{
+			ResultCacheEntry next = entry->next;
+			int			bucket = entry->hashvalue & (nbuckets - 1);
+
+			entry->next = buckets[bucket];
+			buckets[bucket] = entry;
+			entry = next;
+		}
+	}
+
+	pfree(node->rc_Buckets);
+	node->rc_Buckets = buckets;
+	node->rc_NumBuckets = nbuckets;
+}
+
+/*
+ * ExecResultCachePurge
+ *		Discard all cache entries
+ */
+static void
+ExecResultCachePurge(ResultCacheState *node)
+{
+	MemoryContextReset(node->rc_TableContext);
+	MemSet(node->rc_Buckets, 0, node->rc_NumBuckets * sizeof(ResultCacheEntry));
+	dlist_init(&node->rc_LRUList);
+	node->rc_NumEntries = 0;
+	node->rc_MemUsed = 0;
+	node->rc_CurEntry = NULL;
+	node->rc_CurTuple = NULL;
+}
+
+/*
+ * collect_exec_params_walker
+ *		Find the PARAM_EXEC params referenced by an expression
+ */
+static bool
+collect_exec_params_walker(Node *node, Bitmapset **paramids)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+
+		if (param->paramkind == PARAM_EXEC)
+			*paramids = bms_add_member(*paramids, param->paramid);
+		return false;
+	}
+	return expression_tree_walker(node, collect_exec_params_walker,
+								  (void *) paramids);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitResultCache
+ * ----------------------------------------------------------------
+ */
+ResultCacheState *
+ExecInitResultCache(ResultCache *node, EState *estate, int eflags)
+{
+	ResultCacheState *rcstate;
+	long		nbuckets;
+	ListCell   *lc;
+	int			i;
+
+	/* check for unsupported flags */
+	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
+
+	/*
+	 * create state structure
+	 */
+	rcstate = makeNode(ResultCacheState);
+	rcstate->ps.plan = (Plan *) node;
+	rcstate->ps.state = estate;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * We need an expression context to evaluate the cache keys.
+	 */
+	ExecAssignExprContext(estate, &rcstate->ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &rcstate->ps);
+
+	/*
+	 * initialize child nodes
+	 */
+	outerPlanState(rcstate) = ExecInitNode(outerPlan(node), estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&rcstate->ps);
+	rcstate->ps.ps_ProjInfo = NULL;
+
+	/*
+	 * initialize cache keys
+	 */
+	rcstate->rc_NumKeys = node->numKeys;
+	rcstate->rc_KeyExprs = (List *)
+		ExecInitExpr((Expr *) node->param_exprs, (PlanState *) rcstate);
+	rcstate->rc_HashFunctions = (FmgrInfo *) palloc(node->numKeys * sizeof(FmgrInfo));
+	rcstate->rc_EqFunctions = (FmgrInfo *) palloc(node->numKeys * sizeof(FmgrInfo));
+	rcstate->rc_Collations = node->collations;
+	rcstate->rc_KeyTypLen = (int16 *) palloc(node->numKeys * sizeof(int16));
+	rcstate->rc_KeyTypByVal = (bool *) palloc(node->numKeys * sizeof(bool));
+	rcstate->rc_ProbeValues = (Datum *) palloc(node->numKeys * sizeof(Datum));
+	rcstate->rc_ProbeNulls = (bool *) palloc(node->numKeys * sizeof(bool));
+
+	i = 0;
+	foreach(lc, node->param_exprs)
+	{
+		Oid			hashop = node->hashOperators[i];
+		Oid			left_hashfn;
+		Oid			right_hashfn;
+
+		if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 hashop);
+		fmgr_info(left_hashfn, &rcstate->rc_HashFunctions[i]);
+		fmgr_info(get_opcode(hashop), &rcstate->rc_EqFunctions[i]);
+		get_typlenbyval(exprType((Node *) lfirst(lc)),
+						&rcstate->rc_KeyTypLen[i],
+						&rcstate->rc_KeyTypByVal[i]);
+		i++;
+	}
+
+	rcstate->rc_KeyParamIds = NULL;
+	(void) collect_exec_params_walker((Node *) node->param_exprs,
+									  &rcstate->rc_KeyParamIds);
+
+	/*
+	 * initialize the cache itself, sizing the hash table from the planner's
+	 * estimate of the number of distinct keys
+	 */
+	rcstate->rc_SingleRow = node->singlerow;
+	rcstate->rc_TableContext = AllocSetContextCreate(CurrentMemoryContext,
+													 "ResultCache",
+													 ALLOCSET_DEFAULT_MINSIZE,
+													 ALLOCSET_DEFAULT_INITSIZE,
+													 ALLOCSET_DEFAULT_MAXSIZE);
+	nbuckets = Max(node->est_entries, 16);
+	nbuckets = Min(nbuckets, 65536);
+	rcstate->rc_NumBuckets = 1 << my_log2(nbuckets);
+	rcstate->rc_Buckets = (ResultCacheEntry *)
+		palloc0(rcstate->rc_NumBuckets * sizeof(ResultCacheEntry));
+	rcstate->rc_NumEntries = 0;
+	dlist_init(&rcstate->rc_LRUList);
+	rcstate->rc_CurEntry = NULL;
+	rcstate->rc_CurTuple = NULL;
+	rcstate->rc_MemUsed = 0;
+	rcstate->rc_MemLimit = work_mem * 1024L;
+	rcstate->rc_status = RC_CACHE_LOOKUP;
+
+	rcstate->rc_Hits = 0;
+	rcstate->rc_Misses = 0;
+	rcstate->rc_Evictions = 0;
+	rcstate->rc_Overflows = 0;
+	rcstate->rc_MemPeak = 0;
+
+	return rcstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndResultCache
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndResultCache(ResultCacheState *node)
+{
+	/*
+	 * Free the exprcontext
+	 */
+	ExecFreeExprContext(&node->ps);
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ps.ps_ResultTupleSlot);
+
+	/*
+	 * Release the cache
+	 */
+	MemoryContextDelete(node->rc_TableContext);
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+}
+
+/* ----------------------------------------------------------------
+ *		ExecReScanResultCache
+ *
+ *		Prepare to look up the (presumably new) key values.
+ * ----------------------------------------------------------------
+ */
+void
+ExecReScanResultCache(ResultCacheState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	ExecClearTuple(node->ps.ps_ResultTupleSlot);
+
+	node->rc_status = RC_CACHE_LOOKUP;
+	node->rc_CurEntry = NULL;
+	node->rc_CurTuple = NULL;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+
+	/*
+	 * The cached rows are only valid for the current values of any
+	 * parameters that aren't part of the cache key.
+	 */
+	if (bms_nonempty_difference(outerPlan->chgParam, node->rc_KeyParamIds))
+		ExecResultCachePurge(node);
+}
@@ -17,6 +17,7 @@
 
 #include <math.h>
 
+#include "access/heapam.h"
 #include "access/sysattr.h"
 #include "catalog/pg_class.h"
 #include "catalog/pg_operator.h"
@@ -53,6 +54,8 @@ typedef struct pushdown_safety_info
 /* These parameters are set by GUC */
 bool		enable_geqo = false;	/* just in case GUC doesn't set it */
 int			geqo_threshold;
+int			join_search_method = JOIN_SEARCH_IDP;
+int			idp_join_budget = 1000;
 
 /* Hook for plugins to get control in set_rel_pathlist() */
 set_rel_pathlist_hook_type set_rel_pathlist_hook = NULL;
@@ -80,6 +83,9 @@ static void set_foreign_size(PlannerInfo *root, RelOptInfo *rel,
 				 RangeTblEntry *rte);
 static void set_foreign_pathlist(PlannerInfo *root, RelOptInfo *rel,
 					 RangeTblEntry *rte);
+static Bitmapset *find_pruned_inheritance_children(PlannerInfo *root,
+								 RelOptInfo *rel, Index rti,
+								 RangeTblEntry *rte);
 static void set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 					Index rti, RangeTblEntry *rte);
 static void set_append_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
@@ -538,6 +544,63 @@ set_foreign_pathlist(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte)
 	rel->fdwroutine->GetForeignPaths(root, rel, rte->relid);
 }
 
+/*
+ * find_pruned_inheritance_children
+ *	  Find the members of an inheritance set that partition pruning shows
+ *	  can't contain rows satisfying the parent's restriction clauses.
+ *
+ * Returns a set of child RT indexes.  This does the same job as constraint
+ * exclusion, but takes only a binary search over the parent's partition
+ * bounds rather than a proof attempt per child, so we do it first.
+ */
+static Bitmapset *
+find_pruned_inheritance_children(PlannerInfo *root, RelOptInfo *rel,
+								 Index rti, RangeTblEntry *rte)
+{
+	Bitmapset  *result = NULL;
+	Relation	parentrel;
+	PartitionBoundInfo *bounds;
+	bool	   *keep;
+	ListCell   *l;
+
+	if (rte->rtekind != RTE_RELATION ||
+		constraint_exclusion == CONSTRAINT_EXCLUSION_OFF ||
+		rel->baserestrictinfo == NIL)
+		return NULL;
+
+	/* We assume the parent is already locked */
+	parentrel = heap_open(rte->relid, NoLock);
+
+	bounds = RelationGetPartitionBounds(parentrel);
+	keep = bounds ? prune_inheritance_children(bounds, rti,
+											   rel->baserestrictinfo) : NULL;
+	if (keep)
+	{
+		foreach(l, root->append_rel_list)
+		{
+			AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(l);
+			RangeTblEntry *childRTE;
+			int			i;
+
+			if (appinfo->parent_relid != rti)
+				continue;
+			childRTE = root->simple_rte_array[appinfo->child_relid];
+
+			/*
+			 * Grandchildren aren't in the bounds, and so never get pruned
+			 * here; expand_inherited_rtentry has dealt with them already.
+			 */
+			i = partition_child_index(bounds, childRTE->relid);
+			if (i >= 0 && !keep[i])
+				result = bms_add_member(result, appinfo->child_relid);
+		}
+	}
+
+	heap_close(parentrel, NoLock);
+
+	return result;
+}
+
 /*
  * set_append_rel_size
  *	  Set size estimates for an "append relation"
@@ -558,8 +621,12 @@ set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 	double		parent_size;
 	double	   *parent_attrsizes;
 	int			nattrs;
+	Bitmapset  *pruned;
 	ListCell   *l;
 
+	/* Find the children that the parent's partition bounds rule out */
+	pruned = find_pruned_inheritance_children(root, rel, rti, rte);
+
 	/*
 	 * Initialize to compute size estimates for whole append relation.
 	 *
@@ -604,6 +671,13 @@ set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 		childrel = find_base_rel(root, childRTindex);
 		Assert(childrel->reloptkind == RELOPT_OTHER_MEMBER_REL);
 
+		if (bms_is_member(childRTindex, pruned))
+		{
+			/* Partition pruning showed that this child need not be scanned */
+			set_dummy_rel_pathlist(childrel);
+			continue;
+		}
+
 		/*
 		 * We have to copy the parent's targetlist and quals to the child,
 		 * with appropriate substitution of variables.  However, only the
@@ -650,6 +724,13 @@ set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 			continue;
 		}
 
+		/*
+		 * The child will be scanned, so now is the time to collect the
+		 * catalog information build_simple_rel deferred for it.
+		 */
+		if (childRTE->rtekind == RTE_RELATION)
+			get_relation_info(root, childRTE->relid, childRTE->inh, childrel);
+
 		/*
 		 * CE failed, so finish copying/modifying targetlist and join quals.
 		 *
@@ -1652,7 +1733,7 @@ make_rel_from_joinlist(PlannerInfo *root, List *joinlist)
 	{
 		/*
 		 * Consider the different orders in which we could join the rels,
-		 * using a plugin, GEQO, or the regular join search code.
+		 * using a plugin, GEQO or IDP, or the regular join search code.
 		 *
 		 * We put the initial_rels list into a PlannerInfo field because
 		 * has_legal_joinclause() needs to look at it (ugly :-().
@@ -1662,7 +1743,12 @@ make_rel_from_joinlist(PlannerInfo *root, List *joinlist)
 		if (join_search_hook)
 			return (*join_search_hook) (root, levels_needed, initial_rels);
 		else if (enable_geqo && levels_needed >= geqo_threshold)
-			return geqo(root, levels_needed, initial_rels);
+		{
+			if (join_search_method == JOIN_SEARCH_IDP)
+				return idp_join_search(root, levels_needed, initial_rels);
+			else
+				return geqo(root, levels_needed, initial_rels);
+		}
 		else
 			return standard_join_search(root, levels_needed, initial_rels);
 	}
@@ -1765,6 +1851,140 @@ standard_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
 	return rel;
 }
 
+/*
+ * idp_join_search
+ *	  Find a join order for a large join problem by iterative dynamic
+ *	  programming.
+ *
+ * This is used in place of GEQO when join_search_method is "idp".  It has
+ * the same API as standard_join_search, so it can also be installed as a
+ * join_search_hook.
+ *
+ * Each round runs the standard dynamic-programming search over the current
+ * set of items, one level at a time, until either all items are joined or
+ * more than idp_join_budget join relations have been built in the round.
+ * In the latter case we greedily keep the cheapest join relation of the
+ * highest level reached, replace the items it covers with it, and start a
+ * new round.  For join problems small enough to fit in the budget this is
+ * exactly the standard search; beyond that it degrades gracefully towards
+ * greedy join ordering.  Unlike GEQO there is no randomness, so the same
+ * query always gets the same plan.
+ */
+RelOptInfo *
+idp_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
+{
+	List	   *items = list_copy(initial_rels);
+	List	   *save_initial_rels = root->initial_rels;
+	RelOptInfo *best;
+
+	Assert(root->join_rel_level == NULL);
+	Assert(list_length(initial_rels) == levels_needed);
+
+	root->join_rel_level = (List **) palloc((levels_needed + 1) * sizeof(List *));
+
+	for (;;)
+	{
+		int			nitems = list_length(items);
+		int			savelength = list_length(root->join_rel_list);
+		int			lev;
+		int			bestlev = 0;
+		bool		best_added = false;
+		List	   *newitems;
+		ListCell   *lc;
+
+		MemSet(root->join_rel_level, 0, (levels_needed + 1) * sizeof(List *));
+		root->join_rel_level[1] = items;
+
+		/* has_legal_joinclause() must see the items of this round */
+		root->initial_rels = items;
+
+		for (lev = 2; lev <= nitems; lev++)
+		{
+			join_search_one_level(root, lev);
+
+			foreach(lc, root->join_rel_level[lev])
+			{
+				RelOptInfo *rel = (RelOptInfo *) lfirst(lc);
+
+				set_cheapest(rel);
+
+#ifdef OPTIMIZER_DEBUG
+				debug_print_rel(root, rel);
+#endif
+			}
+
+			if (root->join_rel_level[lev] != NIL)
+				bestlev = lev;
+
+			/* stop this round once it has used up its budget */
+			if (list_length(root->join_rel_list) - savelength >= idp_join_budget)
+				break;
+		}
+
+		if (bestlev == nitems)
+		{
+			/* all items are joined, so we're done */
+			Assert(list_length(root->join_rel_level[nitems]) == 1);
+			best = (RelOptInfo *) linitial(root->join_rel_level[nitems]);
+			break;
+		}
+		if (bestlev == 0)
+			elog(ERROR, "failed to build any %d-way joins", nitems);
+
+		/*
+		 * Keep the cheapest rel of the highest level reached.  Ties are
+		 * broken by estimated size, and then by order of construction, which
+		 * is deterministic.
+		 */
+		best = NULL;
+		foreach(lc, root->join_rel_level[bestlev])
+		{
+			RelOptInfo *rel = (RelOptInfo *) lfirst(lc);
+
+			if (best == NULL ||
+				rel->cheapest_total_path->total_cost <
+				best->cheapest_total_path->total_cost ||
+				(rel->cheapest_total_path->total_cost ==
+				 best->cheapest_total_path->total_cost &&
+				 rel->rows < best->rows))
+				best = rel;
+		}
+
+		/*
+		 * Forget all the other join rels built in this round, so that the
+		 * next round builds them afresh from its own items.  (Their storage
+		 * is still referenced by the paths of the rel we keep, so we can't
+		 * free it.)  The hash table will be rebuilt if needed.
+		 */
+		root->join_rel_list = list_truncate(root->join_rel_list, savelength);
+		root->join_rel_list = lappend(root->join_rel_list, best);
+		if (root->join_rel_hash)
+			hash_destroy(root->join_rel_hash);
+		root->join_rel_hash = NULL;
+
+		/* Replace the items covered by the chosen rel with that rel */
+		newitems = NIL;
+		foreach(lc, items)
+		{
+			RelOptInfo *item = (RelOptInfo *) lfirst(lc);
+
+			if (!bms_is_subset(item->relids, best->relids))
+				newitems = lappend(newitems, item);
+			else if (!best_added)
+			{
+				newitems = lappend(newitems, best);
+				best_added = true;
+			}
+		}
+		items = newitems;
+	}
+
+	root->join_rel_level = NULL;
+	root->initial_rels = save_initial_rels;
+
+	return best;
+}
+
 /*****************************************************************************
  *			PUSHING QUALS DOWN INTO SUBQUERIES
  *****************************************************************************/
@@ -2443,6 +2663,10 @@ print_path(PlannerInfo *root, Path *path, int indent)
 			ptype = "Material";
 			subpath = ((MaterialPath *) path)->subpath;
 			break;
+		case T_ResultCachePath:
+			ptype = "ResultCache";
+			subpath = ((ResultCachePath *) path)->subpath;
+			break;
 		case T_UniquePath:
 			ptype = "Unique";
 			subpath = ((UniquePath *) path)->subpath;
@@ -20,6 +20,8 @@
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/plancat.h"
+#include "optimizer/var.h"
+#include "statistics/statistics.h"
 #include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/selfuncs.h"
@@ -41,6 +43,8 @@ typedef struct RangeQueryClause
 
 static void addRangeClause(RangeQueryClause **rqlist, Node *clause,
 			   bool varonleft, bool isLTsel, Selectivity s2);
+static RelOptInfo *find_single_rel_for_clauses(PlannerInfo *root,
+							List *clauses);
 
 
 /****************************************************************************
@@ -86,6 +90,12 @@ static void addRangeClause(RangeQueryClause **rqlist, Node *clause,
  * A free side-effect is that we can recognize redundant inequalities such
  * as "x < 4 AND x < 5"; only the tighter constraint will be counted.
  *
+ * Before all that, if the clauses all reference a single base relation
+ * that has extended statistics (see CREATE STATISTICS), we let those
+ * statistics estimate whichever clauses they can, which accounts for
+ * correlations between the columns.  The clauses so estimated are then
+ * skipped below.
+ *
  * Of course this is all very dependent on the behavior of
  * scalarltsel/scalargtsel; perhaps some day we can generalize the approach.
  */
@@ -99,6 +109,9 @@ clauselist_selectivity(PlannerInfo *root,
 	Selectivity s1 = 1.0;
 	RangeQueryClause *rqlist = NULL;
 	ListCell   *l;
+	RelOptInfo *rel;
+	Bitmapset  *estimatedclauses = NULL;
+	int			listidx;
 
 	/*
 	 * If there's exactly one clause, then no use in trying to match up pairs,
@@ -108,17 +121,35 @@ clauselist_selectivity(PlannerInfo *root,
 		return clause_selectivity(root, (Node *) linitial(clauses),
 								  varRelid, jointype, sjinfo);
 
+	/*
+	 * If the clauses all reference a single base relation with extended
+	 * statistics, apply those first.  They mark the clauses they estimated
+	 * in estimatedclauses, so we don't count them again below.
+	 */
+	rel = find_single_rel_for_clauses(root, clauses);
+	if (rel && rel->rtekind == RTE_RELATION && rel->statlist != NIL)
+		s1 *= statext_clauselist_selectivity(root, clauses, varRelid,
+											 jointype, sjinfo, rel,
+											 &estimatedclauses);
+
 	/*
 	 * Initial scan over clauses.  Anything that doesn't look like a potential
 	 * rangequery clause gets multiplied into s1 and forgotten. Anything that
 	 * does gets inserted into an rqlist entry.
 	 */
+	listidx = -1;
 	foreach(l, clauses)
 	{
 		Node	   *clause = (Node *) lfirst(l);
 		RestrictInfo *rinfo;
 		Selectivity s2;
 
+		listidx++;
+
+		/* Skip clauses already estimated using extended statistics */
+		if (bms_is_member(listidx, estimatedclauses))
+			continue;
+
 		/* Always compute the selectivity using clause_selectivity */
 		s2 = clause_selectivity(root, clause, varRelid, jointype, sjinfo);
 
@@ -373,6 +404,52 @@ addRangeClause(RangeQueryClause **rqlist, Node *clause,
 	*rqlist = rqelem;
 }
 
+/*
+ * find_single_rel_for_clauses
+ *		Return the RelOptInfo of the single base relation referenced by all
+ *		the clauses, or NULL if there isn't exactly one.
+ *
+ * Pseudoconstant clauses reference no relation and are ignored.
+ */
+static RelOptInfo *
+find_single_rel_for_clauses(PlannerInfo *root, List *clauses)
+{
+	int			lastrelid = 0;
+	ListCell   *l;
+
+	foreach(l, clauses)
+	{
+		Node	   *clause = (Node *) lfirst(l);
+		Relids		relids;
+		int			relid;
+
+		if (IsA(clause, RestrictInfo))
+		{
+			RestrictInfo *rinfo = (RestrictInfo *) clause;
+
+			if (rinfo->pseudoconstant)
+				continue;
+			relids = rinfo->clause_relids;
+		}
+		else
+			relids = pull_varnos(clause);
+
+		if (!bms_get_singleton_member(relids, &relid))
+			return NULL;
+
+		if (lastrelid == 0)
+			lastrelid = relid;
+		else if (relid != lastrelid)
+			return NULL;
+	}
+
+	if (lastrelid == 0 || root->simple_rel_array == NULL ||
+		lastrelid >= root->simple_rel_array_size)
+		return NULL;
+
+	return root->simple_rel_array[lastrelid];
+}
+
 /*
  * bms_is_subset_singleton
  *
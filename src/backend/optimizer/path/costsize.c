@@ -115,6 +115,7 @@ bool		enable_sort = true;
 bool		enable_hashagg = true;
 bool		enable_nestloop = true;
 bool		enable_material = true;
+bool		enable_resultcache = true;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
 
@@ -125,6 +126,8 @@ typedef struct
 } cost_qual_eval_context;
 
 static List *extract_nonindex_conditions(List *qual_clauses, List *indexquals);
+static void cost_resultcache_rescan(PlannerInfo *root, ResultCachePath *rcpath,
+						Cost *rescan_startup_cost, Cost *rescan_total_cost);
 static MergeScanSelCache *cached_scansel(PlannerInfo *root,
 			   RestrictInfo *rinfo,
 			   PathKey *pathkey);
@@ -1557,6 +1560,28 @@ cost_material(Path *path,
 	path->total_cost = startup_cost + run_cost;
 }
 
+/*
+ * cost_resultcache
+ *	  Determines and returns the cost of the first scan of a ResultCache
+ *	  path, including the cost of its input.
+ *
+ * The first scan is always a cache miss, so we pay for the lookup and for
+ * storing each row on top of the input's cost.  The savings occur only on
+ * rescans; see cost_resultcache_rescan.
+ */
+void
+cost_resultcache(Path *path,
+				 Cost input_startup_cost, Cost input_total_cost,
+				 double tuples, int nkeys)
+{
+	Cost		lookup_cost = cpu_operator_cost * nkeys;
+
+	path->rows = tuples;
+	path->startup_cost = input_startup_cost + lookup_cost;
+	path->total_cost = input_total_cost + lookup_cost +
+		cpu_tuple_cost + cpu_operator_cost * tuples;
+}
+
 /*
  * cost_agg
  *		Determines and returns the cost of performing an Agg plan node,
@@ -2993,6 +3018,10 @@ cost_rescan(PlannerInfo *root, Path *path,
 				*rescan_total_cost = run_cost;
 			}
 			break;
+		case T_ResultCache:
+			cost_resultcache_rescan(root, (ResultCachePath *) path,
+									rescan_startup_cost, rescan_total_cost);
+			break;
 		case T_Material:
 		case T_Sort:
 			{
@@ -3027,6 +3056,79 @@ cost_rescan(PlannerInfo *root, Path *path,
 	}
 }
 
+/*
+ * cost_resultcache_rescan
+ *		Estimate the cost of rescanning a ResultCache path.
+ *
+ * Each rescan is either a cache hit, which returns the stored rows, or a
+ * miss, which rescans the subpath and stores its rows.  Of the expected
+ * number of rescans, one per distinct key value must miss; of the rest, we
+ * assume a fraction hit that depends on how many entries of the expected
+ * size fit in work_mem at once, as if the keys arrived in random order.
+ *
+ * As a side effect, this sets rcpath->est_entries, which the executor uses
+ * to size its hash table.
+ */
+static void
+cost_resultcache_rescan(PlannerInfo *root, ResultCachePath *rcpath,
+						Cost *rescan_startup_cost, Cost *rescan_total_cost)
+{
+	Path	   *subpath = rcpath->subpath;
+	double		tuples = subpath->rows;
+	double		calls = rcpath->calls;
+	int			nkeys = list_length(rcpath->param_exprs);
+	Cost		input_startup_cost;
+	Cost		input_total_cost;
+	double		ndistinct;
+	double		est_entry_bytes;
+	double		est_cache_entries;
+	double		cached_fraction;
+	double		hit_ratio;
+	Cost		startup_cost;
+	Cost		total_cost;
+
+	cost_rescan(root, subpath, &input_startup_cost, &input_total_cost);
+
+	/* Estimate the number of distinct keys from the outer rel's stats */
+	ndistinct = estimate_num_groups(root, rcpath->param_exprs, calls, NULL);
+	ndistinct = Min(ndistinct, calls);
+
+	/*
+	 * Each entry holds the rows of one scan, plus its keys and some
+	 * bookkeeping, for which we allow a rough 64 bytes.
+	 */
+	est_entry_bytes = relation_byte_size(tuples, subpath->parent->width) +
+		nkeys * sizeof(Datum) + 64;
+	est_cache_entries = floor(work_mem * 1024.0 / est_entry_bytes);
+
+	rcpath->est_entries = (uint32) Min(Min(ndistinct, est_cache_entries),
+									   PG_UINT32_MAX);
+
+	cached_fraction = Min(est_cache_entries, ndistinct) / ndistinct;
+	hit_ratio = ((calls - ndistinct) / calls) * cached_fraction;
+
+	/* Misses pay for rescanning the subpath */
+	startup_cost = input_startup_cost * (1.0 - hit_ratio);
+	total_cost = input_total_cost * (1.0 - hit_ratio);
+
+	/* Every rescan pays for hashing and comparing the keys */
+	startup_cost += cpu_operator_cost * nkeys;
+	total_cost += cpu_operator_cost * nkeys;
+
+	/* Hits pay for returning the stored rows */
+	total_cost += hit_ratio * cpu_operator_cost * tuples;
+
+	/*
+	 * Misses pay for creating an entry and storing the rows in it, and, if
+	 * not everything fits, for evicting an older entry.
+	 */
+	total_cost += (1.0 - hit_ratio) * (cpu_tuple_cost + cpu_operator_cost * tuples);
+	total_cost += (1.0 - cached_fraction) * cpu_tuple_cost;
+
+	*rescan_startup_cost = startup_cost;
+	*rescan_total_cost = total_cost;
+}
+
 
 /*
  * cost_qual_eval
@@ -18,9 +18,12 @@
 
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/restrictinfo.h"
+#include "utils/lsyscache.h"
 
 /* Hook for plugins to get control in add_paths_to_joinrel() */
 set_join_pathlist_hook_type set_join_pathlist_hook = NULL;
@@ -364,6 +367,123 @@ try_nestloop_path(PlannerInfo *root,
 	}
 }
 
+/*
+ * get_resultcache_path
+ *	  If possible, make a ResultCache path that caches the output of
+ *	  'inner_path', which is parameterized by the outer rel, across the
+ *	  rescans done by a nestloop driven by 'outer_path'.  Returns NULL if
+ *	  that isn't possible.  Whether it is worthwhile is up to the costing.
+ *
+ * The cache keys are the outer sides of the join clauses enforced by the
+ * inner path.  Each of those must be of the form "outer_expr = inner_expr"
+ * with a hashable equality operator taking the same type on both sides, so
+ * that the executor can use it to hash and compare outer values.  We also
+ * insist on a non-lateral base relation scan as the inner path, since then
+ * those clauses are the only way values from the outer rel can reach it.
+ */
+static Path *
+get_resultcache_path(PlannerInfo *root,
+					 RelOptInfo *innerrel,
+					 RelOptInfo *outerrel,
+					 Path *inner_path,
+					 Path *outer_path,
+					 JoinType jointype,
+					 JoinPathExtraData *extra)
+{
+	ParamPathInfo *param_info = inner_path->param_info;
+	List	   *param_exprs = NIL;
+	List	   *hash_operators = NIL;
+	bool		singlerow = false;
+	ListCell   *lc;
+
+	if (!enable_resultcache)
+		return NULL;
+
+	/* Nothing to gain unless the inner side will be rescanned */
+	if (outer_path->rows < 2)
+		return NULL;
+
+	if (param_info == NULL ||
+		param_info->ppi_clauses == NIL ||
+		!bms_is_subset(param_info->ppi_req_outer, outerrel->relids))
+		return NULL;
+
+	if (innerrel->reloptkind != RELOPT_BASEREL ||
+		!bms_is_empty(innerrel->lateral_relids))
+		return NULL;
+
+	/* Results depending on volatile functions mustn't be reused */
+	if (contain_volatile_functions((Node *) innerrel->reltargetlist))
+		return NULL;
+	foreach(lc, innerrel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+	}
+
+	/*
+	 * A semi or anti join only fetches the first matching inner row of each
+	 * scan.  If the inner path enforces all the join clauses, that's the
+	 * first row it returns, and we can treat a cache entry as complete after
+	 * one row.  Otherwise entries would never be complete, so don't bother.
+	 */
+	if (jointype == JOIN_SEMI || jointype == JOIN_ANTI)
+	{
+		Relids		inner_and_outer = bms_union(innerrel->relids,
+												param_info->ppi_req_outer);
+
+		foreach(lc, extra->restrictlist)
+		{
+			RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+			if (!join_clause_is_movable_into(rinfo,
+											 innerrel->relids,
+											 inner_and_outer))
+				return NULL;
+		}
+		singlerow = true;
+	}
+
+	foreach(lc, param_info->ppi_clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		OpExpr	   *opexpr;
+		Node	   *outer_expr;
+		Oid			lefttype;
+		Oid			righttype;
+
+		if (rinfo->pseudoconstant ||
+			!is_opclause(rinfo->clause) ||
+			list_length(((OpExpr *) rinfo->clause)->args) != 2 ||
+			contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+		opexpr = (OpExpr *) rinfo->clause;
+
+		if (bms_is_subset(rinfo->left_relids, outerrel->relids) &&
+			bms_is_subset(rinfo->right_relids, innerrel->relids))
+			outer_expr = (Node *) linitial(opexpr->args);
+		else if (bms_is_subset(rinfo->left_relids, innerrel->relids) &&
+				 bms_is_subset(rinfo->right_relids, outerrel->relids))
+			outer_expr = (Node *) lsecond(opexpr->args);
+		else
+			return NULL;
+
+		op_input_types(opexpr->opno, &lefttype, &righttype);
+		if (lefttype != righttype ||
+			!op_hashjoinable(opexpr->opno, lefttype))
+			return NULL;
+
+		param_exprs = lappend(param_exprs, outer_expr);
+		hash_operators = lappend_oid(hash_operators, opexpr->opno);
+	}
+
+	return (Path *) create_resultcache_path(root, innerrel, inner_path,
+											param_exprs, hash_operators,
+											singlerow, outer_path->rows);
+}
+
 /*
  * try_mergejoin_path
  *	  Consider a merge join path; if it appears useful, push it into
@@ -885,6 +1005,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *rcpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -893,6 +1014,22 @@ match_unsorted_outer(PlannerInfo *root,
 								  merge_pathkeys,
 								  jointype,
 								  extra);
+
+				/*
+				 * Also consider caching the inner path's output, in case the
+				 * outer path repeats the values it is parameterized by.
+				 */
+				rcpath = get_resultcache_path(root, innerrel, outerrel,
+											  innerpath, outerpath,
+											  jointype, extra);
+				if (rcpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  outerpath,
+									  rcpath,
+									  merge_pathkeys,
+									  jointype,
+									  extra);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
@@ -22,19 +22,31 @@
  */
 #include "postgres.h"
 
+#include "commands/trigger.h"
+#include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
 #include "optimizer/joininfo.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/planmain.h"
+#include "optimizer/restrictinfo.h"
 #include "optimizer/tlist.h"
 #include "utils/lsyscache.h"
 
+/* GUC parameter */
+bool		enable_fkey_join_removal = true;
+
 /* local functions */
 static bool join_is_removable(PlannerInfo *root, SpecialJoinInfo *sjinfo);
+static bool remove_fkey_joins(PlannerInfo *root, List **joinlist);
+static bool fkey_join_is_removable(PlannerInfo *root, RelOptInfo *fkrel,
+					   ForeignKeyOptInfo *fkinfo, RelOptInfo *refrel);
+static void remove_fkey_join(PlannerInfo *root, RelOptInfo *fkrel,
+				 ForeignKeyOptInfo *fkinfo, RelOptInfo *refrel);
 static void remove_rel_from_query(PlannerInfo *root, int relid,
 					  Relids joinrelids);
+static void remove_rel_references(PlannerInfo *root, int relid);
 static List *remove_rel_from_joinlist(List *joinlist, int relid, int *nremoved);
 static Oid	distinct_col_search(int colno, List *colnos, List *opids);
 
@@ -101,9 +113,372 @@ restart:
 		goto restart;
 	}
 
+	/*
+	 * Also look for inner joins that a foreign key proves useless.  Removing
+	 * one may make further left joins removable, so start over if we do.
+	 *
+	 * Foreign keys are enforced by AFTER triggers, so while any such events
+	 * are queued the constraint need not hold: a referenced row may already
+	 * be deleted with its RI action still pending, or a referencing row may
+	 * not have been checked yet.  Don't trust the constraint then.
+	 */
+	if (enable_fkey_join_removal && !AfterTriggerEventsPending() &&
+		remove_fkey_joins(root, &joinlist))
+		goto restart;
+
 	return joinlist;
 }
 
+/*
+ * remove_fkey_joins
+ *		Try to remove one inner join made redundant by a foreign key.
+ *
+ * If "fkrel" has a foreign key referencing the table scanned by "refrel",
+ * and the only thing the query does with refrel is to join it to fkrel on
+ * the foreign key columns, then the join produces exactly the fkrel rows
+ * whose foreign key columns are all non-null: the constraint guarantees at
+ * least one match, and the unique index underlying the referenced columns
+ * guarantees at most one.  We can therefore drop refrel and filter fkrel
+ * with IS NOT NULL tests instead.
+ *
+ * Returns true if a join was removed, in which case *joinlist is updated.
+ */
+static bool
+remove_fkey_joins(PlannerInfo *root, List **joinlist)
+{
+	Index		fkrti;
+
+	for (fkrti = 1; fkrti < root->simple_rel_array_size; fkrti++)
+	{
+		RelOptInfo *fkrel = root->simple_rel_array[fkrti];
+		ListCell   *lc;
+
+		if (fkrel == NULL || fkrel->reloptkind != RELOPT_BASEREL ||
+			fkrel->fkeylist == NIL)
+			continue;
+
+		foreach(lc, fkrel->fkeylist)
+		{
+			ForeignKeyOptInfo *fkinfo = (ForeignKeyOptInfo *) lfirst(lc);
+			Index		refrti;
+
+			for (refrti = 1; refrti < root->simple_rel_array_size; refrti++)
+			{
+				RelOptInfo *refrel = root->simple_rel_array[refrti];
+				int			nremoved;
+
+				if (refrel == NULL || refrel == fkrel ||
+					refrel->reloptkind != RELOPT_BASEREL ||
+					refrel->rtekind != RTE_RELATION ||
+					root->simple_rte_array[refrti]->relid != fkinfo->confrelid)
+					continue;
+
+				if (!fkey_join_is_removable(root, fkrel, fkinfo, refrel))
+					continue;
+
+				remove_fkey_join(root, fkrel, fkinfo, refrel);
+
+				/* The plan is only good while no RI checks are pending */
+				root->glob->dependsOnFKeys = true;
+
+				/* We verify that exactly one reference gets removed */
+				nremoved = 0;
+				*joinlist = remove_rel_from_joinlist(*joinlist, refrti,
+													 &nremoved);
+				if (nremoved != 1)
+					elog(ERROR, "failed to find relation %d in joinlist",
+						 refrti);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/*
+ * fkey_join_is_removable
+ *	  Check whether refrel is only inner-joined to fkrel on the columns of
+ *	  the foreign key described by fkinfo, and otherwise unused.
+ */
+static bool
+fkey_join_is_removable(PlannerInfo *root, RelOptInfo *fkrel,
+					   ForeignKeyOptInfo *fkinfo, RelOptInfo *refrel)
+{
+	int			fkrelid = fkrel->relid;
+	int			refrelid = refrel->relid;
+	RangeTblEntry *fkrte = root->simple_rte_array[fkrelid];
+	RangeTblEntry *refrte = root->simple_rte_array[refrelid];
+	Relids		joinrelids;
+	bool		matched[INDEX_MAX_KEYS];
+	ListCell   *l;
+	int			attroff;
+	int			i;
+
+	/*
+	 * The constraint says nothing about inheritance children of either
+	 * table, and a sampled or row-marked refrel can't be skipped.  Nor can
+	 * one that is filtered, since that would filter fkrel too.
+	 */
+	if (fkrte->inh || refrte->inh || refrte->tablesample != NULL ||
+		refrel->baserestrictinfo != NIL ||
+		!bms_is_empty(refrel->lateral_relids) ||
+		!bms_is_empty(refrel->lateral_referencers) ||
+		root->parse->resultRelation == refrelid)
+		return false;
+
+	foreach(l, root->rowMarks)
+	{
+		PlanRowMark *rc = (PlanRowMark *) lfirst(l);
+
+		if (rc->rti == refrelid)
+			return false;
+	}
+
+	/*
+	 * The join must be an inner join, meaning no outer join or semijoin may
+	 * separate the two rels.
+	 */
+	foreach(l, root->join_info_list)
+	{
+		SpecialJoinInfo *sjinfo = (SpecialJoinInfo *) lfirst(l);
+
+		if (bms_is_member(fkrelid, sjinfo->syn_lefthand) !=
+			bms_is_member(refrelid, sjinfo->syn_lefthand) ||
+			bms_is_member(fkrelid, sjinfo->syn_righthand) !=
+			bms_is_member(refrelid, sjinfo->syn_righthand))
+			return false;
+	}
+
+	/* No refrel attribute may be needed anywhere but in the join itself */
+	joinrelids = bms_make_singleton(fkrelid);
+	joinrelids = bms_add_member(joinrelids, refrelid);
+
+	for (attroff = refrel->max_attr - refrel->min_attr;
+		 attroff >= 0;
+		 attroff--)
+	{
+		if (!bms_is_subset(refrel->attr_needed[attroff], joinrelids))
+			return false;
+	}
+
+	/* Likewise refrel mustn't contribute to any PlaceHolderVar */
+	foreach(l, root->placeholder_list)
+	{
+		PlaceHolderInfo *phinfo = (PlaceHolderInfo *) lfirst(l);
+
+		if (bms_is_member(refrelid, phinfo->ph_eval_at) ||
+			bms_is_member(refrelid, phinfo->ph_lateral) ||
+			bms_is_member(refrelid,
+						  pull_varnos((Node *) phinfo->ph_var->phexpr)))
+			return false;
+	}
+
+	/*
+	 * Every join clause and equivalence involving refrel must be one of the
+	 * foreign key's equalities.  Note that we demand the plain Vars here; an
+	 * equality on some expression of the columns proves nothing.
+	 */
+	memset(matched, 0, sizeof(matched));
+
+	foreach(l, refrel->joininfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(l);
+		OpExpr	   *opexpr = (OpExpr *) rinfo->clause;
+		Var		   *fkvar;
+		Var		   *refvar;
+
+		if (!bms_equal(rinfo->required_relids, joinrelids) ||
+			rinfo->outerjoin_delayed ||
+			!is_opclause(opexpr) || list_length(opexpr->args) != 2)
+			return false;
+
+		fkvar = (Var *) linitial(opexpr->args);
+		refvar = (Var *) lsecond(opexpr->args);
+		if (IsA(fkvar, Var) && fkvar->varno == refrelid)
+		{
+			Var		   *tmp = fkvar;
+
+			fkvar = refvar;
+			refvar = tmp;
+		}
+		if (!IsA(fkvar, Var) || fkvar->varno != fkrelid ||
+			!IsA(refvar, Var) || refvar->varno != refrelid)
+			return false;
+
+		for (i = 0; i < fkinfo->nkeys; i++)
+		{
+			if (fkvar->varattno == fkinfo->conkey[i] &&
+				refvar->varattno == fkinfo->confkey[i] &&
+				(opexpr->opno == fkinfo->conpfeqop[i] ||
+				 opexpr->opno == get_commutator(fkinfo->conpfeqop[i])))
+				break;
+		}
+		if (i >= fkinfo->nkeys)
+			return false;
+		matched[i] = true;
+	}
+
+	foreach(l, root->eq_classes)
+	{
+		EquivalenceClass *ec = (EquivalenceClass *) lfirst(l);
+		Var		   *refvar = NULL;
+		ListCell   *lc;
+
+		if (!bms_is_member(refrelid, ec->ec_relids))
+			continue;
+
+		if (ec->ec_has_const || ec->ec_has_volatile || ec->ec_broken)
+			return false;
+
+		foreach(lc, ec->ec_members)
+		{
+			EquivalenceMember *em = (EquivalenceMember *) lfirst(lc);
+
+			if (em->em_is_child || !bms_is_member(refrelid, em->em_relids))
+				continue;
+			if (refvar != NULL || !IsA(em->em_expr, Var) ||
+				((Var *) em->em_expr)->varno != refrelid)
+				return false;
+			refvar = (Var *) em->em_expr;
+		}
+		if (refvar == NULL)
+			return false;
+
+		for (i = 0; i < fkinfo->nkeys; i++)
+		{
+			if (refvar->varattno == fkinfo->confkey[i])
+				break;
+		}
+		if (i >= fkinfo->nkeys ||
+			!equal(ec->ec_opfamilies,
+				   get_mergejoin_opfamilies(fkinfo->conpfeqop[i])))
+			return false;
+
+		/* The class must also equate the matching referencing column */
+		foreach(lc, ec->ec_members)
+		{
+			EquivalenceMember *em = (EquivalenceMember *) lfirst(lc);
+			Var		   *fkvar = (Var *) em->em_expr;
+
+			if (!em->em_is_child && IsA(fkvar, Var) &&
+				fkvar->varno == fkrelid &&
+				fkvar->varattno == fkinfo->conkey[i])
+				break;
+		}
+		if (lc == NULL)
+			return false;
+		matched[i] = true;
+	}
+
+	for (i = 0; i < fkinfo->nkeys; i++)
+	{
+		if (!matched[i])
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * remove_fkey_join
+ *	  Remove refrel, which fkey_join_is_removable has approved, from the
+ *	  planner's data structures, and filter out the fkrel rows the join
+ *	  would have rejected.
+ */
+static void
+remove_fkey_join(PlannerInfo *root, RelOptInfo *fkrel,
+				 ForeignKeyOptInfo *fkinfo, RelOptInfo *refrel)
+{
+	int			refrelid = refrel->relid;
+	Oid			fkreloid = root->simple_rte_array[fkrel->relid]->relid;
+	List	   *joininfos;
+	ListCell   *l;
+	int			i;
+
+	remove_rel_references(root, refrelid);
+
+	/* The join clauses are all implied by the constraint, so drop them */
+	joininfos = list_copy(refrel->joininfo);
+	foreach(l, joininfos)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(l);
+
+		remove_join_clause_from_rels(root, rinfo, rinfo->required_relids);
+	}
+
+	/* Likewise forget refrel's members of equivalence classes */
+	foreach(l, root->eq_classes)
+	{
+		EquivalenceClass *ec = (EquivalenceClass *) lfirst(l);
+		ListCell   *lc;
+		ListCell   *next;
+
+		if (!bms_is_member(refrelid, ec->ec_relids))
+			continue;
+
+		for (lc = list_head(ec->ec_members); lc != NULL; lc = next)
+		{
+			EquivalenceMember *em = (EquivalenceMember *) lfirst(lc);
+
+			next = lnext(lc);
+			if (bms_is_member(refrelid, em->em_relids))
+				ec->ec_members = list_delete_ptr(ec->ec_members, em);
+		}
+		for (lc = list_head(ec->ec_sources); lc != NULL; lc = next)
+		{
+			RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+			next = lnext(lc);
+			if (bms_is_member(refrelid, rinfo->clause_relids))
+				ec->ec_sources = list_delete_ptr(ec->ec_sources, rinfo);
+		}
+		for (lc = list_head(ec->ec_derives); lc != NULL; lc = next)
+		{
+			RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+			next = lnext(lc);
+			if (bms_is_member(refrelid, rinfo->clause_relids))
+				ec->ec_derives = list_delete_ptr(ec->ec_derives, rinfo);
+		}
+		ec->ec_relids = bms_del_member(ec->ec_relids, refrelid);
+	}
+
+	/*
+	 * The join's strict equalities rejected fkrel rows having a null in any
+	 * foreign key column, so we must now do that explicitly.
+	 */
+	for (i = 0; i < fkinfo->nkeys; i++)
+	{
+		AttrNumber	attno = fkinfo->conkey[i];
+		NullTest   *ntest;
+		Oid			typid;
+		int32		typmod;
+		Oid			collid;
+
+		if (get_attnotnull(fkreloid, attno))
+			continue;
+
+		get_atttypetypmodcoll(fkreloid, attno, &typid, &typmod, &collid);
+
+		ntest = makeNode(NullTest);
+		ntest->arg = (Expr *) makeVar(fkrel->relid, attno,
+									  typid, typmod, collid, 0);
+		ntest->nulltesttype = IS_NOT_NULL;
+		ntest->argisrow = false;
+		ntest->location = -1;
+
+		distribute_restrictinfo_to_rels(root,
+										make_restrictinfo((Expr *) ntest,
+														  true,
+														  false,
+														  false,
+														  fkrel->relids,
+														  NULL,
+														  NULL));
+	}
+}
+
 /*
  * clause_sides_match_join
  *	  Determine whether a join clause is of the right form to use in this join.
@@ -384,6 +759,58 @@ remove_rel_from_query(PlannerInfo *root, int relid, Relids joinrelids)
 {
 	RelOptInfo *rel = find_base_rel(root, relid);
 	List	   *joininfos;
+	ListCell   *l;
+
+	remove_rel_references(root, relid);
+
+	/*
+	 * Remove any joinquals referencing the rel from the joininfo lists.
+	 *
+	 * In some cases, a joinqual has to be put back after deleting its
+	 * reference to the target rel.  This can occur for pseudoconstant and
+	 * outerjoin-delayed quals, which can get marked as requiring the rel in
+	 * order to force them to be evaluated at or above the join.  We can't
+	 * just discard them, though.  Only quals that logically belonged to the
+	 * outer join being discarded should be removed from the query.
+	 *
+	 * We must make a copy of the rel's old joininfo list before starting the
+	 * loop, because otherwise remove_join_clause_from_rels would destroy the
+	 * list while we're scanning it.
+	 */
+	joininfos = list_copy(rel->joininfo);
+	foreach(l, joininfos)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(l);
+
+		remove_join_clause_from_rels(root, rinfo, rinfo->required_relids);
+
+		if (rinfo->is_pushed_down ||
+			!bms_equal(rinfo->required_relids, joinrelids))
+		{
+			/* Recheck that qual doesn't actually reference the target rel */
+			Assert(!bms_is_member(relid, rinfo->clause_relids));
+
+			/*
+			 * The required_relids probably aren't shared with anything else,
+			 * but let's copy them just to be sure.
+			 */
+			rinfo->required_relids = bms_copy(rinfo->required_relids);
+			rinfo->required_relids = bms_del_member(rinfo->required_relids,
+													relid);
+			distribute_restrictinfo_to_rels(root, rinfo);
+		}
+	}
+}
+
+/*
+ * Mark the target rel dead and remove references to it from other baserels'
+ * attr_needed arrays and from the join, lateral and placeholder bookkeeping.
+ * Join clauses mentioning the rel are the caller's responsibility.
+ */
+static void
+remove_rel_references(PlannerInfo *root, int relid)
+{
+	RelOptInfo *rel = find_base_rel(root, relid);
 	Index		rti;
 	ListCell   *l;
 	ListCell   *nextl;
@@ -475,44 +902,6 @@ remove_rel_from_query(PlannerInfo *root, int relid, Relids joinrelids)
 		Assert(!bms_is_member(relid, phinfo->ph_lateral));
 		phinfo->ph_needed = bms_del_member(phinfo->ph_needed, relid);
 	}
-
-	/*
-	 * Remove any joinquals referencing the rel from the joininfo lists.
-	 *
-	 * In some cases, a joinqual has to be put back after deleting its
-	 * reference to the target rel.  This can occur for pseudoconstant and
-	 * outerjoin-delayed quals, which can get marked as requiring the rel in
-	 * order to force them to be evaluated at or above the join.  We can't
-	 * just discard them, though.  Only quals that logically belonged to the
-	 * outer join being discarded should be removed from the query.
-	 *
-	 * We must make a copy of the rel's old joininfo list before starting the
-	 * loop, because otherwise remove_join_clause_from_rels would destroy the
-	 * list while we're scanning it.
-	 */
-	joininfos = list_copy(rel->joininfo);
-	foreach(l, joininfos)
-	{
-		RestrictInfo *rinfo = (RestrictInfo *) lfirst(l);
-
-		remove_join_clause_from_rels(root, rinfo, rinfo->required_relids);
-
-		if (rinfo->is_pushed_down ||
-			!bms_equal(rinfo->required_relids, joinrelids))
-		{
-			/* Recheck that qual doesn't actually reference the target rel */
-			Assert(!bms_is_member(relid, rinfo->clause_relids));
-
-			/*
-			 * The required_relids probably aren't shared with anything else,
-			 * but let's copy them just to be sure.
-			 */
-			rinfo->required_relids = bms_copy(rinfo->required_relids);
-			rinfo->required_relids = bms_del_member(rinfo->required_relids,
-													relid);
-			distribute_restrictinfo_to_rels(root, rinfo);
-		}
-	}
 }
 
 /*
@@ -19,6 +19,7 @@
 #include <limits.h>
 #include <math.h>
 
+#include "access/heapam.h"
 #include "access/stratnum.h"
 #include "access/sysattr.h"
 #include "catalog/pg_class.h"
@@ -42,6 +43,7 @@
 #include "parser/parse_clause.h"
 #include "parser/parsetree.h"
 #include "utils/lsyscache.h"
+#include "utils/rel.h"
 
 
 static Plan *create_plan_recurse(PlannerInfo *root, Path *best_path);
@@ -52,9 +54,13 @@ static void disuse_physical_tlist(PlannerInfo *root, Plan *plan, Path *path);
 static Plan *create_gating_plan(PlannerInfo *root, Plan *plan, List *quals);
 static Plan *create_join_plan(PlannerInfo *root, JoinPath *best_path);
 static Plan *create_append_plan(PlannerInfo *root, AppendPath *best_path);
+static void set_append_partition_pruning(PlannerInfo *root, Append *plan,
+							 AppendPath *best_path);
 static Plan *create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path);
 static Result *create_result_plan(PlannerInfo *root, ResultPath *best_path);
 static Material *create_material_plan(PlannerInfo *root, MaterialPath *best_path);
+static ResultCache *create_resultcache_plan(PlannerInfo *root,
+						ResultCachePath *best_path);
 static Plan *create_unique_plan(PlannerInfo *root, UniquePath *best_path);
 static SeqScan *create_seqscan_plan(PlannerInfo *root, Path *best_path,
 					List *tlist, List *scan_clauses);
@@ -98,6 +104,8 @@ static List *fix_indexqual_references(PlannerInfo *root, IndexPath *index_path);
 static List *fix_indexorderby_references(PlannerInfo *root, IndexPath *index_path);
 static Node *fix_indexqual_operand(Node *node, IndexOptInfo *index, int indexcol);
 static List *get_switched_clauses(List *clauses, Relids outerrelids);
+static List *get_nestloop_hashclauses(NestPath *best_path,
+						 Relids outerrelids);
 static List *order_qual_clauses(PlannerInfo *root, List *clauses);
 static void copy_path_costsize(Plan *dest, Path *src);
 static void copy_plan_costsize(Plan *dest, Plan *src);
@@ -135,6 +143,7 @@ static BitmapAnd *make_bitmap_and(List *bitmapplans);
 static BitmapOr *make_bitmap_or(List *bitmapplans);
 static NestLoop *make_nestloop(List *tlist,
 			  List *joinclauses, List *otherclauses, List *nestParams,
+			  List *hashclauses,
 			  Plan *lefttree, Plan *righttree,
 			  JoinType jointype);
 static HashJoin *make_hashjoin(List *tlist,
@@ -175,6 +184,9 @@ static EquivalenceMember *find_ec_member_for_tle(EquivalenceClass *ec,
 					   TargetEntry *tle,
 					   Relids relids);
 static Material *make_material(Plan *lefttree);
+static ResultCache *make_resultcache(Plan *lefttree, int numKeys,
+				 Oid *hashOperators, Oid *collations,
+				 List *param_exprs, bool singlerow, uint32 est_entries);
 
 
 /*
@@ -268,6 +280,10 @@ create_plan_recurse(PlannerInfo *root, Path *best_path)
 			plan = (Plan *) create_material_plan(root,
 												 (MaterialPath *) best_path);
 			break;
+		case T_ResultCache:
+			plan = (Plan *) create_resultcache_plan(root,
+												(ResultCachePath *) best_path);
+			break;
 		case T_Unique:
 			plan = create_unique_plan(root,
 									  (UniquePath *) best_path);
@@ -744,9 +760,93 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path)
 
 	plan = make_append(subplans, tlist);
 
+	/* Let the executor prune children, if we can't do it all here */
+	set_append_partition_pruning(root, plan, best_path);
+
 	return (Plan *) plan;
 }
 
+/*
+ * set_append_partition_pruning
+ *	  Set up run-time partition pruning for an Append of the children of an
+ *	  inheritance parent.
+ *
+ * set_append_rel_size already skipped the children ruled out by conditions
+ * comparing the partition key with constants.  If there are also conditions
+ * comparing it with expressions whose value is fixed during a scan, such as
+ * parameters or stable functions, pass them to the executor so it can skip
+ * more children once the values are known.
+ */
+static void
+set_append_partition_pruning(PlannerInfo *root, Append *plan,
+							 AppendPath *best_path)
+{
+	RelOptInfo *rel = best_path->path.parent;
+	RangeTblEntry *rte;
+	Relation	parentrel;
+	PartitionBoundInfo *bounds;
+	List	   *strategies = NIL;
+	List	   *exprs = NIL;
+	bool		have_runtime = false;
+	ListCell   *lc;
+
+	if (rel->reloptkind != RELOPT_BASEREL ||
+		constraint_exclusion == CONSTRAINT_EXCLUSION_OFF)
+		return;
+	rte = planner_rt_fetch(rel->relid, root);
+	if (rte->rtekind != RTE_RELATION || !rte->inh)
+		return;
+
+	/* We assume the parent is already locked */
+	parentrel = heap_open(rte->relid, NoLock);
+
+	bounds = RelationGetPartitionBounds(parentrel);
+	if (bounds)
+	{
+		foreach(lc, rel->baserestrictinfo)
+		{
+			RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+			int			strategy;
+			Expr	   *value;
+			bool		is_array;
+
+			if (!partition_match_clause(bounds, rel->relid, rinfo->clause,
+										&strategy, &value, &is_array) ||
+				is_array)
+				continue;
+
+			if (!IsA(value, Const))
+			{
+				if (contain_var_clause((Node *) value) ||
+					contain_volatile_functions((Node *) value) ||
+					contain_subplans((Node *) value))
+					continue;
+				have_runtime = true;
+			}
+
+			strategies = lappend_int(strategies, strategy);
+			exprs = lappend(exprs, copyObject(value));
+		}
+	}
+
+	heap_close(parentrel, NoLock);
+
+	if (!have_runtime)
+		return;
+
+	plan->part_relid = rte->relid;
+	plan->part_strategies = strategies;
+	plan->part_exprs = exprs;
+	foreach(lc, best_path->subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(lc);
+
+		plan->part_child_oids =
+			lappend_oid(plan->part_child_oids,
+						planner_rt_fetch(subpath->parent->relid, root)->relid);
+	}
+}
+
 /*
  * create_merge_append_plan
  *	  Create a MergeAppend plan for 'best_path' and (recursively) plans
@@ -897,6 +997,59 @@ create_material_plan(PlannerInfo *root, MaterialPath *best_path)
 	return plan;
 }
 
+/*
+ * create_resultcache_plan
+ *	  Create a ResultCache plan for 'best_path' and (recursively) plans
+ *	  for its subpaths.
+ *
+ *	  Returns a Plan node.
+ */
+static ResultCache *
+create_resultcache_plan(PlannerInfo *root, ResultCachePath *best_path)
+{
+	ResultCache *plan;
+	Plan	   *subplan;
+	List	   *param_exprs;
+	Oid		   *operators;
+	Oid		   *collations;
+	int			nkeys;
+	int			i;
+	ListCell   *lc;
+	ListCell   *lc2;
+
+	subplan = create_plan_recurse(root, best_path->subpath);
+
+	/* We don't want any excess columns in the cached tuples */
+	disuse_physical_tlist(root, subplan, best_path->subpath);
+
+	/*
+	 * The cache keys are outer-relation expressions; evaluate them from the
+	 * same nestloop params the subplan uses.
+	 */
+	param_exprs = (List *) replace_nestloop_params(root,
+											(Node *) best_path->param_exprs);
+
+	nkeys = list_length(param_exprs);
+	operators = (Oid *) palloc(nkeys * sizeof(Oid));
+	collations = (Oid *) palloc(nkeys * sizeof(Oid));
+
+	i = 0;
+	forboth(lc, param_exprs, lc2, best_path->hash_operators)
+	{
+		operators[i] = lfirst_oid(lc2);
+		collations[i] = exprCollation((Node *) lfirst(lc));
+		i++;
+	}
+
+	plan = make_resultcache(subplan, nkeys, operators, collations,
+							param_exprs, best_path->singlerow,
+							best_path->est_entries);
+
+	copy_path_costsize(&plan->plan, (Path *) best_path);
+
+	return plan;
+}
+
 /*
  * create_unique_plan
  *	  Create a Unique plan for 'best_path' and (recursively) plans
@@ -2234,6 +2387,7 @@ create_nestloop_plan(PlannerInfo *root,
 	List	   *otherclauses;
 	Relids		outerrelids;
 	List	   *nestParams;
+	List	   *hashclauses;
 	ListCell   *cell;
 	ListCell   *prev;
 	ListCell   *next;
@@ -2299,10 +2453,29 @@ create_nestloop_plan(PlannerInfo *root,
 			prev = cell;
 	}
 
+	/*
+	 * If the inner side doesn't depend on the outer one, the executor can
+	 * switch to hashing the inner relation once the outer relation turns out
+	 * to be much larger than estimated.  Give it the hashable join clauses,
+	 * commuted so that the outer side is on the left.  They remain part of
+	 * the join quals, too.  This doesn't depend on enable_hashjoin, which
+	 * only steers the choice of join method; the executor checks
+	 * adaptive_nestloop_factor.
+	 */
+	hashclauses = NIL;
+	if (nestParams == NIL)
+	{
+		hashclauses = get_nestloop_hashclauses(best_path, outerrelids);
+		if (best_path->path.param_info)
+			hashclauses = (List *)
+				replace_nestloop_params(root, (Node *) hashclauses);
+	}
+
 	join_plan = make_nestloop(tlist,
 							  joinclauses,
 							  otherclauses,
 							  nestParams,
+							  hashclauses,
 							  outer_plan,
 							  inner_plan,
 							  best_path->jointype);
@@ -3275,6 +3448,48 @@ get_switched_clauses(List *clauses, Relids outerrelids)
 	return t_list;
 }
 
+/*
+ * get_nestloop_hashclauses
+ *	  Find the join clauses of a nestloop that a hash join could use as hash
+ *	  clauses, and return them commuted so that the outer side is on the left
+ *	  (see get_switched_clauses).
+ *
+ * The tests are the same ones hash_inner_and_outer applies when considering
+ * hash join paths for the same pair of relations.
+ */
+static List *
+get_nestloop_hashclauses(NestPath *best_path, Relids outerrelids)
+{
+	Relids		innerrelids = best_path->innerjoinpath->parent->relids;
+	bool		isouterjoin = IS_OUTER_JOIN(best_path->jointype);
+	List	   *hashclauses = NIL;
+	ListCell   *lc;
+
+	foreach(lc, best_path->joinrestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		/* for an outer join, only its own join clauses can be used */
+		if (isouterjoin && rinfo->is_pushed_down)
+			continue;
+
+		if (!rinfo->can_join ||
+			rinfo->hashjoinoperator == InvalidOid)
+			continue;			/* not hashjoinable */
+
+		/* the clause must have the form "outer op inner" or vice versa */
+		if (!((bms_is_subset(rinfo->left_relids, outerrelids) &&
+			   bms_is_subset(rinfo->right_relids, innerrelids)) ||
+			  (bms_is_subset(rinfo->left_relids, innerrelids) &&
+			   bms_is_subset(rinfo->right_relids, outerrelids))))
+			continue;
+
+		hashclauses = lappend(hashclauses, rinfo);
+	}
+
+	return get_switched_clauses(hashclauses, outerrelids);
+}
+
 /*
  * order_qual_clauses
  *		Given a list of qual clauses that will all be evaluated at the same
@@ -3854,6 +4069,7 @@ make_nestloop(List *tlist,
 			  List *joinclauses,
 			  List *otherclauses,
 			  List *nestParams,
+			  List *hashclauses,
 			  Plan *lefttree,
 			  Plan *righttree,
 			  JoinType jointype)
@@ -3869,6 +4085,7 @@ make_nestloop(List *tlist,
 	node->join.jointype = jointype;
 	node->join.joinqual = joinclauses;
 	node->nestParams = nestParams;
+	node->hashclauses = hashclauses;
 
 	return node;
 }
@@ -4459,6 +4676,30 @@ make_material(Plan *lefttree)
 	return node;
 }
 
+static ResultCache *
+make_resultcache(Plan *lefttree, int numKeys,
+				 Oid *hashOperators, Oid *collations,
+				 List *param_exprs, bool singlerow, uint32 est_entries)
+{
+	ResultCache *node = makeNode(ResultCache);
+	Plan	   *plan = &node->plan;
+
+	/* cost should be inserted by caller */
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+
+	node->numKeys = numKeys;
+	node->hashOperators = hashOperators;
+	node->collations = collations;
+	node->param_exprs = param_exprs;
+	node->singlerow = singlerow;
+	node->est_entries = est_entries;
+
+	return node;
+}
+
 /*
  * materialize_finished_plan: stick a Material node atop a completed plan
  *
@@ -5101,6 +5342,7 @@ is_projection_capable_plan(Plan *plan)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_ResultCache:
 		case T_Sort:
 		case T_Unique:
 		case T_SetOp:
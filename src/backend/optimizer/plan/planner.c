@@ -37,6 +37,7 @@
 #include "optimizer/planmain.h"
 #include "optimizer/planner.h"
 #include "optimizer/prep.h"
+#include "optimizer/restrictinfo.h"
 #include "optimizer/subselect.h"
 #include "optimizer/tlist.h"
 #include "parser/analyze.h"
@@ -77,7 +78,15 @@ typedef struct
 /* Local functions */
 static Node *preprocess_expression(PlannerInfo *root, Node *expr, int kind);
 static void preprocess_qual_conditions(PlannerInfo *root, Node *jtnode);
+static Plan *plan_subquery(PlannerGlobal *glob, Query *parse,
+			  PlannerInfo *parent_root,
+			  bool hasRecursion, double tuple_fraction,
+			  PlannerInfo **subroot);
 static Plan *inheritance_planner(PlannerInfo *root);
+static bool inherited_target_is_excluded(PlannerInfo *root,
+							 AppendRelInfo *appinfo);
+static Query *adjust_inherited_query(PlannerInfo *root, Query *parse,
+					   AppendRelInfo *appinfo);
 static Plan *grouping_planner(PlannerInfo *root, double tuple_fraction);
 static void preprocess_rowmarks(PlannerInfo *root);
 static double preprocess_limit(PlannerInfo *root,
@@ -195,6 +204,7 @@ standard_planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	glob->lastPHId = 0;
 	glob->lastRowMarkId = 0;
 	glob->transientPlan = false;
+	glob->dependsOnFKeys = false;
 	glob->hasRowSecurity = false;
 
 	/* Determine what fraction of the plan is likely to be scanned */
@@ -263,6 +273,7 @@ standard_planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	result->hasModifyingCTE = parse->hasModifyingCTE;
 	result->canSetTag = parse->canSetTag;
 	result->transientPlan = glob->transientPlan;
+	result->dependsOnFKeys = glob->dependsOnFKeys;
 	result->planTree = top_plan;
 	result->rtable = glob->finalrtable;
 	result->resultRelations = glob->resultRelations;
@@ -311,6 +322,53 @@ subquery_planner(PlannerGlobal *glob, Query *parse,
 				 PlannerInfo *parent_root,
 				 bool hasRecursion, double tuple_fraction,
 				 PlannerInfo **subroot)
+{
+	Query	   *eager_parse = NULL;
+	PlannerInfo *eager_root;
+	PlannerInfo *root;
+	Plan	   *eager_plan;
+	Plan	   *plan;
+
+	/*
+	 * If the query aggregates over a join, see whether its aggregates could
+	 * be partially computed before the join instead (see prepagg.c).  That
+	 * pays off only if the early grouping reduces the number of rows to be
+	 * joined enough, so plan the query both ways and keep the cheaper plan.
+	 */
+	if (eager_aggregate && !hasRecursion)
+		eager_parse = build_eager_agg_query(parse);
+
+	if (eager_parse == NULL)
+		return plan_subquery(glob, parse, parent_root,
+							 hasRecursion, tuple_fraction, subroot);
+
+	eager_plan = plan_subquery(glob, eager_parse, parent_root,
+							   hasRecursion, tuple_fraction, &eager_root);
+	plan = plan_subquery(glob, parse, parent_root,
+						 hasRecursion, tuple_fraction, &root);
+
+	if (eager_plan->total_cost < plan->total_cost)
+	{
+		plan = eager_plan;
+		root = eager_root;
+	}
+
+	/* Return internal info if caller wants it */
+	if (subroot)
+		*subroot = root;
+
+	return plan;
+}
+
+/*
+ * plan_subquery
+ *	  Workhorse for subquery_planner: plan one version of the Query.
+ */
+static Plan *
+plan_subquery(PlannerGlobal *glob, Query *parse,
+			  PlannerInfo *parent_root,
+			  bool hasRecursion, double tuple_fraction,
+			  PlannerInfo **subroot)
 {
 	int			num_old_subplans = list_length(glob->subplans);
 	PlannerInfo *root;
@@ -605,6 +663,14 @@ subquery_planner(PlannerGlobal *glob, Query *parse,
 	if (hasOuterJoins)
 		reduce_outer_joins(root);
 
+	/*
+	 * Merge self-joins on unique keys.  Like reduce_outer_joins, this needs
+	 * preprocessed quals; and running after it lets us see inner joins that
+	 * it has just created.
+	 */
+	if (enable_self_join_removal)
+		remove_useless_self_joins(root);
+
 	/*
 	 * Do the main planning.  If we have an inherited target relation, that
 	 * needs special processing, else go straight to grouping_planner.
@@ -827,6 +893,12 @@ preprocess_phv_expression(PlannerInfo *root, Expr *expr)
  * the UPDATE/DELETE target can never be the nullable side of an outer join,
  * so it's OK to generate the plan this way.
  *
+ * Each child that survives constraint exclusion is still planned in full,
+ * with its own copy of the Query, and each of those plannings sets up
+ * arrays covering the whole rangetable; so the time taken remains quadratic
+ * in the number of children that are actually updated.  We only make sure
+ * that children ruled out by the WHERE clause cost next to nothing.
+ *
  * Returns a query plan.
  */
 static Plan *
@@ -939,6 +1011,19 @@ inheritance_planner(PlannerInfo *root)
 		if (appinfo->parent_relid != parentRTindex)
 			continue;
 
+		/*
+		 * If the WHERE clause alone shows that constraint exclusion will rule
+		 * this child out, skip it without building and planning its Query.
+		 * The first child still becomes the nominal target, though; see
+		 * below.
+		 */
+		if (inherited_target_is_excluded(root, appinfo))
+		{
+			if (nominalRelation < 0)
+				nominalRelation = appinfo->child_relid;
+			continue;
+		}
+
 		/*
 		 * We need a working copy of the PlannerInfo so that we can control
 		 * propagation of information back to the main copy.
@@ -951,10 +1036,7 @@ inheritance_planner(PlannerInfo *root)
 		 * references to the parent RTE to refer to the current child RTE,
 		 * then fool around with subquery RTEs.
 		 */
-		subroot.parse = (Query *)
-			adjust_appendrel_attrs(root,
-								   (Node *) parse,
-								   appinfo);
+		subroot.parse = adjust_inherited_query(root, parse, appinfo);
 
 		/*
 		 * The rowMarks list might contain references to subquery RTEs, so
@@ -1224,6 +1306,121 @@ inheritance_planner(PlannerInfo *root)
 									 SS_assign_special_param(root));
 }
 
+/*
+ * inherited_target_is_excluded
+ *	  Check whether constraint exclusion is sure to rule out a member of the
+ *	  inheritance set that is an UPDATE or DELETE target.
+ *
+ * grouping_planner would find out by itself, but only after we've made a
+ * copy of the Query for the child and gone through most of planning.  We
+ * can detect the same thing much more cheaply for the common case that
+ * WHERE restricts the target directly, by translating just those quals and
+ * applying relation_excluded_by_constraints to a stub RelOptInfo.  (That
+ * looks at nothing but the fields we fill in.)  Restrictions that are only
+ * implied through equivalence classes are left for the full check.
+ */
+static bool
+inherited_target_is_excluded(PlannerInfo *root, AppendRelInfo *appinfo)
+{
+	Query	   *parse = root->parse;
+	RangeTblEntry *childrte;
+	RelOptInfo *childrel;
+	Relids		childrelids;
+	List	   *childquals;
+	List	   *restrictinfos = NIL;
+	ListCell   *lc;
+
+	if (constraint_exclusion == CONSTRAINT_EXCLUSION_OFF ||
+		parse->jointree->quals == NULL)
+		return false;
+
+	childrte = rt_fetch(appinfo->child_relid, parse->rtable);
+	if (childrte->rtekind != RTE_RELATION || childrte->securityQuals != NIL)
+		return false;
+
+	childrelids = bms_make_singleton(appinfo->child_relid);
+	childquals = (List *) adjust_appendrel_attrs(root,
+												 parse->jointree->quals,
+												 appinfo);
+	foreach(lc, childquals)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+
+		if (bms_equal(pull_varnos((Node *) clause), childrelids))
+			restrictinfos = lappend(restrictinfos,
+									make_simple_restrictinfo(clause));
+	}
+	if (restrictinfos == NIL)
+		return false;
+
+	childrel = makeNode(RelOptInfo);
+	childrel->reloptkind = RELOPT_OTHER_MEMBER_REL;
+	childrel->relids = childrelids;
+	childrel->relid = appinfo->child_relid;
+	childrel->rtekind = RTE_RELATION;
+	childrel->baserestrictinfo = restrictinfos;
+
+	return relation_excluded_by_constraints(root, childrel, childrte);
+}
+
+/*
+ * adjust_inherited_query
+ *	  Make a copy of the Query for one member of an inherited target.
+ *
+ * This is adjust_appendrel_attrs, except that plain relation RTEs are shared
+ * with the original Query rather than copied.  They can't contain
+ * references to the parent, and planning doesn't modify them, whereas
+ * copying the whole rangetable -- which has an entry per child -- for each
+ * child would take O(N^2) time and space.  RTEs that have security barrier
+ * quals are copied, since planning turns those into subqueries.
+ */
+static Query *
+adjust_inherited_query(PlannerInfo *root, Query *parse,
+					   AppendRelInfo *appinfo)
+{
+	List	   *rtable = parse->rtable;
+	List	   *copyrtes = NIL;
+	List	   *newrtable = NIL;
+	Query	   *result;
+	ListCell   *lc;
+	ListCell   *copylc;
+
+	foreach(lc, rtable)
+	{
+		RangeTblEntry *rte = (RangeTblEntry *) lfirst(lc);
+
+		if (rte->rtekind != RTE_RELATION || rte->securityQuals != NIL)
+			copyrtes = lappend(copyrtes, rte);
+	}
+
+	/*
+	 * Let adjust_appendrel_attrs see only the RTEs to be copied.  Since
+	 * Vars carry their own RT indexes, it doesn't matter that their
+	 * positions in the list aren't the real ones.
+	 */
+	parse->rtable = copyrtes;
+	result = (Query *) adjust_appendrel_attrs(root, (Node *) parse, appinfo);
+	parse->rtable = rtable;
+
+	/* Now merge the copies back into a complete rangetable */
+	copylc = list_head(result->rtable);
+	foreach(lc, rtable)
+	{
+		RangeTblEntry *rte = (RangeTblEntry *) lfirst(lc);
+
+		if (rte->rtekind != RTE_RELATION || rte->securityQuals != NIL)
+		{
+			newrtable = lappend(newrtable, lfirst(copylc));
+			copylc = lnext(copylc);
+		}
+		else
+			newrtable = lappend(newrtable, rte);
+	}
+	result->rtable = newrtable;
+
+	return result;
+}
+
 /*--------------------
  * grouping_planner
  *	  Perform planning steps related to grouping, aggregation, etc.
@@ -614,6 +614,23 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			 */
 			Assert(plan->qual == NIL);
 			break;
+		case T_ResultCache:
+			{
+				ResultCache *rcplan = (ResultCache *) plan;
+
+				/*
+				 * Like Material, ResultCache returns its input tuples
+				 * unmodified.  Its cache keys contain only nestloop params
+				 * and constants, but fix them up to record any function
+				 * dependencies.
+				 */
+				set_dummy_tlist_references(plan, rtoffset);
+				Assert(plan->qual == NIL);
+
+				rcplan->param_exprs =
+					fix_scan_list(root, rcplan->param_exprs, rtoffset);
+			}
+			break;
 		case T_LockRows:
 			{
 				LockRows   *splan = (LockRows *) plan;
@@ -829,6 +846,8 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 											  (Plan *) lfirst(l),
 											  rtoffset);
 				}
+				splan->part_exprs =
+					fix_scan_list(root, splan->part_exprs, rtoffset);
 			}
 			break;
 		case T_MergeAppend:
@@ -1493,6 +1512,13 @@ set_join_references(PlannerInfo *root, Join *join, int rtoffset)
 		NestLoop   *nl = (NestLoop *) join;
 		ListCell   *lc;
 
+		nl->hashclauses = fix_join_expr(root,
+										nl->hashclauses,
+										outer_itlist,
+										inner_itlist,
+										(Index) 0,
+										rtoffset);
+
 		foreach(lc, nl->nestParams)
 		{
 			NestLoopParam *nlp = (NestLoopParam *) lfirst(lc);
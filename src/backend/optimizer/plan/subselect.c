@@ -2438,6 +2438,8 @@ finalize_plan(PlannerInfo *root, Plan *plan, Bitmapset *valid_params,
 													  valid_params,
 													  scan_params));
 				}
+				finalize_primnode((Node *) ((Append *) plan)->part_exprs,
+								  &context);
 			}
 			break;
 
@@ -2495,6 +2497,8 @@ finalize_plan(PlannerInfo *root, Plan *plan, Bitmapset *valid_params,
 
 				finalize_primnode((Node *) ((Join *) plan)->joinqual,
 								  &context);
+				finalize_primnode((Node *) ((NestLoop *) plan)->hashclauses,
+								  &context);
 				/* collect set of params that will be passed to right child */
 				foreach(l, ((NestLoop *) plan)->nestParams)
 				{
@@ -2551,6 +2555,11 @@ finalize_plan(PlannerInfo *root, Plan *plan, Bitmapset *valid_params,
 							  &context);
 			break;
 
+		case T_ResultCache:
+			finalize_primnode((Node *) ((ResultCache *) plan)->param_exprs,
+							  &context);
+			break;
+
 		case T_Hash:
 		case T_Agg:
 		case T_Material:
@@ -0,0 +1,705 @@
+/*-------------------------------------------------------------------------
+ *
+ * prepagg.c
+ *	  Planner preprocessing for eager aggregation.
+ *
+ * If a query aggregates the result of an inner join, and all of its
+ * aggregates take their input from one relation, it can be cheaper to
+ * aggregate that relation before joining it.  We group its rows on the
+ * columns that the rest of the query needs from it, and reduce each group
+ * to one transition state per aggregate ("partial" aggregation).  The join
+ * then processes one row per group rather than one per input row, and the
+ * query's own aggregation step merges the states using the aggregates'
+ * combine functions before applying their final functions.  This is valid
+ * because every join row that an input row would have contributed to is
+ * formed instead by the group containing it, and merging the group's state
+ * accounts for each of its rows exactly once.
+ *
+ * The transformation is done on the Query tree, by replacing the relation
+ * with a subquery that performs the partial aggregation, so that the rest
+ * of the planner needs no special knowledge of it.  Whether it wins depends
+ * on how far the grouping reduces the relation, so subquery_planner plans
+ * the query both ways and keeps the cheaper plan.
+ *
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/optimizer/prep/prepagg.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_aggregate.h"
+#include "catalog/pg_type.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/prep.h"
+#include "optimizer/var.h"
+#include "parser/parse_oper.h"
+#include "parser/parsetree.h"
+#include "rewrite/rewriteManip.h"
+#include "utils/lsyscache.h"
+#include "utils/syscache.h"
+
+
+/* GUC parameter */
+bool		eager_aggregate = false;
+
+typedef struct
+{
+	Index		relid;			/* rangetable index of aggregated relation */
+	Bitmapset  *keyattnos;		/* its columns needed above the aggregation */
+	bool		failed;			/* found a reference we can't handle */
+} eager_agg_keys_context;
+
+typedef struct
+{
+	Index		relid;			/* rangetable index of aggregated relation */
+	Bitmapset  *keyattnos;		/* its columns available from the subquery */
+	AttrNumber *keymap;			/* maps relation attno to subquery resno */
+	List	   *aggs;			/* Aggrefs of the original query */
+	List	   *partials;		/* the partial Aggref standing for each one */
+	List	   *aggresnos;		/* and its resno in the subquery */
+} eager_agg_replace_context;
+
+static bool eager_agg_jointree_ok(Node *jtnode, int *nrels);
+static bool collect_aggrefs_walker(Node *node, List **aggs);
+static bool eager_agg_aggref_ok(Aggref *aggref, Oid *transtype);
+static bool eager_agg_key_type_ok(Oid keytype);
+static void extract_eager_agg_quals(Node *jtnode, Index relid,
+						List **pushed_quals);
+static bool find_eager_agg_keys_walker(Node *node,
+						   eager_agg_keys_context *context);
+static Node *eager_agg_replace_mutator(Node *node,
+						  eager_agg_replace_context *context);
+
+
+/*
+ * build_eager_agg_query
+ *		Try to push partial aggregation below the joins of a query.
+ *
+ * Returns a new Query in which the relation feeding the aggregates is
+ * replaced by a subquery that partially aggregates it, or NULL if the query
+ * is not suitable.  The given Query is not modified.
+ */
+Query *
+build_eager_agg_query(Query *parse)
+{
+	Query	   *query;
+	Query	   *subquery;
+	RangeTblEntry *rte;
+	RangeTblEntry *subrte;
+	RangeTblRef *rtr;
+	List	   *aggs = NIL;
+	List	   *aggtranstypes = NIL;
+	List	   *pushed_quals = NIL;
+	List	   *subtlist = NIL;
+	List	   *groupClause = NIL;
+	List	   *colnames = NIL;
+	eager_agg_keys_context keys_context;
+	eager_agg_replace_context replace_context;
+	Index		relid = 0;
+	int			nrels = 0;
+	AttrNumber	resno;
+	int			attno;
+	int			maxattno;
+	ListCell   *lc;
+	ListCell   *lt;
+
+	/*
+	 * Only a plain aggregating SELECT qualifies.  We don't try to cope with
+	 * sublinks or CTEs, which could hide further references to the relation,
+	 * nor with anything that is computed between the join and the
+	 * aggregation or depends on individual rows surviving the join.
+	 */
+	if (parse->commandType != CMD_SELECT ||
+		parse->utilityStmt != NULL ||
+		!parse->hasAggs ||
+		parse->hasWindowFuncs ||
+		parse->hasSubLinks ||
+		parse->hasForUpdate ||
+		parse->cteList != NIL ||
+		parse->groupingSets != NIL ||
+		parse->setOperations != NULL ||
+		parse->rowMarks != NIL ||
+		expression_returns_set((Node *) parse->targetList))
+		return NULL;
+
+	/* All joins must be inner joins, and there must be at least one */
+	if (!eager_agg_jointree_ok((Node *) parse->jointree, &nrels) ||
+		nrels < 2)
+		return NULL;
+
+	/* A LATERAL reference could see the relation's individual rows */
+	foreach(lc, parse->rtable)
+	{
+		if (((RangeTblEntry *) lfirst(lc))->lateral)
+			return NULL;
+	}
+
+	query = (Query *) copyObject(parse);
+
+	/*
+	 * Expand references to join alias variables, so that every reference to
+	 * the relation's columns is a Var of the relation itself.
+	 */
+	foreach(lc, query->rtable)
+	{
+		if (((RangeTblEntry *) lfirst(lc))->rtekind == RTE_JOIN)
+		{
+			PlannerInfo *root = makeNode(PlannerInfo);
+
+			root->parse = query;
+			query->targetList = (List *)
+				flatten_join_alias_vars(root, (Node *) query->targetList);
+			query->havingQual =
+				flatten_join_alias_vars(root, query->havingQual);
+			query->jointree = (FromExpr *)
+				flatten_join_alias_vars(root, (Node *) query->jointree);
+			break;
+		}
+	}
+
+	/*
+	 * Find the relation the aggregates read from.  They must all read from
+	 * the same one (or from none, as count(*) does), and it must be a plain
+	 * relation.
+	 */
+	(void) collect_aggrefs_walker((Node *) query->targetList, &aggs);
+	(void) collect_aggrefs_walker(query->havingQual, &aggs);
+	foreach(lc, aggs)
+	{
+		Aggref	   *aggref = (Aggref *) lfirst(lc);
+		Relids		varnos;
+		int			varno;
+		Oid			transtype;
+
+		if (!eager_agg_aggref_ok(aggref, &transtype))
+			return NULL;
+		aggtranstypes = lappend_oid(aggtranstypes, transtype);
+
+		varnos = pull_varnos((Node *) aggref);
+		if (bms_is_empty(varnos))
+			continue;
+		if (!bms_get_singleton_member(varnos, &varno))
+			return NULL;
+		if (relid == 0)
+			relid = varno;
+		else if (relid != varno)
+			return NULL;
+	}
+	if (relid == 0)
+		return NULL;
+
+	rte = rt_fetch(relid, query->rtable);
+	if (rte->rtekind != RTE_RELATION)
+		return NULL;
+
+	/* WHERE and JOIN/ON conditions on the relation alone move below */
+	extract_eager_agg_quals((Node *) query->jointree, relid, &pushed_quals);
+
+	/*
+	 * Every other reference to the relation's columns outside the aggregates
+	 * makes that column a grouping key of the partial aggregation.  There
+	 * must be at least one, else the relation isn't really joined to
+	 * anything.
+	 */
+	keys_context.relid = relid;
+	keys_context.keyattnos = NULL;
+	keys_context.failed = false;
+	(void) find_eager_agg_keys_walker((Node *) query->targetList,
+									  &keys_context);
+	(void) find_eager_agg_keys_walker(query->havingQual, &keys_context);
+	(void) find_eager_agg_keys_walker((Node *) query->jointree,
+									  &keys_context);
+	if (keys_context.failed || bms_is_empty(keys_context.keyattnos))
+		return NULL;
+
+	/*
+	 * Build the targetlist and GROUP BY clause of the subquery: first the
+	 * grouping keys, then one partial aggregate for each distinct aggregate.
+	 */
+	maxattno = 0;
+	attno = -1;
+	while ((attno = bms_next_member(keys_context.keyattnos, attno)) >= 0)
+		maxattno = attno;
+
+	replace_context.relid = relid;
+	replace_context.keyattnos = keys_context.keyattnos;
+	replace_context.keymap = (AttrNumber *)
+		palloc0((maxattno + 1) * sizeof(AttrNumber));
+	replace_context.aggs = aggs;
+	replace_context.partials = NIL;
+	replace_context.aggresnos = NIL;
+
+	resno = 0;
+	attno = -1;
+	while ((attno = bms_next_member(keys_context.keyattnos, attno)) >= 0)
+	{
+		Oid			vartype;
+		int32		vartypmod;
+		Oid			varcollid;
+		Oid			sortop;
+		Oid			eqop;
+		bool		hashable;
+		char	   *colname;
+		TargetEntry *tle;
+		SortGroupClause *grpcl;
+
+		get_rte_attribute_type(rte, attno, &vartype, &vartypmod, &varcollid);
+		if (!eager_agg_key_type_ok(vartype))
+			return NULL;
+		get_sort_group_operators(vartype,
+								 false, false, false,
+								 &sortop, &eqop, NULL,
+								 &hashable);
+		if (!OidIsValid(eqop) || (!OidIsValid(sortop) && !hashable))
+			return NULL;
+
+		colname = get_rte_attribute_name(rte, attno);
+		tle = makeTargetEntry((Expr *) makeVar(1, attno, vartype, vartypmod,
+											   varcollid, 0),
+							  ++resno, colname, false);
+		tle->ressortgroupref = resno;
+		subtlist = lappend(subtlist, tle);
+		colnames = lappend(colnames, makeString(pstrdup(colname)));
+
+		grpcl = makeNode(SortGroupClause);
+		grpcl->tleSortGroupRef = resno;
+		grpcl->eqop = eqop;
+		grpcl->sortop = sortop;
+		grpcl->nulls_first = false;
+		grpcl->hashable = hashable;
+		groupClause = lappend(groupClause, grpcl);
+
+		replace_context.keymap[attno] = resno;
+	}
+
+	forboth(lc, aggs, lt, aggtranstypes)
+	{
+		Aggref	   *partial = (Aggref *) copyObject(lfirst(lc));
+		Oid			transtype = lfirst_oid(lt);
+		ListCell   *lc2;
+
+		/*
+		 * The partial aggregate is evaluated one query level further down,
+		 * so outer references in its arguments (in a correlated subquery,
+		 * say) must point one more level up.  Likewise for the quals below.
+		 */
+		ChangeVarNodes((Node *) partial, relid, 1, 0);
+		IncrementVarSublevelsUp((Node *) partial, 1, 1);
+		partial->aggpartial = true;
+		partial->aggtype = transtype;
+		partial->aggcollid = type_is_collatable(transtype) ?
+			partial->inputcollid : InvalidOid;
+
+		/* Share the partial aggregate between duplicate aggregates */
+		foreach(lc2, subtlist)
+		{
+			TargetEntry *tle = (TargetEntry *) lfirst(lc2);
+
+			if (equal(tle->expr, partial))
+				break;
+		}
+		if (lc2 != NULL)
+		{
+			replace_context.partials = lappend(replace_context.partials,
+											   partial);
+			replace_context.aggresnos =
+				lappend_int(replace_context.aggresnos,
+							((TargetEntry *) lfirst(lc2))->resno);
+			continue;
+		}
+
+		subtlist = lappend(subtlist,
+						   makeTargetEntry((Expr *) partial, ++resno,
+										   get_func_name(partial->aggfnoid),
+										   false));
+		colnames = lappend(colnames,
+						   makeString(get_func_name(partial->aggfnoid)));
+		replace_context.partials = lappend(replace_context.partials, partial);
+		replace_context.aggresnos = lappend_int(replace_context.aggresnos,
+												resno);
+	}
+
+	/* Now build the subquery itself, scanning the original relation */
+	subrte = rte;
+	rtr = makeNode(RangeTblRef);
+	rtr->rtindex = 1;
+	ChangeVarNodes((Node *) pushed_quals, relid, 1, 0);
+	IncrementVarSublevelsUp((Node *) pushed_quals, 1, 1);
+
+	subquery = makeNode(Query);
+	subquery->commandType = CMD_SELECT;
+	subquery->querySource = query->querySource;
+	subquery->canSetTag = true;
+	subquery->hasAggs = true;
+	subquery->hasRowSecurity = query->hasRowSecurity;
+	subquery->rtable = list_make1(subrte);
+	subquery->jointree = makeFromExpr(list_make1(rtr),
+								(Node *) make_ands_explicit(pushed_quals));
+	subquery->targetList = subtlist;
+	subquery->groupClause = groupClause;
+
+	/* ... and put it in place of the relation */
+	rte = makeNode(RangeTblEntry);
+	rte->rtekind = RTE_SUBQUERY;
+	rte->subquery = subquery;
+	rte->security_barrier = false;
+	rte->alias = makeAlias(subrte->eref->aliasname, NIL);
+	rte->eref = makeAlias(subrte->eref->aliasname, colnames);
+	rte->lateral = false;
+	rte->inh = false;
+	rte->inFromCl = subrte->inFromCl;
+	rte->requiredPerms = 0;
+	rte->checkAsUser = InvalidOid;
+	list_nth_cell(query->rtable, relid - 1)->data.ptr_value = rte;
+
+	/*
+	 * Finally, redirect the remaining references to the relation to the
+	 * subquery's output, and turn the aggregates into combining ones.  Join
+	 * alias variables can no longer be referenced, since we flattened them
+	 * above; any that mention a column that isn't available any longer are
+	 * simply dropped.
+	 */
+	query->targetList = (List *)
+		eager_agg_replace_mutator((Node *) query->targetList,
+								  &replace_context);
+	query->havingQual =
+		eager_agg_replace_mutator(query->havingQual, &replace_context);
+	query->jointree = (FromExpr *)
+		eager_agg_replace_mutator((Node *) query->jointree,
+								  &replace_context);
+	foreach(lc, query->rtable)
+	{
+		RangeTblEntry *joinrte = (RangeTblEntry *) lfirst(lc);
+
+		if (joinrte->rtekind != RTE_JOIN)
+			continue;
+		foreach(lt, joinrte->joinaliasvars)
+		{
+			Node	   *aliasvar = (Node *) lfirst(lt);
+
+			keys_context.keyattnos = NULL;
+			keys_context.failed = false;
+			(void) find_eager_agg_keys_walker(aliasvar, &keys_context);
+			if (keys_context.failed ||
+				!bms_is_subset(keys_context.keyattnos,
+							   replace_context.keyattnos))
+				lfirst(lt) = NULL;
+			else
+				lfirst(lt) = eager_agg_replace_mutator(aliasvar,
+													   &replace_context);
+		}
+	}
+
+	return query;
+}
+
+/*
+ * eager_agg_jointree_ok
+ *		Check that a jointree contains only inner joins, counting its
+ *		base relations into *nrels.
+ */
+static bool
+eager_agg_jointree_ok(Node *jtnode, int *nrels)
+{
+	if (jtnode == NULL)
+		return true;
+	if (IsA(jtnode, RangeTblRef))
+	{
+		(*nrels)++;
+		return true;
+	}
+	else if (IsA(jtnode, FromExpr))
+	{
+		FromExpr   *f = (FromExpr *) jtnode;
+		ListCell   *l;
+
+		foreach(l, f->fromlist)
+		{
+			if (!eager_agg_jointree_ok(lfirst(l), nrels))
+				return false;
+		}
+		return true;
+	}
+	else if (IsA(jtnode, JoinExpr))
+	{
+		JoinExpr   *j = (JoinExpr *) jtnode;
+
+		if (j->jointype != JOIN_INNER)
+			return false;
+		return eager_agg_jointree_ok(j->larg, nrels) &&
+			eager_agg_jointree_ok(j->rarg, nrels);
+	}
+	else
+		elog(ERROR, "unrecognized node type: %d",
+			 (int) nodeTag(jtnode));
+	return false;				/* keep compiler quiet */
+}
+
+/*
+ * collect_aggrefs_walker
+ *		Make a list of the Aggrefs in an expression.
+ *
+ * Aggregates can't be nested, so there is no need to look inside them.
+ */
+static bool
+collect_aggrefs_walker(Node *node, List **aggs)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Aggref))
+	{
+		*aggs = lappend(*aggs, node);
+		return false;
+	}
+	return expression_tree_walker(node, collect_aggrefs_walker,
+								  (void *) aggs);
+}
+
+/*
+ * eager_agg_aggref_ok
+ *		Check whether an aggregate can be split into partial and combining
+ *		stages, returning its transition type into *transtype if so.
+ *
+ * It needs a combine function, and its transition state must be something
+ * we can pass from one plan node to another, which rules out "internal".
+ * We also insist on a non-polymorphic state type, since the actual type is
+ * resolved from the input types, which the combining stage doesn't see.
+ * Aggregates with DISTINCT or ORDER BY need to see all their input at once.
+ */
+static bool
+eager_agg_aggref_ok(Aggref *aggref, Oid *transtype)
+{
+	HeapTuple	aggTuple;
+	Form_pg_aggregate aggform;
+	bool		result;
+
+	if (aggref->agglevelsup != 0 ||
+		aggref->aggkind != AGGKIND_NORMAL ||
+		aggref->aggorder != NIL ||
+		aggref->aggdistinct != NIL ||
+		aggref->aggpartial ||
+		aggref->aggcombine)
+		return false;
+
+	aggTuple = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(aggref->aggfnoid));
+	if (!HeapTupleIsValid(aggTuple))
+		elog(ERROR, "cache lookup failed for aggregate %u",
+			 aggref->aggfnoid);
+	aggform = (Form_pg_aggregate) GETSTRUCT(aggTuple);
+
+	*transtype = aggform->aggtranstype;
+	result = (OidIsValid(aggform->aggcombinefn) &&
+			  !aggform->aggfinalextra &&
+			  *transtype != INTERNALOID &&
+			  !IsPolymorphicType(*transtype));
+
+	ReleaseSysCache(aggTuple);
+
+	return result;
+}
+
+/*
+ * eager_agg_key_type_ok
+ *		Check whether grouping on a column of the given type can be done
+ *		below the join.
+ *
+ * The partial aggregation reduces each group of equal key values to one
+ * row, carrying whichever of the values it happened to see first.  That is
+ * only harmless if equal values are indistinguishable: with numeric, for
+ * instance, 1.0 and 1.00 are equal yet print differently, and float8 -0 and
+ * 0 are equal yet behave differently in division, so anything above the
+ * join that looked at the column could see a different value than it would
+ * have without the transformation.  There is no catalog property telling
+ * us which equality operators have that guarantee, so we accept only a
+ * list of built-in types known to have it, and domains over them.
+ */
+static bool
+eager_agg_key_type_ok(Oid keytype)
+{
+	switch (getBaseType(keytype))
+	{
+		case BOOLOID:
+		case CHAROID:
+		case NAMEOID:
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case OIDOID:
+		case TEXTOID:
+		case VARCHAROID:
+		case BYTEAOID:
+		case DATEOID:
+		case TIMEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+		case UUIDOID:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * extract_eager_agg_quals
+ *		Remove from the jointree's quals those that reference only the
+ *		given relation, adding them to *pushed_quals.
+ *
+ * Since all the joins are inner joins, such quals can be applied directly
+ * to the relation's scan.  Volatile quals are left where they were, so as
+ * not to change how often they are evaluated.
+ */
+static void
+extract_eager_agg_quals(Node *jtnode, Index relid, List **pushed_quals)
+{
+	Node	  **qualp;
+	List	   *kept_quals = NIL;
+	ListCell   *l;
+
+	if (jtnode == NULL || IsA(jtnode, RangeTblRef))
+		return;
+	else if (IsA(jtnode, FromExpr))
+	{
+		FromExpr   *f = (FromExpr *) jtnode;
+
+		foreach(l, f->fromlist)
+			extract_eager_agg_quals(lfirst(l), relid, pushed_quals);
+		qualp = &f->quals;
+	}
+	else if (IsA(jtnode, JoinExpr))
+	{
+		JoinExpr   *j = (JoinExpr *) jtnode;
+
+		extract_eager_agg_quals(j->larg, relid, pushed_quals);
+		extract_eager_agg_quals(j->rarg, relid, pushed_quals);
+		qualp = &j->quals;
+	}
+	else
+	{
+		elog(ERROR, "unrecognized node type: %d",
+			 (int) nodeTag(jtnode));
+		return;					/* keep compiler quiet */
+	}
+
+	foreach(l, make_ands_implicit((Expr *) *qualp))
+	{
+		Node	   *qual = (Node *) lfirst(l);
+		Relids		varnos = pull_varnos(qual);
+
+		if (bms_membership(varnos) == BMS_SINGLETON &&
+			bms_is_member(relid, varnos) &&
+			!contain_volatile_functions(qual))
+			*pushed_quals = lappend(*pushed_quals, qual);
+		else
+			kept_quals = lappend(kept_quals, qual);
+	}
+	*qualp = (Node *) make_ands_explicit(kept_quals);
+}
+
+/*
+ * find_eager_agg_keys_walker
+ *		Collect the attnos of the relation's columns referenced outside
+ *		aggregates.
+ *
+ * Whole-row and system column references can't be provided by the
+ * aggregating subquery, so those make us give up.
+ */
+static bool
+find_eager_agg_keys_walker(Node *node, eager_agg_keys_context *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Var))
+	{
+		Var		   *var = (Var *) node;
+
+		if (var->varno == context->relid && var->varlevelsup == 0)
+		{
+			if (var->varattno <= 0)
+				context->failed = true;
+			else
+				context->keyattnos = bms_add_member(context->keyattnos,
+													var->varattno);
+		}
+		return false;
+	}
+	if (IsA(node, Aggref))
+		return false;
+	return expression_tree_walker(node, find_eager_agg_keys_walker,
+								  (void *) context);
+}
+
+/*
+ * eager_agg_replace_mutator
+ *		Redirect references to the aggregated relation to the output of the
+ *		subquery that replaces it.
+ *
+ * Its columns become the subquery's grouping keys, and each aggregate
+ * becomes one that combines the states computed by its partial aggregate.
+ */
+static Node *
+eager_agg_replace_mutator(Node *node, eager_agg_replace_context *context)
+{
+	if (node == NULL)
+		return NULL;
+	if (IsA(node, Var))
+	{
+		Var		   *var = (Var *) node;
+
+		if (var->varno == context->relid && var->varlevelsup == 0)
+		{
+			Assert(bms_is_member(var->varattno, context->keyattnos));
+			var = (Var *) copyObject(var);
+			var->varattno = var->varoattno =
+				context->keymap[var->varattno];
+			return (Node *) var;
+		}
+		return node;
+	}
+	if (IsA(node, Aggref))
+	{
+		Aggref	   *aggref = (Aggref *) node;
+		Aggref	   *partial = NULL;
+		AttrNumber	resno = 0;
+		Aggref	   *newagg;
+		Var		   *statevar;
+		ListCell   *lc;
+		ListCell   *lp;
+		ListCell   *lr;
+
+		forthree(lc, context->aggs, lp, context->partials,
+				 lr, context->aggresnos)
+		{
+			if (equal(lfirst(lc), aggref))
+			{
+				partial = (Aggref *) lfirst(lp);
+				resno = lfirst_int(lr);
+				break;
+			}
+		}
+		if (partial == NULL)
+			elog(ERROR, "could not find partial aggregate");
+
+		statevar = makeVar(context->relid, resno,
+						   partial->aggtype, -1, partial->aggcollid, 0);
+
+		newagg = (Aggref *) copyObject(aggref);
+		newagg->args = list_make1(makeTargetEntry((Expr *) statevar,
+												  1, NULL, false));
+		newagg->aggfilter = NULL;
+		newagg->aggstar = false;
+		newagg->aggvariadic = false;
+		newagg->aggcombine = true;
+		return (Node *) newagg;
+	}
+	return expression_tree_mutator(node, eager_agg_replace_mutator,
+								   (void *) context);
+}
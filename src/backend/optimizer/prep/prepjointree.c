@@ -10,6 +10,7 @@
  *		flatten_simple_union_all
  *		do expression preprocessing (including flattening JOIN alias vars)
  *		reduce_outer_joins
+ *		remove_useless_self_joins
  *
  *
  * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
@@ -27,6 +28,7 @@
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
+#include "optimizer/plancat.h"
 #include "optimizer/placeholder.h"
 #include "optimizer/prep.h"
 #include "optimizer/subselect.h"
@@ -34,6 +36,11 @@
 #include "parser/parse_relation.h"
 #include "parser/parsetree.h"
 #include "rewrite/rewriteManip.h"
+#include "utils/lsyscache.h"
+
+
+/* GUC parameter */
+bool		enable_self_join_removal = true;
 
 
 typedef struct pullup_replace_vars_context
@@ -110,6 +117,11 @@ static void reduce_outer_joins_pass2(Node *jtnode,
 						 Relids nonnullable_rels,
 						 List *nonnullable_vars,
 						 List *forced_null_vars);
+static bool remove_self_join_recurse(PlannerInfo *root, Node **jtlink);
+static void collect_inner_join_items(Node *jtnode, List **itemlinks,
+						 List **quals);
+static bool is_self_join_candidate(PlannerInfo *root, RangeTblEntry *rte,
+					   int rtindex);
 static void substitute_multiple_relids(Node *node,
 						   int varno, Relids subrelids);
 static void fix_append_rel_relids(List *append_rel_list, int varno,
@@ -2759,6 +2771,250 @@ reduce_outer_joins_pass2(Node *jtnode,
 			 (int) nodeTag(jtnode));
 }
 
+/*
+ * remove_useless_self_joins
+ *		Merge inner self-joins that match rows on a unique key.
+ *
+ * If a table is inner-joined to itself with "a.col = b.col" clauses covering
+ * all the columns of a unique index, each row of a can match only itself in
+ * b, so the join simply yields the rows of a for which all those columns are
+ * non-null.  We can then replace every reference to b with a reference to a
+ * and drop b from the jointree, adding IS NOT NULL tests as needed.  Other
+ * quals mentioning b are retained, now referring to a.
+ *
+ * Only relations directly within the same group of inner joins are
+ * considered, since merging across an outer join would change the join's
+ * semantics.  We don't try to cope with row marks, inheritance, sampling,
+ * or security barrier quals, nor with the target of an UPDATE or DELETE.
+ *
+ * This must run after expression preprocessing, so that quals are in
+ * implicit-AND format and JOIN alias Vars have been flattened.  The merged
+ * relation's rangetable entry is left in place, so its permissions are still
+ * checked and plans using it are invalidated along with the table.
+ */
+void
+remove_useless_self_joins(PlannerInfo *root)
+{
+	Query	   *parse = root->parse;
+
+	if (parse->rowMarks != NIL || root->rowMarks != NIL ||
+		list_length(parse->rtable) < 2)
+		return;
+
+	/* Each successful merge may expose another, so keep going */
+	while (remove_self_join_recurse(root, (Node **) &parse->jointree))
+		 /* keep looking */ ;
+}
+
+/*
+ * remove_self_join_recurse
+ *		Find and merge one removable self-join below *jtlink.
+ *
+ * Returns true if a merge was done, in which case the jointree and the
+ * Query's Vars have been updated.
+ */
+static bool
+remove_self_join_recurse(PlannerInfo *root, Node **jtlink)
+{
+	Node	   *jtnode = *jtlink;
+	List	   *itemlinks = NIL;
+	List	   *quals = NIL;
+	ListCell   *lc1;
+	ListCell   *lc2;
+
+	if (jtnode == NULL || IsA(jtnode, RangeTblRef))
+		return false;
+
+	if (IsA(jtnode, JoinExpr) &&
+		((JoinExpr *) jtnode)->jointype != JOIN_INNER)
+	{
+		JoinExpr   *j = (JoinExpr *) jtnode;
+
+		/* Each side of an outer join is handled separately */
+		return remove_self_join_recurse(root, &j->larg) ||
+			remove_self_join_recurse(root, &j->rarg);
+	}
+
+	if (!IsA(jtnode, FromExpr) && !IsA(jtnode, JoinExpr))
+		elog(ERROR, "unrecognized node type: %d",
+			 (int) nodeTag(jtnode));
+
+	/* Flatten this group of inner joins into items and quals */
+	collect_inner_join_items(jtnode, &itemlinks, &quals);
+
+	foreach(lc1, itemlinks)
+	{
+		Node	   *item1 = *(Node **) lfirst(lc1);
+		int			r1;
+		RangeTblEntry *rte1;
+
+		if (!IsA(item1, RangeTblRef))
+			continue;
+		r1 = ((RangeTblRef *) item1)->rtindex;
+		rte1 = rt_fetch(r1, root->parse->rtable);
+		if (!is_self_join_candidate(root, rte1, r1))
+			continue;
+
+		for_each_cell(lc2, lnext(lc1))
+		{
+			Node	   *item2 = *(Node **) lfirst(lc2);
+			int			r2;
+			RangeTblEntry *rte2;
+			List	   *joinquals = NIL;
+			List	   *colnos = NIL;
+			List	   *opnos = NIL;
+			List	   *newitems = NIL;
+			List	   *newquals;
+			FromExpr   *newnode;
+			ListCell   *lc;
+
+			if (!IsA(item2, RangeTblRef))
+				continue;
+			r2 = ((RangeTblRef *) item2)->rtindex;
+			rte2 = rt_fetch(r2, root->parse->rtable);
+			if (rte2->relid != rte1->relid ||
+				!is_self_join_candidate(root, rte2, r2))
+				continue;
+
+			/* Look for "r1.col op r2.col" clauses on a common column */
+			foreach(lc, quals)
+			{
+				OpExpr	   *opexpr = (OpExpr *) lfirst(lc);
+				Var		   *leftvar;
+				Var		   *rightvar;
+
+				if (!is_opclause(opexpr) || list_length(opexpr->args) != 2)
+					continue;
+				leftvar = (Var *) linitial(opexpr->args);
+				rightvar = (Var *) lsecond(opexpr->args);
+				if (!IsA(leftvar, Var) || !IsA(rightvar, Var) ||
+					leftvar->varlevelsup != 0 || rightvar->varlevelsup != 0 ||
+					leftvar->varattno <= 0 ||
+					leftvar->varattno != rightvar->varattno)
+					continue;
+				if (!((leftvar->varno == r1 && rightvar->varno == r2) ||
+					  (leftvar->varno == r2 && rightvar->varno == r1)))
+					continue;
+
+				joinquals = lappend(joinquals, opexpr);
+				colnos = lappend_int(colnos, leftvar->varattno);
+				opnos = lappend_oid(opnos, opexpr->opno);
+			}
+
+			if (joinquals == NIL ||
+				!has_unique_index_on_columns(rte1->relid, colnos, opnos))
+				continue;
+
+			/*
+			 * OK, merge r2 into r1.  The join clauses become redundant,
+			 * except that they rejected rows with nulls in those columns.
+			 */
+			newquals = list_difference_ptr(quals, joinquals);
+			foreach(lc, joinquals)
+			{
+				OpExpr	   *opexpr = (OpExpr *) lfirst(lc);
+				Var		   *var = (Var *) linitial(opexpr->args);
+				NullTest   *ntest;
+
+				if (get_attnotnull(rte1->relid, var->varattno))
+					continue;
+
+				ntest = makeNode(NullTest);
+				ntest->arg = (Expr *) copyObject(var);
+				ntest->nulltesttype = IS_NOT_NULL;
+				ntest->argisrow = false;
+				ntest->location = -1;
+				newquals = lappend(newquals, ntest);
+			}
+
+			foreach(lc, itemlinks)
+			{
+				if (lc != lc2)
+					newitems = lappend(newitems, *(Node **) lfirst(lc));
+			}
+
+			newnode = makeFromExpr(newitems, (Node *) newquals);
+			*jtlink = (Node *) newnode;
+
+			ChangeVarNodes((Node *) root->parse, r2, r1, 0);
+
+			return true;
+		}
+	}
+
+	/* No luck at this level; try the outer joins among the items */
+	foreach(lc1, itemlinks)
+	{
+		if (remove_self_join_recurse(root, (Node **) lfirst(lc1)))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * collect_inner_join_items
+ *		Flatten a tree of FromExprs and inner JoinExprs.
+ *
+ * The addresses of the links to its other members (base rels and outer
+ * joins) are appended to *itemlinks, and all the quals found to *quals.
+ */
+static void
+collect_inner_join_items(Node *jtnode, List **itemlinks, List **quals)
+{
+	if (IsA(jtnode, FromExpr))
+	{
+		FromExpr   *f = (FromExpr *) jtnode;
+		ListCell   *l;
+
+		foreach(l, f->fromlist)
+		{
+			Node	   *child = (Node *) lfirst(l);
+
+			if (IsA(child, FromExpr) ||
+				(IsA(child, JoinExpr) &&
+				 ((JoinExpr *) child)->jointype == JOIN_INNER))
+				collect_inner_join_items(child, itemlinks, quals);
+			else
+				*itemlinks = lappend(*itemlinks, &lfirst(l));
+		}
+		*quals = list_concat(*quals, list_copy((List *) f->quals));
+	}
+	else
+	{
+		JoinExpr   *j = (JoinExpr *) jtnode;
+
+		Assert(IsA(j, JoinExpr) && j->jointype == JOIN_INNER);
+		if (IsA(j->larg, FromExpr) ||
+			(IsA(j->larg, JoinExpr) &&
+			 ((JoinExpr *) j->larg)->jointype == JOIN_INNER))
+			collect_inner_join_items(j->larg, itemlinks, quals);
+		else
+			*itemlinks = lappend(*itemlinks, &j->larg);
+		if (IsA(j->rarg, FromExpr) ||
+			(IsA(j->rarg, JoinExpr) &&
+			 ((JoinExpr *) j->rarg)->jointype == JOIN_INNER))
+			collect_inner_join_items(j->rarg, itemlinks, quals);
+		else
+			*itemlinks = lappend(*itemlinks, &j->rarg);
+		*quals = list_concat(*quals, list_copy((List *) j->quals));
+	}
+}
+
+/*
+ * is_self_join_candidate
+ *		Can this base relation take part in self-join removal?
+ */
+static bool
+is_self_join_candidate(PlannerInfo *root, RangeTblEntry *rte, int rtindex)
+{
+	return rte->rtekind == RTE_RELATION &&
+		!rte->inh &&
+		rte->tablesample == NULL &&
+		rte->securityQuals == NIL &&
+		root->parse->resultRelation != rtindex;
+}
+
 /*
  * substitute_multiple_relids - adjust node relid sets after pulling up
  * a subquery
@@ -33,22 +33,27 @@
 #include "access/heapam.h"
 #include "access/htup_details.h"
 #include "access/sysattr.h"
+#include "catalog/partition.h"
 #include "catalog/pg_inherits_fn.h"
 #include "catalog/pg_type.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
+#include "optimizer/plancat.h"
 #include "optimizer/planmain.h"
 #include "optimizer/planner.h"
 #include "optimizer/prep.h"
 #include "optimizer/tlist.h"
 #include "parser/parse_coerce.h"
 #include "parser/parsetree.h"
+#include "storage/lmgr.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/selfuncs.h"
+#include "utils/syscache.h"
 
 
 typedef struct
@@ -1214,6 +1219,97 @@ expand_inherited_tables(PlannerInfo *root)
 	}
 }
 
+/*
+ * find_unpruned_inheritors
+ *		Find the members of an inheritance set that may contain rows
+ *		satisfying the query's WHERE clause, according to the parent's
+ *		partition bounds.
+ *
+ * Like find_all_inheritors, returns a list of the parent's OID followed by
+ * those of the surviving descendants, and locks the latter.  Returns NIL if
+ * the parent's partition bounds are of no help.
+ *
+ * We look only at the top-level conditions of WHERE, since that's all we
+ * can be sure of this early in planning.  Pruning is redone more thoroughly
+ * in set_append_rel_size, using the parent's restriction clauses.
+ */
+static List *
+find_unpruned_inheritors(PlannerInfo *root, Oid parentOID, Index rti,
+						 LOCKMODE lockmode)
+{
+	Relation	parentrel;
+	PartitionBoundInfo *bounds;
+	List	   *quals;
+	bool	   *keep;
+	List	   *children;
+	List	   *result;
+	ListCell   *l;
+
+	if (root->parse->jointree->quals == NULL)
+		return NIL;
+
+	/* We assume the rewriter already locked the parent */
+	parentrel = heap_open(parentOID, NoLock);
+
+	bounds = RelationGetPartitionBounds(parentrel);
+	if (bounds == NULL)
+	{
+		heap_close(parentrel, NoLock);
+		return NIL;
+	}
+
+	quals = make_ands_implicit((Expr *)
+							   eval_const_expressions(root,
+											 root->parse->jointree->quals));
+	keep = prune_inheritance_children(bounds, rti, quals);
+	if (keep == NULL)
+	{
+		heap_close(parentrel, NoLock);
+		return NIL;
+	}
+
+	/*
+	 * Decide which direct children to keep before taking any locks, since
+	 * processing an invalidation could free the bounds.  Children that
+	 * aren't bounded on the partition key can't be pruned.
+	 */
+	children = NIL;
+	foreach(l, find_inheritance_children(parentOID, NoLock))
+	{
+		Oid			childOID = lfirst_oid(l);
+		int			i = partition_child_index(bounds, childOID);
+
+		if (i < 0 || keep[i])
+			children = lappend_oid(children, childOID);
+	}
+
+	heap_close(parentrel, NoLock);
+
+	/*
+	 * Now lock the surviving children, and add them and their own
+	 * descendants to the result.  As in find_inheritance_children, we must
+	 * check that a child still exists once we've locked it.
+	 */
+	result = list_make1_oid(parentOID);
+	foreach(l, children)
+	{
+		Oid			childOID = lfirst_oid(l);
+
+		LockRelationOid(childOID, lockmode);
+		if (!SearchSysCacheExists1(RELOID, ObjectIdGetDatum(childOID)))
+		{
+			UnlockRelationOid(childOID, lockmode);
+			continue;
+		}
+
+		result = list_concat_unique_oid(result,
+									find_all_inheritors(childOID, lockmode,
+														NULL));
+	}
+
+	return result;
+}
+
 /*
  * expand_inherited_rtentry
  *		Check whether a rangetable entry represents an inheritance set.
@@ -1281,8 +1377,16 @@ expand_inherited_rtentry(PlannerInfo *root, RangeTblEntry *rte, Index rti)
 	else
 		lockmode = AccessShareLock;
 
-	/* Scan for all members of inheritance set, acquire needed locks */
-	inhOIDs = find_all_inheritors(parentOID, lockmode, NULL);
+	/*
+	 * Scan for all members of inheritance set, acquire needed locks.  If the
+	 * parent's partition bounds let us rule out some children up front, we
+	 * needn't even lock those.
+	 */
+	inhOIDs = NIL;
+	if (constraint_exclusion != CONSTRAINT_EXCLUSION_OFF)
+		inhOIDs = find_unpruned_inheritors(root, parentOID, rti, lockmode);
+	if (inhOIDs == NIL)
+		inhOIDs = find_all_inheritors(parentOID, lockmode, NULL);
 
 	/*
 	 * Check that there's at least one descendant, else treat as no-child
@@ -482,8 +482,9 @@ count_agg_clauses_walker(Node *node, count_agg_clauses_context *context)
 			elog(ERROR, "cache lookup failed for aggregate %u",
 				 aggref->aggfnoid);
 		aggform = (Form_pg_aggregate) GETSTRUCT(aggTuple);
-		aggtransfn = aggform->aggtransfn;
-		aggfinalfn = aggform->aggfinalfn;
+		/* the stages of a split aggregate run different component fns */
+		aggtransfn = aggref->aggcombine ? aggform->aggcombinefn : aggform->aggtransfn;
+		aggfinalfn = aggref->aggpartial ? InvalidOid : aggform->aggfinalfn;
 		aggtranstype = aggform->aggtranstype;
 		aggtransspace = aggform->aggtransspace;
 		ReleaseSysCache(aggTuple);
@@ -27,21 +27,29 @@
 #include "catalog/catalog.h"
 #include "catalog/dependency.h"
 #include "catalog/heap.h"
+#include "catalog/partition.h"
+#include "catalog/pg_constraint.h"
+#include "catalog/pg_statistic_ext.h"
+#include "catalog/pg_type.h"
 #include "foreign/fdwapi.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/plancat.h"
+#include "optimizer/planmain.h"
 #include "optimizer/predtest.h"
 #include "optimizer/prep.h"
 #include "parser/parse_relation.h"
 #include "parser/parsetree.h"
 #include "rewrite/rewriteManip.h"
+#include "statistics/statistics.h"
 #include "storage/bufmgr.h"
+#include "utils/array.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
+#include "utils/syscache.h"
 
 
 /* GUC parameter */
@@ -59,6 +67,9 @@ static List *get_relation_constraints(PlannerInfo *root,
 						 bool include_notnull);
 static List *build_index_tlist(PlannerInfo *root, IndexOptInfo *index,
 				  Relation heapRelation);
+static List *get_relation_statistics(RelOptInfo *rel, Relation relation);
+static List *get_relation_foreign_keys(Relation relation);
+static void set_relation_attrs(RelOptInfo *rel, Relation relation);
 
 
 /*
@@ -71,6 +82,8 @@ static List *build_index_tlist(PlannerInfo *root, IndexOptInfo *index,
  *	min_attr	lowest valid AttrNumber
  *	max_attr	highest valid AttrNumber
  *	indexlist	list of IndexOptInfos for relation's indexes
+ *	statlist	list of StatisticExtInfo for relation's statistics objects
+ *	fkeylist	list of ForeignKeyOptInfo for relation's foreign keys
  *	serverid	if it's a foreign table, the server OID
  *	fdwroutine	if it's a foreign table, the FDW function pointers
  *	pages		number of pages
@@ -107,15 +120,9 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("cannot access temporary or unlogged relations during recovery")));
 
-	rel->min_attr = FirstLowInvalidHeapAttributeNumber + 1;
-	rel->max_attr = RelationGetNumberOfAttributes(relation);
-	rel->reltablespace = RelationGetForm(relation)->reltablespace;
-
-	Assert(rel->max_attr >= rel->min_attr);
-	rel->attr_needed = (Relids *)
-		palloc0((rel->max_attr - rel->min_attr + 1) * sizeof(Relids));
-	rel->attr_widths = (int32 *)
-		palloc0((rel->max_attr - rel->min_attr + 1) * sizeof(int32));
+	/* The attr arrays may already exist, if get_relation_attrs was used */
+	if (rel->attr_needed == NULL)
+		set_relation_attrs(rel, relation);
 
 	/*
 	 * Estimate relation size --- unless it's an inheritance parent, in which
@@ -207,6 +214,7 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 				RelationGetForm(indexRelation)->reltablespace;
 			info->rel = rel;
 			info->ncolumns = ncolumns = index->indnatts;
+			info->nkeycolumns = index->indnkeyatts;
 			info->indexkeys = (int *) palloc(sizeof(int) * ncolumns);
 			info->indexcollations = (Oid *) palloc(sizeof(Oid) * ncolumns);
 			info->opfamily = (Oid *) palloc(sizeof(Oid) * ncolumns);
@@ -381,6 +389,15 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 
 	rel->indexlist = indexinfos;
 
+	/* Extended statistics describe the table's own rows, not the appendrel */
+	if (!inhparent)
+		rel->statlist = get_relation_statistics(rel, relation);
+
+	/* Foreign keys are only of use for join removal, among baserels */
+	if (!inhparent && rel->reloptkind == RELOPT_BASEREL &&
+		enable_fkey_join_removal)
+		rel->fkeylist = get_relation_foreign_keys(relation);
+
 	/* Grab foreign-table info using the relcache, while we have it */
 	if (relation->rd_rel->relkind == RELKIND_FOREIGN_TABLE)
 	{
@@ -404,6 +421,229 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 		(*get_relation_info_hook) (root, relationObjectId, inhparent, rel);
 }
 
+/*
+ * get_relation_attrs -
+ *	  Set up just the attribute range and attr arrays of a relation.
+ *
+ * This is the part of get_relation_info's work that must be done for every
+ * member of an inheritance set when its RelOptInfo is built.  The rest,
+ * notably reading index information and measuring the relation's size, is
+ * left until set_append_rel_size knows that the child hasn't been pruned or
+ * excluded; with many children, most of them often are.
+ */
+void
+get_relation_attrs(Oid relationObjectId, RelOptInfo *rel)
+{
+	Relation	relation;
+
+	/* The relation was locked by expand_inherited_rtentry */
+	relation = heap_open(relationObjectId, NoLock);
+	set_relation_attrs(rel, relation);
+	heap_close(relation, NoLock);
+}
+
+/*
+ * set_relation_attrs
+ *		Subroutine for get_relation_info and get_relation_attrs.
+ */
+static void
+set_relation_attrs(RelOptInfo *rel, Relation relation)
+{
+	rel->min_attr = FirstLowInvalidHeapAttributeNumber + 1;
+	rel->max_attr = RelationGetNumberOfAttributes(relation);
+	rel->reltablespace = RelationGetForm(relation)->reltablespace;
+
+	Assert(rel->max_attr >= rel->min_attr);
+	rel->attr_needed = (Relids *)
+		palloc0((rel->max_attr - rel->min_attr + 1) * sizeof(Relids));
+	rel->attr_widths = (int32 *)
+		palloc0((rel->max_attr - rel->min_attr + 1) * sizeof(int32));
+}
+
+/*
+ * get_relation_statistics
+ *		Retrieve extended statistics defined on the table.
+ *
+ * Returns a List (possibly empty) of StatisticExtInfo objects describing
+ * the statistics.  Note that this doesn't load the actual statistics data,
+ * just the identifying metadata.  Only stats actually built are considered.
+ */
+static List *
+get_relation_statistics(RelOptInfo *rel, Relation relation)
+{
+	List	   *statoidlist;
+	List	   *stainfos = NIL;
+	ListCell   *l;
+
+	statoidlist = RelationGetStatExtList(relation);
+
+	foreach(l, statoidlist)
+	{
+		Oid			statOid = lfirst_oid(l);
+		Form_pg_statistic_ext staForm;
+		HeapTuple	htup;
+		Bitmapset  *keys = NULL;
+		int			i;
+
+		htup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(statOid));
+		if (!HeapTupleIsValid(htup))
+			elog(ERROR, "cache lookup failed for statistics object %u", statOid);
+		staForm = (Form_pg_statistic_ext) GETSTRUCT(htup);
+
+		/*
+		 * First, build the array of columns covered.  This is ultimately
+		 * wasted if no stats within the object have actually been built, but
+		 * it doesn't seem worth troubling over that case.
+		 */
+		for (i = 0; i < staForm->stxkeys.dim1; i++)
+			keys = bms_add_member(keys, staForm->stxkeys.values[i]);
+
+		/* add one StatisticExtInfo for each kind built */
+		if (statext_is_kind_built(htup, STATS_EXT_NDISTINCT))
+		{
+			StatisticExtInfo *info = makeNode(StatisticExtInfo);
+
+			info->statOid = statOid;
+			info->rel = rel;
+			info->kind = STATS_EXT_NDISTINCT;
+			info->keys = bms_copy(keys);
+
+			stainfos = lcons(info, stainfos);
+		}
+
+		if (statext_is_kind_built(htup, STATS_EXT_DEPENDENCIES))
+		{
+			StatisticExtInfo *info = makeNode(StatisticExtInfo);
+
+			info->statOid = statOid;
+			info->rel = rel;
+			info->kind = STATS_EXT_DEPENDENCIES;
+			info->keys = bms_copy(keys);
+
+			stainfos = lcons(info, stainfos);
+		}
+
+		if (statext_is_kind_built(htup, STATS_EXT_MCV))
+		{
+			StatisticExtInfo *info = makeNode(StatisticExtInfo);
+
+			info->statOid = statOid;
+			info->rel = rel;
+			info->kind = STATS_EXT_MCV;
+			info->keys = bms_copy(keys);
+
+			stainfos = lcons(info, stainfos);
+		}
+
+		ReleaseSysCache(htup);
+		bms_free(keys);
+	}
+
+	list_free(statoidlist);
+
+	return stainfos;
+}
+
+/*
+ * get_relation_foreign_keys
+ *		Retrieve the foreign key constraints of the table.
+ *
+ * Returns a List (possibly empty) of ForeignKeyOptInfo objects, one for each
+ * constraint the table is the referencing side of.  Constraints that are not
+ * yet validated, or whose checks can be deferred, are left out: rows
+ * violating them may be visible to the query.
+ */
+static List *
+get_relation_foreign_keys(Relation relation)
+{
+	List	   *fkeyoidlist;
+	List	   *fkeyinfos = NIL;
+	ListCell   *l;
+
+	fkeyoidlist = RelationGetFKeyList(relation);
+
+	foreach(l, fkeyoidlist)
+	{
+		Oid			conOid = lfirst_oid(l);
+		Form_pg_constraint conForm;
+		ForeignKeyOptInfo *info;
+		HeapTuple	htup;
+		Datum		adatum;
+		bool		isNull;
+		ArrayType  *arr;
+		int			numkeys;
+		int			i;
+
+		htup = SearchSysCache1(CONSTROID, ObjectIdGetDatum(conOid));
+		if (!HeapTupleIsValid(htup))
+			elog(ERROR, "cache lookup failed for constraint %u", conOid);
+		conForm = (Form_pg_constraint) GETSTRUCT(htup);
+
+		if (conForm->contype != CONSTRAINT_FOREIGN ||
+			!conForm->convalidated ||
+			conForm->condeferrable)
+		{
+			ReleaseSysCache(htup);
+			continue;
+		}
+
+		info = makeNode(ForeignKeyOptInfo);
+		info->conoid = conOid;
+		info->confrelid = conForm->confrelid;
+
+		/* The arrays are laid out as in ri_LoadConstraintInfo() */
+		adatum = SysCacheGetAttr(CONSTROID, htup,
+								 Anum_pg_constraint_conkey, &isNull);
+		if (isNull)
+			elog(ERROR, "null conkey for constraint %u", conOid);
+		arr = DatumGetArrayTypeP(adatum);
+		if (ARR_NDIM(arr) != 1 ||
+			ARR_HASNULL(arr) ||
+			ARR_ELEMTYPE(arr) != INT2OID)
+			elog(ERROR, "conkey is not a 1-D smallint array");
+		numkeys = ARR_DIMS(arr)[0];
+		if (numkeys <= 0 || numkeys > INDEX_MAX_KEYS)
+			elog(ERROR, "foreign key constraint cannot have %d columns",
+				 numkeys);
+		info->nkeys = numkeys;
+		for (i = 0; i < numkeys; i++)
+			info->conkey[i] = ((int16 *) ARR_DATA_PTR(arr))[i];
+
+		adatum = SysCacheGetAttr(CONSTROID, htup,
+								 Anum_pg_constraint_confkey, &isNull);
+		if (isNull)
+			elog(ERROR, "null confkey for constraint %u", conOid);
+		arr = DatumGetArrayTypeP(adatum);
+		if (ARR_NDIM(arr) != 1 ||
+			ARR_DIMS(arr)[0] != numkeys ||
+			ARR_HASNULL(arr) ||
+			ARR_ELEMTYPE(arr) != INT2OID)
+			elog(ERROR, "confkey is not a 1-D smallint array");
+		for (i = 0; i < numkeys; i++)
+			info->confkey[i] = ((int16 *) ARR_DATA_PTR(arr))[i];
+
+		adatum = SysCacheGetAttr(CONSTROID, htup,
+								 Anum_pg_constraint_conpfeqop, &isNull);
+		if (isNull)
+			elog(ERROR, "null conpfeqop for constraint %u", conOid);
+		arr = DatumGetArrayTypeP(adatum);
+		if (ARR_NDIM(arr) != 1 ||
+			ARR_DIMS(arr)[0] != numkeys ||
+			ARR_HASNULL(arr) ||
+			ARR_ELEMTYPE(arr) != OIDOID)
+			elog(ERROR, "conpfeqop is not a 1-D Oid array");
+		memcpy(info->conpfeqop, ARR_DATA_PTR(arr), numkeys * sizeof(Oid));
+
+		ReleaseSysCache(htup);
+
+		fkeyinfos = lappend(fkeyinfos, info);
+	}
+
+	list_free(fkeyoidlist);
+
+	return fkeyinfos;
+}
+
 /*
  * infer_arbiter_indexes -
  *	  Determine the unique indexes used to arbitrate speculative insertion.
@@ -587,8 +827,11 @@ infer_arbiter_indexes(PlannerInfo *root)
 		if (!idxForm->indisunique)
 			goto next;
 
-		/* Build BMS representation of cataloged index attributes */
-		for (natt = 0; natt < idxForm->indnatts; natt++)
+		/*
+		 * Build BMS representation of cataloged index attributes.  Included
+		 * columns don't participate in uniqueness, so ignore them.
+		 */
+		for (natt = 0; natt < idxForm->indnkeyatts; natt++)
 		{
 			int			attno = idxRel->rd_index->indkey.values[natt];
 
@@ -730,7 +973,7 @@ infer_collation_opclass_match(InferenceElem *elem, Relation idxRel,
 		inferopcinputtype = get_opclass_input_type(elem->inferopclass);
 	}
 
-	for (natt = 1; natt <= idxRel->rd_att->natts; natt++)
+	for (natt = 1; natt <= IndexRelationGetNumberOfKeyAttributes(idxRel); natt++)
 	{
 		Oid			opfamily = idxRel->rd_opfamily[natt - 1];
 		Oid			opcinputtype = idxRel->rd_opcintype[natt - 1];
@@ -1193,6 +1436,116 @@ relation_excluded_by_constraints(PlannerInfo *root,
 	return false;
 }
 
+/*
+ * prune_inheritance_children
+ *
+ * Use an inheritance parent's partition bounds to find the children that
+ * may contain rows satisfying the given restriction clauses on range table
+ * entry varno.  The clauses may be bare or wrapped in RestrictInfos.
+ *
+ * Only clauses comparing the partition key with a constant are used.
+ * Returns NULL if there are none; otherwise an array with an entry for each
+ * of the bounds' children, false if the child can be skipped.
+ */
+bool *
+prune_inheritance_children(PartitionBoundInfo *bounds, Index varno,
+						   List *clauses)
+{
+	int			nclauses = list_length(clauses);
+	int		   *strategies;
+	Datum	   *values;
+	bool	   *isnulls;
+	int			nconds = 0;
+	Const	   *arrayconst = NULL;
+	bool	   *keep;
+	ListCell   *lc;
+
+	if (nclauses == 0)
+		return NULL;
+
+	/* leave room for one array element, see below */
+	strategies = (int *) palloc((nclauses + 1) * sizeof(int));
+	values = (Datum *) palloc((nclauses + 1) * sizeof(Datum));
+	isnulls = (bool *) palloc((nclauses + 1) * sizeof(bool));
+
+	foreach(lc, clauses)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+		int			strategy;
+		Expr	   *value;
+		bool		is_array;
+
+		if (IsA(clause, RestrictInfo))
+			clause = ((RestrictInfo *) clause)->clause;
+
+		if (!partition_match_clause(bounds, varno, clause,
+									&strategy, &value, &is_array))
+			continue;
+		if (!IsA(value, Const))
+			continue;
+
+		if (is_array)
+		{
+			/* we only make use of the first "key = ANY (array)" clause */
+			if (arrayconst == NULL)
+				arrayconst = (Const *) value;
+			continue;
+		}
+
+		strategies[nconds] = strategy;
+		values[nconds] = ((Const *) value)->constvalue;
+		isnulls[nconds] = ((Const *) value)->constisnull;
+		nconds++;
+	}
+
+	if (arrayconst == NULL)
+	{
+		if (nconds == 0)
+			return NULL;
+		return partition_prune(bounds, nconds, strategies, values, isnulls);
+	}
+
+	/*
+	 * With "key = ANY (array)", a child must be kept if it may contain rows
+	 * matching any one of the array elements.
+	 */
+	keep = (bool *) palloc0(Max(bounds->nchildren, 1) * sizeof(bool));
+	if (!arrayconst->constisnull)
+	{
+		ArrayType  *arr = DatumGetArrayTypeP(arrayconst->constvalue);
+		int16		elmlen;
+		bool		elmbyval;
+		char		elmalign;
+		Datum	   *elems;
+		bool	   *elemnulls;
+		int			nelems;
+		int			i;
+
+		get_typlenbyvalalign(ARR_ELEMTYPE(arr),
+							 &elmlen, &elmbyval, &elmalign);
+		deconstruct_array(arr, ARR_ELEMTYPE(arr),
+						  elmlen, elmbyval, elmalign,
+						  &elems, &elemnulls, &nelems);
+
+		strategies[nconds] = BTEqualStrategyNumber;
+		for (i = 0; i < nelems; i++)
+		{
+			bool	   *elemkeep;
+			int			j;
+
+			values[nconds] = elems[i];
+			isnulls[nconds] = elemnulls[i];
+			elemkeep = partition_prune(bounds, nconds + 1,
+									   strategies, values, isnulls);
+			for (j = 0; j < bounds->nchildren; j++)
+				keep[j] |= elemkeep[j];
+			pfree(elemkeep);
+		}
+	}
+
+	return keep;
+}
+
 
 /*
  * build_physical_tlist
@@ -1501,3 +1854,98 @@ has_unique_index(RelOptInfo *rel, AttrNumber attno)
 	return false;
 }
 
+/*
+ * has_unique_index_on_columns
+ *
+ * Detect whether the relation has a unique index all of whose columns are
+ * among colnos, such that the corresponding element of opnos is the btree
+ * equality operator of the index column's opfamily.  If so, no two rows of
+ * the relation can satisfy "a.col op b.col" for all the given columns unless
+ * they are the same row.
+ *
+ * Unlike has_unique_index(), this is meant for correctness proofs, so we
+ * insist on the index being immediately enforced and valid, and we don't
+ * require a RelOptInfo: it's used before the planner has built any.  The
+ * caller must already hold a lock on the relation.
+ */
+bool
+has_unique_index_on_columns(Oid relid, List *colnos, List *opnos)
+{
+	Relation	relation;
+	List	   *indexoidlist;
+	ListCell   *l;
+	bool		result = false;
+
+	relation = heap_open(relid, NoLock);
+
+	if (!relation->rd_rel->relhasindex)
+	{
+		heap_close(relation, NoLock);
+		return false;
+	}
+
+	indexoidlist = RelationGetIndexList(relation);
+
+	foreach(l, indexoidlist)
+	{
+		Relation	indexRelation;
+		Form_pg_index index;
+		int			c;
+
+		indexRelation = index_open(lfirst_oid(l), AccessShareLock);
+		index = indexRelation->rd_index;
+
+		/*
+		 * Skip indexes that can't prove anything: invalid ones, ones whose
+		 * checks are deferred, partial or expression indexes, and indexes
+		 * that may not yet be usable by our snapshot (see get_relation_info).
+		 */
+		if (!index->indisvalid || !index->indisunique ||
+			!index->indimmediate ||
+			indexRelation->rd_rel->relam != BTREE_AM_OID ||
+			!heap_attisnull(indexRelation->rd_indextuple,
+							Anum_pg_index_indpred) ||
+			!heap_attisnull(indexRelation->rd_indextuple,
+							Anum_pg_index_indexprs) ||
+			(index->indcheckxmin &&
+			 !TransactionIdPrecedes(HeapTupleHeaderGetXmin(indexRelation->rd_indextuple->t_data),
+									TransactionXmin)))
+		{
+			index_close(indexRelation, NoLock);
+			continue;
+		}
+
+		for (c = 0; c < index->indnatts; c++)
+		{
+			AttrNumber	attno = index->indkey.values[c];
+			Oid			opfamily = indexRelation->rd_opfamily[c];
+			ListCell   *lc1;
+			ListCell   *lc2;
+
+			forboth(lc1, colnos, lc2, opnos)
+			{
+				if (lfirst_int(lc1) == attno &&
+					get_op_opfamily_strategy(lfirst_oid(lc2), opfamily) ==
+					BTEqualStrategyNumber)
+					break;
+			}
+			if (lc1 == NULL)
+				break;			/* this index column isn't constrained */
+		}
+
+		if (c == index->indnatts)
+			result = true;
+
+		index_close(indexRelation, NoLock);
+
+		if (result)
+			break;
+	}
+
+	list_free(indexoidlist);
+
+	heap_close(relation, NoLock);
+
+	return result;
+}
+
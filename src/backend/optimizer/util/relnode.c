@@ -112,10 +112,14 @@ build_simple_rel(PlannerInfo *root, int relid, RelOptKind reloptkind)
 	rel->relid = relid;
 	rel->rtekind = rte->rtekind;
 	/* min_attr, max_attr, attr_needed, attr_widths are set below */
+	rel->attr_needed = NULL;
+	rel->attr_widths = NULL;
 	rel->lateral_vars = NIL;
 	rel->lateral_relids = NULL;
 	rel->lateral_referencers = NULL;
 	rel->indexlist = NIL;
+	rel->statlist = NIL;
+	rel->fkeylist = NIL;
 	rel->pages = 0;
 	rel->tuples = 0;
 	rel->allvisfrac = 0;
@@ -135,8 +139,16 @@ build_simple_rel(PlannerInfo *root, int relid, RelOptKind reloptkind)
 	switch (rte->rtekind)
 	{
 		case RTE_RELATION:
-			/* Table --- retrieve statistics from the system catalogs */
-			get_relation_info(root, rte->relid, rte->inh, rel);
+
+			/*
+			 * Table --- retrieve statistics from the system catalogs.  For an
+			 * inheritance child, set_append_rel_size does that once it knows
+			 * the child won't be pruned; we need only the attr arrays now.
+			 */
+			if (reloptkind == RELOPT_OTHER_MEMBER_REL)
+				get_relation_attrs(rte->relid, rel);
+			else
+				get_relation_info(root, rte->relid, rte->inh, rel);
 			break;
 		case RTE_SUBQUERY:
 		case RTE_FUNCTION:
@@ -380,6 +392,8 @@ build_join_rel(PlannerInfo *root,
 	joinrel->lateral_relids = NULL;
 	joinrel->lateral_referencers = NULL;
 	joinrel->indexlist = NIL;
+	joinrel->statlist = NIL;
+	joinrel->fkeylist = NIL;
 	joinrel->pages = 0;
 	joinrel->tuples = 0;
 	joinrel->allvisfrac = 0;
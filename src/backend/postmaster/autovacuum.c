@@ -120,6 +120,8 @@ int			autovacuum_multixact_freeze_max_age;
 
 int			autovacuum_vac_cost_delay;
 int			autovacuum_vac_cost_limit;
+int			autovacuum_parallel_workers;
+int			autovacuum_vac_max_blocks;
 
 int			Log_autovacuum_min_duration = -1;
 
@@ -190,11 +192,32 @@ typedef struct autovac_table
 	int			at_vacuum_cost_delay;
 	int			at_vacuum_cost_limit;
 	bool		at_dobalance;
+	double		at_cost_weight;
 	char	   *at_relname;
 	char	   *at_nspname;
 	char	   *at_datname;
 } autovac_table;
 
+/*
+ * struct to keep track of the tables do_autovacuum has found to need work,
+ * so that they can be processed in order of priority
+ */
+typedef struct av_candidate
+{
+	Oid			ac_relid;
+	bool		ac_wraparound;	/* vacuum is forced for wraparound */
+	double		ac_priority;	/* see relation_needs_vacanalyze */
+	TimestampTz ac_lastvacuum;	/* last (auto)vacuum, 0 if never */
+} av_candidate;
+
+/*
+ * Upper limit on a worker's weight in cost balancing.  Workers are weighted
+ * by the priority of the table they're processing, so that an urgent table
+ * gets a bigger share of the I/O budget; capping the weight keeps a single
+ * worker from starving the others completely.
+ */
+#define AUTOVAC_MAX_COST_WEIGHT		4.0
+
 /*-------------
  * This struct holds information about a single worker's whereabouts.  We keep
  * an array of these in shared memory, sized according to
@@ -206,6 +229,7 @@ typedef struct autovac_table
  * wi_proc		pointer to PGPROC of the running worker, NULL if not started
  * wi_launchtime Time at which this worker was launched
  * wi_cost_*	Vacuum cost-based delay parameters current in this worker
+ * wi_cost_weight Weight of this worker when balancing cost limits
  *
  * All fields are protected by AutovacuumLock, except for wi_tableoid which is
  * protected by AutovacuumScheduleLock (which is read-only for everyone except
@@ -223,6 +247,7 @@ typedef struct WorkerInfoData
 	int			wi_cost_delay;
 	int			wi_cost_limit;
 	int			wi_cost_limit_base;
+	double		wi_cost_weight;
 } WorkerInfoData;
 
 typedef struct WorkerInfoData *WorkerInfo;
@@ -292,6 +317,7 @@ static void launch_worker(TimestampTz now);
 static List *get_database_list(void);
 static void rebuild_database_list(Oid newdb);
 static int	db_comparator(const void *a, const void *b);
+static int	av_candidate_comparator(const void *a, const void *b);
 static void autovac_balance_cost(void);
 
 static void do_autovacuum(void);
@@ -304,12 +330,15 @@ static void relation_needs_vacanalyze(Oid relid, AutoVacOpts *relopts,
 						  Form_pg_class classForm,
 						  PgStat_StatTabEntry *tabentry,
 						  int effective_multixact_freeze_max_age,
-						  bool *dovacuum, bool *doanalyze, bool *wraparound);
+						  bool *dovacuum, bool *doanalyze, bool *wraparound,
+						  double *priority);
 
 static void autovacuum_do_vac_analyze(autovac_table *tab,
 						  BufferAccessStrategy bstrategy);
 static AutoVacOpts *extract_autovac_opts(HeapTuple tup,
 					 TupleDesc pg_class_desc);
+static av_candidate *make_av_candidate(Oid relid, bool wraparound,
+				  double priority, PgStat_StatTabEntry *tabentry);
 static PgStat_StatTabEntry *get_pgstat_tabentry_relid(Oid relid, bool isshared,
 						  PgStat_StatDBEntry *shared,
 						  PgStat_StatDBEntry *dbentry);
@@ -1063,6 +1092,25 @@ db_comparator(const void *a, const void *b)
 		return (((const avl_dbase *) a)->adl_score < ((const avl_dbase *) b)->adl_score) ? 1 : -1;
 }
 
+/*
+ * qsort comparator for av_candidate: wraparound vacuums first, then by
+ * descending priority, then the table vacuumed longest ago first
+ */
+static int
+av_candidate_comparator(const void *a, const void *b)
+{
+	const av_candidate *ca = (const av_candidate *) a;
+	const av_candidate *cb = (const av_candidate *) b;
+
+	if (ca->ac_wraparound != cb->ac_wraparound)
+		return ca->ac_wraparound ? -1 : 1;
+	if (ca->ac_priority != cb->ac_priority)
+		return (ca->ac_priority > cb->ac_priority) ? -1 : 1;
+	if (ca->ac_lastvacuum != cb->ac_lastvacuum)
+		return (ca->ac_lastvacuum < cb->ac_lastvacuum) ? -1 : 1;
+	return 0;
+}
+
 /*
  * do_start_worker
  *
@@ -1689,6 +1737,7 @@ FreeWorkerInfo(int code, Datum arg)
 		MyWorkerInfo->wi_cost_delay = 0;
 		MyWorkerInfo->wi_cost_limit = 0;
 		MyWorkerInfo->wi_cost_limit_base = 0;
+		MyWorkerInfo->wi_cost_weight = 0;
 		dlist_push_head(&AutoVacuumShmem->av_freeWorkers,
 						&MyWorkerInfo->wi_links);
 		/* not mine anymore */
@@ -1727,9 +1776,11 @@ static void
 autovac_balance_cost(void)
 {
 	/*
-	 * The idea here is that we ration out I/O equally.  The amount of I/O
-	 * that a worker can consume is determined by cost_limit/cost_delay, so we
-	 * try to equalize those ratios rather than the raw limit settings.
+	 * The idea here is that we ration out I/O in proportion to each worker's
+	 * weight, which reflects how urgently its current table needs attention.
+	 * The amount of I/O that a worker can consume is determined by
+	 * cost_limit/cost_delay, so we try to balance those ratios rather than
+	 * the raw limit settings.
 	 *
 	 * note: in cost_limit, zero also means use value from elsewhere, because
 	 * zero is not a valid value.
@@ -1755,8 +1806,8 @@ autovac_balance_cost(void)
 		if (worker->wi_proc != NULL &&
 			worker->wi_dobalance &&
 			worker->wi_cost_limit_base > 0 && worker->wi_cost_delay > 0)
-			cost_total +=
-				(double) worker->wi_cost_limit_base / worker->wi_cost_delay;
+			cost_total += worker->wi_cost_weight *
+				worker->wi_cost_limit_base / worker->wi_cost_delay;
 	}
 
 	/* there are no cost limits -- nothing to do */
@@ -1777,7 +1828,8 @@ autovac_balance_cost(void)
 			worker->wi_cost_limit_base > 0 && worker->wi_cost_delay > 0)
 		{
 			int			limit = (int)
-			(cost_avail * worker->wi_cost_limit_base / cost_total);
+			(cost_avail * worker->wi_cost_weight *
+			 worker->wi_cost_limit_base / cost_total);
 
 			/*
 			 * We put a lower bound of 1 on the cost_limit, to avoid division-
@@ -1791,11 +1843,11 @@ autovac_balance_cost(void)
 		}
 
 		if (worker->wi_proc != NULL)
-			elog(DEBUG2, "autovac_balance_cost(pid=%u db=%u, rel=%u, dobalance=%s cost_limit=%d, cost_limit_base=%d, cost_delay=%d)",
+			elog(DEBUG2, "autovac_balance_cost(pid=%u db=%u, rel=%u, dobalance=%s cost_limit=%d, cost_limit_base=%d, cost_delay=%d, cost_weight=%.2f)",
 				 worker->wi_proc->pid, worker->wi_dboid, worker->wi_tableoid,
 				 worker->wi_dobalance ? "yes" : "no",
 				 worker->wi_cost_limit, worker->wi_cost_limit_base,
-				 worker->wi_cost_delay);
+				 worker->wi_cost_delay, worker->wi_cost_weight);
 	}
 }
 
@@ -1884,7 +1936,12 @@ do_autovacuum(void)
 	HeapTuple	tuple;
 	HeapScanDesc relScan;
 	Form_pg_database dbForm;
+	List	   *candidates = NIL;
 	List	   *table_oids = NIL;
+	av_candidate *sorted;
+	int			ncandidates;
+	int			i;
+	ListCell   *lc;
 	HASHCTL		ctl;
 	HTAB	   *table_toast_map;
 	ListCell   *volatile cell;
@@ -2007,6 +2064,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		double		priority;
 
 		if (classForm->relkind != RELKIND_RELATION &&
 			classForm->relkind != RELKIND_MATVIEW)
@@ -2022,7 +2080,8 @@ do_autovacuum(void)
 		/* Check if it needs vacuum or analyze */
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound,
+								  &priority);
 
 		/*
 		 * Check if it is a temp table (presumably, of some other backend's).
@@ -2069,9 +2128,11 @@ do_autovacuum(void)
 		}
 		else
 		{
-			/* relations that need work are added to table_oids */
+			/* relations that need work are added to candidates */
 			if (dovacuum || doanalyze)
-				table_oids = lappend_oid(table_oids, relid);
+				candidates = lappend(candidates,
+									 make_av_candidate(relid, wraparound,
+													   priority, tabentry));
 
 			/*
 			 * Remember the association for the second pass.  Note: we must do
@@ -2121,6 +2182,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		double		priority;
 
 		/*
 		 * We cannot safely process other backends' temp tables, so skip 'em.
@@ -2151,16 +2213,38 @@ do_autovacuum(void)
 
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound,
+								  &priority);
 
 		/* ignore analyze for toast tables */
 		if (dovacuum)
-			table_oids = lappend_oid(table_oids, relid);
+			candidates = lappend(candidates,
+								 make_av_candidate(relid, wraparound,
+												   priority, tabentry));
 	}
 
 	heap_endscan(relScan);
 	heap_close(classRel, AccessShareLock);
 
+	/*
+	 * Process the tables that most need attention first, rather than in
+	 * pg_class order, so that a table approaching wraparound or badly
+	 * bloated doesn't have to wait behind lots of small tables that only
+	 * just crossed their thresholds.  Other workers in this database order
+	 * the tables the same way and skip tables that somebody is already
+	 * working on, so together they work down the list from the top.
+	 */
+	ncandidates = list_length(candidates);
+	sorted = (av_candidate *) palloc(Max(ncandidates, 1) * sizeof(av_candidate));
+	i = 0;
+	foreach(lc, candidates)
+		sorted[i++] = *(av_candidate *) lfirst(lc);
+	qsort(sorted, ncandidates, sizeof(av_candidate), av_candidate_comparator);
+	for (i = 0; i < ncandidates; i++)
+		table_oids = lappend_oid(table_oids, sorted[i].ac_relid);
+	list_free_deep(candidates);
+	pfree(sorted);
+
 	/*
 	 * Create a buffer access strategy object for VACUUM to use.  We want to
 	 * use the same one across all the vacuum operations we perform, since the
@@ -2289,6 +2373,7 @@ do_autovacuum(void)
 		MyWorkerInfo->wi_cost_delay = tab->at_vacuum_cost_delay;
 		MyWorkerInfo->wi_cost_limit = tab->at_vacuum_cost_limit;
 		MyWorkerInfo->wi_cost_limit_base = tab->at_vacuum_cost_limit;
+		MyWorkerInfo->wi_cost_weight = tab->at_cost_weight;
 
 		/* do a balance */
 		autovac_balance_cost();
@@ -2455,6 +2540,28 @@ get_pgstat_tabentry_relid(Oid relid, bool isshared, PgStat_StatDBEntry *shared,
 	return tabentry;
 }
 
+/*
+ * make_av_candidate
+ *
+ * Build the av_candidate entry for a table do_autovacuum wants to process.
+ */
+static av_candidate *
+make_av_candidate(Oid relid, bool wraparound, double priority,
+				  PgStat_StatTabEntry *tabentry)
+{
+	av_candidate *cand = (av_candidate *) palloc(sizeof(av_candidate));
+
+	cand->ac_relid = relid;
+	cand->ac_wraparound = wraparound;
+	cand->ac_priority = priority;
+	cand->ac_lastvacuum = 0;
+	if (tabentry != NULL)
+		cand->ac_lastvacuum = Max(tabentry->vacuum_timestamp,
+								  tabentry->autovac_vacuum_timestamp);
+
+	return cand;
+}
+
 /*
  * table_recheck_autovac
  *
@@ -2477,6 +2584,7 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 	PgStat_StatDBEntry *shared;
 	PgStat_StatDBEntry *dbentry;
 	bool		wraparound;
+	double		priority;
 	AutoVacOpts *avopts;
 
 	/* use fresh stats */
@@ -2513,7 +2621,8 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 
 	relation_needs_vacanalyze(relid, avopts, classForm, tabentry,
 							  effective_multixact_freeze_max_age,
-							  &dovacuum, &doanalyze, &wraparound);
+							  &dovacuum, &doanalyze, &wraparound,
+							  &priority);
 
 	/* ignore ANALYZE for toast tables */
 	if (classForm->relkind == RELKIND_TOASTVALUE)
@@ -2587,6 +2696,10 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 		tab->at_params.multixact_freeze_table_age = multixact_freeze_table_age;
 		tab->at_params.is_wraparound = wraparound;
 		tab->at_params.log_min_duration = log_min_duration;
+		tab->at_params.nworkers = autovacuum_parallel_workers;
+		tab->at_params.max_blocks = (autovacuum_vac_max_blocks >= 0)
+			? autovacuum_vac_max_blocks
+			: vacuum_max_blocks;
 		tab->at_vacuum_cost_limit = vac_cost_limit;
 		tab->at_vacuum_cost_delay = vac_cost_delay;
 		tab->at_relname = NULL;
@@ -2600,6 +2713,17 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 		tab->at_dobalance =
 			!(avopts && (avopts->vacuum_cost_limit > 0 ||
 						 avopts->vacuum_cost_delay > 0));
+
+		/*
+		 * Weight this table's share of the cost budget by its priority.  A
+		 * table that has only just crossed its threshold has a priority of
+		 * about 1, the neutral weight.  Wraparound vacuums get the maximum.
+		 */
+		if (wraparound)
+			tab->at_cost_weight = AUTOVAC_MAX_COST_WEIGHT;
+		else
+			tab->at_cost_weight = Max(Min(priority, AUTOVAC_MAX_COST_WEIGHT),
+									  1.0);
 	}
 
 	heap_freetuple(classTup);
@@ -2634,6 +2758,15 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
  * transactions back, and if its relminmxid is more than
  * multixact_freeze_max_age multixacts back.
  *
+ * "priority" is set to a measure of how urgently the table needs attention,
+ * used to decide which tables to process first.  It is the largest of the
+ * ratios of dead tuples to the vacuum threshold, of tuples changed since the
+ * last analyze to the analyze threshold (this is where inserts count), and
+ * of the relfrozenxid and relminmxid ages to the respective freeze_max_age.
+ * So a table that just became due for processing has a priority of about 1,
+ * and one with several times as many dead tuples as its threshold ranks
+ * well above it.
+ *
  * A table whose autovacuum_enabled option is false is
  * automatically skipped (unless we have to vacuum it due to freeze_max_age).
  * Thus autovacuum can be disabled for specific tables. Also, when the stats
@@ -2653,7 +2786,8 @@ relation_needs_vacanalyze(Oid relid,
  /* output params below */
 						  bool *dovacuum,
 						  bool *doanalyze,
-						  bool *wraparound)
+						  bool *wraparound,
+						  double *priority)
 {
 	bool		force_vacuum;
 	bool		av_enabled;
@@ -2732,6 +2866,17 @@ relation_needs_vacanalyze(Oid relid,
 	}
 	*wraparound = force_vacuum;
 
+	/* Start the priority off with the wraparound urgency */
+	*priority = 0;
+	if (TransactionIdIsNormal(classForm->relfrozenxid))
+		*priority = (double) (recentXid - classForm->relfrozenxid) /
+			freeze_max_age;
+	if (multixact_freeze_max_age > 0 &&
+		MultiXactIdIsValid(classForm->relminmxid))
+		*priority = Max(*priority,
+						(double) (recentMulti - classForm->relminmxid) /
+						multixact_freeze_max_age);
+
 	/* User disabled it in pg_class.reloptions?  (But ignore if at risk) */
 	if (!av_enabled && !force_vacuum)
 	{
@@ -2768,6 +2913,9 @@ relation_needs_vacanalyze(Oid relid,
 		/* Determine if this table needs vacuum or analyze. */
 		*dovacuum = force_vacuum || (vactuples > vacthresh);
 		*doanalyze = (anltuples > anlthresh);
+
+		*priority = Max(*priority, vactuples / Max(vacthresh, 1.0));
+		*priority = Max(*priority, anltuples / Max(anlthresh, 1.0));
 	}
 	else
 	{
@@ -289,6 +289,7 @@ static void pgstat_recv_resetsharedcounter(PgStat_MsgResetsharedcounter *msg, in
 static void pgstat_recv_resetsinglecounter(PgStat_MsgResetsinglecounter *msg, int len);
 static void pgstat_recv_autovac(PgStat_MsgAutovacStart *msg, int len);
 static void pgstat_recv_vacuum(PgStat_MsgVacuum *msg, int len);
+static void pgstat_recv_vacuum_resume(PgStat_MsgVacuumResume *msg, int len);
 static void pgstat_recv_analyze(PgStat_MsgAnalyze *msg, int len);
 static void pgstat_recv_archiver(PgStat_MsgArchiver *msg, int len);
 static void pgstat_recv_bgwriter(PgStat_MsgBgWriter *msg, int len);
@@ -1324,12 +1325,17 @@ pgstat_report_autovac(Oid dboid)
 /* ---------
  * pgstat_report_vacuum() -
  *
- *	Tell the collector about the table we just vacuumed.
+ *	Tell the collector about the table we just vacuumed.  resume_block is
+ *	where the next VACUUM of the table should start; it is nonzero if this
+ *	VACUUM stopped before reaching the end of the table.  partial is true if
+ *	this VACUUM didn't scan the whole table, either because it stopped early
+ *	or because it didn't start at block 0.
  * ---------
  */
 void
 pgstat_report_vacuum(Oid tableoid, bool shared,
-					 PgStat_Counter livetuples, PgStat_Counter deadtuples)
+					 PgStat_Counter livetuples, PgStat_Counter deadtuples,
+					 BlockNumber resume_block, bool partial)
 {
 	PgStat_MsgVacuum msg;
 
@@ -1343,6 +1349,31 @@ pgstat_report_vacuum(Oid tableoid, bool shared,
 	msg.m_vacuumtime = GetCurrentTimestamp();
 	msg.m_live_tuples = livetuples;
 	msg.m_dead_tuples = deadtuples;
+	msg.m_resume_block = resume_block;
+	msg.m_partial = partial;
+	pgstat_send(&msg, sizeof(msg));
+}
+
+/* ---------
+ * pgstat_report_vacuum_resume() -
+ *
+ *	Tell the collector how far a VACUUM in progress has got, so that if it
+ *	is interrupted, the next VACUUM of the table can continue from there.
+ * ---------
+ */
+void
+pgstat_report_vacuum_resume(Oid tableoid, bool shared,
+							BlockNumber resume_block)
+{
+	PgStat_MsgVacuumResume msg;
+
+	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
+		return;
+
+	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_VACUUM_RESUME);
+	msg.m_databaseid = shared ? InvalidOid : MyDatabaseId;
+	msg.m_tableoid = tableoid;
+	msg.m_resume_block = resume_block;
 	pgstat_send(&msg, sizeof(msg));
 }
 
@@ -3475,6 +3506,11 @@ PgstatCollectorMain(int argc, char *argv[])
 					pgstat_recv_vacuum((PgStat_MsgVacuum *) &msg, len);
 					break;
 
+				case PGSTAT_MTYPE_VACUUM_RESUME:
+					pgstat_recv_vacuum_resume((PgStat_MsgVacuumResume *) &msg,
+											  len);
+					break;
+
 				case PGSTAT_MTYPE_ANALYZE:
 					pgstat_recv_analyze((PgStat_MsgAnalyze *) &msg, len);
 					break;
@@ -3701,6 +3737,7 @@ pgstat_get_tab_entry(PgStat_StatDBEntry *dbentry, Oid tableoid, bool create)
 		result->analyze_count = 0;
 		result->autovac_analyze_timestamp = 0;
 		result->autovac_analyze_count = 0;
+		result->vacuum_resume_block = 0;
 	}
 
 	return result;
@@ -4803,6 +4840,7 @@ pgstat_recv_tabstat(PgStat_MsgTabstat *msg, int len)
 			tabentry->analyze_count = 0;
 			tabentry->autovac_analyze_timestamp = 0;
 			tabentry->autovac_analyze_count = 0;
+			tabentry->vacuum_resume_block = 0;
 		}
 		else
 		{
@@ -4821,6 +4859,7 @@ pgstat_recv_tabstat(PgStat_MsgTabstat *msg, int len)
 			{
 				tabentry->n_live_tuples = 0;
 				tabentry->n_dead_tuples = 0;
+				tabentry->vacuum_resume_block = 0;
 			}
 			tabentry->n_live_tuples += tabmsg->t_counts.t_delta_live_tuples;
 			tabentry->n_dead_tuples += tabmsg->t_counts.t_delta_dead_tuples;
@@ -5057,7 +5096,15 @@ pgstat_recv_vacuum(PgStat_MsgVacuum *msg, int len)
 	tabentry = pgstat_get_tab_entry(dbentry, msg->m_tableoid, true);
 
 	tabentry->n_live_tuples = msg->m_live_tuples;
-	tabentry->n_dead_tuples = msg->m_dead_tuples;
+
+	/*
+	 * If the VACUUM covered only part of the table, the rest still has as
+	 * many dead tuples as before, as far as we know.  Keep the old count so
+	 * that autovacuum comes back for the remainder.
+	 */
+	if (!msg->m_partial)
+		tabentry->n_dead_tuples = msg->m_dead_tuples;
+	tabentry->vacuum_resume_block = msg->m_resume_block;
 
 	if (msg->m_autovacuum)
 	{
@@ -5071,6 +5118,25 @@ pgstat_recv_vacuum(PgStat_MsgVacuum *msg, int len)
 	}
 }
 
+/* ----------
+ * pgstat_recv_vacuum_resume() -
+ *
+ *	Process a VACUUM_RESUME message.
+ * ----------
+ */
+static void
+pgstat_recv_vacuum_resume(PgStat_MsgVacuumResume *msg, int len)
+{
+	PgStat_StatDBEntry *dbentry;
+	PgStat_StatTabEntry *tabentry;
+
+	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
+
+	tabentry = pgstat_get_tab_entry(dbentry, msg->m_tableoid, true);
+
+	tabentry->vacuum_resume_block = msg->m_resume_block;
+}
+
 /* ----------
  * pgstat_recv_analyze() -
  *
@@ -0,0 +1,668 @@
+/*-------------------------------------------------------------------------
+ *
+ * dependencies.c
+ *	  POSTGRES functional dependencies
+ *
+ * A functional dependency (a => b) says that knowing the value of 'a' lets
+ * us predict the value of 'b'.  In a real-world data set dependencies are
+ * rarely perfect, so instead of a yes/no flag we store the "degree" of each
+ * dependency: the fraction of sampled rows consistent with it.
+ *
+ * When estimating equality clauses on both 'a' and 'b', a dependency of
+ * degree f lets us replace the independence assumption
+ *
+ *		P(a,b) = P(a) * P(b)
+ *
+ * with
+ *
+ *		P(a,b) = P(a) * [f + (1-f) * P(b)]
+ *
+ * which reduces to P(a) for a perfect dependency (f = 1).
+ *
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/statistics/dependencies.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_statistic_ext.h"
+#include "nodes/relation.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "statistics/extended_stats_internal.h"
+#include "statistics/statistics.h"
+#include "utils/lsyscache.h"
+#include "utils/syscache.h"
+#include "utils/typcache.h"
+
+/* size of the struct header fields (magic, type, ndeps) */
+#define SizeOfHeader		(3 * sizeof(uint32))
+
+/* size of a serialized dependency (degree, natts, atts) */
+#define SizeOfItem(natts) \
+	(sizeof(double) + sizeof(AttrNumber) * (1 + (natts)))
+
+
+static double dependency_degree(int numrows, HeapTuple *rows,
+				  VacAttrStats **stats, int k, int *dependency);
+static MVDependency *find_strongest_dependency(MVDependencies *dependencies,
+						  Bitmapset *attnums);
+
+
+/*
+ * statext_dependencies_build
+ *		Detect functional dependencies between the given columns.
+ *
+ * For every subset of the columns (the determinant) and every column not in
+ * it (the implied column), we measure how strongly the determinant predicts
+ * the implied column.  Dependencies that never hold in the sample aren't
+ * kept.
+ */
+MVDependencies *
+statext_dependencies_build(int numrows, HeapTuple *rows, Bitmapset *attrs,
+						   VacAttrStats **stats)
+{
+	int			numattrs = bms_num_members(attrs);
+	AttrNumber	attnums[STATS_MAX_DIMENSIONS];
+	int			mask;
+	int			x;
+	int			i;
+	MVDependencies *dependencies = NULL;
+	int			maxdeps = 0;
+
+	/* map dimensions to attribute numbers */
+	i = 0;
+	x = -1;
+	while ((x = bms_next_member(attrs, x)) >= 0)
+		attnums[i++] = (AttrNumber) x;
+
+	/* the determinant is any non-empty, proper subset of the columns */
+	for (mask = 1; mask < (1 << numattrs) - 1; mask++)
+	{
+		int			dependency[STATS_MAX_DIMENSIONS];
+		int			k = 0;
+		int			j;
+
+		for (j = 0; j < numattrs; j++)
+		{
+			if (mask & (1 << j))
+				dependency[k++] = j;
+		}
+
+		/* try each of the remaining columns as the implied one */
+		for (j = 0; j < numattrs; j++)
+		{
+			double		degree;
+			MVDependency *d;
+			int			n;
+
+			if (mask & (1 << j))
+				continue;
+
+			dependency[k] = j;
+
+			degree = dependency_degree(numrows, rows, stats, k + 1,
+									   dependency);
+
+			/* if the dependency seems entirely invalid, don't store it */
+			if (degree == 0.0)
+				continue;
+
+			d = (MVDependency *) palloc0(offsetof(MVDependency, attributes)
+										 + (k + 1) * sizeof(AttrNumber));
+
+			/* copy the dependency (and keep the indexes into stxkeys) */
+			d->degree = degree;
+			d->nattributes = k + 1;
+			for (n = 0; n < k + 1; n++)
+				d->attributes[n] = attnums[dependency[n]];
+
+			/* initialize or enlarge the list of dependencies */
+			if (dependencies == NULL)
+			{
+				maxdeps = 16;
+				dependencies = (MVDependencies *)
+					palloc0(offsetof(MVDependencies, deps) +
+							maxdeps * sizeof(MVDependency *));
+
+				dependencies->magic = STATS_DEPS_MAGIC;
+				dependencies->type = STATS_DEPS_TYPE_BASIC;
+				dependencies->ndeps = 0;
+			}
+			else if (dependencies->ndeps >= maxdeps)
+			{
+				maxdeps *= 2;
+				dependencies = (MVDependencies *)
+					repalloc(dependencies, offsetof(MVDependencies, deps) +
+							 maxdeps * sizeof(MVDependency *));
+			}
+
+			dependencies->deps[dependencies->ndeps++] = d;
+		}
+	}
+
+	return dependencies;
+}
+
+/*
+ * dependency_degree
+ *		Compute the degree of the dependency whose determinant is the first
+ *		(k-1) dimensions in 'dependency' and whose implied column is the
+ *		last one.
+ *
+ * We sort the sample by the determinant and then the implied column, and
+ * walk the groups of rows sharing the same determinant values.  A group
+ * supports the dependency if all its rows have the same implied value too.
+ * The degree is the fraction of rows in supporting groups.
+ */
+static double
+dependency_degree(int numrows, HeapTuple *rows, VacAttrStats **stats,
+				  int k, int *dependency)
+{
+	int			i;
+	int			group_start;
+	int			n_supporting_rows = 0;
+	MultiSortSupport mss;
+	SortItem   *items;
+	AttrNumber	attnums[STATS_MAX_DIMENSIONS];
+
+	/* we need at least two columns (one determinant, one implied) */
+	Assert(k >= 2);
+
+	mss = multi_sort_init(k);
+
+	/* prepare the sort function for the dimensions */
+	for (i = 0; i < k; i++)
+	{
+		VacAttrStats *colstat = stats[dependency[i]];
+		TypeCacheEntry *type;
+
+		type = lookup_type_cache(colstat->attrtypid, TYPECACHE_LT_OPR);
+		if (type->lt_opr == InvalidOid) /* shouldn't happen */
+			elog(ERROR, "cache lookup failed for ordering operator for type %u",
+				 colstat->attrtypid);
+
+		multi_sort_add_dimension(mss, i, type->lt_opr,
+								 colstat->attr->attcollation);
+		attnums[i] = colstat->tupattnum;
+	}
+
+	items = build_sorted_items(numrows, rows, stats[0]->tupDesc, mss,
+							   k, attnums);
+
+	/*
+	 * Walk the sorted rows; whenever the determinant changes (or we reach
+	 * the end), the group just finished is consistent iff its first and last
+	 * rows agree on the implied column, since the group is sorted by it.
+	 */
+	group_start = 0;
+	for (i = 1; i <= numrows; i++)
+	{
+		if (i == numrows ||
+			multi_sort_compare_dims(0, k - 2, &items[i - 1], &items[i],
+									mss) != 0)
+		{
+			if (multi_sort_compare_dim(k - 1, &items[group_start],
+									   &items[i - 1], mss) == 0)
+				n_supporting_rows += (i - group_start);
+
+			group_start = i;
+		}
+	}
+
+	pfree(items);
+	pfree(mss);
+
+	return (n_supporting_rows * 1.0 / numrows);
+}
+
+/*
+ * statext_dependencies_serialize
+ *		Serialize list of dependencies into a bytea value.
+ */
+bytea *
+statext_dependencies_serialize(MVDependencies *dependencies)
+{
+	int			i;
+	bytea	   *output;
+	char	   *tmp;
+	Size		len;
+
+	/* we need to store ndeps, with a number of attributes for each one */
+	len = VARHDRSZ + SizeOfHeader;
+
+	/* and also include space for the actual attribute numbers and degrees */
+	for (i = 0; i < dependencies->ndeps; i++)
+		len += SizeOfItem(dependencies->deps[i]->nattributes);
+
+	output = (bytea *) palloc0(len);
+	SET_VARSIZE(output, len);
+
+	tmp = VARDATA(output);
+
+	/* Store the base struct values (magic, type, ndeps) */
+	memcpy(tmp, &dependencies->magic, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &dependencies->type, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &dependencies->ndeps, sizeof(uint32));
+	tmp += sizeof(uint32);
+
+	/* store number of attributes and attribute numbers for each dependency */
+	for (i = 0; i < dependencies->ndeps; i++)
+	{
+		MVDependency *d = dependencies->deps[i];
+
+		memcpy(tmp, &d->degree, sizeof(double));
+		tmp += sizeof(double);
+
+		memcpy(tmp, &d->nattributes, sizeof(AttrNumber));
+		tmp += sizeof(AttrNumber);
+
+		memcpy(tmp, d->attributes, sizeof(AttrNumber) * d->nattributes);
+		tmp += sizeof(AttrNumber) * d->nattributes;
+
+		/* protect against overflow */
+		Assert(tmp <= ((char *) output + len));
+	}
+
+	return output;
+}
+
+/*
+ * statext_dependencies_deserialize
+ *		Reads serialized dependencies into MVDependencies structure.
+ */
+MVDependencies *
+statext_dependencies_deserialize(bytea *data)
+{
+	int			i;
+	Size		min_expected_size;
+	MVDependencies *dependencies;
+	char	   *tmp;
+
+	if (data == NULL)
+		return NULL;
+
+	if (VARSIZE_ANY_EXHDR(data) < SizeOfHeader)
+		elog(ERROR, "invalid MVDependencies size %zu (expected at least %zu)",
+			 (Size) VARSIZE_ANY_EXHDR(data), SizeOfHeader);
+
+	/* read the MVDependencies header */
+	dependencies = (MVDependencies *) palloc0(sizeof(MVDependencies));
+
+	/* initialize pointer to the data part (skip the varlena header) */
+	tmp = VARDATA_ANY(data);
+
+	/* read the header fields and perform basic sanity checks */
+	memcpy(&dependencies->magic, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&dependencies->type, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&dependencies->ndeps, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+
+	if (dependencies->magic != STATS_DEPS_MAGIC)
+		elog(ERROR, "invalid dependency magic %d (expected %d)",
+			 dependencies->magic, STATS_DEPS_MAGIC);
+
+	if (dependencies->type != STATS_DEPS_TYPE_BASIC)
+		elog(ERROR, "invalid dependency type %d (expected %d)",
+			 dependencies->type, STATS_DEPS_TYPE_BASIC);
+
+	if (dependencies->ndeps == 0)
+		elog(ERROR, "invalid zero-length item array in MVDependencies");
+
+	/* what minimum bytea size do we expect for those parameters */
+	min_expected_size = SizeOfHeader + dependencies->ndeps * SizeOfItem(2);
+
+	if (VARSIZE_ANY_EXHDR(data) < min_expected_size)
+		elog(ERROR, "invalid dependencies size %zu (expected at least %zu)",
+			 (Size) VARSIZE_ANY_EXHDR(data), min_expected_size);
+
+	/* allocate space for the MCV items */
+	dependencies = repalloc(dependencies, offsetof(MVDependencies, deps)
+							+ (dependencies->ndeps * sizeof(MVDependency *)));
+
+	for (i = 0; i < dependencies->ndeps; i++)
+	{
+		double		degree;
+		AttrNumber	k;
+		MVDependency *d;
+
+		/* degree of validity */
+		memcpy(&degree, tmp, sizeof(double));
+		tmp += sizeof(double);
+
+		/* number of attributes */
+		memcpy(&k, tmp, sizeof(AttrNumber));
+		tmp += sizeof(AttrNumber);
+
+		/* is the number of attributes valid? */
+		Assert((k >= 2) && (k <= STATS_MAX_DIMENSIONS));
+
+		/* now that we know the number of attributes, allocate the dependency */
+		d = (MVDependency *) palloc0(offsetof(MVDependency, attributes)
+									 + (k * sizeof(AttrNumber)));
+
+		d->degree = degree;
+		d->nattributes = k;
+
+		/* copy attribute numbers */
+		memcpy(d->attributes, tmp, sizeof(AttrNumber) * d->nattributes);
+		tmp += sizeof(AttrNumber) * d->nattributes;
+
+		dependencies->deps[i] = d;
+
+		/* still within the bytea */
+		Assert(tmp <= ((char *) data + VARSIZE_ANY(data)));
+	}
+
+	/* we should have consumed the whole bytea exactly */
+	Assert(tmp == ((char *) data + VARSIZE_ANY(data)));
+
+	return dependencies;
+}
+
+/*
+ * statext_dependencies_load
+ *		Load the functional dependencies for the indicated pg_statistic_ext
+ *		tuple
+ */
+MVDependencies *
+statext_dependencies_load(Oid mvoid)
+{
+	bool		isnull;
+	Datum		deps;
+	HeapTuple	htup;
+	MVDependencies *result;
+
+	htup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(mvoid));
+	if (!HeapTupleIsValid(htup))
+		elog(ERROR, "cache lookup failed for statistics object %u", mvoid);
+
+	deps = SysCacheGetAttr(STATEXTOID, htup,
+						   Anum_pg_statistic_ext_stxdependencies, &isnull);
+	if (isnull)
+		elog(ERROR,
+			 "requested statistic kind %c is not yet built for statistics object %u",
+			 STATS_EXT_DEPENDENCIES, mvoid);
+
+	result = statext_dependencies_deserialize(DatumGetByteaP(deps));
+
+	ReleaseSysCache(htup);
+
+	return result;
+}
+
+/*
+ * find_strongest_dependency
+ *		find the strongest dependency on the attributes
+ *
+ * When applying functional dependencies, we start with the strongest
+ * dependencies.  That is, we select the dependency that:
+ *
+ * (a) has all attributes covered by equality clauses
+ *
+ * (b) has the most attributes
+ *
+ * (c) has the highest degree of validity
+ *
+ * This guarantees that we eliminate the most redundant conditions first
+ * (see the comment in dependencies_clauselist_selectivity).
+ */
+static MVDependency *
+find_strongest_dependency(MVDependencies *dependencies, Bitmapset *attnums)
+{
+	int			i,
+				j;
+	MVDependency *strongest = NULL;
+
+	/* number of attnums in clauses */
+	int			nattnums = bms_num_members(attnums);
+
+	/*
+	 * Iterate over the MVDependency items and find the strongest one from the
+	 * fully-matched dependencies.
+	 */
+	for (i = 0; i < dependencies->ndeps; i++)
+	{
+		MVDependency *dependency = dependencies->deps[i];
+		bool		fully_matched = true;
+
+		/*
+		 * Skip dependencies referencing more attributes than available
+		 * clauses, as those can't be fully matched.
+		 */
+		if (dependency->nattributes > nattnums)
+			continue;
+
+		if (strongest)
+		{
+			/* skip dependencies on fewer attributes than the strongest. */
+			if (dependency->nattributes < strongest->nattributes)
+				continue;
+
+			/* also skip weaker dependencies when attribute count matches */
+			if (strongest->nattributes == dependency->nattributes &&
+				strongest->degree > dependency->degree)
+				continue;
+		}
+
+		/*
+		 * this dependency is stronger, but we must still check that it's
+		 * fully matched to these attnums.
+		 */
+		for (j = 0; j < dependency->nattributes; j++)
+		{
+			if (!bms_is_member(dependency->attributes[j], attnums))
+			{
+				fully_matched = false;
+				break;
+			}
+		}
+
+		if (fully_matched)
+			strongest = dependency;
+	}
+
+	return strongest;
+}
+
+/*
+ * dependencies_clauselist_selectivity
+ *		Return the estimated selectivity of (a subset of) the given clauses
+ *		using functional dependency statistics, or 1.0 if no useful
+ *		functional dependency statistic exists.
+ *
+ * 'estimatedclauses' is an input/output argument that gets a bit set
+ * corresponding to the (zero-based) list index of each clause that is
+ * included in the estimated selectivity.
+ *
+ * Given equality clauses on attributes (a,b) we find the strongest dependency
+ * between them, i.e. either (a=>b) or (b=>a).  Assuming (a=>b) is the selected
+ * dependency, we then combine the per-clause selectivities using the formula
+ *
+ *	   P(a,b) = P(a) * [f + (1-f)*P(b)]
+ *
+ * where 'f' is the degree of the dependency.
+ *
+ * With clauses on more than two attributes, the dependencies are applied
+ * recursively, starting with the widest/strongest dependencies.  For example
+ * P(a,b,c) is first split like this:
+ *
+ *	   P(a,b,c) = P(a,b) * [f + (1-f)*P(c)]
+ *
+ * assuming (a,b=>c) is the strongest dependency.
+ *
+ * Only the clauses on implied attributes are estimated and marked here; the
+ * determinant clauses are left for the caller to estimate as usual, which
+ * supplies the P(a) factor in the above formulas.
+ */
+Selectivity
+dependencies_clauselist_selectivity(PlannerInfo *root,
+									List *clauses,
+									int varRelid,
+									JoinType jointype,
+									SpecialJoinInfo *sjinfo,
+									RelOptInfo *rel,
+									Bitmapset **estimatedclauses)
+{
+	Selectivity s1 = 1.0;
+	ListCell   *l;
+	Bitmapset  *clauses_attnums = NULL;
+	StatisticExtInfo *stat;
+	MVDependencies *dependencies;
+	AttrNumber *list_attnums;
+	int			listidx;
+
+	/* check if there's any stats that might be useful for us. */
+	if (!has_stats_of_kind(rel->statlist, STATS_EXT_DEPENDENCIES))
+		return 1.0;
+
+	list_attnums = (AttrNumber *) palloc(sizeof(AttrNumber) *
+										 list_length(clauses));
+
+	/*
+	 * Pre-process the clauses list to extract the attnums seen in each item.
+	 * We need to determine if there's any clauses which will be useful for
+	 * dependency selectivity estimations.  Along the way we'll record all of
+	 * the attnums for each clause in a list which we'll reference later so we
+	 * don't need to repeat the same work again.  We'll also keep track of all
+	 * attnums seen.
+	 */
+	listidx = 0;
+	foreach(l, clauses)
+	{
+		Node	   *clause = (Node *) lfirst(l);
+		AttrNumber	attnum;
+
+		if (!bms_is_member(listidx, *estimatedclauses) &&
+			statext_is_compatible_clause(clause, rel->relid, true, &attnum))
+		{
+			list_attnums[listidx] = attnum;
+			clauses_attnums = bms_add_member(clauses_attnums, attnum);
+		}
+		else
+			list_attnums[listidx] = InvalidAttrNumber;
+
+		listidx++;
+	}
+
+	/*
+	 * If there's not at least two distinct attnums then reject the whole list
+	 * of clauses.  We must return 1.0 so the calling function's selectivity is
+	 * unaffected.
+	 */
+	if (bms_num_members(clauses_attnums) < 2)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	/* find the best suited statistics object for these attnums */
+	stat = choose_best_statistics(rel->statlist, clauses_attnums,
+								  STATS_EXT_DEPENDENCIES);
+
+	/* if no matching stats could be found then we've nothing to do */
+	if (!stat)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	/* load the dependency items stored in the statistics object */
+	dependencies = statext_dependencies_load(stat->statOid);
+
+	/*
+	 * Apply the dependencies recursively, starting with the widest/strongest
+	 * ones, and proceeding to the smaller/weaker ones.  At the end of each
+	 * round we factor in the selectivity of clauses on the implied attribute,
+	 * and remove that attribute from the set.
+	 */
+	while (true)
+	{
+		Selectivity s2 = 1.0;
+		MVDependency *dependency;
+		AttrNumber	attnum;
+
+		/* the widest/strongest dependency, fully matched by clauses */
+		dependency = find_strongest_dependency(dependencies,
+											   clauses_attnums);
+
+		/* if no suitable dependency was found, we're done */
+		if (!dependency)
+			break;
+
+		/*
+		 * We found an applicable dependency, so find all the clauses on the
+		 * implied attribute - with dependency (a,b => c) we look for clauses
+		 * on 'c'.
+		 */
+		attnum = dependency->attributes[dependency->nattributes - 1];
+
+		listidx = -1;
+		foreach(l, clauses)
+		{
+			Node	   *clause;
+
+			listidx++;
+
+			/*
+			 * Skip incompatible clauses, and ones we've already estimated on.
+			 */
+			if (list_attnums[listidx] == InvalidAttrNumber ||
+				bms_is_member(listidx, *estimatedclauses))
+				continue;
+
+			/*
+			 * Technically we could find more than one clause for a given
+			 * attnum.  Since these clauses must be equality clauses, we
+			 * choose to only take the selectivity estimate from the final
+			 * clause in the list for this attnum.  If the attnum happens to
+			 * be compared to a different Const in another clause then no
+			 * rows will match anyway.  If it happens to be compared to the
+			 * same Const, then ignoring the additional clause is just the
+			 * thing to do.
+			 */
+			if (list_attnums[listidx] == attnum)
+			{
+				clause = (Node *) lfirst(l);
+
+				s2 = clause_selectivity(root, clause, varRelid, jointype,
+										sjinfo);
+
+				/* mark this one as done, so we don't touch it again. */
+				*estimatedclauses = bms_add_member(*estimatedclauses, listidx);
+
+				/*
+				 * Mark that we've got and used the dependency on this clause.
+				 * We'll want to ignore this when looking for the next
+				 * strongest dependency above.
+				 */
+				clauses_attnums = bms_del_member(clauses_attnums, attnum);
+			}
+		}
+
+		/*
+		 * Now factor in the selectivity for all the "implied" clauses into
+		 * the final one, using this formula:
+		 *
+		 * P(a,b) = P(a) * (f + (1-f) * P(b))
+		 *
+		 * where 'f' is the degree of validity of the dependency.
+		 */
+		s1 *= (dependency->degree + (1 - dependency->degree) * s2);
+	}
+
+	pfree(dependencies);
+	pfree(list_attnums);
+
+	return s1;
+}
@@ -0,0 +1,826 @@
+/*-------------------------------------------------------------------------
+ *
+ * mcv.c
+ *	  POSTGRES multivariate MCV lists
+ *
+ * A multivariate MCV (most-common values) list stores the most frequent
+ * combinations of values of the columns covered by a statistics object,
+ * together with their frequencies in the sample.  Unlike per-column MCV
+ * lists in pg_statistic, this captures the joint distribution of the
+ * columns, so it gives good estimates for conditions on correlated columns
+ * whether or not those conditions are equalities.
+ *
+ * For each item we also keep the "base frequency", i.e. the frequency the
+ * combination would have if the columns were independent.  This lets us
+ * combine the MCV list with the regular per-column estimates for the part
+ * of the data not covered by the list.
+ *
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/statistics/mcv.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_statistic_ext.h"
+#include "fmgr.h"
+#include "nodes/relation.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "statistics/extended_stats_internal.h"
+#include "statistics/statistics.h"
+#include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
+#include "utils/syscache.h"
+#include "utils/typcache.h"
+
+/* size of the struct header fields (magic, type, nitems, ndimensions) */
+#define SizeOfHeader		(3 * sizeof(uint32) + sizeof(AttrNumber))
+
+
+static int	compare_sort_item_count(const void *a, const void *b);
+static int	get_mincount_for_mcv_list(int numrows, int ngroups);
+static double *build_base_frequencies(int numrows, SortItem *items,
+					   int ngroups, SortItem **groups, int ndims,
+					   VacAttrStats **stats);
+static bool mcv_item_matches_clause(Node *clause, MCVItem *item,
+						Bitmapset *keys);
+
+
+/*
+ * statext_mcv_build
+ *		Build a multivariate MCV list from the sampled rows.
+ *
+ * The sample is sorted on all the columns and split into groups of equal
+ * values.  If there are few enough groups and none of them is seen only
+ * once, the list covers the whole sample; otherwise we keep only the groups
+ * noticeably more frequent than average, up to the statistics target.
+ */
+MCVList *
+statext_mcv_build(int numrows, HeapTuple *rows, Bitmapset *attrs,
+				  VacAttrStats **stats)
+{
+	int			i;
+	int			numattrs = bms_num_members(attrs);
+	int			ngroups;
+	int			nitems;
+	int			mincount;
+	int			stattarget = 0;
+	AttrNumber	attnums[STATS_MAX_DIMENSIONS];
+	MultiSortSupport mss;
+	SortItem   *items;
+	SortItem  **groups;
+	double	   *base_frequencies;
+	MCVList    *mcvlist;
+
+	mss = multi_sort_init(numattrs);
+
+	/* prepare the sort functions, and find the statistics target */
+	for (i = 0; i < numattrs; i++)
+	{
+		VacAttrStats *colstat = stats[i];
+		TypeCacheEntry *type;
+		int			target = colstat->attr->attstattarget;
+
+		type = lookup_type_cache(colstat->attrtypid, TYPECACHE_LT_OPR);
+		if (type->lt_opr == InvalidOid) /* shouldn't happen */
+			elog(ERROR, "cache lookup failed for ordering operator for type %u",
+				 colstat->attrtypid);
+
+		multi_sort_add_dimension(mss, i, type->lt_opr,
+								 colstat->attr->attcollation);
+		attnums[i] = colstat->tupattnum;
+
+		if (target < 0)
+			target = default_statistics_target;
+		stattarget = Max(stattarget, target);
+	}
+
+	/* a zero target means the user doesn't want the list */
+	if (stattarget == 0)
+		return NULL;
+
+	items = build_sorted_items(numrows, rows, stats[0]->tupDesc, mss,
+							   numattrs, attnums);
+
+	/*
+	 * Collapse the sorted items into groups.  The first item of each group
+	 * represents it, with the group size in its count field.
+	 */
+	groups = (SortItem **) palloc(numrows * sizeof(SortItem *));
+	ngroups = 0;
+	for (i = 0; i < numrows; i++)
+	{
+		if (ngroups > 0 &&
+			multi_sort_compare(groups[ngroups - 1], &items[i], mss) == 0)
+			groups[ngroups - 1]->count++;
+		else
+		{
+			items[i].count = 1;
+			groups[ngroups++] = &items[i];
+		}
+	}
+
+	/* order the groups by frequency, most common first */
+	qsort(groups, ngroups, sizeof(SortItem *), compare_sort_item_count);
+
+	/*
+	 * If every group was seen more than once and they all fit, the sample
+	 * presumably contains every combination there is, so keep them all.
+	 * Otherwise keep only the groups common enough to be worth tracking.
+	 */
+	if (ngroups <= stattarget && groups[ngroups - 1]->count > 1)
+		nitems = ngroups;
+	else
+	{
+		mincount = get_mincount_for_mcv_list(numrows, ngroups);
+
+		nitems = 0;
+		while (nitems < ngroups && nitems < stattarget &&
+			   groups[nitems]->count >= mincount)
+			nitems++;
+	}
+
+	if (nitems == 0)
+	{
+		pfree(groups);
+		pfree(items);
+		pfree(mss);
+		return NULL;
+	}
+
+	base_frequencies = build_base_frequencies(numrows, items, nitems, groups,
+											  numattrs, stats);
+
+	/* and finally build the MCV list itself */
+	mcvlist = (MCVList *) palloc0(sizeof(MCVList));
+	mcvlist->magic = STATS_MCV_MAGIC;
+	mcvlist->type = STATS_MCV_TYPE_BASIC;
+	mcvlist->ndimensions = numattrs;
+	mcvlist->nitems = nitems;
+	for (i = 0; i < numattrs; i++)
+		mcvlist->types[i] = stats[i]->attrtypid;
+
+	mcvlist->items = (MCVItem **) palloc(nitems * sizeof(MCVItem *));
+	for (i = 0; i < nitems; i++)
+	{
+		MCVItem    *item = (MCVItem *) palloc(sizeof(MCVItem));
+
+		/* the values still point into the sample rows, which is fine */
+		item->values = (Datum *) palloc(numattrs * sizeof(Datum));
+		item->isnull = (bool *) palloc(numattrs * sizeof(bool));
+		memcpy(item->values, groups[i]->values, numattrs * sizeof(Datum));
+		memcpy(item->isnull, groups[i]->isnull, numattrs * sizeof(bool));
+
+		item->frequency = (double) groups[i]->count / numrows;
+		item->base_frequency = base_frequencies[i];
+
+		mcvlist->items[i] = item;
+	}
+
+	pfree(base_frequencies);
+	pfree(groups);
+	pfree(items);
+	pfree(mss);
+
+	return mcvlist;
+}
+
+/*
+ * qsort comparator ordering SortItem pointers by descending count
+ */
+static int
+compare_sort_item_count(const void *a, const void *b)
+{
+	int			ca = (*(SortItem *const *) a)->count;
+	int			cb = (*(SortItem *const *) b)->count;
+
+	if (ca > cb)
+		return -1;
+	if (ca < cb)
+		return 1;
+	return 0;
+}
+
+/*
+ * get_mincount_for_mcv_list
+ *		Minimum number of sample rows a group needs to make the MCV list.
+ *
+ * As in compute_scalar_stats, a value has to be noticeably more common than
+ * the average (by 25%) to be considered a most-common value, and we never
+ * keep values seen only once.
+ */
+static int
+get_mincount_for_mcv_list(int numrows, int ngroups)
+{
+	double		avgcount = (double) numrows / ngroups;
+	int			mincount = (int) (avgcount * 1.25);
+
+	return Max(mincount, 2);
+}
+
+/*
+ * build_base_frequencies
+ *		Compute, for each of the first 'ngroups' groups, the product of the
+ *		per-column frequencies of its values in the sample.
+ *
+ * For each column we sort the sample on that column alone, collapse it into
+ * distinct values with counts, and look each group's value up by binary
+ * search.
+ */
+static double *
+build_base_frequencies(int numrows, SortItem *items, int ngroups,
+					   SortItem **groups, int ndims, VacAttrStats **stats)
+{
+	int			dim;
+	int			i;
+	double	   *result = (double *) palloc(ngroups * sizeof(double));
+	SortItem   *dimitems = (SortItem *) palloc(numrows * sizeof(SortItem));
+
+	for (i = 0; i < ngroups; i++)
+		result[i] = 1.0;
+
+	for (dim = 0; dim < ndims; dim++)
+	{
+		MultiSortSupport mss = multi_sort_init(1);
+		TypeCacheEntry *type;
+		int			ndistinct;
+
+		type = lookup_type_cache(stats[dim]->attrtypid, TYPECACHE_LT_OPR);
+		multi_sort_add_dimension(mss, 0, type->lt_opr,
+								 stats[dim]->attr->attcollation);
+
+		for (i = 0; i < numrows; i++)
+		{
+			dimitems[i].values = &items[i].values[dim];
+			dimitems[i].isnull = &items[i].isnull[dim];
+			dimitems[i].count = 1;
+		}
+
+		qsort_arg((void *) dimitems, numrows, sizeof(SortItem),
+				  multi_sort_compare, mss);
+
+		/* collapse into distinct values */
+		ndistinct = 1;
+		for (i = 1; i < numrows; i++)
+		{
+			if (multi_sort_compare(&dimitems[ndistinct - 1], &dimitems[i],
+								   mss) == 0)
+				dimitems[ndistinct - 1].count++;
+			else
+				dimitems[ndistinct++] = dimitems[i];
+		}
+
+		/* look up the value of each group */
+		for (i = 0; i < ngroups; i++)
+		{
+			SortItem	key;
+			int			lo = 0,
+						hi = ndistinct - 1;
+
+			key.values = &groups[i]->values[dim];
+			key.isnull = &groups[i]->isnull[dim];
+
+			while (lo <= hi)
+			{
+				int			mid = (lo + hi) / 2;
+				int			cmp = multi_sort_compare(&key, &dimitems[mid],
+													 mss);
+
+				if (cmp == 0)
+				{
+					result[i] *= (double) dimitems[mid].count / numrows;
+					break;
+				}
+				else if (cmp < 0)
+					hi = mid - 1;
+				else
+					lo = mid + 1;
+			}
+
+			/* the value came from the sample, so it must be there */
+			Assert(lo <= hi);
+		}
+
+		pfree(mss);
+	}
+
+	pfree(dimitems);
+
+	return result;
+}
+
+/*
+ * statext_mcv_serialize
+ *		Serialize an MCV list into a bytea value.
+ *
+ * The layout is the header (magic, type, nitems, ndimensions), the type OID
+ * of each dimension, and then for each item its frequency, base frequency
+ * and one (isnull, value) pair per dimension.  Pass-by-value datums are
+ * stored as whole Datums, other fixed-length values as typlen bytes, and
+ * varlena and cstring values as a length word followed by the bytes.
+ */
+bytea *
+statext_mcv_serialize(MCVList *mcvlist, VacAttrStats **stats)
+{
+	int			i,
+				dim;
+	int			ndims = mcvlist->ndimensions;
+	Size		len;
+	bytea	   *output;
+	char	   *ptr;
+	Datum	  **detoasted;
+
+	len = VARHDRSZ + SizeOfHeader + ndims * sizeof(Oid);
+
+	/*
+	 * Compute the total size, detoasting varlena values on the way so that
+	 * we store them in plain uncompressed form.
+	 */
+	detoasted = (Datum **) palloc(mcvlist->nitems * sizeof(Datum *));
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		detoasted[i] = (Datum *) palloc(ndims * sizeof(Datum));
+
+		len += 2 * sizeof(double);
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			int			typlen = stats[dim]->attrtype->typlen;
+			bool		typbyval = stats[dim]->attrtype->typbyval;
+
+			len += sizeof(bool);
+			if (item->isnull[dim])
+				continue;
+
+			if (typbyval)
+				len += sizeof(Datum);
+			else if (typlen > 0)
+				len += typlen;
+			else if (typlen == -1)
+			{
+				detoasted[i][dim] =
+					PointerGetDatum(PG_DETOAST_DATUM(item->values[dim]));
+				len += sizeof(uint32) + VARSIZE(DatumGetPointer(detoasted[i][dim]));
+			}
+			else
+				len += sizeof(uint32) + strlen(DatumGetCString(item->values[dim])) + 1;
+		}
+	}
+
+	output = (bytea *) palloc0(len);
+	SET_VARSIZE(output, len);
+
+	ptr = VARDATA(output);
+
+	memcpy(ptr, &mcvlist->magic, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(ptr, &mcvlist->type, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(ptr, &mcvlist->nitems, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(ptr, &mcvlist->ndimensions, sizeof(AttrNumber));
+	ptr += sizeof(AttrNumber);
+	memcpy(ptr, mcvlist->types, ndims * sizeof(Oid));
+	ptr += ndims * sizeof(Oid);
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		memcpy(ptr, &item->frequency, sizeof(double));
+		ptr += sizeof(double);
+		memcpy(ptr, &item->base_frequency, sizeof(double));
+		ptr += sizeof(double);
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			int			typlen = stats[dim]->attrtype->typlen;
+			bool		typbyval = stats[dim]->attrtype->typbyval;
+			uint32		vlen;
+
+			memcpy(ptr, &item->isnull[dim], sizeof(bool));
+			ptr += sizeof(bool);
+
+			if (item->isnull[dim])
+				continue;
+
+			if (typbyval)
+			{
+				memcpy(ptr, &item->values[dim], sizeof(Datum));
+				ptr += sizeof(Datum);
+			}
+			else if (typlen > 0)
+			{
+				memcpy(ptr, DatumGetPointer(item->values[dim]), typlen);
+				ptr += typlen;
+			}
+			else if (typlen == -1)
+			{
+				vlen = VARSIZE(DatumGetPointer(detoasted[i][dim]));
+				memcpy(ptr, &vlen, sizeof(uint32));
+				ptr += sizeof(uint32);
+				memcpy(ptr, DatumGetPointer(detoasted[i][dim]), vlen);
+				ptr += vlen;
+			}
+			else
+			{
+				vlen = strlen(DatumGetCString(item->values[dim])) + 1;
+				memcpy(ptr, &vlen, sizeof(uint32));
+				ptr += sizeof(uint32);
+				memcpy(ptr, DatumGetCString(item->values[dim]), vlen);
+				ptr += vlen;
+			}
+		}
+
+		pfree(detoasted[i]);
+
+		/* protect against overflow */
+		Assert(ptr <= ((char *) output + len));
+	}
+
+	Assert(ptr == ((char *) output + len));
+
+	pfree(detoasted);
+
+	return output;
+}
+
+/*
+ * statext_mcv_deserialize
+ *		Reads a serialized MCV list into an MCVList structure.
+ *
+ * The values are copied into separately palloc'd, properly aligned memory,
+ * so the result does not reference the bytea.
+ */
+MCVList *
+statext_mcv_deserialize(bytea *data)
+{
+	int			i,
+				dim;
+	MCVList    *mcvlist;
+	char	   *ptr;
+	char	   *endptr;
+	int16		typlen[STATS_MAX_DIMENSIONS];
+	bool		typbyval[STATS_MAX_DIMENSIONS];
+
+	if (data == NULL)
+		return NULL;
+
+	if (VARSIZE_ANY_EXHDR(data) < SizeOfHeader)
+		elog(ERROR, "invalid MCV list size %zu (expected at least %zu)",
+			 (Size) VARSIZE_ANY_EXHDR(data), SizeOfHeader);
+
+	mcvlist = (MCVList *) palloc0(sizeof(MCVList));
+
+	ptr = VARDATA_ANY(data);
+	endptr = (char *) data + VARSIZE_ANY(data);
+
+	memcpy(&mcvlist->magic, ptr, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(&mcvlist->type, ptr, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(&mcvlist->nitems, ptr, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(&mcvlist->ndimensions, ptr, sizeof(AttrNumber));
+	ptr += sizeof(AttrNumber);
+
+	if (mcvlist->magic != STATS_MCV_MAGIC)
+		elog(ERROR, "invalid MCV magic %u (expected %u)",
+			 mcvlist->magic, STATS_MCV_MAGIC);
+
+	if (mcvlist->type != STATS_MCV_TYPE_BASIC)
+		elog(ERROR, "invalid MCV type %u (expected %u)",
+			 mcvlist->type, STATS_MCV_TYPE_BASIC);
+
+	if (mcvlist->ndimensions < 2 ||
+		mcvlist->ndimensions > STATS_MAX_DIMENSIONS)
+		elog(ERROR, "invalid number of dimensions %d in MCV list",
+			 mcvlist->ndimensions);
+
+	if (mcvlist->nitems == 0)
+		elog(ERROR, "invalid zero-length item array in MCVList");
+
+	memcpy(mcvlist->types, ptr, mcvlist->ndimensions * sizeof(Oid));
+	ptr += mcvlist->ndimensions * sizeof(Oid);
+
+	for (dim = 0; dim < mcvlist->ndimensions; dim++)
+		get_typlenbyval(mcvlist->types[dim], &typlen[dim], &typbyval[dim]);
+
+	mcvlist->items = (MCVItem **) palloc(mcvlist->nitems * sizeof(MCVItem *));
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = (MCVItem *) palloc(sizeof(MCVItem));
+
+		item->values = (Datum *) palloc0(mcvlist->ndimensions * sizeof(Datum));
+		item->isnull = (bool *) palloc(mcvlist->ndimensions * sizeof(bool));
+
+		memcpy(&item->frequency, ptr, sizeof(double));
+		ptr += sizeof(double);
+		memcpy(&item->base_frequency, ptr, sizeof(double));
+		ptr += sizeof(double);
+
+		for (dim = 0; dim < mcvlist->ndimensions; dim++)
+		{
+			memcpy(&item->isnull[dim], ptr, sizeof(bool));
+			ptr += sizeof(bool);
+
+			if (item->isnull[dim])
+				continue;
+
+			if (typbyval[dim])
+			{
+				memcpy(&item->values[dim], ptr, sizeof(Datum));
+				ptr += sizeof(Datum);
+			}
+			else if (typlen[dim] > 0)
+			{
+				char	   *v = palloc(typlen[dim]);
+
+				memcpy(v, ptr, typlen[dim]);
+				ptr += typlen[dim];
+				item->values[dim] = PointerGetDatum(v);
+			}
+			else
+			{
+				uint32		vlen;
+				char	   *v;
+
+				memcpy(&vlen, ptr, sizeof(uint32));
+				ptr += sizeof(uint32);
+
+				v = palloc(vlen);
+				memcpy(v, ptr, vlen);
+				ptr += vlen;
+				item->values[dim] = PointerGetDatum(v);
+			}
+		}
+
+		mcvlist->items[i] = item;
+
+		if (ptr > endptr)
+			elog(ERROR, "invalid MCV list: item data exceeds the value size");
+	}
+
+	Assert(ptr == endptr);
+
+	return mcvlist;
+}
+
+/*
+ * statext_mcv_load
+ *		Load the MCV list for the indicated pg_statistic_ext tuple
+ */
+MCVList *
+statext_mcv_load(Oid mvoid)
+{
+	bool		isnull;
+	Datum		mcvlist;
+	HeapTuple	htup;
+	MCVList    *result;
+
+	htup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(mvoid));
+	if (!HeapTupleIsValid(htup))
+		elog(ERROR, "cache lookup failed for statistics object %u", mvoid);
+
+	mcvlist = SysCacheGetAttr(STATEXTOID, htup,
+							  Anum_pg_statistic_ext_stxmcv, &isnull);
+	if (isnull)
+		elog(ERROR,
+			 "requested statistic kind %c is not yet built for statistics object %u",
+			 STATS_EXT_MCV, mvoid);
+
+	result = statext_mcv_deserialize(DatumGetByteaP(mcvlist));
+
+	ReleaseSysCache(htup);
+
+	return result;
+}
+
+/*
+ * mcv_item_matches_clause
+ *		Does the MCV item satisfy the (compatible) clause?
+ *
+ * The clause has already been checked by statext_is_compatible_clause, so
+ * it's either "Var op Const", "Const op Var" or a NullTest on a Var.  NULL
+ * values never satisfy an operator clause.
+ */
+static bool
+mcv_item_matches_clause(Node *clause, MCVItem *item, Bitmapset *keys)
+{
+	if (IsA(clause, RestrictInfo))
+		clause = (Node *) ((RestrictInfo *) clause)->clause;
+
+	if (is_opclause(clause))
+	{
+		OpExpr	   *expr = (OpExpr *) clause;
+		Node	   *left = (Node *) linitial(expr->args);
+		Node	   *right = (Node *) lsecond(expr->args);
+		bool		varonleft;
+		Var		   *var;
+		Const	   *cst;
+		int			idx;
+		FmgrInfo	opproc;
+		Datum		match;
+
+		if (IsA(left, RelabelType))
+			left = (Node *) ((RelabelType *) left)->arg;
+		if (IsA(right, RelabelType))
+			right = (Node *) ((RelabelType *) right)->arg;
+
+		varonleft = IsA(left, Var);
+		var = (Var *) (varonleft ? left : right);
+		cst = (Const *) (varonleft ? right : left);
+
+		idx = bms_member_index(keys, var->varattno);
+		Assert(idx >= 0);
+
+		if (item->isnull[idx] || cst->constisnull)
+			return false;
+
+		fmgr_info(get_opcode(expr->opno), &opproc);
+
+		if (varonleft)
+			match = FunctionCall2Coll(&opproc, expr->inputcollid,
+									  item->values[idx], cst->constvalue);
+		else
+			match = FunctionCall2Coll(&opproc, expr->inputcollid,
+									  cst->constvalue, item->values[idx]);
+
+		return DatumGetBool(match);
+	}
+	else if (IsA(clause, NullTest))
+	{
+		NullTest   *expr = (NullTest *) clause;
+		Node	   *arg = (Node *) expr->arg;
+		int			idx;
+
+		if (IsA(arg, RelabelType))
+			arg = (Node *) ((RelabelType *) arg)->arg;
+
+		idx = bms_member_index(keys, ((Var *) arg)->varattno);
+		Assert(idx >= 0);
+
+		if (expr->nulltesttype == IS_NULL)
+			return item->isnull[idx];
+		else
+			return !item->isnull[idx];
+	}
+
+	elog(ERROR, "unrecognized clause type in MCV list estimation: %d",
+		 (int) nodeTag(clause));
+	return false;				/* keep compiler quiet */
+}
+
+/*
+ * mcv_clauselist_selectivity
+ *		Return the selectivity estimate of clauses using a multivariate MCV
+ *		list, or 1.0 if no suitable MCV list exists.
+ *
+ * 'estimatedclauses' is an input/output argument that gets a bit set
+ * corresponding to the (zero-based) list index of each clause estimated
+ * here.
+ *
+ * The MCV list gives the exact selectivity of the clauses within the part
+ * of the data it covers (mcv_sel).  For the rest we use the regular
+ * per-column estimate of the clauses (simple_sel), minus the part of it
+ * that the MCV items already account for under the independence assumption
+ * (mcv_basesel), and clamp the result to the fraction of data not covered
+ * by the list.
+ */
+Selectivity
+mcv_clauselist_selectivity(PlannerInfo *root,
+						   List *clauses,
+						   int varRelid,
+						   JoinType jointype,
+						   SpecialJoinInfo *sjinfo,
+						   RelOptInfo *rel,
+						   Bitmapset **estimatedclauses)
+{
+	ListCell   *l;
+	Bitmapset  *clauses_attnums = NULL;
+	AttrNumber *list_attnums;
+	StatisticExtInfo *stat;
+	MCVList    *mcvlist;
+	List	   *stat_clauses = NIL;
+	Bitmapset  *stat_clause_idxs = NULL;
+	Selectivity simple_sel = 1.0,
+				mcv_sel = 0.0,
+				mcv_basesel = 0.0,
+				mcv_totalsel = 0.0,
+				other_sel,
+				sel;
+	int			listidx;
+	int			i;
+
+	/* check if there's any stats that might be useful for us. */
+	if (!has_stats_of_kind(rel->statlist, STATS_EXT_MCV))
+		return 1.0;
+
+	list_attnums = (AttrNumber *) palloc(sizeof(AttrNumber) *
+										 list_length(clauses));
+
+	/* find the clauses the MCV list could be applied to */
+	listidx = 0;
+	foreach(l, clauses)
+	{
+		Node	   *clause = (Node *) lfirst(l);
+		AttrNumber	attnum;
+
+		if (!bms_is_member(listidx, *estimatedclauses) &&
+			statext_is_compatible_clause(clause, rel->relid, false, &attnum))
+		{
+			list_attnums[listidx] = attnum;
+			clauses_attnums = bms_add_member(clauses_attnums, attnum);
+		}
+		else
+			list_attnums[listidx] = InvalidAttrNumber;
+
+		listidx++;
+	}
+
+	/* we need clauses on at least two columns to gain anything */
+	if (bms_num_members(clauses_attnums) < 2)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	stat = choose_best_statistics(rel->statlist, clauses_attnums,
+								  STATS_EXT_MCV);
+	if (!stat)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	/* collect the clauses covered by the chosen statistics object */
+	listidx = 0;
+	foreach(l, clauses)
+	{
+		if (list_attnums[listidx] != InvalidAttrNumber &&
+			bms_is_member(list_attnums[listidx], stat->keys))
+		{
+			Node	   *clause = (Node *) lfirst(l);
+
+			stat_clauses = lappend(stat_clauses, clause);
+			stat_clause_idxs = bms_add_member(stat_clause_idxs, listidx);
+
+			simple_sel *= clause_selectivity(root, clause, varRelid,
+											 jointype, sjinfo);
+		}
+		listidx++;
+	}
+
+	mcvlist = statext_mcv_load(stat->statOid);
+
+	/* evaluate the clauses on each MCV item */
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+		bool		matches = true;
+
+		foreach(l, stat_clauses)
+		{
+			if (!mcv_item_matches_clause((Node *) lfirst(l), item,
+										 stat->keys))
+			{
+				matches = false;
+				break;
+			}
+		}
+
+		if (matches)
+		{
+			mcv_sel += item->frequency;
+			mcv_basesel += item->base_frequency;
+		}
+
+		mcv_totalsel += item->frequency;
+	}
+
+	/* estimate the part of the data not covered by the MCV list */
+	other_sel = simple_sel - mcv_basesel;
+	CLAMP_PROBABILITY(other_sel);
+
+	if (other_sel > 1.0 - mcv_totalsel)
+		other_sel = 1.0 - mcv_totalsel;
+
+	sel = mcv_sel + other_sel;
+	CLAMP_PROBABILITY(sel);
+
+	*estimatedclauses = bms_add_members(*estimatedclauses, stat_clause_idxs);
+
+	list_free(stat_clauses);
+	pfree(list_attnums);
+
+	return sel;
+}
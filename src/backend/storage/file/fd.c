@@ -287,6 +287,7 @@ static File AllocateVfd(void);
 static void FreeVfd(File file);
 
 static int	FileAccess(File file);
+static int	FileZero(File file, off_t offset, off_t amount);
 static File OpenTemporaryFileInTablespace(Oid tblspcOid, bool rejectError);
 static bool reserveAllocatedDesc(void);
 static int	FreeDesc(AllocateDesc *desc);
@@ -1563,6 +1564,162 @@ FileTruncate(File file, off_t offset)
 	return returnCode;
 }
 
+/*
+ * FileFallocate - allocate zero-filled space in a file
+ *
+ * Makes sure that the given range of the file, which normally lies at or
+ * beyond the current end of file, is allocated on disk and reads as zeroes.
+ * Where posix_fallocate() is available and supported by the filesystem,
+ * the space is reserved without writing it; otherwise we write zeroes.
+ *
+ * Returns 0 on success, or -1 with errno set on failure.
+ */
+int
+FileFallocate(File file, off_t offset, off_t amount)
+{
+	int			returnCode;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FileFallocate %d (%s) " INT64_FORMAT " " INT64_FORMAT,
+			   file, VfdCache[file].fileName,
+			   (int64) offset, (int64) amount));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+#ifdef HAVE_POSIX_FALLOCATE
+	/* temp files must go through FileWrite, for temp_file_limit accounting */
+	if (!(VfdCache[file].fdstate & FD_TEMPORARY))
+	{
+		returnCode = posix_fallocate(VfdCache[file].fd, offset, amount);
+		if (returnCode == 0)
+			return 0;
+
+		/*
+		 * posix_fallocate() returns the error code rather than setting errno.
+		 * If the filesystem doesn't support it, fall back to writing zeroes;
+		 * report any other failure.
+		 */
+		if (returnCode != EINVAL && returnCode != EOPNOTSUPP)
+		{
+			errno = returnCode;
+			return -1;
+		}
+	}
+#endif
+
+	return FileZero(file, offset, amount);
+}
+
+/*
+ * FilePunchHole - deallocate the space backing a range of a file
+ *
+ * The range reads as zeroes afterwards, and the file size is unchanged.
+ * This is only possible where fallocate() supports FALLOC_FL_PUNCH_HOLE;
+ * elsewhere, and on filesystems that don't implement it, we fail with errno
+ * set to EOPNOTSUPP, and the range keeps its previous contents.
+ *
+ * Returns 0 on success, or -1 with errno set on failure.
+ */
+int
+FilePunchHole(File file, off_t offset, off_t amount)
+{
+	int			returnCode;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FilePunchHole %d (%s) " INT64_FORMAT " " INT64_FORMAT,
+			   file, VfdCache[file].fileName,
+			   (int64) offset, (int64) amount));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE)
+	returnCode = fallocate(VfdCache[file].fd,
+						   FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+						   offset, amount);
+	if (returnCode != 0 && errno == ENOSYS)
+		errno = EOPNOTSUPP;
+	return returnCode;
+#else
+	errno = EOPNOTSUPP;
+	return -1;
+#endif
+}
+
+/*
+ * FileRangeIsHole - check whether a range of a file holds no data
+ *
+ * Returns true only if the filesystem reports the whole range as a hole,
+ * as it will after a successful FilePunchHole.  Where SEEK_DATA isn't
+ * available, or on error, we return false.
+ */
+bool
+FileRangeIsHole(File file, off_t offset, off_t amount)
+{
+#ifdef SEEK_DATA
+	off_t		next_data;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FileRangeIsHole %d (%s) " INT64_FORMAT " " INT64_FORMAT,
+			   file, VfdCache[file].fileName,
+			   (int64) offset, (int64) amount));
+
+	if (FileAccess(file) < 0)
+		return false;
+
+	next_data = lseek(VfdCache[file].fd, offset, SEEK_DATA);
+
+	/* we moved the kernel's file position behind FileSeek's back */
+	VfdCache[file].seekPos = FileUnknownPos;
+
+	/* ENXIO means there's no data at all between offset and EOF */
+	if (next_data < 0)
+		return errno == ENXIO;
+	return next_data >= offset + amount;
+#else
+	return false;
+#endif
+}
+
+/*
+ * FileZero - write zeroes to the given range of a file
+ *
+ * Returns 0 on success, or -1 with errno set on failure.
+ */
+static int
+FileZero(File file, off_t offset, off_t amount)
+{
+	static char zerobuf[BLCKSZ];
+
+	if (FileSeek(file, offset, SEEK_SET) != offset)
+		return -1;
+
+	while (amount > 0)
+	{
+		int			chunk = (int) Min(amount, (off_t) sizeof(zerobuf));
+		int			written;
+
+		written = FileWrite(file, zerobuf, chunk);
+		if (written < 0)
+			return -1;
+		if (written != chunk)
+		{
+			/* short write; assume out of disk space */
+			errno = ENOSPC;
+			return -1;
+		}
+		amount -= written;
+	}
+
+	return 0;
+}
+
 /*
  * Return the pathname associated with an open file.
  *
@@ -109,6 +109,7 @@ static int fsm_set_and_search(Relation rel, FSMAddress addr, uint16 slot,
 				   uint8 newValue, uint8 minValue);
 static BlockNumber fsm_search(Relation rel, uint8 min_cat);
 static uint8 fsm_vacuum_page(Relation rel, FSMAddress addr, bool *eof);
+static void fsm_update_recursive(Relation rel, FSMAddress addr, uint8 new_cat);
 
 
 /******** Public API ********/
@@ -188,6 +189,52 @@ RecordPageWithFreeSpace(Relation rel, BlockNumber heapBlk, Size spaceAvail)
 	fsm_set_and_search(rel, addr, slot, new_cat, 0);
 }
 
+/*
+ * UpdateFreeSpaceMap - record the same amount of free space for a range of
+ *		heap blocks, startBlkNum to endBlkNum inclusive.
+ *
+ * Unlike RecordPageWithFreeSpace, this also propagates the new value to the
+ * upper levels of the map right away, so that searchers see the space
+ * without waiting for the next FreeSpaceMapVacuum.  It's meant for freshly
+ * added empty pages, whose category is the highest possible, so simply
+ * overwriting the parent slots can't hide any other free space.
+ */
+void
+UpdateFreeSpaceMap(Relation rel, BlockNumber startBlkNum,
+				   BlockNumber endBlkNum, Size freespace)
+{
+	uint8		new_cat = fsm_space_avail_to_cat(freespace);
+	BlockNumber blkno = startBlkNum;
+
+	while (blkno <= endBlkNum)
+	{
+		FSMAddress	addr;
+		uint16		slot;
+		Buffer		buf;
+		Page		page;
+		bool		modified = false;
+
+		addr = fsm_get_location(blkno, &slot);
+
+		buf = fsm_readbuf(rel, addr, true);
+		LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
+		page = BufferGetPage(buf);
+
+		/* Set all the slots on this FSM page that fall into the range */
+		for (; slot < SlotsPerFSMPage && blkno <= endBlkNum; slot++, blkno++)
+		{
+			if (fsm_set_avail(page, slot, new_cat))
+				modified = true;
+		}
+
+		if (modified)
+			MarkBufferDirtyHint(buf, false);
+		UnlockReleaseBuffer(buf);
+
+		fsm_update_recursive(rel, addr, new_cat);
+	}
+}
+
 /*
  * XLogRecordPageWithFreeSpace - like RecordPageWithFreeSpace, for use in
  *		WAL replay
@@ -788,3 +835,25 @@ fsm_vacuum_page(Relation rel, FSMAddress addr, bool *eof_p)
 
 	return max_avail;
 }
+
+/*
+ * Set the given category in all the ancestors of FSM page addr, up to and
+ * including the root.
+ */
+static void
+fsm_update_recursive(Relation rel, FSMAddress addr, uint8 new_cat)
+{
+	uint16		parentslot;
+	FSMAddress	parent;
+
+	if (addr.level == FSM_ROOT_LEVEL)
+		return;
+
+	/*
+	 * Get the parent page and our slot in the parent page, and update the
+	 * information in that.
+	 */
+	parent = fsm_get_parent(addr, &parentslot);
+	fsm_set_and_search(rel, parent, parentslot, new_cat, 0);
+	fsm_update_recursive(rel, parent, new_cat);
+}
@@ -24,10 +24,14 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/file.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
 
 #include "miscadmin.h"
 #include "access/xlog.h"
 #include "catalog/catalog.h"
+#include "common/pg_lzcompress.h"
 #include "portability/instr_time.h"
 #include "postmaster/bgwriter.h"
 #include "storage/fd.h"
@@ -113,11 +117,73 @@ typedef struct _MdfdVec
 	File		mdfd_vfd;		/* fd number in fd.c's pool */
 	BlockNumber mdfd_segno;		/* segment number, from 0 */
 	struct _MdfdVec *mdfd_chain;	/* next segment, or NULL */
+	bool		mdfd_nopunch;	/* filesystem can't punch holes in it */
 } MdfdVec;
 
 static MemoryContext MdCxt;		/* context for all MdfdVec objects */
 
 
+/*
+ *	Page compression.
+ *
+ *	When page_compression is enabled, each main-fork page is compressed as
+ *	it is written.  If the compressed image fits in fewer filesystem blocks
+ *	than the page itself, we write just those and punch a hole over the rest
+ *	of the page's slot in the file, so the filesystem can release the space.
+ *	Every block keeps its usual BLCKSZ-sized slot, so block addressing,
+ *	segmenting, truncation and mdnblocks() work exactly as for uncompressed
+ *	files; shared buffers always hold uncompressed pages.
+ *
+ *	A compressed image starts with a PageCompressHeader.  It is recognized
+ *	by its magic number and by the value 0xFFFF at the offset where a
+ *	regular page keeps pd_pagesize_version, which no valid page (including
+ *	an all-zeroes one) can have there.  Reading honors whatever a page looks
+ *	like on disk, so turning the setting off leaves existing compressed
+ *	pages readable; they're stored uncompressed the next time they're
+ *	written.
+ *
+ *	Only the compressed length recorded in the header is ever examined, so
+ *	it's harmless if the rest of the slot still holds old data, as happens
+ *	if hole punching isn't supported or we crash before it's done.  A torn
+ *	write is a different matter: a compressed image is rewritten as a whole
+ *	even if only hint bits changed, and a mix of old and new sectors can't
+ *	be decompressed at all.  So page compression may only be enabled when
+ *	hint bit changes are WAL-logged (see check_page_compression), which
+ *	guarantees a full-page image to restore such a page from in recovery.
+ */
+typedef struct PageCompressHeader
+{
+	uint32		pch_magic;		/* PAGE_COMPRESS_MAGIC */
+	uint16		pch_length;		/* length of compressed data */
+	uint8		pch_method;		/* PageCompressionMethod used */
+	uint8		pch_reserved[11];	/* zero */
+	uint16		pch_marker;		/* PAGE_COMPRESS_MARKER, where a regular
+								 * page has pd_pagesize_version */
+} PageCompressHeader;
+
+#define PAGE_COMPRESS_MAGIC		0x50434d50
+#define PAGE_COMPRESS_MARKER	0xFFFF
+#define PAGE_COMPRESS_HDRSZ		sizeof(PageCompressHeader)
+
+/*
+ * Compressed images are padded to a multiple of this, the filesystem block
+ * size on all common filesystems; space can only be released in such units.
+ */
+#define PAGE_COMPRESS_UNIT		4096
+
+/* buffer big enough for a compressed image from any method */
+#ifdef USE_LZ4
+#define PAGE_COMPRESS_BUFSZ \
+	(PAGE_COMPRESS_HDRSZ + Max(PGLZ_MAX_OUTPUT(BLCKSZ), LZ4_COMPRESSBOUND(BLCKSZ)))
+#else
+#define PAGE_COMPRESS_BUFSZ \
+	(PAGE_COMPRESS_HDRSZ + PGLZ_MAX_OUTPUT(BLCKSZ))
+#endif
+
+/* GUC */
+int			page_compression = PAGE_COMPRESSION_OFF;
+
+
 /*
  * In some contexts (currently, standalone backends and the checkpointer)
  * we keep track of pending fsync operations: we need to remember all relation
@@ -187,6 +253,10 @@ static MdfdVec *_mdfd_getseg(SMgrRelation reln, ForkNumber forkno,
 			 BlockNumber blkno, bool skipFsync, ExtensionBehavior behavior);
 static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum,
 		   MdfdVec *seg);
+static int md_compress_page(ForkNumber forknum, char *buffer, char **image);
+static void md_decompress_page(char *buffer, BlockNumber blocknum,
+				   MdfdVec *seg);
+static void md_punch_page_tail(MdfdVec *seg, off_t seekpos, int len);
 
 
 /*
@@ -328,6 +398,7 @@ mdcreate(SMgrRelation reln, ForkNumber forkNum, bool isRedo)
 	reln->md_fd[forkNum]->mdfd_vfd = fd;
 	reln->md_fd[forkNum]->mdfd_segno = 0;
 	reln->md_fd[forkNum]->mdfd_chain = NULL;
+	reln->md_fd[forkNum]->mdfd_nopunch = false;
 }
 
 /*
@@ -491,6 +562,8 @@ mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 {
 	off_t		seekpos;
 	int			nbytes;
+	int			len;
+	char	   *image;
 	MdfdVec    *v;
 
 	/* This assert is too expensive to have on normally ... */
@@ -531,7 +604,14 @@ mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				 errmsg("could not seek to block %u in file \"%s\": %m",
 						blocknum, FilePathName(v->mdfd_vfd))));
 
-	if ((nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ)) != BLCKSZ)
+	/*
+	 * A compressed image is zero-padded to BLCKSZ, since we have to write the
+	 * whole block to extend the file anyway; the padding is punched out
+	 * afterwards.
+	 */
+	len = md_compress_page(forknum, buffer, &image);
+
+	if ((nbytes = FileWrite(v->mdfd_vfd, image, BLCKSZ)) != BLCKSZ)
 	{
 		if (nbytes < 0)
 			ereport(ERROR,
@@ -548,12 +628,80 @@ mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				 errhint("Check free disk space.")));
 	}
 
+	if (len < BLCKSZ)
+		md_punch_page_tail(v, seekpos, len);
+
 	if (!skipFsync && !SmgrIsTemp(reln))
 		register_dirty_segment(reln, forknum, v);
 
 	Assert(_mdnblocks(reln, forknum, v) <= ((BlockNumber) RELSEG_SIZE));
 }
 
+/*
+ *	mdzeroextend() -- Add nblocks zeroed-out blocks to the specified relation,
+ *		starting at blocknum.
+ *
+ *		This is like calling mdextend() with an all-zeroes page for each
+ *		block, but much cheaper: the space is allocated with one
+ *		FileFallocate() call per segment, which avoids writing the pages
+ *		at all where posix_fallocate() is supported.
+ */
+void
+mdzeroextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+			 int nblocks, bool skipFsync)
+{
+	BlockNumber curblocknum = blocknum;
+	int			remblocks = nblocks;
+
+	Assert(nblocks > 0);
+
+	/* This assert is too expensive to have on normally ... */
+#ifdef CHECK_WRITE_VS_EXTEND
+	Assert(blocknum >= mdnblocks(reln, forknum));
+#endif
+
+	/* see mdextend() */
+	if ((uint64) blocknum + nblocks >= (uint64) InvalidBlockNumber)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("cannot extend file \"%s\" beyond %u blocks",
+						relpath(reln->smgr_rnode, forknum),
+						InvalidBlockNumber)));
+
+	while (remblocks > 0)
+	{
+		BlockNumber segstartblock = curblocknum % ((BlockNumber) RELSEG_SIZE);
+		off_t		seekpos = (off_t) BLCKSZ * segstartblock;
+		int			numblocks;
+		MdfdVec    *v;
+
+		/* don't cross a segment boundary in one go */
+		if (segstartblock + remblocks > RELSEG_SIZE)
+			numblocks = RELSEG_SIZE - segstartblock;
+		else
+			numblocks = remblocks;
+
+		v = _mdfd_getseg(reln, forknum, curblocknum, skipFsync,
+						 EXTENSION_CREATE);
+
+		if (FileFallocate(v->mdfd_vfd, seekpos,
+						  (off_t) BLCKSZ * numblocks) != 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not extend file \"%s\": %m",
+							FilePathName(v->mdfd_vfd)),
+					 errhint("Check free disk space.")));
+
+		if (!skipFsync && !SmgrIsTemp(reln))
+			register_dirty_segment(reln, forknum, v);
+
+		Assert(_mdnblocks(reln, forknum, v) <= ((BlockNumber) RELSEG_SIZE));
+
+		remblocks -= numblocks;
+		curblocknum += numblocks;
+	}
+}
+
 /*
  *	mdopen() -- Open the specified relation.
  *
@@ -610,6 +758,7 @@ mdopen(SMgrRelation reln, ForkNumber forknum, ExtensionBehavior behavior)
 	mdfd->mdfd_vfd = fd;
 	mdfd->mdfd_segno = 0;
 	mdfd->mdfd_chain = NULL;
+	mdfd->mdfd_nopunch = false;
 	Assert(_mdnblocks(reln, forknum, mdfd) <= ((BlockNumber) RELSEG_SIZE));
 
 	return mdfd;
@@ -727,6 +876,8 @@ mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 							blocknum, FilePathName(v->mdfd_vfd),
 							nbytes, BLCKSZ)));
 	}
+	else if (forknum == MAIN_FORKNUM)
+		md_decompress_page(buffer, blocknum, v);
 }
 
 /*
@@ -742,6 +893,8 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 {
 	off_t		seekpos;
 	int			nbytes;
+	int			len;
+	char	   *image;
 	MdfdVec    *v;
 
 	/* This assert is too expensive to have on normally ... */
@@ -767,7 +920,9 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				 errmsg("could not seek to block %u in file \"%s\": %m",
 						blocknum, FilePathName(v->mdfd_vfd))));
 
-	nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ);
+	len = md_compress_page(forknum, buffer, &image);
+
+	nbytes = FileWrite(v->mdfd_vfd, image, len);
 
 	TRACE_POSTGRESQL_SMGR_MD_WRITE_DONE(forknum, blocknum,
 										reln->smgr_rnode.node.spcNode,
@@ -775,9 +930,9 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 										reln->smgr_rnode.node.relNode,
 										reln->smgr_rnode.backend,
 										nbytes,
-										BLCKSZ);
+										len);
 
-	if (nbytes != BLCKSZ)
+	if (nbytes != len)
 	{
 		if (nbytes < 0)
 			ereport(ERROR,
@@ -790,10 +945,13 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				 errmsg("could not write block %u in file \"%s\": wrote only %d of %d bytes",
 						blocknum,
 						FilePathName(v->mdfd_vfd),
-						nbytes, BLCKSZ),
+						nbytes, len),
 				 errhint("Check free disk space.")));
 	}
 
+	if (len < BLCKSZ)
+		md_punch_page_tail(v, seekpos, len);
+
 	if (!skipFsync && !SmgrIsTemp(reln))
 		register_dirty_segment(reln, forknum, v);
 }
@@ -1702,6 +1860,7 @@ _mdfd_openseg(SMgrRelation reln, ForkNumber forknum, BlockNumber segno,
 	v->mdfd_vfd = fd;
 	v->mdfd_segno = segno;
 	v->mdfd_chain = NULL;
+	v->mdfd_nopunch = false;
 	Assert(_mdnblocks(reln, forknum, v) <= ((BlockNumber) RELSEG_SIZE));
 
 	/* all done */
@@ -1800,3 +1959,158 @@ _mdnblocks(SMgrRelation reln, ForkNumber forknum, MdfdVec *seg)
 	/* note that this calculation will ignore any partial block at EOF */
 	return (BlockNumber) (len / BLCKSZ);
 }
+
+/*
+ * md_compress_page() -- Prepare the on-disk image of a page for writing.
+ *
+ * Sets *image to the data to write and returns the number of bytes of it
+ * that matter: BLCKSZ if the page is to be stored as is, or else the length
+ * of the compressed image rounded up to PAGE_COMPRESS_UNIT.  A compressed
+ * image lives in a static buffer and is zero-padded to BLCKSZ.
+ */
+static int
+md_compress_page(ForkNumber forknum, char *buffer, char **image)
+{
+	static char *cbuf = NULL;
+	PageCompressHeader *hdr;
+	int32		clen;
+
+	StaticAssertStmt(offsetof(PageCompressHeader, pch_marker) ==
+					 offsetof(PageHeaderData, pd_pagesize_version),
+					 "compressed page marker must overlay pd_pagesize_version");
+
+	*image = buffer;
+
+	/* the FSM, visibility map and init forks are small; leave them be */
+	if (page_compression == PAGE_COMPRESSION_OFF || forknum != MAIN_FORKNUM)
+		return BLCKSZ;
+
+	if (cbuf == NULL)
+		cbuf = MemoryContextAlloc(TopMemoryContext, PAGE_COMPRESS_BUFSZ);
+
+	switch (page_compression)
+	{
+		case PAGE_COMPRESSION_PGLZ:
+			clen = pglz_compress(buffer, BLCKSZ, cbuf + PAGE_COMPRESS_HDRSZ,
+								 PGLZ_strategy_default);
+			break;
+#ifdef USE_LZ4
+		case PAGE_COMPRESSION_LZ4:
+			clen = LZ4_compress_default(buffer, cbuf + PAGE_COMPRESS_HDRSZ,
+										BLCKSZ,
+										PAGE_COMPRESS_BUFSZ - PAGE_COMPRESS_HDRSZ);
+			if (clen == 0)
+				clen = -1;
+			break;
+#endif
+		default:
+			elog(ERROR, "invalid page compression method %d",
+				 page_compression);
+			clen = -1;			/* keep compiler quiet */
+			break;
+	}
+
+	/* not worth it unless we save at least one filesystem block */
+	if (clen < 0 ||
+		TYPEALIGN(PAGE_COMPRESS_UNIT, PAGE_COMPRESS_HDRSZ + clen) >= BLCKSZ)
+		return BLCKSZ;
+
+	hdr = (PageCompressHeader *) cbuf;
+	MemSet(hdr, 0, PAGE_COMPRESS_HDRSZ);
+	hdr->pch_magic = PAGE_COMPRESS_MAGIC;
+	hdr->pch_length = (uint16) clen;
+	hdr->pch_method = (uint8) page_compression;
+	hdr->pch_marker = PAGE_COMPRESS_MARKER;
+	MemSet(cbuf + PAGE_COMPRESS_HDRSZ + clen, 0,
+		   BLCKSZ - (PAGE_COMPRESS_HDRSZ + clen));
+
+	*image = cbuf;
+	return TYPEALIGN(PAGE_COMPRESS_UNIT, PAGE_COMPRESS_HDRSZ + clen);
+}
+
+/*
+ * md_decompress_page() -- Decompress a page just read, if it's compressed.
+ *
+ * buffer holds the full BLCKSZ slot as read from disk; a compressed image
+ * is replaced by the page it represents, anything else is left alone.
+ */
+static void
+md_decompress_page(char *buffer, BlockNumber blocknum, MdfdVec *seg)
+{
+	static char *cbuf = NULL;
+	PageCompressHeader *hdr = (PageCompressHeader *) buffer;
+	int32		clen;
+	int32		rawlen;
+
+	if (hdr->pch_marker != PAGE_COMPRESS_MARKER ||
+		hdr->pch_magic != PAGE_COMPRESS_MAGIC)
+		return;
+
+	clen = hdr->pch_length;
+	if (PAGE_COMPRESS_HDRSZ + clen > BLCKSZ)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid compressed page length %d in block %u of file \"%s\"",
+						clen, blocknum, FilePathName(seg->mdfd_vfd))));
+
+	if (cbuf == NULL)
+		cbuf = MemoryContextAlloc(TopMemoryContext, BLCKSZ);
+	memcpy(cbuf, buffer + PAGE_COMPRESS_HDRSZ, clen);
+
+	switch (hdr->pch_method)
+	{
+		case PAGE_COMPRESSION_PGLZ:
+			rawlen = pglz_decompress(cbuf, clen, buffer, BLCKSZ);
+			break;
+		case PAGE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			rawlen = LZ4_decompress_safe(cbuf, buffer, clen, BLCKSZ);
+			break;
+#else
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("block %u of file \"%s\" is compressed with lz4",
+							blocknum, FilePathName(seg->mdfd_vfd)),
+					 errdetail("This functionality requires the server to be built with lz4 support.")));
+#endif
+		default:
+			rawlen = -1;
+			break;
+	}
+
+	if (rawlen != BLCKSZ)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("could not decompress block %u in file \"%s\"",
+						blocknum, FilePathName(seg->mdfd_vfd))));
+}
+
+/*
+ * md_punch_page_tail() -- Release the unused part of a compressed page's slot.
+ *
+ * The first len bytes of the slot at seekpos hold the compressed image.  If
+ * the filesystem can't punch holes, the space just isn't reclaimed, and we
+ * stop trying for this segment.
+ *
+ * Punching a hole is a metadata change, so we first check whether the tail
+ * is a hole already.  It is when the page was last written compressed to
+ * the same or a shorter length, which is the common case for a page that's
+ * written over and over.
+ */
+static void
+md_punch_page_tail(MdfdVec *seg, off_t seekpos, int len)
+{
+	if (seg->mdfd_nopunch ||
+		FileRangeIsHole(seg->mdfd_vfd, seekpos + len, BLCKSZ - len))
+		return;
+
+	if (FilePunchHole(seg->mdfd_vfd, seekpos + len, BLCKSZ - len) != 0)
+	{
+		if (errno != EOPNOTSUPP)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not deallocate space in file \"%s\": %m",
+							FilePathName(seg->mdfd_vfd))));
+		seg->mdfd_nopunch = true;
+	}
+}
@@ -32,6 +32,7 @@
 #include "catalog/pg_opclass.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_proc.h"
+#include "catalog/pg_statistic_ext.h"
 #include "catalog/pg_tablesample_method.h"
 #include "catalog/pg_trigger.h"
 #include "catalog/pg_type.h"
@@ -1123,6 +1124,18 @@ pg_get_indexdef_worker(Oid indexrelid, int colno,
 		Oid			keycoltype;
 		Oid			keycolcollation;
 
+		/*
+		 * Included columns are reported in a separate INCLUDE list after the
+		 * key columns; they carry no opclass, collation or ordering options.
+		 */
+		if (!colno && keyno == idxrec->indnkeyatts)
+		{
+			if (attrsOnly)
+				break;
+			appendStringInfoString(&buf, ") INCLUDE (");
+			sep = "";
+		}
+
 		if (!colno)
 			appendStringInfoString(&buf, sep);
 		sep = ", ";
@@ -1165,7 +1178,8 @@ pg_get_indexdef_worker(Oid indexrelid, int colno,
 			keycolcollation = exprCollation(indexkey);
 		}
 
-		if (!attrsOnly && (!colno || colno == keyno + 1))
+		if (!attrsOnly && keyno < idxrec->indnkeyatts &&
+			(!colno || colno == keyno + 1))
 		{
 			Oid			indcoll;
 
@@ -1273,6 +1287,99 @@ pg_get_indexdef_worker(Oid indexrelid, int colno,
 }
 
 
+/*
+ * pg_get_statisticsobjdef
+ *		Get the CREATE STATISTICS command for an extended statistics object
+ *
+ * The list of statistics kinds is omitted when all of them are enabled,
+ * which is what CREATE STATISTICS does when given no list.
+ */
+Datum
+pg_get_statisticsobjdef(PG_FUNCTION_ARGS)
+{
+	Oid			statextid = PG_GETARG_OID(0);
+	HeapTuple	statexttup;
+	Form_pg_statistic_ext statextrec;
+	StringInfoData buf;
+	Datum		datum;
+	bool		isnull;
+	ArrayType  *arr;
+	char	   *enabled;
+	bool		ndistinct_enabled = false;
+	bool		dependencies_enabled = false;
+	bool		mcv_enabled = false;
+	int			i;
+
+	statexttup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(statextid));
+	if (!HeapTupleIsValid(statexttup))
+		elog(ERROR, "cache lookup failed for statistics object %u", statextid);
+	statextrec = (Form_pg_statistic_ext) GETSTRUCT(statexttup);
+
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "CREATE STATISTICS %s",
+				  quote_qualified_identifier(get_namespace_name(statextrec->stxnamespace),
+											 NameStr(statextrec->stxname)));
+
+	datum = SysCacheGetAttr(STATEXTOID, statexttup,
+							Anum_pg_statistic_ext_stxkind, &isnull);
+	Assert(!isnull);
+	arr = DatumGetArrayTypeP(datum);
+	if (ARR_NDIM(arr) != 1 ||
+		ARR_HASNULL(arr) ||
+		ARR_ELEMTYPE(arr) != CHAROID)
+		elog(ERROR, "stxkind is not a 1-D char array");
+	enabled = (char *) ARR_DATA_PTR(arr);
+	for (i = 0; i < ARR_DIMS(arr)[0]; i++)
+	{
+		if (enabled[i] == STATS_EXT_NDISTINCT)
+			ndistinct_enabled = true;
+		else if (enabled[i] == STATS_EXT_DEPENDENCIES)
+			dependencies_enabled = true;
+		else if (enabled[i] == STATS_EXT_MCV)
+			mcv_enabled = true;
+	}
+
+	if (!ndistinct_enabled || !dependencies_enabled || !mcv_enabled)
+	{
+		const char *sep = "";
+
+		appendStringInfoString(&buf, " (");
+		if (ndistinct_enabled)
+		{
+			appendStringInfoString(&buf, "ndistinct");
+			sep = ", ";
+		}
+		if (dependencies_enabled)
+		{
+			appendStringInfo(&buf, "%sdependencies", sep);
+			sep = ", ";
+		}
+		if (mcv_enabled)
+			appendStringInfo(&buf, "%smcv", sep);
+		appendStringInfoChar(&buf, ')');
+	}
+
+	appendStringInfoString(&buf, " ON ");
+	for (i = 0; i < statextrec->stxkeys.dim1; i++)
+	{
+		AttrNumber	attnum = statextrec->stxkeys.values[i];
+
+		if (i > 0)
+			appendStringInfoString(&buf, ", ");
+		appendStringInfoString(&buf,
+							   quote_identifier(get_relid_attribute_name(statextrec->stxrelid,
+																		 attnum)));
+	}
+
+	appendStringInfo(&buf, " FROM %s",
+					 generate_relation_name(statextrec->stxrelid, NIL));
+
+	ReleaseSysCache(statexttup);
+
+	PG_RETURN_TEXT_P(string_to_text(buf.data));
+}
+
+
 /*
  * pg_get_constraintdef
  *
@@ -8147,14 +8254,29 @@ get_agg_expr(Aggref *aggref, deparse_context *context)
 	/* Extract the argument types as seen by the parser */
 	nargs = get_aggregate_argtypes(aggref, argtypes);
 
-	/* Print the aggregate name, schema-qualified if needed */
-	appendStringInfo(buf, "%s(%s",
-					 generate_function_name(aggref->aggfnoid, nargs,
-											NIL, argtypes,
-											aggref->aggvariadic,
-											&use_variadic,
-											context->special_exprkind),
-					 (aggref->aggdistinct != NIL) ? "DISTINCT " : "");
+	/* Mark the first stage of a split aggregate (these appear only in plans) */
+	if (aggref->aggpartial)
+		appendStringInfoString(buf, "PARTIAL ");
+
+	/*
+	 * Print the aggregate name, schema-qualified if needed.  The argument of
+	 * a combining aggregate is a transition state, which would mislead the
+	 * function lookup, so just print its plain name.
+	 */
+	if (aggref->aggcombine)
+	{
+		use_variadic = false;
+		appendStringInfo(buf, "%s(",
+						 quote_identifier(get_func_name(aggref->aggfnoid)));
+	}
+	else
+		appendStringInfo(buf, "%s(%s",
+						 generate_function_name(aggref->aggfnoid, nargs,
+												NIL, argtypes,
+												aggref->aggvariadic,
+												&use_variadic,
+												context->special_exprkind),
+						 (aggref->aggdistinct != NIL) ? "DISTINCT " : "");
 
 	if (AGGKIND_IS_ORDERED_SET(aggref->aggkind))
 	{
@@ -107,6 +107,7 @@
 #include "catalog/pg_collation.h"
 #include "catalog/pg_opfamily.h"
 #include "catalog/pg_statistic.h"
+#include "catalog/pg_statistic_ext.h"
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
 #include "mb/pg_wchar.h"
@@ -123,6 +124,7 @@
 #include "parser/parse_clause.h"
 #include "parser/parse_coerce.h"
 #include "parser/parsetree.h"
+#include "statistics/statistics.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
 #include "utils/date.h"
@@ -190,6 +192,9 @@ static bool get_actual_variable_range(PlannerInfo *root,
 						  Oid sortop,
 						  Datum *min, Datum *max);
 static RelOptInfo *find_join_input_rel(PlannerInfo *root, Relids relids);
+static bool estimate_multivariate_ndistinct(PlannerInfo *root,
+								RelOptInfo *rel, List **varinfos,
+								double *ndistinct);
 static Selectivity prefix_selectivity(PlannerInfo *root,
 				   VariableStatData *vardata,
 				   Oid vartype, Oid opfamily, Const *prefixcon);
@@ -644,6 +649,50 @@ mcv_selectivity(VariableStatData *vardata, FmgrInfo *opproc,
 	return mcv_selec;
 }
 
+/*
+ *	get_column_mcvs		- Fetch a column's MCV list
+ *
+ * Returns true and sets *values, *freqs and *nvalues to the most common
+ * values of relid.attnum and their frequencies, or returns false if ANALYZE
+ * recorded none.  The arrays and any pass-by-reference values are palloc'd
+ * in CurrentMemoryContext and belong to the caller.  Unlike the estimators
+ * above this needs no PlannerInfo, so it is usable by callers such as the
+ * plan cache that keep the list to classify many parameter values.
+ */
+bool
+get_column_mcvs(Oid relid, AttrNumber attnum, bool inh,
+				Datum **values, float4 **freqs, int *nvalues)
+{
+	HeapTuple	statsTuple;
+	Oid			atttype;
+	int32		atttypmod;
+	Oid			attcollation;
+	int			nnumbers;
+	bool		result;
+
+	statsTuple = SearchSysCache3(STATRELATTINH,
+								 ObjectIdGetDatum(relid),
+								 Int16GetDatum(attnum),
+								 BoolGetDatum(inh));
+	if (!HeapTupleIsValid(statsTuple))
+		return false;
+
+	get_atttypetypmodcoll(relid, attnum, &atttype, &atttypmod, &attcollation);
+
+	/* get_attstatsslot copies the values out of the tuple for us */
+	result = get_attstatsslot(statsTuple, atttype, atttypmod,
+							  STATISTIC_KIND_MCV, InvalidOid,
+							  NULL,
+							  values, nvalues,
+							  freqs, &nnumbers);
+	if (result && nnumbers < *nvalues)
+		*nvalues = nnumbers;
+
+	ReleaseSysCache(statsTuple);
+
+	return result;
+}
+
 /*
  *	histogram_selectivity	- Examine the histogram for selectivity estimates
  *
@@ -3161,9 +3210,10 @@ add_unique_group_var(PlannerInfo *root, List *varinfos,
  *	pgset - NULL, or a List** pointing to a grouping set to filter the
  *		groupExprs against
  *
- * Given the lack of any cross-correlation statistics in the system, it's
- * impossible to do anything really trustworthy with GROUP BY conditions
- * involving multiple Vars.  We should however avoid assuming the worst
+ * Unless extended statistics exist for the grouped columns, we have no
+ * cross-correlation statistics, and it's impossible to do anything really
+ * trustworthy with GROUP BY conditions involving multiple Vars.  We should
+ * however avoid assuming the worst
  * case (all possible cross-product terms actually appear as groups) since
  * very often the grouped-by Vars are highly correlated.  Our current approach
  * is as follows:
@@ -3191,7 +3241,10 @@ add_unique_group_var(PlannerInfo *root, List *varinfos,
  *	4.  For Vars within a single source rel, we multiply together the numbers
  *		of values, clamp to the number of rows in the rel (divided by 10 if
  *		more than one Var), and then multiply by the selectivity of the
- *		restriction clauses for that rel.  When there's more than one Var,
+ *		restriction clauses for that rel.  If the rel has multivariate
+ *		ndistinct statistics (see CREATE STATISTICS) covering several of the
+ *		Vars, the stored estimate for that combination replaces the product
+ *		of their individual estimates.  When there's more than one Var,
  *		the initial product is probably too high (it's the worst case) but
  *		clamping to a fraction of the rel's rows seems to be a helpful
  *		heuristic for not letting the estimate get out of hand.  (The factor
@@ -3334,25 +3387,25 @@ estimate_num_groups(PlannerInfo *root, List *groupExprs, double input_rows,
 	{
 		GroupVarInfo *varinfo1 = (GroupVarInfo *) linitial(varinfos);
 		RelOptInfo *rel = varinfo1->rel;
-		double		reldistinct = varinfo1->ndistinct;
+		double		reldistinct = 1;
 		double		relmaxndistinct = reldistinct;
-		int			relvarcount = 1;
+		int			relvarcount = 0;
 		List	   *newvarinfos = NIL;
+		List	   *relvarinfos = NIL;
 
 		/*
-		 * Get the product of numdistinct estimates of the Vars for this rel.
-		 * Also, construct new varinfos list of remaining Vars.
+		 * Split the list of varinfos in two - one for the current rel, one
+		 * for remaining Vars on other rels.
 		 */
+		relvarinfos = lcons(varinfo1, relvarinfos);
 		for_each_cell(l, lnext(list_head(varinfos)))
 		{
 			GroupVarInfo *varinfo2 = (GroupVarInfo *) lfirst(l);
 
 			if (varinfo2->rel == varinfo1->rel)
 			{
-				reldistinct *= varinfo2->ndistinct;
-				if (relmaxndistinct < varinfo2->ndistinct)
-					relmaxndistinct = varinfo2->ndistinct;
-				relvarcount++;
+				/* varinfos on current rel */
+				relvarinfos = lcons(varinfo2, relvarinfos);
 			}
 			else
 			{
@@ -3361,6 +3414,47 @@ estimate_num_groups(PlannerInfo *root, List *groupExprs, double input_rows,
 			}
 		}
 
+		/*
+		 * Get the numdistinct estimate for the Vars of this rel.  We
+		 * iteratively search for multivariate n-distinct with maximum number
+		 * of vars; assuming that each var group is independent of the others,
+		 * we multiply them together.  Any remaining relvarinfos after no more
+		 * multivariate matches are found are assumed independent too, so
+		 * their individual ndistinct estimates are multiplied also.
+		 *
+		 * While iterating, count how many separate numdistinct values we
+		 * apply.  We apply a fudge factor below, but only if we multiplied
+		 * more than one such values.
+		 */
+		while (relvarinfos)
+		{
+			double		mvndistinct;
+
+			if (estimate_multivariate_ndistinct(root, rel, &relvarinfos,
+												&mvndistinct))
+			{
+				reldistinct *= mvndistinct;
+				if (relmaxndistinct < mvndistinct)
+					relmaxndistinct = mvndistinct;
+				relvarcount++;
+			}
+			else
+			{
+				foreach(l, relvarinfos)
+				{
+					GroupVarInfo *varinfo2 = (GroupVarInfo *) lfirst(l);
+
+					reldistinct *= varinfo2->ndistinct;
+					if (relmaxndistinct < varinfo2->ndistinct)
+						relmaxndistinct = varinfo2->ndistinct;
+					relvarcount++;
+				}
+
+				/* we're done with this relation */
+				relvarinfos = NIL;
+			}
+		}
+
 		/*
 		 * Sanity check --- don't divide by zero if empty relation.
 		 */
@@ -3415,6 +3509,133 @@ estimate_num_groups(PlannerInfo *root, List *groupExprs, double input_rows,
 	return numdistinct;
 }
 
+/*
+ * estimate_multivariate_ndistinct
+ *		Find the multivariate ndistinct statistics covering the most of the
+ *		given Vars of 'rel'.
+ *
+ * If one covering at least two of the Vars is found, set *ndistinct to the
+ * stored estimate for that combination, remove the covered Vars from
+ * *varinfos, and return true.  Otherwise return false.
+ */
+static bool
+estimate_multivariate_ndistinct(PlannerInfo *root, RelOptInfo *rel,
+								List **varinfos, double *ndistinct)
+{
+	ListCell   *lc;
+	Bitmapset  *attnums = NULL;
+	int			nmatches;
+	Oid			statOid = InvalidOid;
+	MVNDistinct *stats;
+	Bitmapset  *matched = NULL;
+
+	/* bail out immediately if the table has no extended statistics */
+	if (!rel->statlist)
+		return false;
+
+	/* Determine the attnums we're looking for */
+	foreach(lc, *varinfos)
+	{
+		GroupVarInfo *varinfo = (GroupVarInfo *) lfirst(lc);
+
+		Assert(varinfo->rel == rel);
+
+		if (IsA(varinfo->var, Var) &&
+			((Var *) varinfo->var)->varattno > 0)
+			attnums = bms_add_member(attnums,
+									 ((Var *) varinfo->var)->varattno);
+	}
+
+	/* We need at least two attributes for multivariate statistics */
+	if (bms_num_members(attnums) <= 1)
+		return false;
+
+	/* Find the statistics object that covers the most of the attributes */
+	nmatches = 1;				/* we require at least two matches */
+	foreach(lc, rel->statlist)
+	{
+		StatisticExtInfo *info = (StatisticExtInfo *) lfirst(lc);
+		Bitmapset  *shared;
+		int			nshared;
+
+		/* skip statistics of other kinds */
+		if (info->kind != STATS_EXT_NDISTINCT)
+			continue;
+
+		/* compute attnums shared by the vars and the statistics object */
+		shared = bms_intersect(info->keys, attnums);
+		nshared = bms_num_members(shared);
+
+		/*
+		 * Does this statistics object match more columns than the currently
+		 * best object?  If so, use this one instead.
+		 */
+		if (nshared > nmatches)
+		{
+			statOid = info->statOid;
+			nmatches = nshared;
+			matched = shared;
+		}
+	}
+
+	/* No match? */
+	if (statOid == InvalidOid)
+		return false;
+	Assert(nmatches > 1 && matched != NULL);
+
+	stats = statext_ndistinct_load(statOid);
+
+	/*
+	 * If we have a match, search it for the specific item that matches (there
+	 * must be one), and construct the output values.
+	 */
+	if (stats)
+	{
+		int			i;
+		List	   *newlist = NIL;
+		MVNDistinctItem *item = NULL;
+
+		/* Find the specific item that exactly matches the combination */
+		for (i = 0; i < stats->nitems; i++)
+		{
+			MVNDistinctItem *tmpitem = &stats->items[i];
+
+			if (bms_subset_compare(tmpitem->attrs, matched) == BMS_EQUAL)
+			{
+				item = tmpitem;
+				break;
+			}
+		}
+
+		/* make sure we found an item */
+		if (!item)
+			elog(ERROR, "corrupt MVNDistinct entry");
+
+		/* Form the output varinfo list, keeping only unmatched ones */
+		foreach(lc, *varinfos)
+		{
+			GroupVarInfo *varinfo = (GroupVarInfo *) lfirst(lc);
+			AttrNumber	attnum;
+
+			if (!IsA(varinfo->var, Var))
+			{
+				newlist = lappend(newlist, varinfo);
+				continue;
+			}
+
+			attnum = ((Var *) varinfo->var)->varattno;
+			if (attnum <= 0 || !bms_is_member(attnum, matched))
+				newlist = lappend(newlist, varinfo);
+		}
+
+		*varinfos = newlist;
+		*ndistinct = item->ndistinct;
+		return true;
+	}
+
+	return false;
+}
+
 /*
  * Estimate hash bucketsize fraction (ie, number of entries in a bucket
  * divided by total tuples in relation) if the specified expression is used
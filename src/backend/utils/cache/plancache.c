@@ -9,7 +9,11 @@
  * changes in the objects they depend on.
  *
  * The logic for choosing generic or custom plans is in choose_custom_plan,
- * which see for comments.
+ * which see for comments.  Where a statement compares table columns to its
+ * parameters, we may also keep a few generic plans that were planned for
+ * parameter values of a particular selectivity class, so that a statement
+ * whose parameters sometimes hit a very common value and sometimes a rare
+ * one is not stuck with a single generic plan that suits only one of them.
  *
  * Cache invalidation is driven off sinval events.  Any CachedPlanSource
  * that matches the event is marked invalid, as is its generic CachedPlan
@@ -51,6 +55,8 @@
 
 #include "access/transam.h"
 #include "catalog/namespace.h"
+#include "catalog/pg_collation.h"
+#include "commands/trigger.h"
 #include "executor/executor.h"
 #include "executor/spi.h"
 #include "miscadmin.h"
@@ -63,10 +69,14 @@
 #include "storage/lmgr.h"
 #include "tcop/pquery.h"
 #include "tcop/utility.h"
+#include "utils/fmgroids.h"
 #include "utils/inval.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/resowner_private.h"
 #include "utils/rls.h"
+#include "utils/selfuncs.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
@@ -87,22 +97,79 @@
  */
 static CachedPlanSource *first_saved_plan = NULL;
 
+/* GUC parameter */
+bool		plan_cache_selectivity = true;
+
+/*
+ * A "column = parameter" comparison in a cached query, whose parameter value
+ * determines which selectivity-specific generic plan we use.  We consider
+ * at most MAX_SELECTIVITY_PARAMS of them, which keeps the class key small.
+ *
+ * Classifying a value means looking it up in the column's MCV list, which
+ * happens on every execution, so we keep a copy of the list rather than
+ * fetching and deconstructing the statistics tuple each time.  The copy
+ * lives in its own small context below the query_context, and is fetched
+ * again after PlanCacheStatCallback reports that the statistics changed.
+ */
+typedef struct PlanCacheSelParam
+{
+	Oid			relid;			/* relation containing the column */
+	AttrNumber	attnum;			/* column number */
+	bool		inh;			/* use inheritance-tree statistics? */
+	Oid			opno;			/* the equality operator */
+	bool		varonleft;		/* is the column the left-hand input? */
+	int			paramid;		/* number of the PARAM_EXTERN parameter */
+	Oid			paramtype;		/* its expected type */
+	uint32		stathash;		/* hash value of its pg_statistic entry */
+	FmgrInfo	eqproc;			/* lookup info for opno's function */
+	bool		mcvs_valid;		/* are the fields below up to date? */
+	MemoryContext mcv_context;	/* context holding the MCV list, or NULL */
+	int			nmcvs;			/* number of MCV entries, 0 if none */
+	Datum	   *mcv_values;		/* the most common values */
+	float4	   *mcv_freqs;		/* and their frequencies */
+} PlanCacheSelParam;
+
+#define MAX_SELECTIVITY_PARAMS	8
+
+typedef struct
+{
+	List	   *rtable;			/* rangetable of the Query being scanned */
+	PlanCacheSelParam *params;	/* output array */
+	int			nparams;		/* number of entries filled */
+} find_sel_params_context;
+
 static void ReleaseGenericPlan(CachedPlanSource *plansource);
+static void ReleaseGenericPlanLink(CachedPlan **planp);
 static List *RevalidateCachedQuery(CachedPlanSource *plansource);
-static bool CheckCachedPlan(CachedPlanSource *plansource);
+static bool CheckCachedPlan(CachedPlanSource *plansource, CachedPlan **planp);
 static CachedPlan *BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 				ParamListInfo boundParams);
 static bool choose_custom_plan(CachedPlanSource *plansource,
-				   ParamListInfo boundParams);
+				   ParamListInfo boundParams, int *selkey);
 static double cached_plan_cost(CachedPlan *plan, bool include_planner);
+static void find_selectivity_params(CachedPlanSource *plansource);
+static bool find_selectivity_params_walker(Node *node,
+							   find_sel_params_context *context);
+static int	selectivity_class_key(CachedPlanSource *plansource,
+					  ParamListInfo boundParams);
+static void load_selectivity_mcvs(CachedPlanSource *plansource,
+					  PlanCacheSelParam *sp);
+static int	find_selectivity_slot(CachedPlanSource *plansource, int selkey);
+static int	assign_selectivity_slot(CachedPlanSource *plansource, int selkey);
+static ParamListInfo selectivity_hint_params(ParamListInfo boundParams);
 static void AcquireExecutorLocks(List *stmt_list, bool acquire);
 static void AcquirePlannerLocks(List *stmt_list, bool acquire);
 static void ScanQueryForLocks(Query *parsetree, bool acquire);
 static bool ScanQueryWalker(Node *node, bool *acquire);
 static bool plan_list_is_transient(List *stmt_list);
+static bool plan_list_depends_on_fkeys(List *stmt_list);
 static TupleDesc PlanCacheComputeResultDesc(List *stmt_list);
+static void PlanCacheRelCheckPlan(CachedPlan *plan, Oid relid);
+static void PlanCacheFuncCheckPlan(CachedPlan *plan, int cacheid,
+					   uint32 hashvalue);
 static void PlanCacheRelCallback(Datum arg, Oid relid);
 static void PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue);
+static void PlanCacheStatCallback(Datum arg, int cacheid, uint32 hashvalue);
 static void PlanCacheSysCallback(Datum arg, int cacheid, uint32 hashvalue);
 
 
@@ -116,6 +183,7 @@ InitPlanCache(void)
 {
 	CacheRegisterRelcacheCallback(PlanCacheRelCallback, (Datum) 0);
 	CacheRegisterSyscacheCallback(PROCOID, PlanCacheFuncCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(STATRELATTINH, PlanCacheStatCallback, (Datum) 0);
 	CacheRegisterSyscacheCallback(NAMESPACEOID, PlanCacheSysCallback, (Datum) 0);
 	CacheRegisterSyscacheCallback(OPEROID, PlanCacheSysCallback, (Datum) 0);
 	CacheRegisterSyscacheCallback(AMOPOPID, PlanCacheSysCallback, (Datum) 0);
@@ -207,6 +275,9 @@ CreateCachedPlan(Node *raw_parse_tree,
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
 	plansource->num_custom_plans = 0;
+	plansource->num_sel_params = -1;
+	plansource->sel_params = NULL;
+	plansource->next_splan = 0;
 	plansource->hasRowSecurity = false;
 	plansource->rowSecurityDisabled
 		= (security_context & SECURITY_ROW_LEVEL_DISABLED) != 0;
@@ -277,6 +348,9 @@ CreateOneShotCachedPlan(Node *raw_parse_tree,
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
 	plansource->num_custom_plans = 0;
+	plansource->num_sel_params = -1;
+	plansource->sel_params = NULL;
+	plansource->next_splan = 0;
 
 	return plansource;
 }
@@ -523,18 +597,34 @@ DropCachedPlan(CachedPlanSource *plansource)
 }
 
 /*
- * ReleaseGenericPlan: release a CachedPlanSource's generic plan, if any.
+ * ReleaseGenericPlan: release a CachedPlanSource's generic plans, if any.
+ *
+ * This drops the fully generic plan as well as any selectivity-specific ones.
+ * The cost knowledge associated with them is kept.
  */
 static void
 ReleaseGenericPlan(CachedPlanSource *plansource)
+{
+	int			i;
+
+	ReleaseGenericPlanLink(&plansource->gplan);
+	for (i = 0; i < CACHED_PLAN_SELECTIVITY_SLOTS; i++)
+		ReleaseGenericPlanLink(&plansource->splans[i]);
+}
+
+/*
+ * ReleaseGenericPlanLink: release one generic plan link of a CachedPlanSource
+ */
+static void
+ReleaseGenericPlanLink(CachedPlan **planp)
 {
 	/* Be paranoid about the possibility that ReleaseCachedPlan fails */
-	if (plansource->gplan)
+	if (*planp)
 	{
-		CachedPlan *plan = plansource->gplan;
+		CachedPlan *plan = *planp;
 
 		Assert(plan->magic == CACHEDPLAN_MAGIC);
-		plansource->gplan = NULL;
+		*planp = NULL;
 		ReleaseCachedPlan(plan, false);
 	}
 }
@@ -655,6 +745,8 @@ RevalidateCachedQuery(CachedPlanSource *plansource)
 	plansource->relationOids = NIL;
 	plansource->invalItems = NIL;
 	plansource->search_path = NULL;
+	plansource->num_sel_params = -1;
+	plansource->sel_params = NULL;
 
 	/*
 	 * Free the query_context.  We don't really expect MemoryContextDelete to
@@ -799,7 +891,10 @@ RevalidateCachedQuery(CachedPlanSource *plansource)
 }
 
 /*
- * CheckCachedPlan: see if the CachedPlanSource's generic plan is valid.
+ * CheckCachedPlan: see if one of the CachedPlanSource's generic plans is valid.
+ *
+ * planp points to the plansource's link to the generic plan to check: either
+ * its gplan field or one of its splans entries.
  *
  * Caller must have already called RevalidateCachedQuery to verify that the
  * querytree is up to date.
@@ -808,9 +903,9 @@ RevalidateCachedQuery(CachedPlanSource *plansource)
  * (We must do this for the "true" result to be race-condition-free.)
  */
 static bool
-CheckCachedPlan(CachedPlanSource *plansource)
+CheckCachedPlan(CachedPlanSource *plansource, CachedPlan **planp)
 {
-	CachedPlan *plan = plansource->gplan;
+	CachedPlan *plan = *planp;
 
 	/* Assert that caller checked the querytree */
 	Assert(plansource->is_valid);
@@ -846,6 +941,16 @@ CheckCachedPlan(CachedPlanSource *plansource)
 			!TransactionIdEquals(plan->saved_xmin, TransactionXmin))
 			plan->is_valid = false;
 
+		/*
+		 * If the planner removed a join on the strength of a foreign key,
+		 * the plan is wrong while RI trigger events are still queued, since
+		 * the constraint may not hold until they have fired.
+		 */
+		if (plan->is_valid &&
+			plan->depends_on_fkeys &&
+			AfterTriggerEventsPending())
+			plan->is_valid = false;
+
 		/*
 		 * By now, if any invalidation has happened, the inval callback
 		 * functions will have marked the plan invalid.
@@ -863,7 +968,7 @@ CheckCachedPlan(CachedPlanSource *plansource)
 	/*
 	 * Plan has been invalidated, so unlink it from the parent and release it.
 	 */
-	ReleaseGenericPlan(plansource);
+	ReleaseGenericPlanLink(planp);
 
 	return false;
 }
@@ -878,7 +983,8 @@ CheckCachedPlan(CachedPlanSource *plansource)
  * boundParams.  To build a custom plan, pass the actual parameter values via
  * boundParams.  For best effect, the PARAM_FLAG_CONST flag should be set on
  * each parameter value; otherwise the planner will treat the value as a
- * hint rather than a hard constant.
+ * hint rather than a hard constant.  (We exploit the latter behavior to build
+ * selectivity-specific generic plans: see selectivity_hint_params.)
  *
  * Planning work is done in the caller's memory context.  The finished plan
  * is in a child memory context, which typically should get reparented
@@ -892,6 +998,7 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	List	   *plist;
 	bool		snapshot_set;
 	bool		spi_pushed;
+	char	   *shared_key = NULL;
 	MemoryContext plan_context;
 	MemoryContext oldcxt = CurrentMemoryContext;
 
@@ -946,9 +1053,34 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	spi_pushed = SPI_push_conditional();
 
 	/*
-	 * Generate the plan.
+	 * A generic plan for a saved statement may already have been built by
+	 * another backend; if so, use its copy from the shared plan cache.  The
+	 * key must be computed before the planner scribbles on qlist.  Don't
+	 * look while after-trigger events are pending, since the shared plan may
+	 * have removed a join by trusting a foreign key (see CheckCachedPlan).
+	 */
+	plist = NIL;
+	if (SharedPlanCacheEnabled() &&
+		boundParams == NULL &&
+		plansource->is_saved &&
+		!plansource->is_oneshot &&
+		!plansource->hasRowSecurity &&
+		!AfterTriggerEventsPending())
+	{
+		shared_key = SharedPlanCacheKey(qlist, plansource->cursor_options);
+		plist = SharedPlanCacheLookup(shared_key);
+	}
+
+	/*
+	 * Generate the plan, unless we found it above.
 	 */
-	plist = pg_plan_queries(qlist, plansource->cursor_options, boundParams);
+	if (plist == NIL)
+	{
+		plist = pg_plan_queries(qlist, plansource->cursor_options, boundParams);
+
+		if (shared_key != NULL)
+			SharedPlanCacheStore(shared_key, plist);
+	}
 
 	/* Clean up SPI state */
 	SPI_pop_conditional(spi_pushed);
@@ -995,6 +1127,7 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	}
 	else
 		plan->saved_xmin = InvalidTransactionId;
+	plan->depends_on_fkeys = plan_list_depends_on_fkeys(plist);
 	plan->refcount = 0;
 	plan->context = plan_context;
 	plan->is_oneshot = plansource->is_oneshot;
@@ -1013,12 +1146,20 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
  * choose_custom_plan: choose whether to use custom or generic plan
  *
  * This defines the policy followed by GetCachedPlan.
+ *
+ * *selkey is set to the selectivity class key of the parameter values if we
+ * compared costs using a selectivity-specific generic plan, else to zero.
+ * In the former case, a "false" result means that the generic plan kept for
+ * that class (see find_selectivity_slot) should be used.
  */
 static bool
-choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams)
+choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams,
+				   int *selkey)
 {
 	double		avg_custom_cost;
 
+	*selkey = 0;
+
 	/* One-shot plans will always be considered custom */
 	if (plansource->is_oneshot)
 		return true;
@@ -1040,6 +1181,29 @@ choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams)
 	if (plansource->num_custom_plans < 5)
 		return true;
 
+	/*
+	 * If the query compares columns to parameters, a single generic plan
+	 * can't suit both very common and very rare parameter values, so compare
+	 * a custom plan against a generic plan planned for values of the same
+	 * selectivity class instead.  We make one custom plan for each class we
+	 * see to learn what a custom plan costs for it; thereafter the class's
+	 * own generic plan is preferred if it's cheaper than that.
+	 */
+	if (plan_cache_selectivity)
+	{
+		*selkey = selectivity_class_key(plansource, boundParams);
+		if (*selkey != 0)
+		{
+			int			slot = find_selectivity_slot(plansource, *selkey);
+
+			if (slot < 0 || plansource->splan_custom_costs[slot] < 0)
+				return true;
+			if (plansource->splan_costs[slot] < plansource->splan_custom_costs[slot])
+				return false;
+			return true;
+		}
+	}
+
 	avg_custom_cost = plansource->total_custom_cost / plansource->num_custom_plans;
 
 	/*
@@ -1112,6 +1276,307 @@ cached_plan_cost(CachedPlan *plan, bool include_planner)
 	return result;
 }
 
+/*
+ * find_selectivity_params: find the "column = parameter" comparisons in a
+ * CachedPlanSource's query_list
+ *
+ * We look for equality comparisons (those estimated by eqsel) between a
+ * plain table column and an external parameter in the WHERE and JOIN/ON
+ * clauses of each query, not descending into sub-selects.  The result is
+ * stored into the plansource's query_context, so that it goes away whenever
+ * the querytree does.  The columns' MCV lists are fetched only when first
+ * needed, by load_selectivity_mcvs.
+ */
+static void
+find_selectivity_params(CachedPlanSource *plansource)
+{
+	find_sel_params_context context;
+	MemoryContext oldcxt;
+	ListCell   *lc;
+	int			i;
+
+	Assert(plansource->query_context != NULL);
+
+	oldcxt = MemoryContextSwitchTo(plansource->query_context);
+	context.params = (PlanCacheSelParam *)
+		palloc(MAX_SELECTIVITY_PARAMS * sizeof(PlanCacheSelParam));
+	context.nparams = 0;
+	MemoryContextSwitchTo(oldcxt);
+
+	foreach(lc, plansource->query_list)
+	{
+		Query	   *query = (Query *) lfirst(lc);
+
+		Assert(IsA(query, Query));
+		if (query->commandType == CMD_UTILITY)
+			continue;
+		context.rtable = query->rtable;
+		(void) find_selectivity_params_walker((Node *) query->jointree,
+											  &context);
+	}
+
+	for (i = 0; i < context.nparams; i++)
+	{
+		PlanCacheSelParam *sp = &context.params[i];
+
+		sp->stathash = GetSysCacheHashValue3(STATRELATTINH,
+											 ObjectIdGetDatum(sp->relid),
+											 Int16GetDatum(sp->attnum),
+											 BoolGetDatum(sp->inh));
+		fmgr_info_cxt(get_opcode(sp->opno), &sp->eqproc,
+					  plansource->query_context);
+		sp->mcvs_valid = false;
+		sp->mcv_context = NULL;
+		sp->nmcvs = 0;
+		sp->mcv_values = NULL;
+		sp->mcv_freqs = NULL;
+	}
+
+	plansource->sel_params = context.params;
+	plansource->num_sel_params = context.nparams;
+}
+
+static bool
+find_selectivity_params_walker(Node *node, find_sel_params_context *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Query))
+	{
+		/* Don't look into sub-selects */
+		return false;
+	}
+	if (IsA(node, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) node;
+
+		if (list_length(opexpr->args) == 2 &&
+			context->nparams < MAX_SELECTIVITY_PARAMS &&
+			get_oprrest(opexpr->opno) == F_EQSEL)
+		{
+			Node	   *left = (Node *) linitial(opexpr->args);
+			Node	   *right = (Node *) lsecond(opexpr->args);
+			Var		   *var = NULL;
+			Param	   *param = NULL;
+			bool		varonleft = true;
+
+			if (IsA(left, Var) && IsA(right, Param))
+			{
+				var = (Var *) left;
+				param = (Param *) right;
+			}
+			else if (IsA(left, Param) && IsA(right, Var))
+			{
+				var = (Var *) right;
+				param = (Param *) left;
+				varonleft = false;
+			}
+
+			if (var != NULL &&
+				var->varlevelsup == 0 &&
+				var->varattno > 0 &&
+				param->paramkind == PARAM_EXTERN)
+			{
+				RangeTblEntry *rte = rt_fetch(var->varno, context->rtable);
+
+				if (rte->rtekind == RTE_RELATION)
+				{
+					PlanCacheSelParam *sp = &context->params[context->nparams++];
+
+					sp->relid = rte->relid;
+					sp->attnum = var->varattno;
+					sp->inh = rte->inh;
+					sp->opno = opexpr->opno;
+					sp->varonleft = varonleft;
+					sp->paramid = param->paramid;
+					sp->paramtype = param->paramtype;
+				}
+			}
+		}
+		/* fall through to examine the arguments */
+	}
+	return expression_tree_walker(node, find_selectivity_params_walker,
+								  (void *) context);
+}
+
+/*
+ * selectivity_class_key: compute the selectivity class key of the given
+ * parameter values, or zero if the query has no parameters we classify
+ *
+ * Each "column = parameter" comparison contributes a class based on where
+ * the parameter value falls in the column's MCV list: 0 if it's not there
+ * (or is NULL, or there are no statistics), otherwise one class per decade
+ * of frequency.  The per-comparison classes are packed two bits apiece
+ * below a leading 1 bit, so that a valid key is never zero.
+ */
+static int
+selectivity_class_key(CachedPlanSource *plansource, ParamListInfo boundParams)
+{
+	int			key = 1;
+	int			i;
+
+	if (plansource->num_sel_params < 0)
+		find_selectivity_params(plansource);
+	if (plansource->num_sel_params == 0)
+		return 0;
+
+	for (i = 0; i < plansource->num_sel_params; i++)
+	{
+		PlanCacheSelParam *sp = &plansource->sel_params[i];
+		double		freq = -1.0;
+		int			selclass;
+
+		if (sp->paramid > 0 && sp->paramid <= boundParams->numParams)
+		{
+			ParamExternData *prm = &boundParams->params[sp->paramid - 1];
+
+			/* give hook a chance in case parameter is dynamic */
+			if (!OidIsValid(prm->ptype) && boundParams->paramFetch != NULL)
+				(*boundParams->paramFetch) (boundParams, sp->paramid);
+
+			if (prm->ptype == sp->paramtype && !prm->isnull)
+			{
+				int			j;
+
+				if (!sp->mcvs_valid)
+					load_selectivity_mcvs(plansource, sp);
+
+				for (j = 0; j < sp->nmcvs; j++)
+				{
+					Datum		mcv = sp->mcv_values[j];
+					bool		match;
+
+					/* be careful to apply operator right way 'round */
+					if (sp->varonleft)
+						match = DatumGetBool(FunctionCall2Coll(&sp->eqproc,
+													   DEFAULT_COLLATION_OID,
+															mcv, prm->value));
+					else
+						match = DatumGetBool(FunctionCall2Coll(&sp->eqproc,
+													   DEFAULT_COLLATION_OID,
+															prm->value, mcv));
+					if (match)
+					{
+						freq = sp->mcv_freqs[j];
+						break;
+					}
+				}
+			}
+		}
+
+		if (freq < 0)
+			selclass = 0;
+		else if (freq < 0.01)
+			selclass = 1;
+		else if (freq < 0.1)
+			selclass = 2;
+		else
+			selclass = 3;
+
+		key = (key << 2) | selclass;
+	}
+
+	return key;
+}
+
+/*
+ * load_selectivity_mcvs: fetch the MCV list of a classified column
+ *
+ * The list is copied into the parameter's own memory context, discarding
+ * any previous copy.
+ */
+static void
+load_selectivity_mcvs(CachedPlanSource *plansource, PlanCacheSelParam *sp)
+{
+	MemoryContext oldcxt;
+
+	if (sp->mcv_context == NULL)
+		sp->mcv_context = AllocSetContextCreate(plansource->query_context,
+												"CachedPlanSource MCV list",
+												ALLOCSET_SMALL_MINSIZE,
+												ALLOCSET_SMALL_INITSIZE,
+												ALLOCSET_SMALL_MAXSIZE);
+	else
+		MemoryContextReset(sp->mcv_context);
+	sp->nmcvs = 0;
+	sp->mcv_values = NULL;
+	sp->mcv_freqs = NULL;
+
+	/*
+	 * Mark the list valid before fetching it: if the catalog access below
+	 * processes an invalidation for these statistics, the flag is cleared
+	 * again and we'll fetch the list anew next time.
+	 */
+	sp->mcvs_valid = true;
+
+	oldcxt = MemoryContextSwitchTo(sp->mcv_context);
+	if (!get_column_mcvs(sp->relid, sp->attnum, sp->inh,
+						 &sp->mcv_values, &sp->mcv_freqs, &sp->nmcvs))
+		sp->nmcvs = 0;
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * find_selectivity_slot: find the slot used for a selectivity class key,
+ * or return -1 if there is none
+ */
+static int
+find_selectivity_slot(CachedPlanSource *plansource, int selkey)
+{
+	int			i;
+
+	for (i = 0; i < CACHED_PLAN_SELECTIVITY_SLOTS; i++)
+	{
+		if (plansource->splan_keys[i] == selkey)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * assign_selectivity_slot: find or make a slot for a selectivity class key
+ *
+ * If all slots are in use, the oldest one is recycled.
+ */
+static int
+assign_selectivity_slot(CachedPlanSource *plansource, int selkey)
+{
+	int			slot = find_selectivity_slot(plansource, selkey);
+
+	if (slot >= 0)
+		return slot;
+
+	slot = plansource->next_splan;
+	plansource->next_splan = (slot + 1) % CACHED_PLAN_SELECTIVITY_SLOTS;
+
+	ReleaseGenericPlanLink(&plansource->splans[slot]);
+	plansource->splan_keys[slot] = selkey;
+	plansource->splan_costs[slot] = -1;
+	plansource->splan_custom_costs[slot] = -1;
+
+	return slot;
+}
+
+/*
+ * selectivity_hint_params: make a copy of boundParams for planning a
+ * selectivity-specific generic plan
+ *
+ * Clearing PARAM_FLAG_CONST makes the planner use the values only for
+ * estimation, so the resulting plan is correct for any parameter values.
+ */
+static ParamListInfo
+selectivity_hint_params(ParamListInfo boundParams)
+{
+	ParamListInfo params = copyParamList(boundParams);
+	int			i;
+
+	if (params == NULL)
+		return NULL;
+	for (i = 0; i < params->numParams; i++)
+		params->params[i].pflags &= ~PARAM_FLAG_CONST;
+	return params;
+}
+
 /*
  * GetCachedPlan: get a cached plan from a CachedPlanSource.
  *
@@ -1137,6 +1602,7 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 	CachedPlan *plan;
 	List	   *qlist;
 	bool		customplan;
+	int			selkey;
 
 	/* Assert caller is doing things in a sane order */
 	Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
@@ -1149,24 +1615,40 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 	qlist = RevalidateCachedQuery(plansource);
 
 	/* Decide whether to use a custom plan */
-	customplan = choose_custom_plan(plansource, boundParams);
+	customplan = choose_custom_plan(plansource, boundParams, &selkey);
 
 	if (!customplan)
 	{
-		if (CheckCachedPlan(plansource))
+		CachedPlan **gplanp = &plansource->gplan;
+		double	   *gcostp = &plansource->generic_cost;
+		ParamListInfo gparams = NULL;
+
+		/* Use the generic plan for the parameters' selectivity class, if any */
+		if (selkey != 0)
+		{
+			int			slot = find_selectivity_slot(plansource, selkey);
+
+			Assert(slot >= 0);
+			gplanp = &plansource->splans[slot];
+			gcostp = &plansource->splan_costs[slot];
+		}
+
+		if (CheckCachedPlan(plansource, gplanp))
 		{
 			/* We want a generic plan, and we already have a valid one */
-			plan = plansource->gplan;
+			plan = *gplanp;
 			Assert(plan->magic == CACHEDPLAN_MAGIC);
 		}
 		else
 		{
-			/* Build a new generic plan */
-			plan = BuildCachedPlan(plansource, qlist, NULL);
-			/* Just make real sure plansource->gplan is clear */
-			ReleaseGenericPlan(plansource);
+			/* Build a new generic plan, using the values only as hints */
+			if (selkey != 0)
+				gparams = selectivity_hint_params(boundParams);
+			plan = BuildCachedPlan(plansource, qlist, gparams);
+			/* Just make real sure the plansource's link is clear */
+			ReleaseGenericPlanLink(gplanp);
 			/* Link the new generic plan into the plansource */
-			plansource->gplan = plan;
+			*gplanp = plan;
 			plan->refcount++;
 			/* Immediately reparent into appropriate context */
 			if (plansource->is_saved)
@@ -1182,7 +1664,7 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 								MemoryContextGetParent(plansource->context));
 			}
 			/* Update generic_cost whenever we make a new generic plan */
-			plansource->generic_cost = cached_plan_cost(plan, false);
+			*gcostp = cached_plan_cost(plan, false);
 
 			/*
 			 * If, based on the now-known value of generic_cost, we'd not have
@@ -1193,7 +1675,7 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 			 * find it's a loser, but we don't want to actually execute that
 			 * plan.
 			 */
-			customplan = choose_custom_plan(plansource, boundParams);
+			customplan = choose_custom_plan(plansource, boundParams, &selkey);
 
 			/*
 			 * If we choose to plan again, we need to re-copy the query_list,
@@ -1214,6 +1696,13 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 			plansource->total_custom_cost += cached_plan_cost(plan, true);
 			plansource->num_custom_plans++;
 		}
+		/* Remember its cost for comparison with the class's generic plan */
+		if (selkey != 0)
+		{
+			int			slot = assign_selectivity_slot(plansource, selkey);
+
+			plansource->splan_custom_costs[slot] = cached_plan_cost(plan, true);
+		}
 	}
 
 	/* Flag the plan as in use by caller */
@@ -1281,6 +1770,8 @@ void
 CachedPlanSetParentContext(CachedPlanSource *plansource,
 						   MemoryContext newcontext)
 {
+	int			i;
+
 	/* Assert caller is doing things in a sane order */
 	Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
 	Assert(plansource->is_complete);
@@ -1296,14 +1787,24 @@ CachedPlanSetParentContext(CachedPlanSource *plansource,
 
 	/*
 	 * The query_context needs no special handling, since it's a child of
-	 * plansource->context.  But if there's a generic plan, it should be
-	 * maintained as a sibling of plansource->context.
+	 * plansource->context.  But if there are generic plans, they should be
+	 * maintained as siblings of plansource->context.
 	 */
 	if (plansource->gplan)
 	{
 		Assert(plansource->gplan->magic == CACHEDPLAN_MAGIC);
 		MemoryContextSetParent(plansource->gplan->context, newcontext);
 	}
+	for (i = 0; i < CACHED_PLAN_SELECTIVITY_SLOTS; i++)
+	{
+		CachedPlan *splan = plansource->splans[i];
+
+		if (splan)
+		{
+			Assert(splan->magic == CACHEDPLAN_MAGIC);
+			MemoryContextSetParent(splan->context, newcontext);
+		}
+	}
 }
 
 /*
@@ -1392,6 +1893,9 @@ CopyCachedPlan(CachedPlanSource *plansource)
 	newsource->generic_cost = plansource->generic_cost;
 	newsource->total_custom_cost = plansource->total_custom_cost;
 	newsource->num_custom_plans = plansource->num_custom_plans;
+	newsource->num_sel_params = -1;
+	newsource->sel_params = NULL;
+	newsource->next_splan = 0;
 
 	MemoryContextSwitchTo(oldcxt);
 
@@ -1658,6 +2162,29 @@ plan_list_is_transient(List *stmt_list)
 	return false;
 }
 
+/*
+ * plan_list_depends_on_fkeys: check if any of the plans in the list rely on
+ * foreign key constraints holding.
+ */
+static bool
+plan_list_depends_on_fkeys(List *stmt_list)
+{
+	ListCell   *lc;
+
+	foreach(lc, stmt_list)
+	{
+		PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+
+		if (!IsA(plannedstmt, PlannedStmt))
+			continue;			/* Ignore utility statements */
+
+		if (plannedstmt->dependsOnFKeys)
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * PlanCacheComputeResultDesc: given a list of analyzed-and-rewritten Queries,
  * determine the result tupledesc it will produce.  Returns NULL if the
@@ -1708,6 +2235,10 @@ static void
 PlanCacheRelCallback(Datum arg, Oid relid)
 {
 	CachedPlanSource *plansource;
+	int			i;
+
+	/* Every backend sees this message, so it can clean the shared cache too */
+	SharedPlanCacheInvalRelation(relid);
 
 	for (plansource = first_saved_plan; plansource; plansource = plansource->next_saved)
 	{
@@ -1734,28 +2265,40 @@ PlanCacheRelCallback(Datum arg, Oid relid)
 		}
 
 		/*
-		 * The generic plan, if any, could have more dependencies than the
-		 * querytree does, so we have to check it too.
+		 * The generic plans, if any, could have more dependencies than the
+		 * querytree does, so we have to check them too.
 		 */
-		if (plansource->gplan && plansource->gplan->is_valid)
-		{
-			ListCell   *lc;
+		PlanCacheRelCheckPlan(plansource->gplan, relid);
+		for (i = 0; i < CACHED_PLAN_SELECTIVITY_SLOTS; i++)
+			PlanCacheRelCheckPlan(plansource->splans[i], relid);
+	}
+}
 
-			foreach(lc, plansource->gplan->stmt_list)
-			{
-				PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+/*
+ * PlanCacheRelCheckPlan
+ *		Invalidate a generic plan, if any, that mentions the given rel
+ */
+static void
+PlanCacheRelCheckPlan(CachedPlan *plan, Oid relid)
+{
+	ListCell   *lc;
 
-				Assert(!IsA(plannedstmt, Query));
-				if (!IsA(plannedstmt, PlannedStmt))
-					continue;	/* Ignore utility statements */
-				if ((relid == InvalidOid) ? plannedstmt->relationOids != NIL :
-					list_member_oid(plannedstmt->relationOids, relid))
-				{
-					/* Invalidate the generic plan only */
-					plansource->gplan->is_valid = false;
-					break;		/* out of stmt_list scan */
-				}
-			}
+	if (plan == NULL || !plan->is_valid)
+		return;
+
+	foreach(lc, plan->stmt_list)
+	{
+		PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+
+		Assert(!IsA(plannedstmt, Query));
+		if (!IsA(plannedstmt, PlannedStmt))
+			continue;			/* Ignore utility statements */
+		if ((relid == InvalidOid) ? plannedstmt->relationOids != NIL :
+			list_member_oid(plannedstmt->relationOids, relid))
+		{
+			/* Invalidate the generic plan only */
+			plan->is_valid = false;
+			break;				/* out of stmt_list scan */
 		}
 	}
 }
@@ -1774,6 +2317,9 @@ static void
 PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue)
 {
 	CachedPlanSource *plansource;
+	int			i;
+
+	SharedPlanCacheInvalSyscache(cacheid, hashvalue);
 
 	for (plansource = first_saved_plan; plansource; plansource = plansource->next_saved)
 	{
@@ -1810,36 +2356,78 @@ PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue)
 		}
 
 		/*
-		 * The generic plan, if any, could have more dependencies than the
-		 * querytree does, so we have to check it too.
+		 * The generic plans, if any, could have more dependencies than the
+		 * querytree does, so we have to check them too.
 		 */
-		if (plansource->gplan && plansource->gplan->is_valid)
+		PlanCacheFuncCheckPlan(plansource->gplan, cacheid, hashvalue);
+		for (i = 0; i < CACHED_PLAN_SELECTIVITY_SLOTS; i++)
+			PlanCacheFuncCheckPlan(plansource->splans[i], cacheid, hashvalue);
+	}
+}
+
+/*
+ * PlanCacheFuncCheckPlan
+ *		Invalidate a generic plan, if any, that mentions the given object
+ */
+static void
+PlanCacheFuncCheckPlan(CachedPlan *plan, int cacheid, uint32 hashvalue)
+{
+	ListCell   *lc;
+
+	if (plan == NULL || !plan->is_valid)
+		return;
+
+	foreach(lc, plan->stmt_list)
+	{
+		PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+		ListCell   *lc3;
+
+		Assert(!IsA(plannedstmt, Query));
+		if (!IsA(plannedstmt, PlannedStmt))
+			continue;			/* Ignore utility statements */
+		foreach(lc3, plannedstmt->invalItems)
 		{
-			foreach(lc, plansource->gplan->stmt_list)
+			PlanInvalItem *item = (PlanInvalItem *) lfirst(lc3);
+
+			if (item->cacheId != cacheid)
+				continue;
+			if (hashvalue == 0 ||
+				item->hashValue == hashvalue)
 			{
-				PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
-				ListCell   *lc3;
+				/* Invalidate the generic plan only */
+				plan->is_valid = false;
+				break;			/* out of invalItems scan */
+			}
+		}
+		if (!plan->is_valid)
+			break;				/* out of stmt_list scan */
+	}
+}
 
-				Assert(!IsA(plannedstmt, Query));
-				if (!IsA(plannedstmt, PlannedStmt))
-					continue;	/* Ignore utility statements */
-				foreach(lc3, plannedstmt->invalItems)
-				{
-					PlanInvalItem *item = (PlanInvalItem *) lfirst(lc3);
+/*
+ * PlanCacheStatCallback
+ *		Syscache inval callback function for STATRELATTINH cache
+ *
+ * New statistics don't make any plan invalid, but the MCV lists kept for
+ * classifying parameter values (see selectivity_class_key) must be fetched
+ * again.  Here we just mark them out of date; they may be in use right now.
+ */
+static void
+PlanCacheStatCallback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	CachedPlanSource *plansource;
+	int			i;
 
-					if (item->cacheId != cacheid)
-						continue;
-					if (hashvalue == 0 ||
-						item->hashValue == hashvalue)
-					{
-						/* Invalidate the generic plan only */
-						plansource->gplan->is_valid = false;
-						break;	/* out of invalItems scan */
-					}
-				}
-				if (!plansource->gplan->is_valid)
-					break;		/* out of stmt_list scan */
-			}
+	for (plansource = first_saved_plan; plansource; plansource = plansource->next_saved)
+	{
+		Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
+
+		for (i = 0; i < plansource->num_sel_params; i++)
+		{
+			PlanCacheSelParam *sp = &plansource->sel_params[i];
+
+			if (hashvalue == 0 || sp->stathash == hashvalue)
+				sp->mcvs_valid = false;
 		}
 	}
 }
@@ -1853,6 +2441,7 @@ PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue)
 static void
 PlanCacheSysCallback(Datum arg, int cacheid, uint32 hashvalue)
 {
+	SharedPlanCacheReset();
 	ResetPlanCache();
 }
 
@@ -0,0 +1,933 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.c
+ *	  Cluster-wide cache of generic plans for prepared statements.
+ *
+ * Every backend that prepares a statement normally parses, analyzes and
+ * plans it for itself, and keeps its generic plan in private memory (see
+ * plancache.c).  With many pooled connections running the same small set
+ * of statements, that means planning the same query over and over, which
+ * is especially painful right after a burst of reconnections.  When
+ * shared_plan_cache_size is set, plancache.c offers each generic plan it
+ * builds to this module, and looks here before planning a statement that
+ * another backend may already have planned.
+ *
+ * Plans are stored in a fixed-size area of the main shared memory segment
+ * in their nodeToString() representation, and read back with
+ * stringToNode() into the requesting backend's own CachedPlan, so executor
+ * code never sees shared memory.  The lookup key is the text form of the
+ * analyzed and rewritten query tree, together with the database, the
+ * current user, the cursor options, the effective search_path and the
+ * planner settings that most influence plan shape.  Two backends that would
+ * build the same query tree as the same user under the same settings thus
+ * get the same plan.
+ *
+ * Invalidation piggybacks on the sinval callbacks plancache.c already
+ * registers: each entry records the relations and PlanInvalItems its plan
+ * depends on, and whichever backend processes a matching invalidation
+ * message removes the entry.  Since every backend sees every message, this
+ * happens promptly no matter which backend runs the DDL.  A backend only
+ * consults this cache after acquiring its planner locks and therefore
+ * after absorbing pending invalidations, so it cannot pick up a plan
+ * invalidated by a committed change to a relation it uses.  To keep the
+ * per-message cost low we first test a small bitmap of all dependencies
+ * present in the cache.
+ *
+ * Storage is a pool of fixed-size blocks; each entry's key and plan string
+ * are stored consecutively in a chain of blocks.  When space runs out,
+ * entries are evicted using a clock sweep over usage counts, as in the
+ * buffer manager.  All of this is protected by SharedPlanCacheLock.
+ *
+ * Plans that depend on row security, that are only valid for the current
+ * transaction, or that contain foreign or custom scans (whose private
+ * data we cannot be sure to read back) are never shared.  Neither are plans
+ * that use temporary relations: the key doesn't always tell them apart,
+ * since a name inside an inlined SQL function can resolve to a different
+ * session's temporary table under the same search_path.
+ *
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedplancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_class.h"
+#include "lib/stringinfo.h"
+#include "miscadmin.h"
+#include "nodes/plannodes.h"
+#include "optimizer/cost.h"
+#include "optimizer/paths.h"
+#include "optimizer/planmain.h"
+#include "optimizer/prep.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/dynahash.h"
+#include "utils/sharedplancache.h"
+#include "utils/syscache.h"
+
+
+/* GUC parameter: size of the shared plan cache in kB, or 0 to disable */
+int			shared_plan_cache_size = 0;
+
+/* Size of a storage block, including its link word */
+#define SPC_BLOCK_SIZE		1024
+#define SPC_BLOCK_DATA		(SPC_BLOCK_SIZE - sizeof(int))
+
+/* We allocate one entry slot per this much cache space */
+#define SPC_BYTES_PER_ENTRY 16384
+
+/* Plans with more dependencies than this are not shared */
+#define SPC_MAX_DEPS		32
+
+/* Clock sweep usage count limit */
+#define SPC_MAX_USAGE		5
+
+/* cacheId used for relation dependencies */
+#define SPC_DEP_RELATION	(-1)
+
+/* Number of bits in the dependency filter */
+#define SPC_FILTER_BITS		65536
+#define SPC_FILTER_WORDS	(SPC_FILTER_BITS / 64)
+
+typedef struct SharedPlanBlock
+{
+	int			next;			/* next block of the same entry, or -1 */
+	char		data[SPC_BLOCK_DATA];
+} SharedPlanBlock;
+
+typedef struct SharedPlanDep
+{
+	int			cacheId;		/* syscache ID, or SPC_DEP_RELATION */
+	uint32		value;			/* hash value, or relation OID */
+} SharedPlanDep;
+
+typedef struct SharedPlanEntry
+{
+	int			next;			/* next entry in bucket or free list, or -1 */
+	bool		in_use;			/* does this slot hold a plan? */
+	int			usage_count;	/* for clock sweep */
+	uint32		hashvalue;		/* hash of key */
+	int			keylen;			/* length of key string */
+	int			planlen;		/* length of plan string */
+	int			firstblock;		/* first block holding key + plan */
+	int			ndeps;			/* number of valid entries in deps[] */
+	SharedPlanDep deps[SPC_MAX_DEPS];
+} SharedPlanEntry;
+
+typedef struct SharedPlanCacheControl
+{
+	int			nentries;		/* number of entry slots */
+	int			nbuckets;		/* number of hash buckets, a power of 2 */
+	int			nblocks;		/* number of storage blocks */
+	int			nused;			/* number of entries in use */
+	int			freeentry;		/* head of free entry list, or -1 */
+	int			freeblock;		/* head of free block list, or -1 */
+	int			nfreeblocks;	/* length of free block list */
+	int			clockhand;		/* next entry to consider for eviction */
+	uint64		depfilter[SPC_FILTER_WORDS];	/* dependencies maybe present */
+} SharedPlanCacheControl;
+
+/* Position within an entry's chain of blocks */
+typedef struct SpcCursor
+{
+	int			block;
+	int			offset;
+} SpcCursor;
+
+/* Pointers into shared memory, set up by SharedPlanCacheShmemInit */
+static SharedPlanCacheControl *SpcCtl = NULL;
+static int *SpcBuckets = NULL;
+static SharedPlanEntry *SpcEntries = NULL;
+static SharedPlanBlock *SpcBlocks = NULL;
+
+static void spc_compute_sizes(int *nentries, int *nbuckets, int *nblocks);
+static int	spc_find(const char *key, int keylen, uint32 hashvalue);
+static void spc_seek(SpcCursor *cursor, int firstblock, int pos);
+static void spc_advance(SpcCursor *cursor, int n);
+static void spc_copy_in(SpcCursor *cursor, const char *src, int len);
+static void spc_copy_out(SpcCursor *cursor, char *dst, int len);
+static bool spc_equal(SpcCursor *cursor, const char *src, int len);
+static int	spc_alloc_blocks(int nblocks);
+static bool spc_evict_one(void);
+static void spc_remove_entry(int idx);
+static bool spc_scan_deps(int cacheid, uint32 value, bool any_value,
+			  bool remove);
+static uint32 spc_filter_bit(int cacheid, uint32 value);
+static void spc_rebuild_filter(void);
+static void spc_invalidate(int cacheid, uint32 value, bool any_value);
+static bool spc_relation_is_temp(Oid relid);
+
+
+/*
+ * spc_compute_sizes
+ *		Work out the layout of the cache from shared_plan_cache_size
+ */
+static void
+spc_compute_sizes(int *nentries, int *nbuckets, int *nblocks)
+{
+	Size		total = (Size) shared_plan_cache_size * 1024;
+	Size		fixed;
+
+	*nentries = Max(total / SPC_BYTES_PER_ENTRY, 16);
+	*nbuckets = 1 << my_log2(*nentries);
+
+	fixed = MAXALIGN(sizeof(SharedPlanCacheControl)) +
+		MAXALIGN(*nbuckets * sizeof(int)) +
+		MAXALIGN(*nentries * sizeof(SharedPlanEntry));
+	if (total > fixed + 64 * sizeof(SharedPlanBlock))
+		*nblocks = (total - fixed) / sizeof(SharedPlanBlock);
+	else
+		*nblocks = 64;
+}
+
+/*
+ * SharedPlanCacheShmemSize --- report amount of shared memory space needed
+ */
+Size
+SharedPlanCacheShmemSize(void)
+{
+	int			nentries;
+	int			nbuckets;
+	int			nblocks;
+	Size		size;
+
+	if (!SharedPlanCacheEnabled())
+		return 0;
+
+	spc_compute_sizes(&nentries, &nbuckets, &nblocks);
+
+	size = MAXALIGN(sizeof(SharedPlanCacheControl));
+	size = add_size(size, MAXALIGN(mul_size(nbuckets, sizeof(int))));
+	size = add_size(size, MAXALIGN(mul_size(nentries, sizeof(SharedPlanEntry))));
+	size = add_size(size, mul_size(nblocks, sizeof(SharedPlanBlock)));
+
+	return size;
+}
+
+/*
+ * SharedPlanCacheShmemInit --- initialize this module's shared memory
+ */
+void
+SharedPlanCacheShmemInit(void)
+{
+	int			nentries;
+	int			nbuckets;
+	int			nblocks;
+	char	   *ptr;
+	bool		found;
+	int			i;
+
+	if (!SharedPlanCacheEnabled())
+		return;
+
+	spc_compute_sizes(&nentries, &nbuckets, &nblocks);
+
+	ptr = ShmemInitStruct("Shared Plan Cache",
+						  SharedPlanCacheShmemSize(),
+						  &found);
+
+	SpcCtl = (SharedPlanCacheControl *) ptr;
+	ptr += MAXALIGN(sizeof(SharedPlanCacheControl));
+	SpcBuckets = (int *) ptr;
+	ptr += MAXALIGN(nbuckets * sizeof(int));
+	SpcEntries = (SharedPlanEntry *) ptr;
+	ptr += MAXALIGN(nentries * sizeof(SharedPlanEntry));
+	SpcBlocks = (SharedPlanBlock *) ptr;
+
+	if (found)
+		return;
+
+	Assert(!IsUnderPostmaster);
+
+	MemSet(SpcCtl, 0, sizeof(SharedPlanCacheControl));
+	SpcCtl->nentries = nentries;
+	SpcCtl->nbuckets = nbuckets;
+	SpcCtl->nblocks = nblocks;
+
+	for (i = 0; i < nbuckets; i++)
+		SpcBuckets[i] = -1;
+
+	for (i = 0; i < nentries; i++)
+	{
+		SpcEntries[i].in_use = false;
+		SpcEntries[i].next = (i + 1 < nentries) ? i + 1 : -1;
+	}
+	SpcCtl->freeentry = 0;
+
+	for (i = 0; i < nblocks; i++)
+		SpcBlocks[i].next = (i + 1 < nblocks) ? i + 1 : -1;
+	SpcCtl->freeblock = 0;
+	SpcCtl->nfreeblocks = nblocks;
+}
+
+/*
+ * SharedPlanCacheKey
+ *		Build the lookup key for a list of analyzed-and-rewritten queries
+ *
+ * The querytree list must not yet have been scribbled on by the planner.
+ */
+char *
+SharedPlanCacheKey(List *querytree_list, int cursor_options)
+{
+	StringInfoData buf;
+
+	initStringInfo(&buf);
+
+	/*
+	 * The plan depends on the current user: the planner checks EXECUTE
+	 * permission on SQL functions before inlining them, and once a function
+	 * is inlined nothing checks it again at execution.  A plan built for one
+	 * role must therefore never be handed to another.
+	 */
+	appendStringInfo(&buf, "%u %u %d ", MyDatabaseId, GetUserId(),
+					 cursor_options);
+
+	/* planner settings that commonly differ between sessions */
+	appendStringInfo(&buf, "%.17g %.17g %.17g %.17g %.17g %d %.17g ",
+					 seq_page_cost, random_page_cost, cpu_tuple_cost,
+					 cpu_index_tuple_cost, cpu_operator_cost,
+					 effective_cache_size, cursor_tuple_fraction);
+	appendStringInfo(&buf, "%d%d%d%d%d%d%d%d%d%d%d%d %d %d %d %d %d %d %d %d ",
+					 enable_seqscan, enable_indexscan, enable_indexonlyscan,
+					 enable_bitmapscan, enable_tidscan, enable_sort,
+					 enable_hashagg, enable_nestloop, enable_material,
+					 enable_resultcache, enable_mergejoin, enable_hashjoin,
+					 constraint_exclusion, work_mem,
+					 from_collapse_limit, join_collapse_limit,
+					 enable_geqo, geqo_threshold,
+					 join_search_method, idp_join_budget);
+	appendStringInfo(&buf, "%d ", eager_aggregate);
+	appendStringInfo(&buf, "%d%d ",
+					 enable_self_join_removal, enable_fkey_join_removal);
+
+	/* the planner may look up names, e.g. when inlining SQL functions */
+	appendStringInfoString(&buf, nodeToString(fetch_search_path(false)));
+	appendStringInfoChar(&buf, ' ');
+
+	appendStringInfoString(&buf, nodeToString(querytree_list));
+
+	return buf.data;
+}
+
+/*
+ * SharedPlanCacheLookup
+ *		Fetch a copy of the plan stored under the given key
+ *
+ * Returns the statement list in the caller's memory context, or NIL if
+ * there is no such entry.
+ */
+List *
+SharedPlanCacheLookup(const char *key)
+{
+	int			keylen = strlen(key);
+	uint32		hashvalue;
+	char	   *planstr = NULL;
+	int			idx;
+	List	   *result;
+
+	if (!SharedPlanCacheEnabled())
+		return NIL;
+
+	hashvalue = DatumGetUInt32(hash_any((const unsigned char *) key, keylen));
+
+	LWLockAcquire(SharedPlanCacheLock, LW_SHARED);
+
+	idx = spc_find(key, keylen, hashvalue);
+	if (idx >= 0)
+	{
+		SharedPlanEntry *entry = &SpcEntries[idx];
+		SpcCursor	cursor;
+
+		planstr = palloc(entry->planlen + 1);
+		spc_seek(&cursor, entry->firstblock, entry->keylen);
+		spc_copy_out(&cursor, planstr, entry->planlen);
+		planstr[entry->planlen] = '\0';
+
+		/*
+		 * We don't hold the lock exclusively, so this may lose a concurrent
+		 * increment; that's harmless, as for buffer usage counts.
+		 */
+		if (entry->usage_count < SPC_MAX_USAGE)
+			entry->usage_count++;
+	}
+
+	LWLockRelease(SharedPlanCacheLock);
+
+	if (planstr == NULL)
+		return NIL;
+
+	result = (List *) stringToNode(planstr);
+	pfree(planstr);
+
+	return result;
+}
+
+/*
+ * SharedPlanCacheStore
+ *		Offer a freshly built generic plan to the shared cache
+ *
+ * Plans that can't be shared, or don't fit, are silently ignored.
+ */
+void
+SharedPlanCacheStore(const char *key, List *stmt_list)
+{
+	SharedPlanDep deps[SPC_MAX_DEPS];
+	int			ndeps = 0;
+	int			keylen;
+	int			planlen;
+	int			nblocks;
+	uint32		hashvalue;
+	char	   *planstr;
+	ListCell   *lc;
+	SharedPlanEntry *entry;
+	SpcCursor	cursor;
+	int			firstblock;
+	int			idx;
+	int			i;
+
+	if (!SharedPlanCacheEnabled())
+		return;
+
+	/* Check that the plan can be shared, and collect its dependencies */
+	foreach(lc, stmt_list)
+	{
+		PlannedStmt *stmt = (PlannedStmt *) lfirst(lc);
+		ListCell   *lc2;
+
+		if (!IsA(stmt, PlannedStmt) ||
+			stmt->utilityStmt != NULL ||
+			stmt->transientPlan ||
+			stmt->hasRowSecurity)
+			return;
+
+		foreach(lc2, stmt->rtable)
+		{
+			RangeTblEntry *rte = (RangeTblEntry *) lfirst(lc2);
+
+			if (rte->rtekind == RTE_RELATION &&
+				rte->relkind == RELKIND_FOREIGN_TABLE)
+				return;
+		}
+
+		foreach(lc2, stmt->relationOids)
+		{
+			/* this covers all the relations in the range table, too */
+			if (spc_relation_is_temp(lfirst_oid(lc2)))
+				return;
+
+			if (ndeps >= SPC_MAX_DEPS)
+				return;
+			deps[ndeps].cacheId = SPC_DEP_RELATION;
+			deps[ndeps].value = lfirst_oid(lc2);
+			ndeps++;
+		}
+
+		foreach(lc2, stmt->invalItems)
+		{
+			PlanInvalItem *item = (PlanInvalItem *) lfirst(lc2);
+
+			if (ndeps >= SPC_MAX_DEPS)
+				return;
+			deps[ndeps].cacheId = item->cacheId;
+			deps[ndeps].value = item->hashValue;
+			ndeps++;
+		}
+	}
+
+	planstr = nodeToString(stmt_list);
+
+	/* custom scan providers write their own private data; can't read it */
+	if (strstr(planstr, "{CUSTOMSCAN") != NULL)
+	{
+		pfree(planstr);
+		return;
+	}
+
+	keylen = strlen(key);
+	planlen = strlen(planstr);
+	nblocks = (keylen + planlen + SPC_BLOCK_DATA - 1) / SPC_BLOCK_DATA;
+	hashvalue = DatumGetUInt32(hash_any((const unsigned char *) key, keylen));
+
+	LWLockAcquire(SharedPlanCacheLock, LW_EXCLUSIVE);
+
+	/* Don't let one huge plan flush everything else */
+	if (nblocks > SpcCtl->nblocks / 4)
+		goto done;
+
+	/* Someone might have beaten us to it */
+	if (spc_find(key, keylen, hashvalue) >= 0)
+		goto done;
+
+	firstblock = spc_alloc_blocks(nblocks);
+	if (firstblock < 0)
+		goto done;
+
+	if (SpcCtl->freeentry < 0 && !spc_evict_one())
+	{
+		/* give back the blocks; can't happen unless nentries is tiny */
+		int			last = firstblock;
+
+		while (SpcBlocks[last].next >= 0)
+			last = SpcBlocks[last].next;
+		SpcBlocks[last].next = SpcCtl->freeblock;
+		SpcCtl->freeblock = firstblock;
+		SpcCtl->nfreeblocks += nblocks;
+		goto done;
+	}
+
+	idx = SpcCtl->freeentry;
+	entry = &SpcEntries[idx];
+	SpcCtl->freeentry = entry->next;
+
+	entry->in_use = true;
+	entry->usage_count = 1;
+	entry->hashvalue = hashvalue;
+	entry->keylen = keylen;
+	entry->planlen = planlen;
+	entry->firstblock = firstblock;
+	entry->ndeps = ndeps;
+	memcpy(entry->deps, deps, ndeps * sizeof(SharedPlanDep));
+
+	spc_seek(&cursor, firstblock, 0);
+	spc_copy_in(&cursor, key, keylen);
+	spc_copy_in(&cursor, planstr, planlen);
+
+	entry->next = SpcBuckets[hashvalue & (SpcCtl->nbuckets - 1)];
+	SpcBuckets[hashvalue & (SpcCtl->nbuckets - 1)] = idx;
+	SpcCtl->nused++;
+
+	for (i = 0; i < ndeps; i++)
+	{
+		uint32		bit = spc_filter_bit(deps[i].cacheId, deps[i].value);
+
+		SpcCtl->depfilter[bit / 64] |= UINT64CONST(1) << (bit % 64);
+	}
+
+done:
+	LWLockRelease(SharedPlanCacheLock);
+
+	pfree(planstr);
+}
+
+/*
+ * SharedPlanCacheInvalRelation
+ *		Remove all plans that depend on the given relation
+ */
+void
+SharedPlanCacheInvalRelation(Oid relid)
+{
+	if (!OidIsValid(relid))
+		SharedPlanCacheReset();
+	else
+		spc_invalidate(SPC_DEP_RELATION, relid, false);
+}
+
+/*
+ * SharedPlanCacheInvalSyscache
+ *		Remove all plans that depend on the given syscache entry, or on any
+ *		entry of that cache if hashvalue is 0
+ */
+void
+SharedPlanCacheInvalSyscache(int cacheid, uint32 hashvalue)
+{
+	spc_invalidate(cacheid, hashvalue, hashvalue == 0);
+}
+
+/*
+ * SharedPlanCacheReset
+ *		Remove all plans
+ */
+void
+SharedPlanCacheReset(void)
+{
+	int			nused;
+	int			i;
+
+	if (!SharedPlanCacheEnabled())
+		return;
+
+	LWLockAcquire(SharedPlanCacheLock, LW_SHARED);
+	nused = SpcCtl->nused;
+	LWLockRelease(SharedPlanCacheLock);
+
+	if (nused == 0)
+		return;
+
+	LWLockAcquire(SharedPlanCacheLock, LW_EXCLUSIVE);
+	for (i = 0; i < SpcCtl->nentries; i++)
+	{
+		if (SpcEntries[i].in_use)
+			spc_remove_entry(i);
+	}
+	MemSet(SpcCtl->depfilter, 0, sizeof(SpcCtl->depfilter));
+	LWLockRelease(SharedPlanCacheLock);
+}
+
+/*
+ * spc_invalidate
+ *		Common code for the invalidation entry points
+ *
+ * Most invalidation messages concern objects no cached plan depends on, so
+ * check under a shared lock first.
+ */
+static void
+spc_invalidate(int cacheid, uint32 value, bool any_value)
+{
+	bool		found = false;
+
+	if (!SharedPlanCacheEnabled())
+		return;
+
+	LWLockAcquire(SharedPlanCacheLock, LW_SHARED);
+	if (SpcCtl->nused > 0)
+	{
+		if (any_value)
+			found = spc_scan_deps(cacheid, value, true, false);
+		else
+		{
+			uint32		bit = spc_filter_bit(cacheid, value);
+
+			if (SpcCtl->depfilter[bit / 64] & (UINT64CONST(1) << (bit % 64)))
+				found = spc_scan_deps(cacheid, value, false, false);
+		}
+	}
+	LWLockRelease(SharedPlanCacheLock);
+
+	if (!found)
+		return;
+
+	LWLockAcquire(SharedPlanCacheLock, LW_EXCLUSIVE);
+	(void) spc_scan_deps(cacheid, value, any_value, true);
+	spc_rebuild_filter();
+	LWLockRelease(SharedPlanCacheLock);
+}
+
+/*
+ * spc_relation_is_temp
+ *		Is the given relation a temporary one?
+ *
+ * A plan's relationOids can include the OIDs of regclass constants, which
+ * needn't name an existing relation, so don't complain if it's missing.
+ */
+static bool
+spc_relation_is_temp(Oid relid)
+{
+	HeapTuple	tp;
+	bool		result = false;
+
+	tp = SearchSysCache1(RELOID, ObjectIdGetDatum(relid));
+	if (HeapTupleIsValid(tp))
+	{
+		result = (((Form_pg_class) GETSTRUCT(tp))->relpersistence ==
+				  RELPERSISTENCE_TEMP);
+		ReleaseSysCache(tp);
+	}
+	return result;
+}
+
+/*
+ * spc_scan_deps
+ *		Look for entries depending on the given object
+ *
+ * If remove is true, remove all of them (caller must hold the lock
+ * exclusively); else just report whether there are any.
+ */
+static bool
+spc_scan_deps(int cacheid, uint32 value, bool any_value, bool remove)
+{
+	bool		found = false;
+	int			i;
+	int			j;
+
+	for (i = 0; i < SpcCtl->nentries; i++)
+	{
+		SharedPlanEntry *entry = &SpcEntries[i];
+
+		if (!entry->in_use)
+			continue;
+
+		for (j = 0; j < entry->ndeps; j++)
+		{
+			if (entry->deps[j].cacheId == cacheid &&
+				(any_value || entry->deps[j].value == value))
+				break;
+		}
+		if (j < entry->ndeps)
+		{
+			if (!remove)
+				return true;
+			spc_remove_entry(i);
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+/*
+ * spc_filter_bit
+ *		Map a dependency to its bit in the dependency filter
+ */
+static uint32
+spc_filter_bit(int cacheid, uint32 value)
+{
+	return (value ^ ((uint32) (cacheid + 1) * 0x9E3779B9)) % SPC_FILTER_BITS;
+}
+
+/*
+ * spc_rebuild_filter
+ *		Recompute the dependency filter from the entries in use
+ *
+ * Bits are set as entries are added but never cleared individually, so we
+ * rebuild the filter whenever we've removed entries for invalidation.
+ */
+static void
+spc_rebuild_filter(void)
+{
+	int			i;
+	int			j;
+
+	MemSet(SpcCtl->depfilter, 0, sizeof(SpcCtl->depfilter));
+
+	for (i = 0; i < SpcCtl->nentries; i++)
+	{
+		SharedPlanEntry *entry = &SpcEntries[i];
+
+		if (!entry->in_use)
+			continue;
+
+		for (j = 0; j < entry->ndeps; j++)
+		{
+			uint32		bit = spc_filter_bit(entry->deps[j].cacheId,
+											 entry->deps[j].value);
+
+			SpcCtl->depfilter[bit / 64] |= UINT64CONST(1) << (bit % 64);
+		}
+	}
+}
+
+/*
+ * spc_find
+ *		Look up an entry by key; returns its index, or -1 if not found
+ */
+static int
+spc_find(const char *key, int keylen, uint32 hashvalue)
+{
+	int			idx;
+
+	for (idx = SpcBuckets[hashvalue & (SpcCtl->nbuckets - 1)];
+		 idx >= 0;
+		 idx = SpcEntries[idx].next)
+	{
+		SharedPlanEntry *entry = &SpcEntries[idx];
+		SpcCursor	cursor;
+
+		if (entry->hashvalue != hashvalue || entry->keylen != keylen)
+			continue;
+
+		spc_seek(&cursor, entry->firstblock, 0);
+		if (spc_equal(&cursor, key, keylen))
+			return idx;
+	}
+
+	return -1;
+}
+
+/*
+ * spc_seek
+ *		Position a cursor at the given byte offset of a block chain
+ */
+static void
+spc_seek(SpcCursor *cursor, int firstblock, int pos)
+{
+	cursor->block = firstblock;
+	while (pos >= SPC_BLOCK_DATA)
+	{
+		cursor->block = SpcBlocks[cursor->block].next;
+		pos -= SPC_BLOCK_DATA;
+	}
+	cursor->offset = pos;
+}
+
+/*
+ * spc_advance
+ *		Move a cursor forward by n bytes, which must not cross a block end
+ */
+static void
+spc_advance(SpcCursor *cursor, int n)
+{
+	cursor->offset += n;
+	if (cursor->offset == SPC_BLOCK_DATA)
+	{
+		cursor->block = SpcBlocks[cursor->block].next;
+		cursor->offset = 0;
+	}
+}
+
+/*
+ * spc_copy_in
+ *		Copy data into a block chain
+ */
+static void
+spc_copy_in(SpcCursor *cursor, const char *src, int len)
+{
+	while (len > 0)
+	{
+		int			n = Min(len, SPC_BLOCK_DATA - cursor->offset);
+
+		memcpy(SpcBlocks[cursor->block].data + cursor->offset, src, n);
+		spc_advance(cursor, n);
+		src += n;
+		len -= n;
+	}
+}
+
+/*
+ * spc_copy_out
+ *		Copy data out of a block chain
+ */
+static void
+spc_copy_out(SpcCursor *cursor, char *dst, int len)
+{
+	while (len > 0)
+	{
+		int			n = Min(len, SPC_BLOCK_DATA - cursor->offset);
+
+		memcpy(dst, SpcBlocks[cursor->block].data + cursor->offset, n);
+		spc_advance(cursor, n);
+		dst += n;
+		len -= n;
+	}
+}
+
+/*
+ * spc_equal
+ *		Compare data in a block chain with a local string
+ */
+static bool
+spc_equal(SpcCursor *cursor, const char *src, int len)
+{
+	while (len > 0)
+	{
+		int			n = Min(len, SPC_BLOCK_DATA - cursor->offset);
+
+		if (memcmp(SpcBlocks[cursor->block].data + cursor->offset, src, n) != 0)
+			return false;
+		spc_advance(cursor, n);
+		src += n;
+		len -= n;
+	}
+	return true;
+}
+
+/*
+ * spc_alloc_blocks
+ *		Allocate a chain of nblocks blocks, evicting entries if necessary
+ *
+ * Returns the first block of the chain, or -1 if there isn't enough space
+ * even with the cache emptied.
+ */
+static int
+spc_alloc_blocks(int nblocks)
+{
+	int			first;
+	int			last;
+	int			i;
+
+	Assert(nblocks > 0);
+
+	while (SpcCtl->nfreeblocks < nblocks)
+	{
+		if (!spc_evict_one())
+			return -1;
+	}
+
+	first = last = SpcCtl->freeblock;
+	for (i = 1; i < nblocks; i++)
+		last = SpcBlocks[last].next;
+	SpcCtl->freeblock = SpcBlocks[last].next;
+	SpcBlocks[last].next = -1;
+	SpcCtl->nfreeblocks -= nblocks;
+
+	return first;
+}
+
+/*
+ * spc_evict_one
+ *		Remove one entry chosen by clock sweep; false if there are none
+ */
+static bool
+spc_evict_one(void)
+{
+	int			tries;
+
+	if (SpcCtl->nused == 0)
+		return false;
+
+	/* each full sweep decrements all usage counts, so this terminates */
+	for (tries = 0; tries <= SpcCtl->nentries * (SPC_MAX_USAGE + 1); tries++)
+	{
+		int			idx = SpcCtl->clockhand;
+		SharedPlanEntry *entry = &SpcEntries[idx];
+
+		SpcCtl->clockhand = (idx + 1) % SpcCtl->nentries;
+
+		if (!entry->in_use)
+			continue;
+		if (entry->usage_count > 0)
+		{
+			entry->usage_count--;
+			continue;
+		}
+
+		spc_remove_entry(idx);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * spc_remove_entry
+ *		Unlink an entry from its hash chain and free its storage
+ */
+static void
+spc_remove_entry(int idx)
+{
+	SharedPlanEntry *entry = &SpcEntries[idx];
+	int		   *link;
+	int			last;
+	int			nblocks;
+
+	Assert(entry->in_use);
+
+	for (link = &SpcBuckets[entry->hashvalue & (SpcCtl->nbuckets - 1)];
+		 *link != idx;
+		 link = &SpcEntries[*link].next)
+		Assert(*link >= 0);
+	*link = entry->next;
+
+	last = entry->firstblock;
+	nblocks = 1;
+	while (SpcBlocks[last].next >= 0)
+	{
+		last = SpcBlocks[last].next;
+		nblocks++;
+	}
+	SpcBlocks[last].next = SpcCtl->freeblock;
+	SpcCtl->freeblock = entry->firstblock;
+	SpcCtl->nfreeblocks += nblocks;
+
+	entry->in_use = false;
+	entry->next = SpcCtl->freeentry;
+	SpcCtl->freeentry = idx;
+	SpcCtl->nused--;
+}
@@ -28,6 +28,8 @@
 
 #include "access/commit_ts.h"
 #include "access/gin.h"
+#include "access/nbtree.h"
+#include "access/toast_compression.h"
 #include "access/transam.h"
 #include "access/twophase.h"
 #include "access/xact.h"
@@ -37,6 +39,7 @@
 #include "commands/vacuum.h"
 #include "commands/variable.h"
 #include "commands/trigger.h"
+#include "executor/nodeNestloop.h"
 #include "funcapi.h"
 #include "libpq/auth.h"
 #include "libpq/be-fsstubs.h"
@@ -47,6 +50,7 @@
 #include "optimizer/geqo.h"
 #include "optimizer/paths.h"
 #include "optimizer/planmain.h"
+#include "optimizer/prep.h"
 #include "parser/parse_expr.h"
 #include "parser/parse_type.h"
 #include "parser/parser.h"
@@ -69,6 +73,7 @@
 #include "storage/pg_shmem.h"
 #include "storage/proc.h"
 #include "storage/predicate.h"
+#include "storage/smgr.h"
 #include "tcop/tcopprot.h"
 #include "tsearch/ts_cache.h"
 #include "utils/builtins.h"
@@ -80,6 +85,7 @@
 #include "utils/portal.h"
 #include "utils/ps_status.h"
 #include "utils/rls.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/tzparser.h"
 #include "utils/xml.h"
@@ -327,6 +333,12 @@ static const struct config_enum_entry backslash_quote_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry join_search_method_options[] = {
+	{"geqo", JOIN_SEARCH_GEQO, false},
+	{"idp", JOIN_SEARCH_IDP, false},
+	{NULL, 0, false}
+};
+
 /*
  * Although only "on", "off", and "partition" are documented, we
  * accept all the likely variants of "on" and "off".
@@ -396,6 +408,35 @@ static const struct config_enum_entry row_security_options[] = {
 	{NULL, 0, false}
 };
 
+/*
+ * Only the compression methods compiled into this server are offered.
+ */
+static const struct config_enum_entry default_toast_compression_options[] = {
+	{"pglz", TOAST_PGLZ_COMPRESSION_ID, false},
+#ifdef USE_LZ4
+	{"lz4", TOAST_LZ4_COMPRESSION_ID, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", TOAST_ZSTD_COMPRESSION_ID, false},
+#endif
+	{NULL, 0, false}
+};
+
+/*
+ * As above, lz4 is offered only if it was compiled in.
+ */
+static const struct config_enum_entry page_compression_options[] = {
+	{"off", PAGE_COMPRESSION_OFF, false},
+	{"pglz", PAGE_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", PAGE_COMPRESSION_LZ4, false},
+#endif
+	{"false", PAGE_COMPRESSION_OFF, true},
+	{"no", PAGE_COMPRESSION_OFF, true},
+	{"0", PAGE_COMPRESSION_OFF, true},
+	{NULL, 0, false}
+};
+
 /*
  * Options for enum values stored in other modules
  */
@@ -845,6 +886,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_resultcache", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of result caching for parameterized nested-loop inner sides."),
+			NULL
+		},
+		&enable_resultcache,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_nestloop", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of nested-loop join plans."),
@@ -872,6 +922,24 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_self_join_removal", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables removal of self-joins on unique keys."),
+			NULL
+		},
+		&enable_self_join_removal,
+		true,
+		NULL, NULL, NULL
+	},
+	{
+		{"enable_fkey_join_removal", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables removal of inner joins proven redundant by foreign keys."),
+			NULL
+		},
+		&enable_fkey_join_removal,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"geqo", PGC_USERSET, QUERY_TUNING_GEQO,
 			gettext_noop("Enables genetic query optimization."),
@@ -882,6 +950,27 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"eager_aggregate", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Enables the planner to aggregate a relation partially before joining it."),
+			gettext_noop("Queries that qualify are planned both with and without "
+						 "early aggregation, and the cheaper plan is kept.")
+		},
+		&eager_aggregate,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"plan_cache_selectivity", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Lets cached statements keep generic plans for different parameter selectivities."),
+			gettext_noop("Parameter values compared to table columns are classified "
+						 "by their frequency in the columns' statistics, and each class "
+						 "may get its own generic plan.")
+		},
+		&plan_cache_selectivity,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		/* Not for general use --- used by SET SESSION AUTHORIZATION */
 		{"is_superuser", PGC_INTERNAL, UNGROUPED,
@@ -1691,6 +1780,16 @@ static struct config_int ConfigureNamesInt[] =
 		12, 2, INT_MAX,
 		NULL, NULL, NULL
 	},
+	{
+		{"idp_join_budget", PGC_USERSET, QUERY_TUNING_GEQO,
+			gettext_noop("Sets the number of join relations each round of "
+						 "iterative dynamic programming join search may build."),
+			NULL
+		},
+		&idp_join_budget,
+		1000, 1, INT_MAX,
+		NULL, NULL, NULL
+	},
 	{
 		{"geqo_effort", PGC_USERSET, QUERY_TUNING_GEQO,
 			gettext_noop("GEQO: effort is used to set the default for other GEQO parameters."),
@@ -1884,6 +1983,17 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"shared_plan_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the amount of shared memory used to share generic plans of prepared statements between sessions."),
+			gettext_noop("Zero disables the shared plan cache."),
+			GUC_UNIT_KB
+		},
+		&shared_plan_cache_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	/*
 	 * We use the hopefully-safely-small value of 100kB as the compiled-in
 	 * default for max_stack_depth.  InitializeGUCOptions will increase it if
@@ -2091,6 +2201,28 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"vacuum_parallel_workers", PGC_USERSET, CLIENT_CONN_STATEMENT,
+			gettext_noop("Sets the maximum number of parallel workers used by VACUUM (PARALLEL) to vacuum indexes."),
+			NULL
+		},
+		&vacuum_parallel_workers,
+		2, 0, MAX_BACKENDS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"vacuum_max_blocks", PGC_USERSET, CLIENT_CONN_STATEMENT,
+			gettext_noop("Sets the maximum number of table blocks VACUUM processes before stopping."),
+			gettext_noop("The next VACUUM of the table continues where this one stopped. "
+						 "Zero means no limit."),
+			GUC_UNIT_BLOCKS
+		},
+		&vacuum_max_blocks,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"vacuum_defer_cleanup_age", PGC_SIGHUP, REPLICATION_MASTER,
 			gettext_noop("Number of transactions by which VACUUM and HOT cleanup should be deferred, if any."),
@@ -2359,6 +2491,18 @@ static struct config_int ConfigureNamesInt[] =
 		check_effective_io_concurrency, assign_effective_io_concurrency, NULL
 	},
 
+	{
+		{"index_prefetch_distance",
+			PGC_USERSET,
+			RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Number of index entries to look ahead for prefetching heap pages in index scans."),
+			gettext_noop("Zero disables prefetching in index scans.")
+		},
+		&index_prefetch_distance,
+		0, 0, MaxIndexTuplesPerPage,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"max_worker_processes",
 			PGC_POSTMASTER,
@@ -2555,6 +2699,27 @@ static struct config_int ConfigureNamesInt[] =
 		check_autovacuum_work_mem, NULL, NULL
 	},
 
+	{
+		{"autovacuum_parallel_workers", PGC_SIGHUP, AUTOVACUUM,
+			gettext_noop("Sets the maximum number of parallel workers each autovacuum worker uses to vacuum indexes."),
+			gettext_noop("A value of 0 makes autovacuum vacuum indexes serially.")
+		},
+		&autovacuum_parallel_workers,
+		0, 0, MAX_BACKENDS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"autovacuum_vacuum_max_blocks", PGC_SIGHUP, AUTOVACUUM,
+			gettext_noop("Sets the maximum number of table blocks each autovacuum run processes."),
+			gettext_noop("-1 means use vacuum_max_blocks."),
+			GUC_UNIT_BLOCKS
+		},
+		&autovacuum_vac_max_blocks,
+		-1, -1, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"tcp_keepalives_idle", PGC_USERSET, CLIENT_CONN_OTHER,
 			gettext_noop("Time between issuing TCP keepalives."),
@@ -2744,6 +2909,17 @@ static struct config_real ConfigureNamesReal[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"adaptive_nestloop_factor", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets how far the outer row count of a nested loop "
+						 "may exceed its estimate before the inner side is hashed."),
+			gettext_noop("Zero disables switching a nested loop to a hashed inner side.")
+		},
+		&adaptive_nestloop_factor,
+		100.0, 0.0, 1.0e10,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"geqo_selection_bias", PGC_USERSET, QUERY_TUNING_GEQO,
 			gettext_noop("GEQO: selective pressure within the population."),
@@ -3425,6 +3601,26 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"default_toast_compression", PGC_USERSET, CLIENT_CONN_STATEMENT,
+			gettext_noop("Sets the default compression method for compressible values."),
+			gettext_noop("Columns with a \"compression\" option use that method instead.")
+		},
+		&default_toast_compression,
+		TOAST_PGLZ_COMPRESSION_ID, default_toast_compression_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"page_compression", PGC_SIGHUP, RESOURCES_DISK,
+			gettext_noop("Compresses table and index pages as they are written to disk."),
+			gettext_noop("Pages already on disk stay readable whatever the setting.")
+		},
+		&page_compression,
+		PAGE_COMPRESSION_OFF, page_compression_options,
+		check_page_compression, NULL, NULL
+	},
+
 	{
 		{"client_min_messages", PGC_USERSET, LOGGING_WHEN,
 			gettext_noop("Sets the message levels that are sent to the client."),
@@ -3436,6 +3632,16 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"join_search_method", PGC_USERSET, QUERY_TUNING_GEQO,
+			gettext_noop("Selects the join search method used at or above geqo_threshold."),
+			NULL
+		},
+		&join_search_method,
+		JOIN_SEARCH_IDP, join_search_method_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"constraint_exclusion", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Enables the planner to use constraints to optimize queries."),
@@ -3332,6 +3332,10 @@ _printTocEntry(ArchiveHandle *AH, TocEntry *te, RestoreOptions *ropt, bool isDat
 		{
 			/* these object types don't have separate owners */
 		}
+		else if (strcmp(te->desc, "STATISTICS") == 0)
+		{
+			/* there is no ALTER STATISTICS to change the owner with */
+		}
 		else
 		{
 			write_msg(modulename, "WARNING: don't know how to set owner for object type %s\n",
@@ -77,7 +77,8 @@ typedef enum
 	DO_POST_DATA_BOUNDARY,
 	DO_EVENT_TRIGGER,
 	DO_REFRESH_MATVIEW,
-	DO_POLICY
+	DO_POLICY,
+	DO_STATSEXT
 } DumpableObjectType;
 
 typedef struct _dumpableObject
@@ -478,6 +479,14 @@ typedef struct _policyInfo
 	char	   *polwithcheck;
 } PolicyInfo;
 
+typedef struct _statsExtInfo
+{
+	DumpableObject dobj;
+	TableInfo  *statsexttable;	/* link to table the statistics are on */
+	char	   *rolname;		/* name of owner, or empty string */
+	char	   *statsextdef;	/* CREATE STATISTICS command */
+} StatsExtInfo;
+
 /* global decls */
 extern bool force_quotes;		/* double-quotes for identifiers flag */
 extern bool g_verbose;			/* verbose flag */
@@ -560,5 +569,7 @@ extern void getExtensionMembership(Archive *fout, DumpOptions *dopt, ExtensionIn
 					   int numExtensions);
 extern EventTriggerInfo *getEventTriggers(Archive *fout, int *numEventTriggers);
 extern void getPolicies(Archive *fout, TableInfo tblinfo[], int numTables);
+extern void getExtendedStatistics(Archive *fout, TableInfo tblinfo[],
+					  int numTables);
 
 #endif   /* PG_DUMP_H */
@@ -13,6 +13,10 @@
 
 #include <fcntl.h>
 
+#include "storage/bufpage.h"
+#include "storage/checksum.h"
+#include "storage/checksum_impl.h"
+
 
 
 #ifndef WIN32
@@ -123,6 +127,128 @@ linkAndUpdateFile(pageCnvCtx *pageConverter,
 }
 
 
+/*
+ * rewriteVisibilityMap()
+ *
+ * In versions of PostgreSQL prior to catversion 201507012, the visibility
+ * map kept only one bit per heap page, the all-visible bit.  The map now
+ * also tracks an all-frozen bit, so each old map page is expanded into two
+ * new ones.  The all-frozen bits all start out clear; the next vacuum of
+ * each table will set them where appropriate.
+ */
+const char *
+rewriteVisibilityMap(const char *fromfile, const char *tofile, bool force)
+{
+/* backend's visibilitymap.c uses the same layout */
+#define VM_MAPSIZE			(BLCKSZ - MAXALIGN(SizeOfPageHeaderData))
+#define VM_BITS_PER_HEAPBLOCK	2
+
+	int			src_fd;
+	int			dst_fd;
+	char	   *buffer;
+	char	   *new_vmbuf;
+	ssize_t		bytesRead;
+	BlockNumber new_blkno = 0;
+	const char *msg = NULL;
+
+	if ((src_fd = open(fromfile, O_RDONLY, 0)) < 0)
+		return getErrorText(errno);
+
+	if ((dst_fd = open(tofile, O_RDWR | O_CREAT | (force ? 0 : O_EXCL),
+					   S_IRUSR | S_IWUSR)) < 0)
+	{
+		msg = getErrorText(errno);
+		close(src_fd);
+		return msg;
+	}
+
+	/* pg_malloc'd memory is suitably aligned for page header access */
+	buffer = (char *) pg_malloc(BLCKSZ);
+	new_vmbuf = (char *) pg_malloc(BLCKSZ);
+
+	while ((bytesRead = read(src_fd, buffer, BLCKSZ)) == BLCKSZ)
+	{
+		char	   *old_cur;
+		char	   *old_break;
+		char	   *old_blkend;
+		PageHeaderData pageheader;
+
+		/* Save the page header data */
+		memcpy(&pageheader, buffer, SizeOfPageHeaderData);
+
+		/*
+		 * Each byte of the old map covers eight heap pages and expands to
+		 * two bytes of the new map, so half an old map page fills a whole
+		 * new one.
+		 */
+		old_cur = buffer + MAXALIGN(SizeOfPageHeaderData);
+		old_blkend = buffer + BLCKSZ;
+		old_break = old_cur + VM_MAPSIZE / 2;
+
+		while (old_cur < old_blkend)
+		{
+			char	   *new_cur;
+
+			memset(new_vmbuf, 0, BLCKSZ);
+			memcpy(new_vmbuf, &pageheader, SizeOfPageHeaderData);
+			new_cur = new_vmbuf + MAXALIGN(SizeOfPageHeaderData);
+
+			while (old_cur < old_break)
+			{
+				uint8		byte = *(uint8 *) old_cur;
+				uint16		new_vmbits = 0;
+				int			i;
+
+				/* Spread the all-visible bits; all-frozen bits stay clear */
+				for (i = 0; i < BITS_PER_BYTE; i++)
+				{
+					if (byte & (1 << i))
+						new_vmbits |= 1 << (VM_BITS_PER_HEAPBLOCK * i);
+				}
+
+				/* Copy new visibility map bytes, low byte first */
+				new_cur[0] = (char) (new_vmbits & 0xFF);
+				new_cur[1] = (char) (new_vmbits >> 8);
+
+				old_cur++;
+				new_cur += 2;
+			}
+
+			/* Set new checksum for the visibility map page, if enabled */
+			if (new_cluster.controldata.data_checksum_version != 0)
+				((PageHeader) new_vmbuf)->pd_checksum =
+					pg_checksum_page(new_vmbuf, new_blkno);
+
+			errno = 0;
+			if (write(dst_fd, new_vmbuf, BLCKSZ) != BLCKSZ)
+			{
+				/* if write didn't set errno, assume problem is no disk space */
+				if (errno == 0)
+					errno = ENOSPC;
+				msg = getErrorText(errno);
+				goto err;
+			}
+
+			old_break += VM_MAPSIZE / 2;
+			new_blkno++;
+		}
+	}
+
+	if (bytesRead < 0)
+		msg = getErrorText(errno);
+	else if (bytesRead != 0)
+		msg = "found partial page in source file";
+
+err:
+	pg_free(buffer);
+	pg_free(new_vmbuf);
+	close(dst_fd);
+	close(src_fd);
+
+	return msg;
+}
+
+
 #ifndef WIN32
 static int
 copy_file(const char *srcfile, const char *dstfile, bool force)
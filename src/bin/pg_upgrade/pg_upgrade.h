@@ -130,6 +130,12 @@ extern char *output_files[];
  */
 #define JSONB_FORMAT_CHANGE_CAT_VER 201409291
 
+/*
+ * The visibility map gained an all-frozen bit per heap page, so map pages
+ * written before this catalog version must be rewritten.
+ */
+#define VISIBILITY_MAP_FROZEN_BIT_CAT_VER 201507012
+
 /*
  * Each relation is represented by a relinfo structure.
  */
@@ -400,6 +406,8 @@ const char *copyAndUpdateFile(pageCnvCtx *pageConverter, const char *src,
 				  const char *dst, bool force);
 const char *linkAndUpdateFile(pageCnvCtx *pageConverter, const char *src,
 				  const char *dst);
+const char *rewriteVisibilityMap(const char *fromfile, const char *tofile,
+					 bool force);
 
 void		check_hard_link(void);
 FILE	   *fopen_priv(const char *path, const char *mode);
@@ -2096,6 +2096,65 @@ describeOneTableDetails(const char *schemaname,
 			PQclear(result);
 		}
 
+		/* print any extended statistics */
+		if (pset.sversion >= 90500)
+		{
+			printfPQExpBuffer(&buf,
+							  "SELECT n.nspname, stat.stxname,\n"
+							  "  (SELECT pg_catalog.string_agg(pg_catalog.quote_ident(a.attname), ', ')\n"
+							  "   FROM pg_catalog.unnest(stat.stxkeys) s(attnum)\n"
+							  "   JOIN pg_catalog.pg_attribute a\n"
+							  "     ON a.attrelid = stat.stxrelid AND a.attnum = s.attnum\n"
+							  "        AND NOT a.attisdropped) AS columns,\n"
+							  "  'd' = any(stat.stxkind) AS ndist_enabled,\n"
+							  "  'f' = any(stat.stxkind) AS deps_enabled,\n"
+							  "  'm' = any(stat.stxkind) AS mcv_enabled,\n"
+							  "  stat.stxrelid::pg_catalog.regclass\n"
+							  "FROM pg_catalog.pg_statistic_ext stat\n"
+							  "  JOIN pg_catalog.pg_namespace n ON n.oid = stat.stxnamespace\n"
+							  "WHERE stat.stxrelid = '%s' ORDER BY 1, 2;",
+							  oid);
+
+			result = PSQLexec(buf.data);
+			if (!result)
+				goto error_return;
+			else
+				tuples = PQntuples(result);
+
+			if (tuples > 0)
+			{
+				printTableAddFooter(&cont, _("Statistics objects:"));
+				for (i = 0; i < tuples; i++)
+				{
+					const char *sep = "";
+
+					printfPQExpBuffer(&buf, "    \"%s\".\"%s\" (",
+									  PQgetvalue(result, i, 0),
+									  PQgetvalue(result, i, 1));
+
+					if (strcmp(PQgetvalue(result, i, 3), "t") == 0)
+					{
+						appendPQExpBufferStr(&buf, "ndistinct");
+						sep = ", ";
+					}
+					if (strcmp(PQgetvalue(result, i, 4), "t") == 0)
+					{
+						appendPQExpBuffer(&buf, "%sdependencies", sep);
+						sep = ", ";
+					}
+					if (strcmp(PQgetvalue(result, i, 5), "t") == 0)
+						appendPQExpBuffer(&buf, "%smcv", sep);
+
+					appendPQExpBuffer(&buf, ") ON %s FROM %s",
+									  PQgetvalue(result, i, 2),
+									  PQgetvalue(result, i, 6));
+
+					printTableAddFooter(&cont, buf.data);
+				}
+			}
+			PQclear(result);
+		}
+
 		/* print rules */
 		if (tableinfo.hasrules && tableinfo.relkind != 'm')
 		{
@@ -936,7 +936,8 @@ extern void ginHeapTupleFastCollect(GinState *ginstate,
 						OffsetNumber attnum, Datum value, bool isNull,
 						ItemPointer ht_ctid);
 extern void ginInsertCleanup(GinState *ginstate,
-				 bool vac_delay, IndexBulkDeleteResult *stats);
+				 bool full_clean, IndexBulkDeleteResult *stats);
+extern Datum gin_clean_pending_list(PG_FUNCTION_ARGS);
 
 /* ginpostinglist.c */
 
@@ -0,0 +1,74 @@
+/*-------------------------------------------------------------------------
+ *
+ * toast_compression.h
+ *	  Compression methods for in-line compressed TOAST data.
+ *
+ * Copyright (c) 2015, PostgreSQL Global Development Group
+ *
+ * src/include/access/toast_compression.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef TOAST_COMPRESSION_H
+#define TOAST_COMPRESSION_H
+
+/*
+ * Compression method IDs.  These are stored on disk in the two high bits of
+ * the va_tcinfo word of every compressed datum, so they must never change.
+ * pglz must be 0, since that's what datums written before compression
+ * methods existed look like.
+ */
+typedef enum ToastCompressionId
+{
+	TOAST_PGLZ_COMPRESSION_ID = 0,
+	TOAST_LZ4_COMPRESSION_ID = 1,
+	TOAST_ZSTD_COMPRESSION_ID = 2
+} ToastCompressionId;
+
+#define TOAST_INVALID_COMPRESSION_ID	(-1)
+
+/*
+ * The information at the start of the compressed toast data.
+ */
+typedef struct toast_compress_header
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	uint32		tcinfo;			/* raw size and compression method */
+} toast_compress_header;
+
+/*
+ * Utilities for manipulation of header information for compressed
+ * toast entries.
+ */
+#define TOAST_COMPRESS_HDRSZ		((int32) sizeof(toast_compress_header))
+#define TOAST_COMPRESS_RAWSIZE(ptr) \
+	(((toast_compress_header *) (ptr))->tcinfo & VARLENA_RAWSIZE_MASK)
+#define TOAST_COMPRESS_METHOD(ptr) \
+	(((toast_compress_header *) (ptr))->tcinfo >> VARLENA_RAWSIZE_BITS)
+#define TOAST_COMPRESS_RAWDATA(ptr) \
+	(((char *) (ptr)) + TOAST_COMPRESS_HDRSZ)
+#define TOAST_COMPRESS_SET_SIZE_AND_METHOD(ptr, len, cmethod) \
+	do { \
+		Assert((len) > 0 && (len) <= VARLENA_RAWSIZE_MASK); \
+		((toast_compress_header *) (ptr))->tcinfo = \
+			((uint32) (len)) | ((uint32) (cmethod) << VARLENA_RAWSIZE_BITS); \
+	} while (0)
+
+/* GUC variable */
+extern int	default_toast_compression;
+
+/* per-method compression and decompression routines */
+extern struct varlena *pglz_compress_datum(const struct varlena * value);
+extern struct varlena *pglz_decompress_datum(const struct varlena * value);
+extern struct varlena *lz4_compress_datum(const struct varlena * value);
+extern struct varlena *lz4_decompress_datum(const struct varlena * value);
+extern struct varlena *lz4_decompress_datum_slice(const struct varlena * value,
+						   int32 slicelength);
+extern struct varlena *zstd_compress_datum(const struct varlena * value);
+extern struct varlena *zstd_decompress_datum(const struct varlena * value);
+
+extern int	CompressionNameToMethod(const char *compression);
+extern const char *GetCompressionMethodName(int cmethod);
+extern void validateCompressionOption(char *value);
+
+#endif   /* TOAST_COMPRESSION_H */
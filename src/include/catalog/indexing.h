@@ -321,6 +321,13 @@ DECLARE_UNIQUE_INDEX(pg_tablesample_method_name_index, 3331, on pg_tablesample_m
 DECLARE_UNIQUE_INDEX(pg_tablesample_method_oid_index, 3332, on pg_tablesample_method using btree(oid oid_ops));
 #define TableSampleMethodOidIndexId  3332
 
+DECLARE_UNIQUE_INDEX(pg_statistic_ext_oid_index, 3380, on pg_statistic_ext using btree(oid oid_ops));
+#define StatisticExtOidIndexId				3380
+DECLARE_UNIQUE_INDEX(pg_statistic_ext_name_index, 3379, on pg_statistic_ext using btree(stxname name_ops, stxnamespace oid_ops));
+#define StatisticExtNameIndexId				3379
+DECLARE_INDEX(pg_statistic_ext_relid_index, 3378, on pg_statistic_ext using btree(stxrelid oid_ops));
+#define StatisticExtRelidIndexId			3378
+
 /* last step of initialization script: build the indexes declared above */
 BUILD_INDICES
 
@@ -0,0 +1,73 @@
+/*-------------------------------------------------------------------------
+ *
+ * partition.h
+ *	  Partition bounds derived from the CHECK constraints of inheritance
+ *	  children, for fast partition pruning.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/catalog/partition.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "fmgr.h"
+#include "nodes/primnodes.h"
+#include "utils/relcache.h"
+
+/*
+ * One range of partition key values that a child may contain.  A child
+ * bounded by a list of values has one single-value range per value.
+ */
+typedef struct PartitionRange
+{
+	Datum		lo;				/* lower bound, unless lo_inf */
+	Datum		hi;				/* upper bound, unless hi_inf */
+	bool		lo_inf;			/* no lower bound */
+	bool		hi_inf;			/* no upper bound */
+	bool		lo_incl;		/* lower bound is inclusive */
+	bool		hi_incl;		/* upper bound is inclusive */
+	int			child;			/* index into PartitionBoundInfo.children */
+} PartitionRange;
+
+/*
+ * The partition bounds of an inheritance parent, as cached in its relcache
+ * entry.
+ *
+ * Children whose CHECK constraints restrict the partition key appear in
+ * children[]; their ranges, sorted and non-overlapping, in ranges[], so
+ * that the children that may hold a given key value can be found by binary
+ * search.  Children whose constraints say nothing about the key aren't
+ * listed, and can never be pruned.  Since a range says nothing about NULL
+ * keys, pruning is valid only for strict conditions on the key.
+ */
+typedef struct PartitionBoundInfo
+{
+	AttrNumber	key;			/* the parent's partition key column */
+	Oid			keytype;		/* input type of the key's btree opclass */
+	Oid			keycoll;		/* collation of the key column */
+	Oid			opfamily;		/* btree opfamily the bounds are in */
+	FmgrInfo	cmpfn;			/* its comparison function for keytype */
+	int16		typlen;
+	bool		typbyval;
+	int			nchildren;
+	Oid		   *children;		/* OIDs of bounded children, in OID order */
+	int			nranges;
+	PartitionRange *ranges;		/* ranges of all bounded children */
+} PartitionBoundInfo;
+
+extern PartitionBoundInfo *RelationGetPartitionBounds(Relation rel);
+extern void CacheInvalidatePartitionBounds(Oid relid);
+
+extern bool partition_match_clause(PartitionBoundInfo *bounds, Index varno,
+					   Expr *clause, int *strategy, Expr **value,
+					   bool *is_array);
+extern bool *partition_prune(PartitionBoundInfo *bounds, int nconds,
+				const int *strategies, const Datum *values,
+				const bool *isnulls);
+extern int	partition_child_index(PartitionBoundInfo *bounds, Oid childOid);
+
+#endif   /* PARTITION_H */
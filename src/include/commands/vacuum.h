@@ -145,6 +145,10 @@ typedef struct VacuumParams
 	int			log_min_duration;		/* minimum execution threshold in ms
 										 * at which  verbose logs are
 										 * activated, -1 to use default */
+	int			nworkers;		/* max parallel workers for index vacuuming,
+								 * 0 to vacuum indexes serially */
+	int			max_blocks;		/* max heap blocks to scan in one go, 0 for
+								 * no limit */
 } VacuumParams;
 
 /* GUC parameters */
@@ -154,6 +158,8 @@ extern int	vacuum_freeze_min_age;
 extern int	vacuum_freeze_table_age;
 extern int	vacuum_multixact_freeze_min_age;
 extern int	vacuum_multixact_freeze_table_age;
+extern int	vacuum_parallel_workers;
+extern int	vacuum_max_blocks;
 
 
 /* in commands/vacuum.c */
@@ -17,6 +17,7 @@
 #include "access/genam.h"
 #include "access/heapam.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -33,7 +34,9 @@
  *		entries for a particular index.  Used for both index_build and
  *		retail creation of index entries.
  *
- *		NumIndexAttrs		number of columns in this index
+ *		NumIndexAttrs		total number of columns in this index
+ *		NumIndexKeyAttrs	number of key columns in index; the remaining
+ *							columns are non-key "included" columns
  *		KeyAttrNumbers		underlying-rel attribute numbers used as keys
  *							(zeroes indicate expressions)
  *		Expressions			expr trees for expression entries, or NIL if none
@@ -58,7 +61,8 @@
 typedef struct IndexInfo
 {
 	NodeTag		type;
-	int			ii_NumIndexAttrs;
+	int			ii_NumIndexAttrs;	/* total number of columns in index */
+	int			ii_NumIndexKeyAttrs;	/* number of key columns in index */
 	AttrNumber	ii_KeyAttrNumbers[INDEX_MAX_KEYS];
 	List	   *ii_Expressions; /* list of Expr */
 	List	   *ii_ExpressionsState;	/* list of ExprState */
@@ -1143,6 +1147,11 @@ typedef struct ModifyTableState
  *
  *		nplans			how many plans are in the array
  *		whichplan		which plan is being executed (0 .. n-1)
+ *		nremoved		how many subplans partition pruning removed at startup
+ *		prune_exprs		ExprStates of the plan's part_exprs
+ *		prune_params	PARAM_EXEC params used in them
+ *		prune_pending	must we redo pruning before the next scan?
+ *		valid			which subplans to scan, or NULL for all of them
  * ----------------
  */
 typedef struct AppendState
@@ -1151,6 +1160,11 @@ typedef struct AppendState
 	PlanState **appendplans;	/* array of PlanStates for my inputs */
 	int			as_nplans;
 	int			as_whichplan;
+	int			as_nremoved;
+	List	   *as_prune_exprs;
+	Bitmapset  *as_prune_params;
+	bool		as_prune_pending;
+	bool	   *as_valid;
 } AppendState;
 
 /* ----------------
@@ -1644,14 +1658,61 @@ typedef struct JoinState
  *		NeedNewOuter	   true if need new outer tuple on next call
  *		MatchedOuter	   true if found a join match for current outer tuple
  *		NullInnerTupleSlot prepared null tuple for left outer joins
- * ----------------
- */
+ *
+ *		The remaining fields support switching to a hashed inner side when
+ *		the outer relation turns out to be much larger than estimated:
+ *
+ *		OuterHashKeys	   the outer-side hash keys (ExprStates)
+ *		InnerHashKeys	   the inner-side hash keys (ExprStates)
+ *		OuterHashFunctions lookup data for outer-side hash functions
+ *		InnerHashFunctions lookup data for inner-side hash functions
+ *		OuterRows		   outer tuples fetched since the last rescan
+ *		SwitchThreshold    switch after this many outer tuples, or 0
+ *		HashStatus		   whether the inner side is currently hashed
+ *		HashContext		   memory context holding the hash table
+ *		HashBuckets		   bucket array of the hash table
+ *		NumBuckets		   size of bucket array (always a power of 2)
+ *		CurEntry		   next entry to examine for current outer tuple
+ *		CurHashValue	   hash value of current outer tuple
+ *		HashTupleSlot	   slot used to return hashed inner tuples
+ *		SwitchedAt		   outer rows seen at first switch, for EXPLAIN
+ *		HashedRows		   inner rows loaded at first switch, for EXPLAIN
+ *		HashSpace		   memory used at first switch, for EXPLAIN
+ *		HashAbandoned	   first switch exceeded work_mem, for EXPLAIN
+ * ----------------
+ */
+typedef enum NestLoopHashStatus
+{
+	NL_HASH_NONE,				/* inner side is rescanned as usual */
+	NL_HASH_ACTIVE,				/* inner side is hashed */
+	NL_HASH_FAILED				/* hashing was tried, but overran work_mem */
+} NestLoopHashStatus;
+
+typedef struct NestLoopHashEntryData *NestLoopHashEntry;
+
 typedef struct NestLoopState
 {
 	JoinState	js;				/* its first field is NodeTag */
 	bool		nl_NeedNewOuter;
 	bool		nl_MatchedOuter;
 	TupleTableSlot *nl_NullInnerTupleSlot;
+	List	   *nl_OuterHashKeys;
+	List	   *nl_InnerHashKeys;
+	FmgrInfo   *nl_OuterHashFunctions;
+	FmgrInfo   *nl_InnerHashFunctions;
+	double		nl_OuterRows;
+	double		nl_SwitchThreshold;
+	NestLoopHashStatus nl_HashStatus;
+	MemoryContext nl_HashContext;
+	NestLoopHashEntry *nl_HashBuckets;
+	int			nl_NumBuckets;
+	NestLoopHashEntry nl_CurEntry;
+	uint32		nl_CurHashValue;
+	TupleTableSlot *nl_HashTupleSlot;
+	double		nl_SwitchedAt;
+	double		nl_HashedRows;
+	Size		nl_HashSpace;
+	bool		nl_HashAbandoned;
 } NestLoopState;
 
 /* ----------------
@@ -1775,6 +1836,54 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+/* ----------------
+ *	 ResultCacheState information
+ *
+ *		rc_status		what the next ExecResultCache call should do
+ *		rc_Buckets		hash table of cache entries, keyed by the values of
+ *						the key expressions
+ *		rc_LRUList		all cache entries, least recently used first
+ *		rc_CurEntry		entry being read or filled by the current scan
+ *		rc_MemUsed		memory currently used by cache entries
+ *
+ *		The remaining fields are statistics for EXPLAIN ANALYZE.
+ * ----------------
+ */
+typedef struct ResultCacheEntryData *ResultCacheEntry;
+typedef struct ResultCacheTupleData *ResultCacheTuple;
+
+typedef struct ResultCacheState
+{
+	PlanState	ps;				/* its first field is NodeTag */
+	int			rc_status;		/* RC_* value, see nodeResultCache.c */
+	int			rc_NumKeys;		/* number of cache keys */
+	List	   *rc_KeyExprs;	/* ExprStates of cache key expressions */
+	FmgrInfo   *rc_HashFunctions;	/* per-key hash functions */
+	FmgrInfo   *rc_EqFunctions; /* per-key equality functions */
+	Oid		   *rc_Collations;	/* per-key collations */
+	int16	   *rc_KeyTypLen;	/* per-key type lengths, for copying */
+	bool	   *rc_KeyTypByVal;
+	Datum	   *rc_ProbeValues; /* key values of the current scan */
+	bool	   *rc_ProbeNulls;
+	Bitmapset  *rc_KeyParamIds; /* PARAM_EXEC params used by the keys */
+	bool		rc_SingleRow;	/* entries are complete after one row? */
+	MemoryContext rc_TableContext;	/* holds cache entries and tuples */
+	ResultCacheEntry *rc_Buckets;
+	int			rc_NumBuckets;
+	int			rc_NumEntries;
+	dlist_head	rc_LRUList;
+	ResultCacheEntry rc_CurEntry;
+	ResultCacheTuple rc_CurTuple;	/* last tuple returned from rc_CurEntry */
+	Size		rc_MemUsed;
+	Size		rc_MemLimit;
+	/* statistics */
+	long		rc_Hits;
+	long		rc_Misses;
+	long		rc_Evictions;
+	long		rc_Overflows;
+	Size		rc_MemPeak;
+} ResultCacheState;
+
 /* ----------------
  *	 SortState information
  * ----------------
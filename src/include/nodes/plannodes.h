@@ -49,6 +49,8 @@ typedef struct PlannedStmt
 
 	bool		transientPlan;	/* redo plan when TransactionXmin changes? */
 
+	bool		dependsOnFKeys; /* redo plan while RI checks are pending? */
+
 	struct Plan *planTree;		/* tree of Plan nodes */
 
 	List	   *rtable;			/* list of RangeTblEntry nodes */
@@ -193,12 +195,23 @@ typedef struct ModifyTable
 /* ----------------
  *	 Append node -
  *		Generate the concatenation of the results of sub-plans.
+ *
+ * When appending the children of an inheritance parent with partition
+ * bounds, and some conditions on the partition key compare it with values
+ * that are only known at execution time, part_relid is the parent's OID and
+ * the remaining fields allow the executor to skip subplans for children
+ * that can't contain matching rows (see nodeAppend.c).  Otherwise
+ * part_relid is InvalidOid and the other fields are NIL.
  * ----------------
  */
 typedef struct Append
 {
 	Plan		plan;
 	List	   *appendplans;
+	Oid			part_relid;		/* inheritance parent, or InvalidOid */
+	List	   *part_strategies;	/* integer list of btree strategies */
+	List	   *part_exprs;		/* values the key is compared with */
+	List	   *part_child_oids;	/* OID of each appendplan's relation */
 } Append;
 
 /* ----------------
@@ -597,12 +610,18 @@ typedef struct Join
  * Vars, but perhaps someday that'd be worth relaxing.  (Note: during plan
  * creation, the paramval can actually be a PlaceHolderVar expression; but it
  * must be a Var with varno OUTER_VAR by the time it gets to the executor.)
+ *
+ * If there are no nestParams, hashclauses lists the hashable join clauses
+ * (a subset of joinqual), with the outer-side expression on the left.  The
+ * executor uses them to switch to hashing the inner relation if the outer
+ * relation turns out to be much larger than the planner estimated.
  * ----------------
  */
 typedef struct NestLoop
 {
 	Join		join;
 	List	   *nestParams;		/* list of NestLoopParam nodes */
+	List	   *hashclauses;	/* hashable join clauses, or NIL */
 } NestLoop;
 
 typedef struct NestLoopParam
@@ -653,6 +672,27 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		result cache node
+ *
+ * Caches the rows returned by its subplan for each distinct set of values
+ * of param_exprs, which are evaluated at each rescan.  This is used on the
+ * inner side of a parameterized nestloop whose outer side repeats join key
+ * values.  If singlerow is true, the caller will only ever ask for the first
+ * row of each scan, so a cache entry is complete after one row.
+ * ----------------
+ */
+typedef struct ResultCache
+{
+	Plan		plan;
+	int			numKeys;		/* number of cache key expressions */
+	Oid		   *hashOperators;	/* hashable equality operators for keys */
+	Oid		   *collations;		/* collations for keys */
+	List	   *param_exprs;	/* cache key expressions */
+	bool		singlerow;		/* entries are complete after one row? */
+	uint32		est_entries;	/* planner's estimate of distinct keys */
+} ResultCache;
+
 /* ----------------
  *		sort node
  * ----------------
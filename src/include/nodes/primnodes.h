@@ -250,6 +250,13 @@ typedef struct Param
  * DISTINCT is not supported in this case, so aggdistinct will be NIL.
  * The direct arguments appear in aggdirectargs (as a list of plain
  * expressions, not TargetEntry nodes).
+ *
+ * The parser always produces aggpartial = aggcombine = false.  The planner
+ * may split a normal aggregate into two stages (see prepagg.c): a partial
+ * stage, whose aggtype is the transition type and which returns the state
+ * value instead of the final result, and a combine stage, whose args list
+ * holds a single TargetEntry yielding such states, which are merged using
+ * the aggregate's combine function before the final function is applied.
  */
 typedef struct Aggref
 {
@@ -266,6 +273,10 @@ typedef struct Aggref
 	bool		aggstar;		/* TRUE if argument list was really '*' */
 	bool		aggvariadic;	/* true if variadic arguments have been
 								 * combined into an array last argument */
+	bool		aggpartial;		/* return the transition state, without
+								 * applying the final function */
+	bool		aggcombine;		/* args is a single transition state, to be
+								 * merged with the combine function */
 	char		aggkind;		/* aggregate kind (see pg_aggregate.h) */
 	Index		agglevelsup;	/* > 0 if agg belongs to outer query */
 	int			location;		/* token location, or -1 if unknown */
@@ -101,6 +101,8 @@ typedef struct PlannerGlobal
 
 	bool		transientPlan;	/* redo plan when TransactionXmin changes? */
 
+	bool		dependsOnFKeys; /* join removed by trusting a foreign key? */
+
 	bool		hasRowSecurity; /* row security applied? */
 } PlannerGlobal;
 
@@ -363,6 +365,11 @@ typedef struct PlannerInfo
  *		lateral_referencers - relids of rels that reference this one laterally
  *		indexlist - list of IndexOptInfo nodes for relation's indexes
  *					(always NIL if it's not a table)
+ *		statlist - list of StatisticExtInfo nodes for the relation's
+ *				   extended statistics (always NIL if it's not a table)
+ *		fkeylist - list of ForeignKeyOptInfo nodes for the relation's
+ *				   enforced foreign key constraints (always NIL if it's not
+ *				   a table)
  *		pages - number of disk pages in relation (zero if not a table)
  *		tuples - number of tuples in relation (not considering restrictions)
  *		allvisfrac - fraction of disk pages that are marked all-visible
@@ -461,6 +468,8 @@ typedef struct RelOptInfo
 	Relids		lateral_relids; /* minimum parameterization of rel */
 	Relids		lateral_referencers;	/* rels that reference me laterally */
 	List	   *indexlist;		/* list of IndexOptInfo */
+	List	   *statlist;		/* list of StatisticExtInfo */
+	List	   *fkeylist;		/* list of ForeignKeyOptInfo */
 	BlockNumber pages;			/* size estimates derived from pg_class */
 	double		tuples;
 	double		allvisfrac;
@@ -489,7 +498,9 @@ typedef struct RelOptInfo
  *		Per-index information for planning/optimization
  *
  *		indexkeys[], indexcollations[], opfamily[], and opcintype[]
- *		each have ncolumns entries.
+ *		each have ncolumns entries.  Only the first nkeycolumns of them are
+ *		key columns; any remaining columns are non-key "included" columns,
+ *		which have no opfamily and can only be used by index-only scans.
  *
  *		sortopfamily[], reverse_sort[], and nulls_first[] likewise have
  *		ncolumns entries, if the index is ordered; but if it is unordered,
@@ -525,6 +536,7 @@ typedef struct IndexOptInfo
 
 	/* index descriptor information */
 	int			ncolumns;		/* number of columns in index */
+	int			nkeycolumns;	/* number of key columns in index */
 	int		   *indexkeys;		/* column numbers of index's keys, or 0 */
 	Oid		   *indexcollations;	/* OIDs of collations of index columns */
 	Oid		   *opfamily;		/* OIDs of operator families for columns */
@@ -555,6 +567,45 @@ typedef struct IndexOptInfo
 	bool		amhasgetbitmap; /* does AM have amgetbitmap interface? */
 } IndexOptInfo;
 
+/*
+ * StatisticExtInfo
+ *		Information about extended statistics for planning/optimization
+ *
+ * Each pg_statistic_ext row is represented by one or more nodes of this
+ * type, or even zero if ANALYZE has not computed them.
+ */
+typedef struct StatisticExtInfo
+{
+	NodeTag		type;
+
+	Oid			statOid;		/* OID of the statistics row */
+	RelOptInfo *rel;			/* back-link to statistic's table */
+	char		kind;			/* statistic kind of this entry */
+	Bitmapset  *keys;			/* attnums of the columns covered */
+} StatisticExtInfo;
+
+/*
+ * ForeignKeyOptInfo
+ *		Information about a foreign key constraint, for join removal
+ *
+ * Only validated, non-deferrable constraints are represented, since only
+ * those guarantee that every referencing row with no null key columns has
+ * a match in the referenced table at all times during query execution.
+ * The constraint's table is the RelOptInfo whose fkeylist contains this
+ * node; confrelid identifies the referenced table.
+ */
+typedef struct ForeignKeyOptInfo
+{
+	NodeTag		type;
+
+	Oid			conoid;			/* OID of the pg_constraint row */
+	Oid			confrelid;		/* OID of the referenced table */
+	int			nkeys;			/* number of columns in the foreign key */
+	AttrNumber	conkey[INDEX_MAX_KEYS];		/* cols in referencing table */
+	AttrNumber	confkey[INDEX_MAX_KEYS];	/* cols in referenced table */
+	Oid			conpfeqop[INDEX_MAX_KEYS];	/* PK = FK equality operators */
+} ForeignKeyOptInfo;
+
 
 /*
  * EquivalenceClasses
@@ -1004,6 +1055,25 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * ResultCachePath represents a ResultCache plan node, i.e., a cache of the
+ * output of a parameterized subpath for each distinct set of parameter
+ * values.  param_exprs are the outer-side expressions the subpath's
+ * parameterization depends on, and hash_operators their equality operators.
+ * calls is the expected number of rescans, which cost_rescan() uses to
+ * estimate the cache hit ratio.
+ */
+typedef struct ResultCachePath
+{
+	Path		path;
+	Path	   *subpath;
+	List	   *hash_operators; /* equality operators of cache keys */
+	List	   *param_exprs;	/* cache key expressions */
+	bool		singlerow;		/* entries are complete after one row? */
+	double		calls;			/* expected number of rescans */
+	uint32		est_entries;	/* estimated number of distinct keys */
+} ResultCachePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
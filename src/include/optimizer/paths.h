@@ -22,6 +22,15 @@
  */
 extern bool enable_geqo;
 extern int	geqo_threshold;
+extern int	join_search_method;
+extern int	idp_join_budget;
+
+/* Possible values for join_search_method */
+typedef enum
+{
+	JOIN_SEARCH_GEQO,			/* genetic optimizer, see optimizer/geqo */
+	JOIN_SEARCH_IDP				/* iterative dynamic programming */
+} JoinSearchMethod;
 
 /* Hook for plugins to get control in set_rel_pathlist() */
 typedef void (*set_rel_pathlist_hook_type) (PlannerInfo *root,
@@ -47,6 +56,8 @@ extern PGDLLIMPORT join_search_hook_type join_search_hook;
 
 
 extern RelOptInfo *make_one_rel(PlannerInfo *root, List *joinlist);
+extern RelOptInfo *idp_join_search(PlannerInfo *root, int levels_needed,
+				List *initial_rels);
 extern RelOptInfo *standard_join_search(PlannerInfo *root, int levels_needed,
 					 List *initial_rels);
 
@@ -14,6 +14,7 @@
 #ifndef PLANCAT_H
 #define PLANCAT_H
 
+#include "catalog/partition.h"
 #include "nodes/relation.h"
 #include "utils/relcache.h"
 
@@ -28,6 +29,8 @@ extern PGDLLIMPORT get_relation_info_hook_type get_relation_info_hook;
 extern void get_relation_info(PlannerInfo *root, Oid relationObjectId,
 				  bool inhparent, RelOptInfo *rel);
 
+extern void get_relation_attrs(Oid relationObjectId, RelOptInfo *rel);
+
 extern List *infer_arbiter_indexes(PlannerInfo *root);
 
 extern void estimate_rel_size(Relation rel, int32 *attr_widths,
@@ -38,10 +41,16 @@ extern int32 get_relation_data_width(Oid relid, int32 *attr_widths);
 extern bool relation_excluded_by_constraints(PlannerInfo *root,
 								 RelOptInfo *rel, RangeTblEntry *rte);
 
+extern bool *prune_inheritance_children(PartitionBoundInfo *bounds,
+						   Index varno, List *clauses);
+
 extern List *build_physical_tlist(PlannerInfo *root, RelOptInfo *rel);
 
 extern bool has_unique_index(RelOptInfo *rel, AttrNumber attno);
 
+extern bool has_unique_index_on_columns(Oid relid, List *colnos,
+							List *opnos);
+
 extern Selectivity restriction_selectivity(PlannerInfo *root,
 						Oid operatorid,
 						List *args,
@@ -18,14 +18,24 @@
 #include "nodes/relation.h"
 
 
+/*
+ * prototypes for prepagg.c
+ */
+extern bool eager_aggregate;
+
+extern Query *build_eager_agg_query(Query *parse);
+
 /*
  * prototypes for prepjointree.c
  */
+extern bool enable_self_join_removal;
+
 extern void pull_up_sublinks(PlannerInfo *root);
 extern void inline_set_returning_functions(PlannerInfo *root);
 extern void pull_up_subqueries(PlannerInfo *root);
 extern void flatten_simple_union_all(PlannerInfo *root);
 extern void reduce_outer_joins(PlannerInfo *root);
+extern void remove_useless_self_joins(PlannerInfo *root);
 extern Relids get_relids_in_jointree(Node *jtnode, bool include_joins);
 extern Relids get_relids_for_join(PlannerInfo *root, int joinrelid);
 
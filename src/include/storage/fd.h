@@ -74,6 +74,9 @@ extern int	FileWrite(File file, char *buffer, int amount);
 extern int	FileSync(File file);
 extern off_t FileSeek(File file, off_t offset, int whence);
 extern int	FileTruncate(File file, off_t offset);
+extern int	FileFallocate(File file, off_t offset, off_t amount);
+extern int	FilePunchHole(File file, off_t offset, off_t amount);
+extern bool FileRangeIsHole(File file, off_t offset, off_t amount);
 extern char *FilePathName(File file);
 
 /* Operations that allow use of regular stdio --- USE WITH CAUTION */
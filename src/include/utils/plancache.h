@@ -21,6 +21,15 @@
 #define CACHEDPLANSOURCE_MAGIC		195726186
 #define CACHEDPLAN_MAGIC			953717834
 
+/*
+ * Number of generic plans a CachedPlanSource can keep for distinct
+ * parameter-selectivity classes, in addition to its fully generic plan.
+ */
+#define CACHED_PLAN_SELECTIVITY_SLOTS	4
+
+/* GUC parameter */
+extern bool plan_cache_selectivity;
+
 /*
  * CachedPlanSource (which might better have been called CachedQuery)
  * represents a SQL query that we expect to use multiple times.  It stores
@@ -37,6 +46,12 @@
  * cached plan then it is meant to be re-used across multiple executions, so
  * callers must always treat CachedPlans as read-only.
  *
+ * Besides the fully generic plan, a CachedPlanSource can hold a few generic
+ * plans that were planned using the estimated selectivity of a particular
+ * set of parameter values.  These are still usable with any parameters, but
+ * are only chosen for values that fall in the same selectivity class as the
+ * ones they were planned for (see choose_custom_plan).
+ *
  * Once successfully built and "saved", CachedPlanSources typically live
  * for the life of the backend, although they can be dropped explicitly.
  * CachedPlans are reference-counted and go away automatically when the last
@@ -109,6 +124,16 @@ typedef struct CachedPlanSource
 	double		generic_cost;	/* cost of generic plan, or -1 if not known */
 	double		total_custom_cost;		/* total cost of custom plans so far */
 	int			num_custom_plans;		/* number of plans included in total */
+	/* Generic plans for particular parameter-selectivity classes: */
+	int			num_sel_params; /* # of entries in sel_params, or -1 if not
+								 * yet determined */
+	struct PlanCacheSelParam *sel_params;	/* array in query_context */
+	struct CachedPlan *splans[CACHED_PLAN_SELECTIVITY_SLOTS];
+	int			splan_keys[CACHED_PLAN_SELECTIVITY_SLOTS];	/* class keys,
+															 * 0 if unused */
+	double		splan_costs[CACHED_PLAN_SELECTIVITY_SLOTS];	/* or -1 */
+	double		splan_custom_costs[CACHED_PLAN_SELECTIVITY_SLOTS];	/* or -1 */
+	int			next_splan;		/* next slot to recycle */
 	bool		hasRowSecurity; /* planned with row security? */
 	int			row_security_env;		/* row security setting when planned */
 	bool		rowSecurityDisabled;	/* is row security disabled? */
@@ -134,6 +159,7 @@ typedef struct CachedPlan
 	bool		is_valid;		/* is the stmt_list currently valid? */
 	TransactionId saved_xmin;	/* if valid, replan when TransactionXmin
 								 * changes from this value */
+	bool		depends_on_fkeys;	/* replan while RI checks are pending? */
 	int			generation;		/* parent's generation number for this plan */
 	int			refcount;		/* count of live references to this struct */
 	MemoryContext context;		/* context containing this CachedPlan */
@@ -112,10 +112,27 @@ typedef struct RelationData
 	Oid			rd_oidindex;	/* OID of unique index on OID, if any */
 	Oid			rd_replidindex; /* OID of replica identity index, if any */
 
+	/* data managed by RelationGetStatExtList: */
+	bool		rd_statvalid;	/* is rd_statlist valid? */
+	List	   *rd_statlist;	/* list of OIDs of extended stats */
+
+	/* data managed by RelationGetFKeyList: */
+	bool		rd_fkeyvalid;	/* is rd_fkeylist valid? */
+	List	   *rd_fkeylist;	/* list of OIDs of foreign key constraints */
+
 	/* data managed by RelationGetIndexAttrBitmap: */
 	Bitmapset  *rd_indexattr;	/* identifies columns used in indexes */
 	Bitmapset  *rd_keyattr;		/* cols that can be ref'd by foreign keys */
 	Bitmapset  *rd_idattr;		/* included in replica identity index */
+	Bitmapset  *rd_hotblockingattr;		/* cols used in non-summarizing
+										 * indexes */
+	Bitmapset  *rd_summarizedattr;	/* cols used in summarizing indexes */
+
+	/* data managed by RelationGetPartitionBounds: */
+	bool		rd_partboundvalid;		/* is rd_partbound valid? */
+	/* use "struct" here to avoid needing to include partition.h: */
+	struct PartitionBoundInfo *rd_partbound;	/* bounds of children, if any */
+	MemoryContext rd_partcxt;	/* private memory cxt for rd_partbound */
 
 	/*
 	 * rd_options is set whenever rd_rel is loaded into the relcache entry.
@@ -350,6 +367,22 @@ typedef struct ViewOptions
  */
 #define RelationGetNumberOfAttributes(relation) ((relation)->rd_rel->relnatts)
 
+/*
+ * IndexRelationGetNumberOfAttributes
+ *		Returns the number of attributes in an index.
+ */
+#define IndexRelationGetNumberOfAttributes(relation) \
+		((relation)->rd_index->indnatts)
+
+/*
+ * IndexRelationGetNumberOfKeyAttributes
+ *		Returns the number of key attributes in an index.  Any remaining
+ *		attributes are non-key columns added by INCLUDE, which are stored
+ *		in leaf tuples only and take no part in searches or uniqueness.
+ */
+#define IndexRelationGetNumberOfKeyAttributes(relation) \
+		((relation)->rd_index->indnkeyatts)
+
 /*
  * RelationGetDescr
  *		Returns tuple descriptor for a relation.
@@ -0,0 +1,34 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.h
+ *	  Cluster-wide cache of generic plans for prepared statements.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/utils/sharedplancache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDPLANCACHE_H
+#define SHAREDPLANCACHE_H
+
+#include "nodes/pg_list.h"
+
+/* GUC parameter */
+extern int	shared_plan_cache_size;
+
+#define SharedPlanCacheEnabled()	(shared_plan_cache_size > 0)
+
+extern Size SharedPlanCacheShmemSize(void);
+extern void SharedPlanCacheShmemInit(void);
+
+extern char *SharedPlanCacheKey(List *querytree_list, int cursor_options);
+extern List *SharedPlanCacheLookup(const char *key);
+extern void SharedPlanCacheStore(const char *key, List *stmt_list);
+
+extern void SharedPlanCacheInvalRelation(Oid relid);
+extern void SharedPlanCacheInvalSyscache(int cacheid, uint32 hashvalue);
+extern void SharedPlanCacheReset(void);
+
+#endif   /* SHAREDPLANCACHE_H */
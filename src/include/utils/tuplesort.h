@@ -54,6 +54,10 @@ typedef struct Tuplesortstate Tuplesortstate;
  * The "index_btree" API stores/sorts IndexTuples (preserving all their
  * header fields).  The sort keys are specified by a btree index definition.
  *
+ * The "index_gist" API is similar to index_btree, but the tuples are
+ * sorted in the order defined by the GiST opclasses' sort support functions
+ * (typically a space-filling curve).
+ *
  * The "index_hash" API is similar to index_btree, but the tuples are
  * actually sorted by their hash codes not the raw data.
  */
@@ -70,6 +74,9 @@ extern Tuplesortstate *tuplesort_begin_index_btree(Relation heapRel,
 							Relation indexRel,
 							bool enforceUnique,
 							int workMem, bool randomAccess);
+extern Tuplesortstate *tuplesort_begin_index_gist(Relation heapRel,
+						   Relation indexRel,
+						   int workMem, bool randomAccess);
 extern Tuplesortstate *tuplesort_begin_index_hash(Relation heapRel,
 						   Relation indexRel,
 						   uint32 hash_mask,
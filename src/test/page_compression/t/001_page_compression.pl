@@ -0,0 +1,112 @@
+# Test that pages written with page_compression read back correctly, both
+# while the setting is on and after it has been turned off again.
+use strict;
+use warnings;
+use TestLib;
+use Test::More tests => 9;
+use IPC::Run qw(run);
+
+my $tempdir = TestLib::tempdir;
+my $pgdata  = "$tempdir/pgdata";
+
+sub query
+{
+	my ($sql) = @_;
+	my ($stdout, $stderr);
+
+	run [ 'psql', '-X', '-A', '-t', '-d', 'postgres', '-c', $sql ],
+	  '>', \$stdout, '2>', \$stderr
+	  or die "psql failed: $stderr";
+	chomp $stdout;
+	return $stdout;
+}
+
+sub set_page_compression
+{
+	my ($value) = @_;
+
+	open CONF, ">>$pgdata/postgresql.conf";
+	print CONF "page_compression = $value\n";
+	close CONF;
+	restart_test_server();
+}
+
+# true if block 0 of the relation is stored compressed: the compressed
+# image has 0xFFFF where a regular page keeps pd_pagesize_version
+sub first_block_compressed
+{
+	my ($relname) = @_;
+	my $path = query("SELECT pg_relation_filepath('$relname')");
+	my $block;
+
+	open my $fh, '<', "$pgdata/$path" or die "could not open $path: $!";
+	binmode $fh;
+	read($fh, $block, 24) == 24 or die "could not read $path: $!";
+	close $fh;
+	return unpack('x18 v', $block) == 0xFFFF;
+}
+
+my $digest_sql = q{
+	SELECT md5(string_agg(g || ':' || t, ',' ORDER BY g)) FROM compressible
+	UNION ALL
+	SELECT md5(string_agg(g || ':' || encode(t, 'hex'), ',' ORDER BY g)) FROM incompressible
+};
+my $count_sql = q{
+	SET enable_seqscan = off;
+	SELECT count(*) FROM compressible WHERE g BETWEEN 1000 AND 1999
+};
+
+start_test_server($tempdir);
+
+# page compression relies on full-page images after hint bit changes
+open CONF, ">>$pgdata/postgresql.conf";
+print CONF "wal_log_hints = on\n";
+close CONF;
+set_page_compression('pglz');
+
+# repetitive text compresses well; random bytes don't compress at all
+psql 'postgres', q{
+	CREATE TABLE compressible AS
+		SELECT g, repeat('x', 200) || g AS t FROM generate_series(1, 10000) g;
+	CREATE INDEX compressible_g ON compressible (g);
+	CREATE TABLE incompressible AS
+		SELECT g, decode(md5(g::text) || md5((-g)::text) ||
+						 md5((g * 7)::text) || md5((g * 13)::text), 'hex') AS t
+		FROM generate_series(1, 10000) g;
+	CHECKPOINT;
+};
+my $digest = query($digest_sql);
+
+ok(first_block_compressed('compressible'), 'compressible page is stored compressed');
+ok(!first_block_compressed('incompressible'), 'incompressible page is stored as is');
+
+# the restart empties shared buffers, so everything is read back from disk
+restart_test_server();
+is(query($digest_sql), $digest, 'contents read back with compression on');
+is(query($count_sql), '1000', 'index read back with compression on');
+
+# rewriting a compressed page in place, possibly to a different length
+psql 'postgres', q{
+	UPDATE compressible SET t = repeat('y', 150) || g WHERE g % 2 = 0;
+	VACUUM compressible;
+	CHECKPOINT;
+};
+$digest = query($digest_sql);
+restart_test_server();
+is(query($digest_sql), $digest, 'rewritten pages read back');
+
+# compressed pages stay readable after turning the setting off, and are
+# stored uncompressed when next written
+set_page_compression('off');
+is(query($digest_sql), $digest, 'contents read back with compression off');
+is(query($count_sql), '1000', 'index read back with compression off');
+
+psql 'postgres', q{
+	UPDATE compressible SET t = t || 'z';
+	VACUUM compressible;
+	CHECKPOINT;
+};
+$digest = query($digest_sql);
+ok(!first_block_compressed('compressible'), 'rewritten page is stored as is');
+restart_test_server();
+is(query($digest_sql), $digest, 'uncompressed rewrite read back');
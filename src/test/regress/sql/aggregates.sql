@@ -590,3 +590,49 @@ drop view aggordview1;
 -- variadic aggregates
 select least_agg(q1,q2) from int8_tbl;
 select least_agg(variadic array[q1,q2]) from int8_tbl;
+
+-- eager aggregation: partial aggregation pushed below a join must give
+-- the same answers as aggregating after the join
+set eager_aggregate = on;
+select t.ten, count(*), sum(t.unique1), max(t.unique1)
+  from tenk1 t join onek o on t.unique1 = o.unique1
+ group by t.ten order by t.ten;
+reset eager_aggregate;
+select t.ten, count(*), sum(t.unique1), max(t.unique1)
+  from tenk1 t join onek o on t.unique1 = o.unique1
+ group by t.ten order by t.ten;
+-- with few distinct join key values, grouping before the join pays off
+create temp table eager_dim as
+  select g as k, 'dim ' || g as name from generate_series(0, 999) g;
+analyze eager_dim;
+set eager_aggregate = on;
+explain (costs off)
+select count(*), sum(t.unique1)
+  from tenk1 t join eager_dim d on t.ten = d.k;
+select count(*), sum(t.unique1)
+  from tenk1 t join eager_dim d on t.ten = d.k;
+-- a user-defined aggregate qualifies if it has a combine function
+create aggregate eager_total(int4) (
+  sfunc = int84pl, stype = int8, combinefunc = int8pl, initcond = '0'
+);
+explain (costs off)
+select eager_total(t.unique1)
+  from tenk1 t join eager_dim d on t.ten = d.k;
+select eager_total(t.unique1)
+  from tenk1 t join eager_dim d on t.ten = d.k;
+-- outer references must still find their query level once pushed down
+select d.k,
+       (select sum(t.unique1)
+          from tenk1 t join eager_dim d2 on t.ten = d2.k
+         where t.hundred = d.k)
+  from eager_dim d where d.k < 3 order by d.k;
+-- grouping below the join must not merge equal but distinct values
+create temp table eager_num (n numeric, v int);
+insert into eager_num values (1.0, 1), (1.00, 2);
+create temp table eager_numdim (n numeric);
+insert into eager_numdim values (1);
+select e.n::text, sum(e.v)
+  from eager_num e join eager_numdim d on e.n = d.n
+ group by e.n::text order by 1;
+reset eager_aggregate;
+drop aggregate eager_total(int4);
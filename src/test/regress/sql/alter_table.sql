@@ -1688,3 +1688,13 @@ ALTER TABLE logged1 SET UNLOGGED; -- silently do nothing
 DROP TABLE logged3;
 DROP TABLE logged2;
 DROP TABLE logged1;
+
+-- TOAST compression method column option
+CREATE TABLE cmdata(f1 text);
+ALTER TABLE cmdata ALTER COLUMN f1 SET (compression = pglz);
+INSERT INTO cmdata VALUES (repeat('1234567890', 1000));
+SELECT length(f1), substr(f1, 9991, 10), pg_column_size(f1) < 10000 AS compressed FROM cmdata;
+ALTER TABLE cmdata ALTER COLUMN f1 SET (compression = nosuchmethod); -- fails
+ALTER TABLE cmdata ALTER COLUMN f1 RESET (compression);
+SELECT length(f1), substr(f1, 9991, 10) FROM cmdata;
+DROP TABLE cmdata;
@@ -416,3 +416,20 @@ VACUUM brintest;  -- force a summarization cycle in brinidx
 
 UPDATE brintest SET int8col = int8col * int4col;
 UPDATE brintest SET textcol = '' WHERE textcol IS NOT NULL;
+
+-- A HOT update that changes only BRIN-indexed columns must still extend
+-- the block range summaries to cover the new values
+CREATE TABLE brin_hot (id int PRIMARY KEY, val int);
+INSERT INTO brin_hot SELECT g, g FROM generate_series(1, 100) g;
+CREATE INDEX brin_hot_val_idx ON brin_hot USING brin (val);
+UPDATE brin_hot SET val = 1000 WHERE id = 50;
+SET enable_seqscan = off;
+SELECT id FROM brin_hot WHERE val = 1000;
+-- the btree must not have gained an entry for the heap-only tuple
+SELECT id, val FROM brin_hot WHERE id = 50;
+UPDATE brin_hot SET val = 2000 WHERE id = 50;
+SELECT id, val FROM brin_hot WHERE id = 50;
+SELECT id FROM brin_hot WHERE val = 2000;
+SELECT count(*) FROM brin_hot WHERE id BETWEEN 49 AND 51;
+RESET enable_seqscan;
+DROP TABLE brin_hot;
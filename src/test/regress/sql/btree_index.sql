@@ -92,3 +92,25 @@ vacuum btree_tall_tbl;
 -- need to insert some rows to cause the fast root page to split.
 insert into btree_tall_tbl (id, t)
   select g, repeat('x', 100) from generate_series(1, 500) g;
+
+--
+-- Test heap prefetching in plain index scans, in both directions
+--
+set index_prefetch_distance = 16;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+explain (costs off)
+select unique1 from tenk1 where unique2 < 1000 order by unique2;
+select count(*), sum(unique1) from
+  (select unique1 from tenk1 where unique2 < 1000 order by unique2) s;
+select unique1, unique2 from tenk1 where unique2 < 1000 order by unique2
+  offset 500 limit 3;
+explain (costs off)
+select unique1 from tenk1 where unique2 < 1000 order by unique2 desc;
+select count(*), sum(unique1) from
+  (select unique1 from tenk1 where unique2 < 1000 order by unique2 desc) s;
+select unique1, unique2 from tenk1 where unique2 < 1000 order by unique2 desc
+  offset 500 limit 3;
+reset index_prefetch_distance;
+reset enable_seqscan;
+reset enable_bitmapscan;
@@ -0,0 +1,19 @@
+--
+-- TOAST compression with lz4
+--
+-- The alternative output is for servers built without lz4 support, where
+-- the column option is rejected and the default method is used instead.
+CREATE TABLE cmlz4 (id int, f1 text);
+ALTER TABLE cmlz4 ALTER COLUMN f1 SET (compression = lz4);
+INSERT INTO cmlz4 VALUES (1, repeat('1234567890', 1000));
+INSERT INTO cmlz4 VALUES (2, repeat('abc', 5000) || repeat('xyz', 5000));
+SELECT id, length(f1), md5(f1), pg_column_size(f1) < length(f1) AS compressed
+  FROM cmlz4 ORDER BY id;
+-- slices, which need only part of the value decompressed
+SELECT id, substr(f1, 1, 12), substr(f1, 4995, 12) FROM cmlz4 ORDER BY id;
+-- values compressed with different methods can share a column
+ALTER TABLE cmlz4 ALTER COLUMN f1 SET (compression = pglz);
+INSERT INTO cmlz4 VALUES (3, repeat('abcdefghij', 1000));
+ALTER TABLE cmlz4 ALTER COLUMN f1 RESET (compression);
+SELECT id, length(f1), md5(f1) FROM cmlz4 ORDER BY id;
+DROP TABLE cmlz4;
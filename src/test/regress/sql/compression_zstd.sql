@@ -0,0 +1,19 @@
+--
+-- TOAST compression with zstd
+--
+-- The alternative output is for servers built without zstd support, where
+-- the column option is rejected and the default method is used instead.
+CREATE TABLE cmzstd (id int, f1 text);
+ALTER TABLE cmzstd ALTER COLUMN f1 SET (compression = zstd);
+INSERT INTO cmzstd VALUES (1, repeat('1234567890', 1000));
+INSERT INTO cmzstd VALUES (2, repeat('abc', 5000) || repeat('xyz', 5000));
+SELECT id, length(f1), md5(f1), pg_column_size(f1) < length(f1) AS compressed
+  FROM cmzstd ORDER BY id;
+-- slices, which need only part of the value decompressed
+SELECT id, substr(f1, 1, 12), substr(f1, 4995, 12) FROM cmzstd ORDER BY id;
+-- values compressed with different methods can share a column
+ALTER TABLE cmzstd ALTER COLUMN f1 SET (compression = pglz);
+INSERT INTO cmzstd VALUES (3, repeat('abcdefghij', 1000));
+ALTER TABLE cmzstd ALTER COLUMN f1 RESET (compression);
+SELECT id, length(f1), md5(f1) FROM cmzstd ORDER BY id;
+DROP TABLE cmzstd;
@@ -12,6 +12,11 @@ insert into gin_test_tbl select array[1, 3, g] from generate_series(1, 1000) g;
 
 vacuum gin_test_tbl; -- flush the fastupdate buffers
 
+-- Test explicit cleanup of the pending list
+insert into gin_test_tbl select array[3, 1, g] from generate_series(1, 1000) g;
+select gin_clean_pending_list('gin_test_idx') > 0 as cleaned;
+select gin_clean_pending_list('gin_test_idx'); -- nothing left to clean
+
 -- Test vacuuming
 delete from gin_test_tbl where i @> array[2];
 vacuum gin_test_tbl;
@@ -27,3 +32,16 @@ insert into gin_test_tbl select array[1, 3, g] from generate_series(1, 1000) g;
 
 delete from gin_test_tbl where i @> array[2];
 vacuum gin_test_tbl;
+
+-- Test searches.  Key 1 has a large posting tree whose items are mostly
+-- consecutive, so that they decode eight at a time; combining it with a
+-- rare key makes the scan skip over long runs of its items.
+set enable_seqscan = off;
+explain (costs off)
+select count(*) from gin_test_tbl where i @> array[1, 500];
+select count(*) from gin_test_tbl where i @> array[1];
+select count(*) from gin_test_tbl where i @> array[1, 500];
+select count(*) from gin_test_tbl where i @> array[1, 1000];
+select count(*) from gin_test_tbl where i @> array[1, 2];
+select i from gin_test_tbl where i @> array[3, 999] order by i;
+reset enable_seqscan;
@@ -24,6 +24,15 @@ delete from gist_point_tbl where id < 10000;
 
 vacuum analyze gist_point_tbl;
 
+-- Rebuild the index.  point_ops supports the sorted build method, so this
+-- packs the sorted points bottom-up; check that all the rows can be found.
+reindex index gist_pointidx;
+set enable_seqscan=off;
+set enable_bitmapscan=off;
+select count(*) from gist_point_tbl where p <@ box(point(0,0), point(200000, 200000));
+reset enable_seqscan;
+reset enable_bitmapscan;
+
 
 --
 -- Test Index-only plans on GiST indexes
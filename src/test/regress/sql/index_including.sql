@@ -0,0 +1,34 @@
+--
+-- Test btree indexes with included (non-key) columns
+--
+
+CREATE TABLE tbl_include (c1 int, c2 int, c3 int, c4 box);
+INSERT INTO tbl_include SELECT x, 2*x, 3*x, box('4,4,4,4') FROM generate_series(1,10) AS x;
+
+-- included columns need no btree opclass
+CREATE UNIQUE INDEX tbl_include_unique ON tbl_include USING btree (c1, c2) INCLUDE (c3, c4);
+SELECT indnatts, indnkeyatts FROM pg_index
+  WHERE indexrelid = 'tbl_include_unique'::regclass;
+SELECT pg_get_indexdef('tbl_include_unique'::regclass);
+
+-- uniqueness is checked on key columns only
+INSERT INTO tbl_include SELECT 1, 2, 3*x, box('4,4,4,4') FROM generate_series(1,10) AS x;
+INSERT INTO tbl_include VALUES (11, 22, 3, box('4,4,4,4'));
+SELECT count(*) FROM tbl_include;
+
+-- enough rows to split leaf pages and build internal levels
+INSERT INTO tbl_include SELECT x, 2*x, 3*x, box('4,4,4,4') FROM generate_series(12,10000) AS x;
+CREATE INDEX tbl_include_idx ON tbl_include USING btree (c1) INCLUDE (c2, c3);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT c1, c2, c3 FROM tbl_include WHERE c1 > 9997 ORDER BY c1;
+SELECT count(*) FROM tbl_include WHERE c1 BETWEEN 100 AND 5099;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+-- unsupported cases
+CREATE INDEX tbl_include_err ON tbl_include USING hash (c1) INCLUDE (c2);
+CREATE INDEX tbl_include_err ON tbl_include USING btree (c1) INCLUDE ((c2 + 1));
+CREATE INDEX tbl_include_err ON tbl_include USING btree (c1) INCLUDE (c2 DESC);
+
+DROP TABLE tbl_include;
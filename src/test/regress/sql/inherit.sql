@@ -473,3 +473,59 @@ FROM generate_series(1, 3) g(i);
 reset enable_seqscan;
 reset enable_indexscan;
 reset enable_bitmapscan;
+
+--
+-- Check partition pruning with bounds derived from CHECK constraints
+--
+create table prt (a int, b text);
+create table prt_1 (check (a >= 0 and a < 10)) inherits (prt);
+create table prt_2 (check (a >= 10 and a < 20)) inherits (prt);
+create table prt_3 (check (a in (20, 25))) inherits (prt);
+create table prt_4 (check (b <> 'x')) inherits (prt);
+insert into prt_1 values (5, 'a');
+insert into prt_2 values (15, 'b');
+insert into prt_3 values (25, 'c');
+insert into prt_4 values (15, 'd');
+explain (costs off) select * from prt where a = 15;
+select * from prt where a = 15 order by b;
+explain (costs off) select * from prt where a in (5, 25);
+select * from prt where a in (5, 25) order by b;
+-- run-time pruning, using a value not known while planning
+set prt.val = '15';
+explain (costs off) select * from prt where a = current_setting('prt.val')::int;
+select * from prt where a = current_setting('prt.val')::int order by b;
+reset prt.val;
+-- adding a constraint makes prt_4 prunable too
+alter table prt_4 add check (a = 30);
+explain (costs off) select * from prt where a = 15;
+-- UPDATE leaves out children that constraint exclusion rules out
+explain (costs off) update prt set a = a where b = 'x';
+drop table prt cascade;
+-- UPDATE/DELETE skip target children that constraint exclusion rules out
+-- before planning them; that includes the parent, which nonetheless remains
+-- the nominal target (note the NO INHERIT constraint)
+create table cet (a int, b text, check (a < 0) no inherit);
+create table cet_1 (check (a >= 0 and a < 10)) inherits (cet);
+create table cet_2 (check (a >= 10 and a < 20)) inherits (cet);
+create index cet_1_b_idx on cet_1 (b);
+create index cet_2_b_idx on cet_2 (b);
+insert into cet values (-1, 'p');
+insert into cet_1 values (1, 'a'), (2, 'b');
+insert into cet_2 values (11, 'c'), (12, 'd');
+explain (costs off) update cet set b = 'z' where a = 1;
+update cet set b = 'z' where a = 1;
+select * from cet order by a;
+-- the excluded children's indexes are never opened
+begin;
+delete from cet where a = 11;
+select c.relname, l.mode from pg_locks l join pg_class c on c.oid = l.relation
+  where l.pid = pg_backend_pid() and c.relname like 'cet%' order by 1;
+commit;
+select count(*) from cet;
+-- likewise, a query never opens the indexes of the children it excludes
+begin;
+select * from cet where a = 12;
+select c.relname, l.mode from pg_locks l join pg_class c on c.oid = l.relation
+  where l.pid = pg_backend_pid() and c.relname like 'cet%' order by 1;
+commit;
+drop table cet cascade;
@@ -347,12 +347,30 @@ select count(*) from tenk1 x where
 begin;
 set geqo = on;
 set geqo_threshold = 2;
+set join_search_method = geqo;
 select count(*) from tenk1 x where
   x.unique1 in (select a.f1 from int4_tbl a,float8_tbl b where a.f1=b.f1) and
   x.unique1 = 0 and
   x.unique1 in (select aa.f1 from int4_tbl aa,float8_tbl bb where aa.f1=bb.f1);
 rollback;
 
+-- and with the iterative DP search, forcing greedy choices
+begin;
+set geqo = on;
+set geqo_threshold = 2;
+set join_search_method = idp;
+set idp_join_budget = 1;
+select count(*) from tenk1 x where
+  x.unique1 in (select a.f1 from int4_tbl a,float8_tbl b where a.f1=b.f1) and
+  x.unique1 = 0 and
+  x.unique1 in (select aa.f1 from int4_tbl aa,float8_tbl bb where aa.f1=bb.f1);
+select count(*), count(e.f1)
+  from int4_tbl a join int4_tbl b on a.f1 = b.f1
+  join int4_tbl c on b.f1 = c.f1
+  join int4_tbl d on c.f1 = d.f1
+  left join int4_tbl e on d.f1 = e.f1 and e.f1 > 0;
+rollback;
+
 
 --
 -- Clean up
@@ -1091,6 +1109,87 @@ SELECT * FROM
 
 rollback;
 
+--
+-- test removal of self-joins on unique keys
+--
+
+create temp table sj (a int primary key, b int, c int);
+create unique index sj_c_key on sj (c);
+insert into sj values (1, 10, 100), (2, 20, null), (3, 30, 300);
+
+explain (costs off)
+select s1.a, s2.b from sj s1 join sj s2 on s1.a = s2.a where s2.b > 15;
+select s1.a, s2.b from sj s1 join sj s2 on s1.a = s2.a where s2.b > 15;
+
+-- a nullable unique column needs an IS NOT NULL test instead
+explain (costs off)
+select s1.a, s2.b from sj s1, sj s2 where s1.c = s2.c;
+select s1.a, s2.b from sj s1, sj s2 where s1.c = s2.c;
+
+--
+-- test removal of inner joins proven redundant by a foreign key
+--
+
+create temp table fkr_parent (id int primary key, name text);
+create temp table fkr_child (id int primary key,
+                             pid int references fkr_parent, dat text);
+create temp table fkr_child_d (id int primary key,
+                               pid int references fkr_parent deferrable);
+insert into fkr_parent values (1, 'one'), (2, 'two');
+insert into fkr_child values (1, 1, 'a'), (2, null, 'b'), (3, 2, 'c');
+
+explain (costs off)
+select c.id, c.dat from fkr_child c join fkr_parent p on c.pid = p.id;
+select c.id, c.dat from fkr_child c join fkr_parent p on c.pid = p.id;
+
+-- not removable if the referenced table's rows are filtered
+select c.id from fkr_child c join fkr_parent p on c.pid = p.id
+  where p.name = 'one';
+
+-- not removable if the constraint is deferrable
+begin;
+set constraints all deferred;
+insert into fkr_child_d values (1, 1), (2, 3);
+select c.id from fkr_child_d c join fkr_parent p on c.pid = p.id;
+rollback;
+
+-- not removable while RI checks are pending, since they are AFTER triggers;
+-- the trigger's name makes it fire before the RI ones, so it sees the
+-- referenced row gone but the referencing row not yet complained about
+create function fkr_join_count() returns bigint language plpgsql as $$
+declare n bigint;
+begin
+  select count(*) into n from fkr_child c join fkr_parent p on c.pid = p.id;
+  return n;
+end $$;
+create function fkr_notice() returns trigger language plpgsql as $$
+begin
+  raise notice 'join rows: %', fkr_join_count();
+  return null;
+end $$;
+create trigger "A_fkr_notice" after delete on fkr_parent
+  for each row execute procedure fkr_notice();
+select fkr_join_count();
+delete from fkr_parent where id = 2;
+drop trigger "A_fkr_notice" on fkr_parent;
+drop function fkr_notice();
+drop function fkr_join_count();
+
+-- both kinds of removal can be disabled
+begin;
+set local enable_hashjoin = off;
+set local enable_mergejoin = off;
+
+set local enable_self_join_removal = off;
+explain (costs off)
+select s1.a, s2.b from sj s1 join sj s2 on s1.a = s2.a where s2.b > 15;
+
+set local enable_fkey_join_removal = off;
+explain (costs off)
+select c.id, c.dat from fkr_child c join fkr_parent p on c.pid = p.id;
+
+rollback;
+
 -- bug #8444: we've historically allowed duplicate aliases within aliased JOINs
 
 select * from
@@ -1344,3 +1443,146 @@ update xx1 set x2 = f1 from xx1, lateral (select * from int4_tbl where f1 = x1)
 delete from xx1 using (select * from int4_tbl where f1 = x1) ss;
 delete from xx1 using (select * from int4_tbl where f1 = xx1.x1) ss;
 delete from xx1 using lateral (select * from int4_tbl where f1 = x1) ss;
+
+--
+-- test result cache on the inner side of a parameterized nestloop
+--
+create temp table rc_outer as
+  select i % 10 as k from generate_series(1, 1000) i;
+analyze rc_outer;
+create function explain_rc(query text) returns setof text language plpgsql as
+$$
+declare
+  ln text;
+begin
+  for ln in execute 'explain (analyze, costs off, timing off) ' || query loop
+    if ln like '%Hits:%' then
+      return next regexp_replace(btrim(ln), 'Memory Usage: \d+kB',
+                                 'Memory Usage: NkB');
+    end if;
+  end loop;
+end
+$$;
+
+begin;
+
+set local enable_hashjoin = off;
+set local enable_mergejoin = off;
+
+explain (costs off)
+select sum(t.ten) from rc_outer o join tenk1 t on t.unique1 = o.k;
+select sum(t.ten) from rc_outer o join tenk1 t on t.unique1 = o.k;
+
+-- only the first scan for each of the 10 keys misses
+select explain_rc('select sum(t.ten) from rc_outer o join tenk1 t on t.unique1 = o.k');
+
+-- the result must be the same without the cache
+set local enable_resultcache = off;
+select sum(t.ten) from rc_outer o join tenk1 t on t.unique1 = o.k;
+
+rollback;
+
+-- The rows for k = 0 don't fit in work_mem.  Scans for that key bypass the
+-- cache, and the first one evicts the other keys' entries to make room.
+-- Plan while the entries fit, then run the plan with less memory.
+create temp table rc_inner as
+  select case when i <= 500 then 0 else i - 500 end as k,
+         repeat('x', 100) as pad
+  from generate_series(1, 509) i;
+create index rc_inner_k on rc_inner (k);
+analyze rc_inner;
+
+begin;
+
+set local enable_hashjoin = off;
+set local enable_mergejoin = off;
+set local enable_bitmapscan = off;
+
+prepare rc_q as
+select count(*), sum(length(i.pad))
+  from (select k from rc_outer order by k desc) o join rc_inner i on i.k = o.k;
+execute rc_q;
+
+set local work_mem = '64kB';
+select explain_rc('execute rc_q');
+execute rc_q;
+
+rollback;
+
+deallocate rc_q;
+drop function explain_rc(text);
+
+--
+-- test switching a nestloop to a hashed inner side when its outer side
+-- turns out to be much bigger than estimated
+--
+create temp table anl_inner as
+  select i % 50 as k, repeat('x', 100) as v from generate_series(1, 2000) i;
+insert into anl_inner values (null, 'null key');
+analyze anl_inner;
+create function anl_outer(n int) returns setof int language plpgsql rows 1 as
+$$ begin return query select generate_series(1, n); return next null; end $$;
+create function explain_anl(query text) returns setof text language plpgsql as
+$$
+declare
+  ln text;
+begin
+  for ln in execute 'explain (analyze, costs off, timing off) ' || query loop
+    if ln like '%Adaptive Hash%' then
+      return next regexp_replace(btrim(ln), 'Memory Usage: \d+kB',
+                                 'Memory Usage: NkB');
+    end if;
+  end loop;
+end
+$$;
+
+begin;
+set local enable_hashjoin = off;
+set local enable_mergejoin = off;
+set local enable_hashagg = off;
+set local adaptive_nestloop_factor = 10;
+
+explain (costs off)
+select count(*), sum(o.x) from anl_outer(60) o(x) join anl_inner i on o.x = i.k;
+
+select explain_anl('select count(*), sum(o.x) from anl_outer(60) o(x) join anl_inner i on o.x = i.k');
+
+select count(*), sum(o.x) from anl_outer(60) o(x) join anl_inner i on o.x = i.k;
+
+-- outer joins, semijoins and antijoins; null keys on either side never match
+select explain_anl('select count(*), count(i.k) from anl_outer(60) o(x) left join anl_inner i on o.x = i.k');
+
+select count(*), count(i.k) from anl_outer(60) o(x) left join anl_inner i on o.x = i.k;
+
+select explain_anl('select count(*) from anl_outer(60) o(x) where exists (select 1 from anl_inner i where i.k = o.x)');
+
+select count(*) from anl_outer(60) o(x) where exists (select 1 from anl_inner i where i.k = o.x);
+
+select explain_anl('select count(*) from anl_outer(60) o(x) where not exists (select 1 from anl_inner i where i.k = o.x)');
+
+select count(*) from anl_outer(60) o(x) where not exists (select 1 from anl_inner i where i.k = o.x);
+
+-- the hash table must be rebuilt when a rescan changes the inner side
+select g, (select count(*) from anl_outer(60) o(x)
+             join anl_inner i on o.x = i.k and i.k < g)
+from generate_series(10, 30, 10) g;
+
+-- if the inner side doesn't fit in work_mem, carry on as a plain nestloop
+set local work_mem = '64kB';
+
+select explain_anl('select count(*), sum(o.x) from anl_outer(60) o(x) join anl_inner i on o.x = i.k');
+
+select count(*), sum(o.x) from anl_outer(60) o(x) join anl_inner i on o.x = i.k;
+
+-- the same results without switching
+set local adaptive_nestloop_factor = 0;
+reset work_mem;
+
+select count(*), sum(o.x) from anl_outer(60) o(x) join anl_inner i on o.x = i.k;
+
+select count(*), count(i.k) from anl_outer(60) o(x) left join anl_inner i on o.x = i.k;
+
+rollback;
+drop function explain_anl(text);
+drop function anl_outer(int);
+drop table anl_inner;
@@ -749,6 +749,20 @@ WHERE a.aggfnoid = p.oid AND
      -- we could carry the check further, but 3 args is enough for now
     );
 
+-- Cross-check combinefn (if present) against its entry in pg_proc.
+-- NOTE: use physically_coercible here, as for transfn, because max and
+-- min on abstime combine using int4larger/int4smaller.
+SELECT a.aggfnoid::oid, p.proname, pcm.oid, pcm.proname
+FROM pg_aggregate AS a, pg_proc AS p, pg_proc AS pcm
+WHERE a.aggfnoid = p.oid AND
+    a.aggcombinefn = pcm.oid AND
+    (pcm.proretset OR
+     pcm.pronargs != 2 OR
+     a.aggkind != 'n' OR
+     NOT physically_coercible(pcm.prorettype, a.aggtranstype) OR
+     NOT physically_coercible(a.aggtranstype, pcm.proargtypes[0]) OR
+     NOT physically_coercible(a.aggtranstype, pcm.proargtypes[1]));
+
 -- If transfn is strict then either initval should be non-NULL, or
 -- input type should match transtype so that the first non-null input
 -- can be assigned as the state value.
@@ -156,3 +156,37 @@ end$$ language plpgsql;
 
 select cachebug();
 select cachebug();
+
+-- Check selectivity-specific generic plans: a parameter that hits a very
+-- common value should not share a generic plan with rare values
+
+create temp table pcsel (a int, b text);
+insert into pcsel
+  select case when i <= 5000 then 0 else i end, 'x'
+  from generate_series(1, 10000) i;
+create index pcsel_a_idx on pcsel (a);
+analyze pcsel;
+
+prepare pcsel_q(int) as select b from pcsel where a = $1;
+
+-- build up some custom-plan history
+execute pcsel_q(6001);
+execute pcsel_q(6001);
+execute pcsel_q(6001);
+execute pcsel_q(6001);
+execute pcsel_q(6001);
+
+-- each class gets one custom plan, then a generic plan of its own
+explain (costs off) execute pcsel_q(6002);
+explain (costs off) execute pcsel_q(6003);
+explain (costs off) execute pcsel_q(0);
+explain (costs off) execute pcsel_q(0);
+explain (costs off) execute pcsel_q(6004);
+
+-- without that, the common value gets the single generic plan
+set plan_cache_selectivity = off;
+explain (costs off) execute pcsel_q(0);
+reset plan_cache_selectivity;
+
+deallocate pcsel_q;
+drop table pcsel;
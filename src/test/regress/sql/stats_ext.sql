@@ -0,0 +1,87 @@
+-- Generic extended statistics support
+
+-- Helper function to extract the estimated number of rows from the top
+-- plan node of a query
+CREATE FUNCTION check_estimated_rows(text) RETURNS int
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+BEGIN
+    FOR ln IN EXECUTE format('explain %s', $1)
+    LOOP
+        RETURN substring(ln from 'rows=(\d+)')::int;
+    END LOOP;
+END;
+$$;
+
+-- Verify failures
+CREATE TABLE ext_stats_test (x int, y int, z int);
+CREATE STATISTICS tst;
+CREATE STATISTICS tst ON x, y FROM nonexistent;
+CREATE STATISTICS tst ON a, b FROM ext_stats_test;
+CREATE STATISTICS tst ON x, x, y FROM ext_stats_test;
+CREATE STATISTICS tst ON x FROM ext_stats_test;
+CREATE STATISTICS tst (unrecognized) ON x, y FROM ext_stats_test;
+DROP STATISTICS tst;
+DROP STATISTICS IF EXISTS tst;
+
+-- Ensure stats are dropped sanely, and test IF NOT EXISTS while at it
+CREATE STATISTICS IF NOT EXISTS ab1_x_y_stats ON x, y FROM ext_stats_test;
+CREATE STATISTICS IF NOT EXISTS ab1_x_y_stats ON x, y FROM ext_stats_test;
+CREATE STATISTICS ab1_x_y_stats ON x, y FROM ext_stats_test;
+ALTER TABLE ext_stats_test ALTER COLUMN y TYPE bigint;
+ALTER TABLE ext_stats_test DROP COLUMN z;
+SELECT stxname, stxkeys, stxkind
+  FROM pg_statistic_ext WHERE stxrelid = 'ext_stats_test'::regclass;
+ALTER TABLE ext_stats_test DROP COLUMN y;
+SELECT stxname, stxkeys, stxkind
+  FROM pg_statistic_ext WHERE stxrelid = 'ext_stats_test'::regclass;
+DROP TABLE ext_stats_test;
+
+-- Correlated columns: a and b always have the same value
+CREATE TABLE ext_stats_corr (a int, b int);
+INSERT INTO ext_stats_corr SELECT i % 100, i % 100 FROM generate_series(1, 10000) s(i);
+ANALYZE ext_stats_corr;
+
+-- without extended statistics the columns are assumed independent
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a < 5 AND b < 5');
+SELECT check_estimated_rows('SELECT a, b FROM ext_stats_corr GROUP BY a, b');
+
+-- n-distinct coefficients
+CREATE STATISTICS ext_stats_corr_nd (ndistinct) ON a, b FROM ext_stats_corr;
+-- nothing changes until ANALYZE builds the statistics
+SELECT check_estimated_rows('SELECT a, b FROM ext_stats_corr GROUP BY a, b');
+ANALYZE ext_stats_corr;
+SELECT check_estimated_rows('SELECT a, b FROM ext_stats_corr GROUP BY a, b');
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+DROP STATISTICS ext_stats_corr_nd;
+
+-- functional dependencies
+CREATE STATISTICS ext_stats_corr_deps (dependencies) ON a, b FROM ext_stats_corr;
+ANALYZE ext_stats_corr;
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+-- dependencies only help with equality clauses
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a < 5 AND b < 5');
+DROP STATISTICS ext_stats_corr_deps;
+
+-- multivariate MCV lists
+CREATE STATISTICS ext_stats_corr_mcv (mcv) ON a, b FROM ext_stats_corr;
+ANALYZE ext_stats_corr;
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a < 5 AND b < 5');
+-- a combination that never occurs
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 2');
+
+-- statistics objects are shown by \d and can be reconstructed for pg_dump
+CREATE STATISTICS ext_stats_corr_nd_deps (ndistinct, dependencies) ON b, a FROM ext_stats_corr;
+\d ext_stats_corr
+SELECT pg_get_statisticsobjdef(oid) FROM pg_statistic_ext
+  WHERE stxrelid = 'ext_stats_corr'::regclass ORDER BY stxname;
+
+-- dropping the table drops the statistics object
+DROP TABLE ext_stats_corr;
+SELECT count(*) FROM pg_statistic_ext WHERE stxname LIKE 'ext_stats_corr%';
+
+DROP FUNCTION check_estimated_rows(text);
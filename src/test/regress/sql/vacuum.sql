@@ -60,5 +60,81 @@ VACUUM FULL pg_database;
 VACUUM FULL vaccluster;
 VACUUM FULL vactst;
 
+CREATE TABLE vacparallel (a int, b int);
+CREATE INDEX vacparallel_a ON vacparallel (a);
+CREATE INDEX vacparallel_b ON vacparallel (b);
+INSERT INTO vacparallel SELECT i, i FROM generate_series(1, 1000) i;
+DELETE FROM vacparallel WHERE a % 2 = 0;
+VACUUM (PARALLEL) vacparallel;
+SELECT count(*) FROM vacparallel WHERE a > 500;
+DROP TABLE vacparallel;
+
+-- vacuum a table in slices.  The rows of an aborted insert are dead to
+-- everyone, so each block a VACUUM covers becomes empty and all-visible.
+CREATE TABLE vacslice (a int, b text) WITH (autovacuum_enabled = off);
+CREATE INDEX vacslice_a ON vacslice (a);
+BEGIN;
+INSERT INTO vacslice SELECT i, repeat('x', 100) FROM generate_series(1, 580) i;
+ROLLBACK;
+-- the saved resume point travels through the stats collector
+CREATE FUNCTION wait_for_vacslice_vacuum(n int) RETURNS void AS $$
+BEGIN
+  FOR i IN 1 .. 300 LOOP
+    EXIT WHEN (SELECT vacuum_count FROM pg_stat_user_tables
+               WHERE relname = 'vacslice') >= n;
+    PERFORM pg_sleep(0.1);
+    PERFORM pg_stat_clear_snapshot();
+  END LOOP;
+END
+$$ LANGUAGE plpgsql;
+SET vacuum_max_blocks = 4;
+VACUUM vacslice;
+SELECT relpages, relallvisible FROM pg_class WHERE relname = 'vacslice';
+SELECT wait_for_vacslice_vacuum(1);
+VACUUM vacslice;
+SELECT relpages, relallvisible FROM pg_class WHERE relname = 'vacslice';
+SELECT wait_for_vacslice_vacuum(2);
+RESET vacuum_max_blocks;
+-- without a limit, a manual VACUUM starts over at block 0 and covers the
+-- whole table, so it can truncate it completely
+VACUUM vacslice;
+SELECT relpages, relallvisible FROM pg_class WHERE relname = 'vacslice';
+DROP FUNCTION wait_for_vacslice_vacuum(int);
+DROP TABLE vacslice;
+
+-- dead tuples scattered over the table, a few per page at high offsets on
+-- some pages and filling others completely, are removed from table and index
+CREATE TABLE vacscatter (a int, b text) WITH (autovacuum_enabled = off);
+CREATE INDEX vacscatter_a ON vacscatter (a);
+DO $$
+BEGIN
+  FOR i IN 1 .. 2000 LOOP
+    BEGIN
+      INSERT INTO vacscatter VALUES (i, 'x');
+      IF i % 37 = 0 THEN
+        RAISE EXCEPTION 'discard row %', i;
+      END IF;
+    EXCEPTION WHEN raise_exception THEN
+      NULL;
+    END;
+  END LOOP;
+END
+$$;
+BEGIN;
+INSERT INTO vacscatter SELECT i, 'y' FROM generate_series(2001, 3000) i;
+ROLLBACK;
+INSERT INTO vacscatter SELECT i, 'z' FROM generate_series(3001, 3100) i;
+VACUUM vacscatter;
+-- new rows reuse the freed line pointers, so stale index entries would show
+INSERT INTO vacscatter SELECT -i, 'w' FROM generate_series(1, 3000) i;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*), sum(a) FROM vacscatter WHERE a > 0;
+SELECT * FROM vacscatter WHERE a IN (37, 1998, 1999, 2500, 3001) ORDER BY a;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+SELECT count(*), sum(a) FROM vacscatter WHERE a > 0;
+DROP TABLE vacscatter;
+
 DROP TABLE vaccluster;
 DROP TABLE vactst;
@@ -0,0 +1,130 @@
+# Test that generic plans are shared between backends through the shared
+# plan cache, that DDL removes them, and that plans which are only valid
+# for one session or one role are never handed to another.
+use strict;
+use warnings;
+use TestLib;
+use Test::More tests => 8;
+use IPC::Run qw(run start pump finish timeout);
+
+my $tempdir = TestLib::tempdir;
+my $pgdata  = "$tempdir/pgdata";
+
+# runs the given SQL as one query string in a new backend, and returns
+# the output of the last statement
+sub query
+{
+	my ($sql, $user) = @_;
+	my ($stdout, $stderr);
+	my @cmd = ('psql', '-X', '-A', '-t', '-d', 'postgres');
+
+	push @cmd, '-U', $user if defined $user;
+	run [ @cmd, '-c', $sql ], '>', \$stdout, '2>', \$stderr
+	  or die "psql failed: $stderr";
+	chomp $stdout;
+	return $stdout;
+}
+
+# like query, but returns the error output of a command expected to fail
+sub query_error
+{
+	my ($sql, $user) = @_;
+	my ($stdout, $stderr);
+
+	run [ 'psql', '-X', '-A', '-t', '-d', 'postgres', '-U', $user,
+		'-c', $sql ],
+	  '>', \$stdout, '2>', \$stderr;
+	return $stderr;
+}
+
+my $prepare_sql = q{
+	PREPARE q AS SELECT b FROM spc WHERE a = 1;
+	EXPLAIN (COSTS OFF) EXECUTE q;
+};
+
+start_test_server($tempdir);
+
+# autovacuum must not analyze the table behind our back
+open CONF, ">>$pgdata/postgresql.conf";
+print CONF "shared_plan_cache_size = 1024\n";
+print CONF "autovacuum = off\n";
+close CONF;
+restart_test_server();
+
+# A one-row table is best scanned sequentially.  Adding rows sends no
+# invalidation, so a backend that plans the statement afresh afterwards
+# picks the index, while one that reuses the shared plan keeps the
+# sequential scan.
+psql 'postgres', q{
+	CREATE TABLE spc (a int, b text);
+	INSERT INTO spc VALUES (1, 'one');
+	CREATE INDEX spc_a_idx ON spc (a);
+	ANALYZE spc;
+};
+like(query($prepare_sql), qr/Seq Scan on spc/,
+	'generic plan built for the small table');
+
+psql 'postgres', q{
+	INSERT INTO spc SELECT g, 'many' FROM generate_series(2, 100000) g;
+};
+like(query('EXPLAIN (COSTS OFF) SELECT b FROM spc WHERE a = 1'),
+	qr/Index Scan using spc_a_idx on spc/,
+	'a fresh plan uses the index');
+like(query($prepare_sql), qr/Seq Scan on spc/,
+	'second backend reuses the shared plan');
+
+# DDL on the table removes the shared plan
+psql 'postgres', 'CREATE INDEX spc_b_idx ON spc (b)';
+like(query($prepare_sql), qr/Index Scan using spc_a_idx on spc/,
+	'shared plan is replanned after DDL');
+
+# A plan that reads a temporary table through an inlined function has the
+# same key in every session, but must not be shared.  The first session
+# has to stay connected, as its temporary table would otherwise be
+# dropped and the plan invalidated anyway.
+psql 'postgres', q{
+	SET check_function_bodies = off;
+	CREATE FUNCTION spc_rows() RETURNS SETOF int LANGUAGE sql STABLE
+		AS 'SELECT a FROM spc_tmp';
+};
+
+my ($in, $out, $err) = ('', '', '');
+my $h = start [ 'psql', '-X', '-q', '-A', '-t', '-d', 'postgres' ],
+  '<', \$in, '>', \$out, '2>', \$err, timeout(180);
+$in .= q{
+	CREATE TEMP TABLE spc_tmp (a int);
+	INSERT INTO spc_tmp VALUES (1);
+	PREPARE tq AS SELECT count(*) FROM spc_rows();
+	EXECUTE tq;
+};
+pump $h until $out =~ /^\d+$/m || $err ne '';
+is($out, "1\n", 'first session counts its own temporary table');
+
+is( query(
+		q{
+	CREATE TEMP TABLE spc_tmp (a int);
+	INSERT INTO spc_tmp VALUES (1), (2);
+	PREPARE tq AS SELECT count(*) FROM spc_rows();
+	EXECUTE tq;
+}), '2', 'second session counts its own temporary table');
+
+$in .= "\\q\n";
+finish $h;
+
+# The planner inlines a SQL function only if the current user may execute
+# it, and nothing checks the permission once the call is gone.  A plan
+# built by a privileged role must not be reused by one without EXECUTE.
+psql 'postgres', q{
+	CREATE ROLE spc_unprivileged LOGIN;
+	CREATE FUNCTION spc_secret() RETURNS int LANGUAGE sql AS 'SELECT 42';
+	REVOKE EXECUTE ON FUNCTION spc_secret() FROM PUBLIC;
+};
+my $secret_sql = q{
+	PREPARE sq AS SELECT spc_secret();
+	EXECUTE sq;
+};
+is(query($secret_sql), '42', 'privileged role runs the function');
+like(
+	query_error($secret_sql, 'spc_unprivileged'),
+	qr/permission denied for function spc_secret/,
+	'unprivileged role does not get the privileged role\'s plan');
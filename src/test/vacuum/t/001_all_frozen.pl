@@ -0,0 +1,79 @@
+# Test that VACUUM FREEZE skips pages marked all-frozen in the visibility map,
+# that locking a row clears the mark, and that relfrozenxid still advances.
+use strict;
+use warnings;
+use TestLib;
+use Test::More tests => 10;
+use IPC::Run qw(run);
+
+my $tempdir = TestLib::tempdir;
+my $pgdata  = "$tempdir/pgdata";
+
+sub query
+{
+	my ($sql) = @_;
+	my ($stdout, $stderr);
+
+	run [ 'psql', '-X', '-A', '-t', '-d', 'postgres', '-c', $sql ],
+	  '>', \$stdout, '2>', \$stderr
+	  or die "psql failed: $stderr";
+	chomp $stdout;
+	return $stdout;
+}
+
+# returns the INFO output of a verbose VACUUM FREEZE
+sub vacuum_freeze
+{
+	my ($stdout, $stderr);
+
+	run [ 'psql', '-X', '-d', 'postgres', '-c',
+		'VACUUM (FREEZE, VERBOSE) frz' ],
+	  '>', \$stdout, '2>', \$stderr
+	  or die "psql failed: $stderr";
+	return $stderr;
+}
+
+my $frozenxid_sql = "SELECT relfrozenxid FROM pg_class WHERE relname = 'frz'";
+
+start_test_server($tempdir);
+
+# keep autovacuum from holding back the xmin horizon
+open CONF, ">>$pgdata/postgresql.conf";
+print CONF "autovacuum = off\n";
+close CONF;
+restart_test_server();
+
+psql 'postgres', q{
+	CREATE TABLE frz (id int, t text) WITH (autovacuum_enabled = off);
+	INSERT INTO frz SELECT g, repeat('x', 100) FROM generate_series(1, 10000) g;
+	VACUUM FREEZE frz;
+};
+my $npages = query("SELECT relpages FROM pg_class WHERE relname = 'frz'");
+my $frozenxid = query($frozenxid_sql);
+my $rest = $npages - 1;
+
+my $log = vacuum_freeze();
+like($log, qr/in 0 out of $npages pages/, 'all-frozen table is not read');
+like($log, qr/Skipped $npages frozen pages/, 'all pages skipped as frozen');
+
+# locking a row stores an xmax, so its page is no longer all-frozen
+psql 'postgres', q{
+	BEGIN;
+	SELECT * FROM frz WHERE id = 1 FOR UPDATE;
+	COMMIT;
+};
+isnt(query("SELECT xmax FROM frz WHERE id = 1"), '0', 'locked row has an xmax');
+
+$log = vacuum_freeze();
+like($log, qr/in 1 out of $npages pages/, 'page of locked row is read');
+like($log, qr/Skipped $rest frozen pages/, 'other pages skipped as frozen');
+is(query("SELECT xmax FROM frz WHERE id = 1"), '0', 'lock is frozen away');
+isnt(query($frozenxid_sql), $frozenxid, 'relfrozenxid advanced');
+
+# the page has been marked all-frozen again
+$log = vacuum_freeze();
+like($log, qr/in 0 out of $npages pages/, 'all-frozen table is not read again');
+like($log, qr/Skipped $npages frozen pages/, 'all pages skipped as frozen again');
+
+is(query("SELECT count(*), sum(id) FROM frz"), '10000|50005000',
+	'contents intact');